@@ -0,0 +1,298 @@
+import argparse
+import base64
+import ctypes
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+parser = argparse.ArgumentParser("Network frame capture dump, analysis and replay.")
+parser.add_argument("-dst, -D", dest="port_dest", type=str, nargs=1, help="Serial port to dump the capture ring from")
+parser.add_argument("-o", dest="output", type=str, help="File to write the dumped (or replayed) capture to")
+parser.add_argument("-i", dest="input", type=str, nargs="+", help="Capture file(s) to analyse, a second file is compared against the first")
+parser.add_argument("-r", dest="replay", type=str, help="Capture file to replay into the host build of the network layer")
+parser.add_argument("--id", dest="node_id", type=lambda v: int(v, 0), default=None,
+                    help="Node-id of the captured node, by default the source of its first frame")
+parser.add_argument("--root", dest="root", action="store_true", help="The captured node is the root")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Seed of esp_random() in the replay")
+parser.add_argument("-X", dest="defines", action="append", default=[],
+                    help="Define for the replay build, as the captured firmware had it, e.g. -X NET_TDMA")
+parser.add_argument("--mbedtls", dest="mbedtls", default=None,
+                    help="mbedtls prefix (include/, lib/) if not installed system wide")
+args = parser.parse_args()
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+SRC = os.path.join(ROOT, "serial", "main")
+HOST = os.path.join(ROOT, "serial", "host")
+
+# Layout of CaptureEntry / NetFrame in net_layer.h (packed, little endian).
+#  Dumps from before 5.27.6 have no MAC.
+ENTRY = struct.Struct("<qB6s")
+ENTRY_NO_MAC = struct.Struct("<qB")
+HEADER = struct.Struct("<BBBBB11s")
+FRAME_SIZE = 16 + 136
+ENTRY_SIZE = ENTRY.size + FRAME_SIZE
+CHECKSUM = 3
+RES_IDENT = 1
+BROADCAST = 0xFF
+STEP = 10000  # us, replay steps while waiting for the node's own frames
+WAIT_OWN = 10000000  # us, how long past their captured time
+
+CONTROL = ["DEFAULT", "LOCATE", "LINK", "STATUS", "MAP", "BLACKOUT", "FREEZE", "GROUP", "LEASE", "LATERAL", "HEALTH"]
+LOCATE, LINK, LEASE = 1, 2, 8
+DIRECTION = ["in", "out"]
+
+
+def dump_device(port, output):
+    import serial
+
+    ser = serial.Serial(port=port, baudrate=115200, timeout=10, write_timeout=10)
+    ser.reset_input_buffer()
+    ser.write("NET_CAPTURE DUMP\n".encode("ascii"))
+
+    line = ""
+    while not line.startswith("capture "):
+        line = ser.readline().decode("ascii").strip()
+    if line == "capture disabled":
+        print("The device was built without NET_CAPTURE")
+        return
+
+    _, count, total, size = line.split(" ")
+    if int(size) not in (ENTRY_SIZE, ENTRY_NO_MAC.size + FRAME_SIZE):
+        print(f"Entry size mismatch: device {size}, expected {ENTRY_SIZE}")
+        return
+
+    with open(output, "w") as out:
+        for _ in range(int(count)):
+            out.write(ser.readline().decode("ascii").strip() + "\n")
+
+    print(f"Dumped {count} of {total} captured frames to {output}")
+
+
+def load(path):
+    entries = []
+    with open(path) as f:
+        for line in f:
+            raw = base64.b64decode(line.strip())
+            if len(raw) == ENTRY_SIZE:
+                time, direction, mac = ENTRY.unpack_from(raw)
+            elif len(raw) == ENTRY_NO_MAC.size + FRAME_SIZE:
+                (time, direction), mac = ENTRY_NO_MAC.unpack_from(raw), None
+            else:
+                continue
+            frame = raw[len(raw) - FRAME_SIZE:]
+            version, source, destination, checksum, control, reserved = HEADER.unpack_from(frame)
+            entries.append({
+                "time": time,
+                "direction": direction,
+                "mac": mac if mac != bytes(6) else None,
+                "source": source,
+                "destination": destination,
+                "control": control,
+                "frame": frame,
+            })
+    return entries
+
+
+def save(path, entries):
+    with open(path, "w") as out:
+        for e in entries:
+            raw = ENTRY.pack(e["time"], e["direction"], e["mac"] or bytes(6)) + e["frame"]
+            out.write(base64.b64encode(raw).decode("ascii") + "\n")
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def analyse(entries):
+    result = {}
+    for direction in (0, 1):
+        frames = [e for e in entries if e["direction"] == direction]
+        if len(frames) < 2:
+            result[direction] = None
+            continue
+
+        span = (frames[-1]["time"] - frames[0]["time"]) / 1e6
+        gaps = [b["time"] - a["time"] for a, b in zip(frames, frames[1:])]
+        result[direction] = {
+            "frames": len(frames),
+            "rate": len(frames) / span if span > 0 else 0,
+            "throughput": len(frames) * FRAME_SIZE / span if span > 0 else 0,
+            "p50": percentile(gaps, 50),
+            "p99": percentile(gaps, 99),
+            "controls": {c: sum(1 for f in frames if f["control"] == i) for i, c in enumerate(CONTROL)},
+        }
+    return result
+
+
+def report(path, stats, baseline=None):
+    print(f"{path}:")
+    for direction, s in stats.items():
+        if s is None:
+            print(f"  {DIRECTION[direction]:>3}: too few frames")
+            continue
+        print(f"  {DIRECTION[direction]:>3}: {s['frames']} frames, {s['rate']:.1f} frames/s, "
+              f"{s['throughput']:.0f} B/s, gap p50 {s['p50']}us p99 {s['p99']}us")
+        print("       " + " ".join(f"{c}={n}" for c, n in s["controls"].items() if n))
+        if baseline and baseline.get(direction):
+            b = baseline[direction]
+            print(f"       vs baseline: rate {s['rate'] - b['rate']:+.1f} frames/s, "
+                  f"gap p99 {s['p99'] - b['p99']:+d}us")
+
+
+class CaptureEntry(ctypes.Structure):
+    _pack_ = 1
+    _fields_ = [("time", ctypes.c_int64), ("direction", ctypes.c_uint8), ("mac", ctypes.c_uint8 * 6),
+                ("frame", ctypes.c_uint8 * FRAME_SIZE)]
+
+
+def host_build():
+    """The network layer and net_replay.c against the stubs in serial/host, as net_fuzz.py builds it."""
+    sources = [os.path.join(SRC, f) for f in ("net_layer.c", "net_wheel.c", "net_lease.c", "net_health.c",
+                                              "net_crypto.c", "utils.c")]
+    sources += [os.path.join(HOST, "host.c"), os.path.join(HOST, "net_replay.c")]
+    out = os.path.join(tempfile.mkdtemp(), "libnetreplay.so")
+    cmd = ["gcc", "-O2", "-g", "-shared", "-fPIC", "-Wno-int-to-pointer-cast", "-Wno-pointer-to-int-cast",
+           "-I", HOST, "-I", SRC]
+    libs = ["-lmbedcrypto"]
+    if args.mbedtls:
+        cmd += ["-I", os.path.join(args.mbedtls, "include")]
+        libs = ["-L", os.path.join(args.mbedtls, "lib"), "-Wl,-rpath," + os.path.join(args.mbedtls, "lib")] + libs
+    cmd += ["-D" + d for d in args.defines]
+    subprocess.check_call(cmd + ["-o", out] + sources + libs)
+    lib = ctypes.CDLL(out)
+    lib.replay_boot.argtypes = [ctypes.c_uint64, ctypes.c_uint8, ctypes.c_int]
+    lib.replay_until.argtypes = [ctypes.c_int64]
+    lib.replay_frame.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+    lib.replay_sent.argtypes = [ctypes.POINTER(CaptureEntry), ctypes.c_int]
+    return lib
+
+
+def peer_mac(node_id):
+    """A MAC for a sender the dump has none for, one per node-id."""
+    return bytes([0x02, 0x00, 0x5e, 0x10, 0x00, node_id])
+
+
+def rewrite(frame, at, value):
+    """frame with 'value' at 'at', the checksum as right (or wrong) as it was."""
+    new = bytearray(frame)
+    new[at:at + len(value)] = value
+    delta = 0
+    for a, b in zip(frame, new):
+        delta ^= a ^ b
+    new[CHECKSUM] ^= delta
+    return bytes(new)
+
+
+def replay(entries):
+    """
+    Offers the captured inbound frames to a freshly booted node at their
+    capture times, its timers firing in between, and compares what it sends
+    with the captured outbound frames. What the device drew at random is
+    mapped as the replay learns it: the ident of its LOCATE (answered in
+    LINK) and its MAC (in LEASE records). Sealed contents (NET_ENCRYPT,
+    NET_LINK_KX) do not replay, their keys differ.
+    """
+    entries = sorted(entries, key=lambda e: e["time"])
+    captured = [e for e in entries if e["direction"] == 1]
+    node_id = args.node_id
+    if node_id is None:
+        node_id = captured[0]["source"] if captured else next(
+            (e["destination"] for e in entries if e["destination"] != BROADCAST), 1)
+
+    lib = host_build()
+    own = ctypes.create_string_buffer(6)
+    if lib.replay_boot(args.seed, node_id, int(args.root)) != 0:
+        raise SystemExit("replay: net_init failed")
+    lib.esp_read_mac(own, 0)
+
+    buf = (CaptureEntry * 256)()
+    replayed, ident, device_mac, error = [], {}, None, 0
+
+    def collect():
+        nonlocal device_mac
+        n = lib.replay_sent(buf, len(buf))
+        for c in buf[:n]:
+            frame = bytes(c.frame)
+            replayed.append({"time": c.time, "direction": 1, "mac": bytes(c.mac), "source": frame[1],
+                             "destination": frame[2], "control": frame[4], "frame": frame})
+        # Pair the k-th LOCATE and LEASE of either side.
+        for control in (LOCATE, LEASE):
+            mine = [e for e in replayed if e["control"] == control]
+            theirs = [e for e in captured if e["control"] == control]
+            for a, b in zip(theirs, mine):
+                if control == LOCATE:
+                    ident[a["frame"][5 + RES_IDENT]] = b["frame"][5 + RES_IDENT]
+                else:
+                    device_mac = a["frame"][16:22]
+
+    # An inbound frame goes in as long after the node's last frame before it
+    #  as it was captured: the replayed node draws its timers at random.
+    fed, now, shift, before = [], 0, 0, 0
+    for e in entries:
+        if e["direction"] != 0:
+            before += 1
+            continue
+        while len(replayed) < before and now < e["time"] + shift + WAIT_OWN:
+            now += STEP
+            error = error or lib.replay_until(now)
+            collect()
+        if before and len(replayed) >= before:
+            shift = replayed[before - 1]["time"] - captured[before - 1]["time"]
+        now = max(now, e["time"] + shift)
+        error = error or lib.replay_until(now)
+        collect()
+
+        frame, mac = e["frame"], e["mac"] or peer_mac(e["source"])
+        if e["control"] == LINK and frame[5 + RES_IDENT] in ident:
+            frame = rewrite(frame, 5 + RES_IDENT, bytes([ident[frame[5 + RES_IDENT]]]))
+        if e["control"] == LEASE and device_mac and frame[16:22] == device_mac:
+            frame = rewrite(frame, 16, own.raw)
+        fed.append(dict(e, time=now, mac=mac, frame=frame))
+        error = error or lib.replay_frame(mac, frame, len(frame))
+        collect()
+    if captured:
+        error = error or lib.replay_until(max(now, captured[-1]["time"] + shift))
+    collect()
+
+    # The outbound frames in order, by control type and destination.
+    want = [(e["control"], e["destination"]) for e in captured]
+    got = [(e["control"], e["destination"]) for e in replayed]
+    same = 0
+    while same < min(len(want), len(got)) and want[same] == got[same]:
+        same += 1
+
+    def describe(e):
+        name = CONTROL[e["control"]] if e["control"] < len(CONTROL) else str(e["control"])
+        return f"{name} to 0x{e['destination']:02X} at {e['time']}us"
+
+    print(f"replay of {len(fed)} inbound frames into node 0x{node_id:02X}{' (root)' if args.root else ''}, "
+          f"seed {args.seed}, {lib.replay_reboots()} reboots")
+    print(f"  out: {len(captured)} captured, {len(replayed)} replayed, first {same} the same")
+    if same < max(len(want), len(got)):
+        print(f"  first difference: captured {describe(captured[same]) if same < len(captured) else 'nothing'}, "
+              f"replayed {describe(replayed[same]) if same < len(replayed) else 'nothing'}")
+    if error:
+        print(f"  check_table() failed: {error}")
+    if args.output:
+        save(args.output, sorted(fed + replayed, key=lambda e: e["time"]))
+    return 0 if not error and want == got else 1
+
+
+if args.port_dest:
+    dump_device(args.port_dest[0], args.output or "capture.txt")
+
+if args.input:
+    baseline = None
+    for path in args.input:
+        stats = analyse(load(path))
+        report(path, stats, baseline)
+        baseline = baseline or stats
+
+if args.replay:
+    sys.exit(replay(load(args.replay)))
@@ -0,0 +1,207 @@
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import tempfile
+import threading
+import time
+
+parser = argparse.ArgumentParser("Host check of the Collatz kernels: bit-exact agreement and numbers/s (COLLATZ_BENCH on a node).")
+parser.add_argument("-n", dest="numbers", type=int, default=1 << 20, help="Odd numbers per kernel for the benchmark")
+parser.add_argument("-c", dest="cases", type=int, default=20000, help="Random cases per range for the agreement test")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+parser.add_argument("-w", dest="workers", type=int, default=2, help="Workers for the block time, slices interleaved")
+args = parser.parse_args()
+
+SRC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "serial", "main")
+
+# Mirrors rl_int.h and collatz_kernel.h.
+INT_LEN = 10
+BLEN = 30
+MASK = (1 << BLEN) - 1
+
+# Mirrors collatz.c: a block of 2^BLOCKSHIFT integers in slices of SLICE odd numbers.
+BLOCKSHIFT = 22
+SLICE = 0x1000
+SLICES = (1 << BLOCKSHIFT) // 2 // SLICE
+SIEVE_K = 16
+
+
+class BigInt(ctypes.Structure):
+    _fields_ = [("len", ctypes.c_uint32), ("a", ctypes.c_uint32 * INT_LEN)]
+
+
+def to_big(n):
+    b = BigInt()
+    while n:
+        b.a[b.len] = n & MASK
+        b.len += 1
+        n >>= BLEN
+    return b
+
+
+def from_big(b):
+    n = 0
+    for i in reversed(range(b.len)):
+        n = (n << BLEN) | b.a[i]
+    return n
+
+
+class Sieve(ctypes.Structure):
+    _fields_ = [("k", ctypes.c_int), ("mask", ctypes.c_uint32), ("survivors", ctypes.c_uint32),
+                ("bits", ctypes.POINTER(ctypes.c_uint8))]
+
+
+def build():
+    out = os.path.join(tempfile.mkdtemp(), "libcollatz.so")
+    subprocess.check_call(["gcc", "-O2", "-shared", "-fPIC", "-I", SRC, "-o", out,
+                           os.path.join(SRC, "rl_int.c"), os.path.join(SRC, "collatz_kernel.c"),
+                           os.path.join(SRC, "collatz_sieve.c")])
+    lib = ctypes.CDLL(out)
+    for name in ("ck_descend_plain", "ck_descend", "ck_descend_wide"):
+        getattr(lib, name).argtypes = [ctypes.POINTER(BigInt), ctypes.POINTER(BigInt)]
+    lib.ck_run.argtypes = [ctypes.c_void_p, ctypes.POINTER(BigInt), ctypes.c_uint32]
+    lib.ck_range.argtypes = [ctypes.POINTER(BigInt), ctypes.c_uint32, ctypes.c_void_p]
+    lib.cs_init.argtypes = [ctypes.POINTER(Sieve), ctypes.c_int]
+    return lib
+
+
+def descend(n, limit, k):
+    """ck_descend in Python: k steps per jump from 2^30 up, single odd steps below."""
+    while n > limit:
+        if n >> BLEN:
+            for _ in range(k):
+                n = (3 * n + 1) >> 1 if n & 1 else n >> 1
+        else:
+            if n & 1:
+                n = 3 * n + 1
+            while not n & 1:
+                n >>= 1
+    return n
+
+
+def agreement(lib, k, rnd):
+    # (bits of the start, how far the limit sits below it): the frame above
+    # 2^68, the top of the 128 bit words, promotion past 2^128, rl_int only
+    # and the small values of START_FROM_ONE.
+    ranges = [(69, 2), (100, 1 << 40), (119, 1 << 100), (120, 1 << 118), (127, 2), (140, 2), (24, 2)]
+    bad = 0
+    for bits, below in ranges:
+        for _ in range(args.cases):
+            n = rnd.getrandbits(bits) | (1 << (bits - 1)) | 1
+            limit = max(n - rnd.randrange(2, below + 2), 1)
+            want = descend(n, limit, k)
+            for name in ("ck_descend", "ck_descend_wide"):
+                x, lim = to_big(n), to_big(limit)
+                if getattr(lib, name)(ctypes.byref(x), ctypes.byref(lim)) or from_big(x) != want:
+                    bad += 1
+                    print(f"  {name} disagrees on n=0x{n:x} limit=0x{limit:x}")
+        print(f"  {bits:>3} bit starts: {args.cases} cases")
+    return bad
+
+
+def survives(r, k):
+    """collatz_sieve.c: no j <= k with 3^c < 2^j."""
+    c = 0
+    for j in range(1, k + 1):
+        if r & 1:
+            r, c = (3 * r + 1) >> 1, c + 1
+        else:
+            r >>= 1
+        if 3 ** c < 1 << j:
+            return False
+    return True
+
+
+def sieved_ranges(lib, rnd, k=16, count=1 << 16):
+    """ck_range with the sieve runs exactly the survivors, on words and on rl_int."""
+    sieve = Sieve()
+    if lib.cs_init(ctypes.byref(sieve), k):
+        raise SystemExit("cs_init failed")
+    keep = [survives(r, k) if r & 1 else False for r in range(1 << k)]
+    bad = 0
+    for bits in (80, 118, 125):
+        base = rnd.getrandbits(bits) | (1 << (bits - 1)) | 1
+        want = sum(keep[(base + 2 * (i + 1)) & ((1 << k) - 1)] for i in range(count))
+        level = to_big(base)
+        got = lib.ck_range(ctypes.byref(level), count, ctypes.byref(sieve))
+        if got != want or from_big(level) != base + 2 * count:
+            bad += 1
+            print(f"  ck_range from 0x{base:x}: ran {got}, survivors {want}")
+        print(f"  {bits:>3} bit range: {got} of {count} run")
+    return bad
+
+
+def benchmark(lib):
+    base = to_big((1 << 68) - 1)  # collatz_init
+    results = {}
+    for name in ("ck_descend_plain", "ck_descend", "ck_descend_wide"):
+        fn = ctypes.cast(getattr(lib, name), ctypes.c_void_p)
+        t0 = time.perf_counter()
+        if lib.ck_run(fn, ctypes.byref(base), args.numbers):
+            raise SystemExit(f"{name}: overflow")
+        results[name] = args.numbers / (time.perf_counter() - t0)
+    # the block loop of compute_block: the whole range on 128 bit words
+    level = to_big(from_big(base))
+    t0 = time.perf_counter()
+    if lib.ck_range(ctypes.byref(level), args.numbers, None) != args.numbers:
+        raise SystemExit("ck_range: overflow")
+    results["ck_range"] = args.numbers / (time.perf_counter() - t0)
+    if from_big(level) != from_big(base) + 2 * args.numbers:
+        raise SystemExit("ck_range: level not advanced")
+    return results
+
+
+def block_time(lib, workers):
+    """compute_slices: one sieved block from 2^68, slice s on worker s % workers, wall time."""
+    sieve = Sieve()
+    if lib.cs_init(ctypes.byref(sieve), SIEVE_K):
+        raise SystemExit("cs_init failed")
+    start = (1 << 68) - 1
+    tested = [0] * workers
+
+    def worker(w):
+        for s in range(w, SLICES, workers):
+            level = to_big(start + s * SLICE * 2)
+            t = lib.ck_range(ctypes.byref(level), SLICE, ctypes.byref(sieve))
+            if t < 0:
+                raise SystemExit("ck_range: overflow")
+            tested[w] += t
+
+    threads = [threading.Thread(target=worker, args=(w,)) for w in range(workers)]
+    t0 = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return time.perf_counter() - t0, tested
+
+
+lib = build()
+k = lib.ck_steps()
+rnd = random.Random(args.seed)
+
+print(f"agreement, k {k}:")
+bad = agreement(lib, k, rnd) + sieved_ranges(lib, rnd)
+print("  PASS" if not bad else f"  FAIL ({bad})")
+
+print(f"throughput, {args.numbers} odd numbers from 2^68:")
+r = benchmark(lib)
+plain = r["ck_descend_plain"]
+for name, label in (("ck_descend_plain", "plain"), ("ck_descend", "table"), ("ck_descend_wide", "wide"),
+                    ("ck_range", "range")):
+    print(f"  {label:>5}: {r[name]:>12.0f} numbers/s  x{r[name] / plain:.2f}")
+
+print(f"block time, sieve k {SIEVE_K}, {SLICES} slices of {SLICE}:")
+one, tested = block_time(lib, 1)
+print(f"  1 worker:  {one * 1000:8.1f} ms, {tested[0]} numbers run")
+cpus = len(os.sched_getaffinity(0))
+if args.workers > 1 and cpus < args.workers:
+    print(f"  {args.workers} workers: unverified, {cpus} CPU(s) to run them on "
+          f"(on a node: COLLATZ_STATS block after COLLATZ_WORKERS 1 and {args.workers})")
+elif args.workers > 1:
+    many, tested = block_time(lib, args.workers)
+    print(f"  {args.workers} workers: {many * 1000:8.1f} ms, x{one / many:.2f}, numbers run " +
+          " / ".join(str(t) for t in tested))
+raise SystemExit(1 if bad else 0)
@@ -0,0 +1,266 @@
+import argparse
+import ctypes
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+parser = argparse.ArgumentParser("Host check of the Collatz frame checkpoint: set_frame, save to NVS, resume after a "
+                                 "reboot; and of the snapshot a joining node takes from its parent.")
+parser.add_argument("-c", dest="cases", type=int, default=20, help="Random frames to round-trip")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+parser.add_argument("--mbedtls", dest="mbedtls", default=None,
+                    help="mbedtls prefix (include/, lib/) if not installed system wide")
+args = parser.parse_args()
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+SRC = os.path.join(ROOT, "serial", "main")
+HOST = os.path.join(ROOT, "serial", "host")
+
+# collatz.c and the network layer under it, against the stubs in serial/host.
+SOURCES = [os.path.join(SRC, f) for f in ("collatz.c", "collatz_frame.c", "collatz_kernel.c", "collatz_sieve.c",
+                                          "rl_int.c", "net_layer.c", "net_wheel.c", "net_lease.c",
+                                          "net_health.c", "net_crypto.c", "utils.c")] + \
+          [os.path.join(HOST, f) for f in ("host.c", "net_replay.c")]
+
+# Mirrors collatz.c (default build) and rl_int.h.
+BLOCKSHIFT = 22
+BLOCKS = 1024
+INT_LEN = 10
+BLEN = 30
+START = (1 << 68) - 1
+
+# checkpoint_t: blocksize, blocks, frame, base (bigint_t), done bits.
+CHECKPOINT = struct.Struct("<III I%dI %ds" % (INT_LEN, (BLOCKS + 7) // 8))
+HOST_NVS_NAME = 16
+
+# Mirrors net_layer.h (default build) for the two-node run.
+FRAME = 152
+MESH_STEP = 10_000
+MESH_TIME = 120_000_000
+
+
+class CaptureEntry(ctypes.Structure):
+    _pack_ = 1
+    _fields_ = [("time", ctypes.c_int64), ("direction", ctypes.c_uint8), ("mac", ctypes.c_uint8 * 6),
+                ("frame", ctypes.c_uint8 * FRAME)]
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [("sieve_k", ctypes.c_int), ("survivors", ctypes.c_uint32), ("blocks", ctypes.c_uint32),
+                ("tested", ctypes.c_uint64), ("skipped", ctypes.c_uint64), ("block_us", ctypes.c_int64),
+                ("workers", ctypes.c_int), ("resumed", ctypes.c_int), ("wasted", ctypes.c_uint32),
+                ("joins", ctypes.c_uint32), ("sync_requests", ctypes.c_uint32), ("sync_us", ctypes.c_int64),
+                ("reports", ctypes.c_uint32), ("steals", ctypes.c_uint32), ("takeovers", ctypes.c_uint32),
+                ("duplicates", ctypes.c_uint32), ("parts", ctypes.c_uint32), ("frame_us", ctypes.c_int64)]
+
+
+def build():
+    out = os.path.join(tempfile.mkdtemp(), "libcollatz.so")
+    cmd = ["gcc", "-O2", "-shared", "-fPIC", "-Wno-int-to-pointer-cast", "-Wno-pointer-to-int-cast",
+           "-I", HOST, "-I", SRC]
+    libs = ["-lmbedcrypto"]
+    if args.mbedtls:
+        cmd += ["-I", os.path.join(args.mbedtls, "include")]
+        libs = ["-L", os.path.join(args.mbedtls, "lib"), "-Wl,-rpath," + os.path.join(args.mbedtls, "lib")] + libs
+    subprocess.check_call(cmd + ["-o", out] + SOURCES + libs)
+    return out
+
+
+def load(path):
+    """A fresh copy of the library, so that every node has its own statics."""
+    copy = os.path.join(tempfile.mkdtemp(), os.path.basename(path))
+    shutil.copy(path, copy)
+    lib = ctypes.CDLL(copy)
+    lib.host_reset.argtypes = [ctypes.c_uint64]
+    lib.host_nvs_export.argtypes = [ctypes.c_char_p, ctypes.c_int]
+    lib.host_nvs_import.argtypes = [ctypes.c_char_p, ctypes.c_int]
+    lib.raise_frame.argtypes = [ctypes.c_uint32]
+    lib.replay_boot.argtypes = [ctypes.c_uint64, ctypes.c_uint8, ctypes.c_int]
+    lib.replay_until.argtypes = [ctypes.c_int64]
+    lib.replay_frame.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+    lib.replay_sent.argtypes = [ctypes.POINTER(CaptureEntry), ctypes.c_int]
+    lib.collatz_comm_step.argtypes = [ctypes.c_int32]
+    return lib
+
+
+def boot(path, nvs):
+    """A fresh copy of the library is a node after a reboot: nothing kept but NVS."""
+    lib = load(path)
+    lib.host_reset(1)
+    lib.host_nvs_import(nvs, len(nvs))
+    lib.net_init(1, 1)
+    lib.collatz_init(1)
+    return lib
+
+
+def export(lib):
+    buf = ctypes.create_string_buffer(1 << 16)
+    n = lib.host_nvs_export(buf, len(buf))
+    assert n >= 0
+    return buf.raw[:n]
+
+
+def entries(nvs):
+    """(namespace, key) -> value of an exported NVS."""
+    out, at = {}, 0
+    while at < len(nvs):
+        space = nvs[at:at + HOST_NVS_NAME].rstrip(b"\0").decode()
+        key = nvs[at + HOST_NVS_NAME:at + 2 * HOST_NVS_NAME].rstrip(b"\0").decode()
+        (n,) = struct.unpack_from("<I", nvs, at + 2 * HOST_NVS_NAME)
+        out[space, key] = nvs[at + 2 * HOST_NVS_NAME + 4:at + 2 * HOST_NVS_NAME + 4 + n]
+        at += 2 * HOST_NVS_NAME + 4 + n
+    return out
+
+
+def replace(nvs, space, key, value):
+    """The exported NVS with one value swapped, same length."""
+    at = 0
+    while at < len(nvs):
+        (n,) = struct.unpack_from("<I", nvs, at + 2 * HOST_NVS_NAME)
+        if nvs[at:at + HOST_NVS_NAME].rstrip(b"\0") == space and \
+                nvs[at + HOST_NVS_NAME:at + 2 * HOST_NVS_NAME].rstrip(b"\0") == key:
+            assert n == len(value)
+            start = at + 2 * HOST_NVS_NAME + 4
+            return nvs[:start] + value + nvs[start + n:]
+        at += 2 * HOST_NVS_NAME + 4 + n
+    raise KeyError(key)
+
+
+def checkpoint(nvs):
+    fields = CHECKPOINT.unpack(entries(nvs)["collatz", "frame"])
+    blocksize, blocks, frame, length = fields[:4]
+    limbs = fields[4:4 + INT_LEN]
+    base = sum(limbs[i] << (BLEN * i) for i in range(length))
+    done = {i for i in range(BLOCKS) if fields[-1][i >> 3] & (1 << (i & 7))}
+    return blocksize, blocks, frame, base, done
+
+
+def stats(lib):
+    st = Stats()
+    lib.collatz_stats(ctypes.byref(st))
+    return st
+
+
+def resumed(lib):
+    return stats(lib).resumed
+
+
+def check(path, frame, done, rnd):
+    """Save at 'frame', resume with 'done' blocks, move on one block and save again."""
+    errors = []
+    lib = boot(path, b"")
+    lib.raise_frame(frame)
+    lib.collatz_checkpoint()
+    nvs = export(lib)
+    blocksize, blocks, saved, base, _ = checkpoint(nvs)
+    if (blocksize, blocks, saved) != (1 << BLOCKSHIFT, BLOCKS, frame) or base != START + (frame << BLOCKSHIFT):
+        errors.append(f"saved frame {saved} base {base:#x}, expected {frame} {START + (frame << BLOCKSHIFT):#x}")
+
+    # DONE blocks as a peer's reports would have left them.
+    raw = bytearray(entries(nvs)["collatz", "frame"])
+    for i in done:
+        raw[CHECKPOINT.size - (BLOCKS + 7) // 8 + (i >> 3)] |= 1 << (i & 7)
+    nvs = replace(nvs, b"collatz", b"frame", bytes(raw))
+
+    lib = boot(path, nvs)
+    if not resumed(lib):
+        errors.append("did not resume from a matching checkpoint")
+    lib.raise_frame(frame + 1)
+    lib.collatz_checkpoint()
+    _, _, saved, base, kept = checkpoint(export(lib))
+    want = {i - 1 for i in done if i > 0}
+    if saved != frame + 1 or base != START + ((frame + 1) << BLOCKSHIFT) or kept != want:
+        errors.append(f"after resume and one block: frame {saved}, {len(kept)} done, expected {frame + 1}, {len(want)}")
+
+    # A checkpoint written for another start must be ignored.
+    raw[12 + 4 + 4 * rnd.randrange(3)] ^= 1 << rnd.randrange(8)
+    lib = boot(path, replace(nvs, b"collatz", b"frame", bytes(raw)))
+    if resumed(lib):
+        errors.append("resumed from a checkpoint with another base")
+    return errors
+
+
+def entry(space, key, value):
+    """One NVS value as host_nvs_export lays it out."""
+    return space.ljust(HOST_NVS_NAME, b"\0") + key.ljust(HOST_NVS_NAME, b"\0") + struct.pack("<I", len(value)) + value
+
+
+def mesh(path, frame, done):
+    """A root at 'frame' with 'done' blocks and a node joining it: the node must
+    get in sync from the snapshot, all SNAP_PARTS parts of it, and then hold
+    the root's frame and DONE blocks."""
+    errors = []
+
+    # The root's state, as a checkpoint it resumes from.
+    lib = boot(path, b"")
+    lib.raise_frame(frame)
+    lib.collatz_checkpoint()
+    raw = bytearray(entries(export(lib))["collatz", "frame"])
+    for i in done:
+        raw[CHECKPOINT.size - (BLOCKS + 7) // 8 + (i >> 3)] |= 1 << (i & 7)
+
+    root, node = load(path), load(path)
+    macs = {id(root): bytes([2, 0, 0, 0, 0, 1]), id(node): bytes([2, 0, 0, 0, 0, 0x30])}
+    if root.replay_boot(1, 1, 1) or node.replay_boot(2, 0x30, 0):
+        return ["net_init failed"]
+    nvs = export(root) + entry(b"collatz", b"frame", bytes(raw))
+    root.host_nvs_import(nvs, len(nvs))
+    root.collatz_init(1)
+    node.collatz_init(0)
+    if not resumed(root):
+        return ["root did not resume its checkpoint"]
+
+    sent = (CaptureEntry * 64)()
+    now = 0
+    while now < MESH_TIME and not stats(node).joins:
+        now += MESH_STEP
+        for lib in (root, node):
+            if lib.replay_until(now):
+                return [f"check_table failed at {now / 1e6:.2f}s"]
+            while lib.collatz_comm_step(0):
+                pass
+        for src, dst in ((root, node), (node, root)):
+            for i in range(src.replay_sent(sent, len(sent))):
+                if dst.replay_frame(macs[id(src)], bytes(sent[i].frame), FRAME):
+                    return [f"check_table failed at {now / 1e6:.2f}s"]
+
+    st = stats(node)
+    if not node.net_has_uplink():
+        errors.append("node never joined")
+    elif not st.joins:
+        errors.append(f"not in sync after {now / 1e6:.0f}s, {st.sync_requests} requests")
+    else:
+        node.collatz_checkpoint()
+        _, _, got, _, kept = checkpoint(export(node))
+        if got != frame or kept != set(done):
+            errors.append(f"in sync at frame {got} with {len(kept)} done, expected {frame} with {len(done)}")
+    return errors
+
+
+if __name__ == "__main__":
+    rnd = random.Random(args.seed)
+    path = build()
+    frames = [0, 1, (1 << 20) - 1] + [rnd.randrange(1 << 24) for _ in range(args.cases)]
+    failures = 0
+    for frame in frames:
+        done = set(rnd.sample(range(BLOCKS), rnd.randrange(0, 64)))
+        errors = check(path, frame, done, rnd)
+        for e in errors:
+            print(f"frame {frame}: {e}")
+        failures += bool(errors)
+    print(f"{len(frames)} frames round-tripped through NVS: " + ("PASS" if not failures else f"FAIL ({failures})"))
+
+    # Spread over every part of the snapshot, the last block included.
+    joins = 0
+    for frame in (0, rnd.randrange(1, 1 << 24)):
+        done = set(rnd.sample(range(BLOCKS), 96)) | {BLOCKS - 1}
+        errors = mesh(path, frame, done)
+        for e in errors:
+            print(f"join at frame {frame}: {e}")
+        joins += bool(errors)
+    print("2 joins in sync from a snapshot: " + ("PASS" if not joins else f"FAIL ({joins})"))
+    sys.exit(1 if failures or joins else 0)
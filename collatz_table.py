@@ -0,0 +1,49 @@
+import argparse
+import os
+
+parser = argparse.ArgumentParser("Generates the 2^k-step table of the Collatz kernel (serial/main/collatz_table.h).")
+parser.add_argument("-k", dest="k", type=int, default=12, help="Steps per jump, the table has 2^k entries (k <= 16)")
+parser.add_argument("-o", dest="output", type=str,
+                    default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "serial", "main", "collatz_table.h"),
+                    help="Header to write")
+args = parser.parse_args()
+
+# Mirrors collatz_kernel.h: d in the low CK_D_BITS, odd step count above.
+CK_D_BITS = 27
+
+assert 1 <= args.k <= 16, "3^k must fit in CK_D_BITS"
+
+
+def jump(b, k):
+    """k steps of T(n) = n odd ? (3n + 1) / 2 : n / 2 from b, returns (odd steps, T^k(b))."""
+    c = 0
+    for _ in range(k):
+        if b & 1:
+            b = (3 * b + 1) >> 1
+            c += 1
+        else:
+            b >>= 1
+    return c, b
+
+
+entries = []
+for b in range(1 << args.k):
+    c, d = jump(b, args.k)
+    assert d < (1 << CK_D_BITS)
+    entries.append(c << CK_D_BITS | d)
+
+with open(args.output, "w") as out:
+    out.write("/*\n")
+    out.write(f"* Generated by collatz_table.py -k {args.k}, do not edit.  Included by\n")
+    out.write("*  collatz_kernel.c only: const, so it stays in flash and is read through\n")
+    out.write("*  the cache mapping instead of taking RAM.\n")
+    out.write("*\n")
+    out.write("* Entry b: T^k(b) in the low CK_D_BITS, the odd steps among those k above.\n")
+    out.write("*/\n")
+    out.write(f"#define COLLATZ_TABLE_K {args.k}\n\n")
+    out.write("static const uint32_t collatz_table[1 << COLLATZ_TABLE_K] = {\n")
+    for i in range(0, len(entries), 8):
+        out.write("    " + ", ".join(f"0x{e:08X}" for e in entries[i:i + 8]) + ",\n")
+    out.write("};\n")
+
+print(f"{len(entries)} entries, {4 * len(entries)} bytes -> {args.output}")
@@ -0,0 +1,106 @@
+import argparse
+import ctypes
+import os
+import subprocess
+import sys
+import tempfile
+
+parser = argparse.ArgumentParser("Host run of net_crypto.c: seal / open round trip and the NET_CRYPTO figures "
+                                 "against a software mbedtls.")
+parser.add_argument("-n", dest="frames", type=int, default=5000, help="Frames per measurement")
+parser.add_argument("-l", dest="length", type=int, default=8 + 128,
+                    help="Bytes per frame, default app header plus NET_MAX_PAYLOAD as NET_CRYPTO")
+parser.add_argument("--mbedtls", dest="mbedtls", default=None,
+                    help="mbedtls prefix (include/, lib/) if not installed system wide")
+args = parser.parse_args()
+
+SRC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "serial", "main")
+
+# Mirrors net_crypto.h.
+KEY_SIZE = 16
+NONCE_SIZE = 13
+TAG_SIZE = 6
+# Room for a crypto_key_t, whose size depends on the mbedtls build.
+KEY_ROOM = 4096
+
+
+class Bench(ctypes.Structure):
+    _fields_ = [("frames", ctypes.c_uint32), ("bytes", ctypes.c_uint32), ("copy_us", ctypes.c_float),
+                ("key_us", ctypes.c_float), ("seal_us", ctypes.c_float), ("open_us", ctypes.c_float),
+                ("kx_us", ctypes.c_float), ("kx_cycles", ctypes.c_uint32)]
+
+
+def build():
+    out = os.path.join(tempfile.mkdtemp(), "libnetcrypto.so")
+    cmd = ["gcc", "-O2", "-shared", "-fPIC", "-I", SRC]
+    libs = ["-lmbedcrypto"]
+    if args.mbedtls:
+        cmd += ["-I", os.path.join(args.mbedtls, "include")]
+        libs = ["-L", os.path.join(args.mbedtls, "lib"), "-Wl,-rpath," + os.path.join(args.mbedtls, "lib")] + libs
+    subprocess.check_call(cmd + ["-o", out, os.path.join(SRC, "net_crypto.c")] + libs)
+    lib = ctypes.CDLL(out)
+    lib.crypto_bench.argtypes = [ctypes.POINTER(Bench), ctypes.c_uint32, ctypes.c_size_t]
+    lib.crypto_key_set.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+    lib.crypto_key_free.argtypes = [ctypes.c_void_p]
+    for name in ("crypto_seal", "crypto_open"):
+        getattr(lib, name).argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t,
+                                       ctypes.c_char_p, ctypes.c_size_t, ctypes.c_char_p]
+    return lib
+
+
+def round_trip(lib):
+    """Seals with one key context, opens with another set up from the same key, then tampers."""
+    errors = []
+    sealer = ctypes.create_string_buffer(KEY_ROOM)
+    opener = ctypes.create_string_buffer(KEY_ROOM)
+    key = bytes(range(KEY_SIZE))
+    aad = b"header-bytes-16b"
+    if lib.crypto_key_set(sealer, key) or lib.crypto_key_set(opener, key):
+        return ["crypto_key_set failed"]
+
+    for i in range(64):
+        nonce = i.to_bytes(NONCE_SIZE, "little")
+        plain = bytes((i * 7 + j) & 0xff for j in range(args.length))
+        data = ctypes.create_string_buffer(plain, args.length)
+        tag = ctypes.create_string_buffer(TAG_SIZE)
+        if lib.crypto_seal(sealer, nonce, aad, len(aad), data, args.length, tag) or data.raw == plain:
+            errors.append(f"frame {i}: not sealed")
+            continue
+        sealed = data.raw
+        if lib.crypto_open(opener, nonce, aad, len(aad), data, args.length, tag.raw) or data.raw != plain:
+            errors.append(f"frame {i}: did not open")
+        flipped = bytearray(sealed)
+        flipped[i % args.length] ^= 1
+        data = ctypes.create_string_buffer(bytes(flipped), args.length)
+        if lib.crypto_open(opener, nonce, aad, len(aad), data, args.length, tag.raw) == 0:
+            errors.append(f"frame {i}: opened after a bit flip")
+
+    lib.crypto_key_free(sealer)
+    lib.crypto_key_free(opener)
+    empty = ctypes.create_string_buffer(KEY_ROOM)
+    data = ctypes.create_string_buffer(args.length)
+    if lib.crypto_seal(empty, bytes(NONCE_SIZE), aad, len(aad), data, args.length, bytes(TAG_SIZE)) == 0:
+        errors.append("sealed with a key context that was never set")
+    return errors
+
+
+if __name__ == "__main__":
+    lib = build()
+
+    errors = round_trip(lib)
+    for e in errors:
+        print(f"  {e}")
+    print("round trip: " + ("PASS" if not errors else f"FAIL ({len(errors)})"))
+
+    # The same figures NET_CRYPTO prints on a node, software AES here.
+    b = Bench()
+    lib.crypto_bench(ctypes.byref(b), args.frames, args.length)
+    print(f"{b.frames} frames of {b.bytes} bytes")
+    print(f"plain {b.copy_us:.2f}us/frame")
+    print(f"key setup {b.key_us:.2f}us")
+    print(f"seal {b.seal_us:.2f}us/frame {b.bytes / b.seal_us:.2f} MB/s, "
+          f"{b.seal_us + b.key_us:.2f}us with a key setup per frame")
+    print(f"open {b.open_us:.2f}us/frame {b.bytes / b.open_us:.2f} MB/s, "
+          f"{b.open_us + b.key_us:.2f}us with a key setup per frame")
+    print(f"x25519 {b.kx_us:.0f}us {b.kx_cycles} cycles")
+    sys.exit(1 if errors else 0)
@@ -0,0 +1,416 @@
+import argparse
+import collections
+import ctypes
+import os
+import queue
+import random
+import select
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import tty
+
+parser = argparse.ArgumentParser("Host side of the serial gateway: virtual apps over the node's console UART.")
+parser.add_argument("-dst, -D", dest="port_dest", type=str, nargs=1, help="Serial port of the gateway node")
+parser.add_argument("-a", dest="apps", type=int, nargs="+", default=[], help="App ids to register as virtual apps")
+parser.add_argument("-e", dest="echo", action="store_true", help="Send every received frame back the way it came")
+parser.add_argument("-w", dest="window", type=int, default=16, help="Frames the node may have in flight to us")
+parser.add_argument("-t", dest="pty_test", action="store_true", help="Run framing and flow control against a pty instead of a device")
+parser.add_argument("-n", dest="frames", type=int, default=2000, help="Frames for the pty test")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed for the pty test")
+args = parser.parse_args()
+
+SRC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "serial", "main")
+
+# Mirrors gateway_frame.h.
+GW_VERSION = 1
+GW_END, GW_ESC, GW_ESC_END, GW_ESC_ESC = 0xC0, 0xDB, 0xDC, 0xDD
+GW_MAX_PAYLOAD = 128
+GW_HELLO, GW_OPEN, GW_CLOSE, GW_SEND, GW_RECV, GW_CREDIT, GW_EXIT, GW_STATUS = range(1, 9)
+GW_FLAG_UP = 0x01
+
+HEADER = struct.Struct("<BHHBB")
+HELLO = struct.Struct("<BBBBB")
+GW_MAX_FRAME = HEADER.size + GW_MAX_PAYLOAD + 2
+
+CREDIT_PERIOD = 0.5
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def encode(frame):
+    crc = crc16(frame)
+    out = bytearray([GW_END])
+    for b in frame + bytes([crc & 0xFF, crc >> 8]):
+        if b == GW_END:
+            out += bytes([GW_ESC, GW_ESC_END])
+        elif b == GW_ESC:
+            out += bytes([GW_ESC, GW_ESC_ESC])
+        else:
+            out.append(b)
+    out.append(GW_END)
+    return bytes(out)
+
+
+def allowed(seq, limit):
+    return ((limit - seq) & 0xFFFF) - 1 < 0x7FFF
+
+
+class Decoder:
+    def __init__(self):
+        self.buf = bytearray()
+        self.esc = False
+        self.broken = False
+        self.bad = 0
+
+    def feed(self, data):
+        frames = []
+        for b in data:
+            if b == GW_END:
+                frame, broken = bytes(self.buf), self.broken or self.esc
+                self.buf, self.esc, self.broken = bytearray(), False, False
+                if not frame and not broken:
+                    continue
+                if broken or len(frame) < HEADER.size + 2 or crc16(frame[:-2]) != frame[-2] | frame[-1] << 8:
+                    self.bad += 1
+                    continue
+                frames.append(frame[:-2])
+            elif self.broken:
+                continue
+            elif self.esc:
+                self.esc = False
+                if b in (GW_ESC_END, GW_ESC_ESC):
+                    self.buf.append(GW_END if b == GW_ESC_END else GW_ESC)
+                else:
+                    self.broken = True
+            elif b == GW_ESC:
+                self.esc = True
+            elif len(self.buf) == GW_MAX_FRAME:
+                self.broken = True
+            else:
+                self.buf.append(b)
+        return frames
+
+
+class FdPort:
+    """pyserial-like read / write on a file descriptor (pty)."""
+
+    def __init__(self, fd):
+        self.fd = fd
+
+    def read(self, size):
+        if not select.select([self.fd], [], [], 0.05)[0]:
+            return b""
+        return os.read(self.fd, size)
+
+    def write(self, data):
+        while data:
+            data = data[os.write(self.fd, data):]
+
+
+class Gateway:
+    """Host end of gateway mode.  Frames from the node arrive on a reader thread,
+    recv() hands them out and grants the node 'window' frames past the last one."""
+
+    def __init__(self, port, window=16):
+        self.port = port
+        self.window = window
+        self.decoder = Decoder()
+        self.lock = threading.Lock()
+        self.cond = threading.Condition()
+        self.frames = queue.Queue()
+        self.status = queue.Queue()
+        self.hello = None
+        self.node_limit = 0     # node's grant for our GW_SEND frames
+        self.tx_seq = 0
+        self.delivered = 0      # node frame after the last one handed out
+        self.granted = 0
+        self.violations = 0     # node frames past our grant
+        self.running = False
+        self.reader = None
+
+    def _write(self, kind, seq, app=0, flags=0, group=0, payload=b""):
+        with self.lock:
+            self.port.write(encode(HEADER.pack(kind, seq & 0xFFFF, app, flags, group) + payload))
+
+    def _credit(self):
+        self.granted = self.delivered
+        self._write(GW_CREDIT, self.delivered + self.window)
+
+    def _read(self):
+        last_credit = time.monotonic()
+        while self.running:
+            for frame in self.decoder.feed(self.port.read(512)):
+                kind, seq, app, flags, group = HEADER.unpack_from(frame)
+                payload = frame[HEADER.size:]
+                if kind == GW_HELLO:
+                    self.hello = HELLO.unpack_from(payload)
+                    with self.cond:
+                        self.node_limit = seq
+                        self.cond.notify_all()
+                elif kind == GW_CREDIT:
+                    with self.cond:
+                        self.node_limit = seq
+                        self.cond.notify_all()
+                elif kind == GW_RECV:
+                    if not allowed(seq, (self.granted + self.window) & 0xFFFF):
+                        self.violations += 1
+                    self.frames.put((seq, app, flags, group, payload))
+                elif kind == GW_STATUS:
+                    self.status.put((seq, app, struct.unpack("<b", payload[:1])[0]))
+            # The grant doubles as keep-alive, the node leaves gateway mode without one.
+            if self.hello and time.monotonic() - last_credit > CREDIT_PERIOD:
+                last_credit = time.monotonic()
+                self._credit()
+
+    def start(self, timeout=5.0):
+        self.running = True
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+        self.port.write(b"GATEWAY\n")
+        end = time.monotonic() + timeout
+        while self.hello is None:
+            if time.monotonic() > end:
+                self.running = False
+                raise TimeoutError("no GW_HELLO from the node")
+            time.sleep(0.01)
+        self._credit()
+        return self.hello
+
+    def _request(self, kind, app, timeout=2.0):
+        seq = self.tx_seq & 0xFFFF
+        self._write(kind, seq, app)
+        end = time.monotonic() + timeout
+        while time.monotonic() < end:
+            try:
+                s, a, result = self.status.get(timeout=0.1)
+            except queue.Empty:
+                continue
+            if s == seq and a == app:
+                return result
+        raise TimeoutError("no GW_STATUS from the node")
+
+    def open_app(self, app):
+        return self._request(GW_OPEN, app)
+
+    def close_app(self, app):
+        return self._request(GW_CLOSE, app)
+
+    def send(self, app, data, up=False, group=0, timeout=5.0):
+        with self.cond:
+            if not self.cond.wait_for(lambda: allowed(self.tx_seq & 0xFFFF, self.node_limit), timeout):
+                raise TimeoutError("no grant from the node")
+        self._write(GW_SEND, self.tx_seq, app, GW_FLAG_UP if up else 0, group, bytes(data))
+        self.tx_seq += 1
+
+    def recv(self, timeout=None):
+        """Returns (app, from_up, group, payload), or None on timeout."""
+        try:
+            seq, app, flags, group, payload = self.frames.get(timeout=timeout)
+        except queue.Empty:
+            return None
+        self.delivered = (seq + 1) & 0xFFFF
+        if ((self.delivered - self.granted) & 0xFFFF) >= self.window // 2:
+            self._credit()
+        return app, bool(flags & GW_FLAG_UP), group, payload
+
+    def exit(self):
+        self._write(GW_EXIT, 0)
+        self.running = False
+        self.reader.join()
+
+
+class FakeNode(threading.Thread):
+    """The node end for the pty test, framing through the firmware's own
+    gateway_frame.c: echoes every GW_SEND back as GW_RECV within the host's grant."""
+
+    def __init__(self, fd, lib, window, rnd):
+        super().__init__(daemon=True)
+        self.port = FdPort(fd)
+        self.lib = lib
+        self.window = window
+        self.rnd = rnd
+        self.dec = GwDecoder()
+        lib.gw_decoder_init(ctypes.byref(self.dec))
+        self.pending = collections.deque()
+        self.host_limit = 0
+        self.tx_seq = 0
+        self.rx_next = 0
+        self.granted = 0
+        self.violations = 0
+        self.corrupted = 0
+        self.echoed = 0
+
+    def write(self, kind, seq, app=0, flags=0, group=0, payload=b"", corrupt=False):
+        frame = HEADER.pack(kind, seq & 0xFFFF, app, flags, group) + payload
+        out = ctypes.create_string_buffer(2 * GW_MAX_FRAME + 2)
+        n = self.lib.gw_encode(frame, len(frame), out)
+        data = bytearray(out.raw[:n])
+        if corrupt:
+            data[1 + self.rnd.randrange(n - 2)] ^= 0x5A
+        # Console chatter between frames, like a stray log line.
+        if self.rnd.random() < 0.02:
+            data = b"I (1234) wifi: noise\r\n" + data
+        self.port.write(bytes(data))
+
+    def credit(self):
+        self.granted = self.rx_next
+        self.write(GW_CREDIT, self.rx_next + self.window)
+
+    def run(self):
+        line = b""
+        while not line.endswith(b"\n"):
+            line += self.port.read(1)
+        self.write(GW_HELLO, self.window, payload=HELLO.pack(GW_VERSION, 0x1D, 1, self.window, GW_MAX_PAYLOAD))
+
+        while True:
+            for b in self.port.read(512):
+                n = self.lib.gw_decode(ctypes.byref(self.dec), b)
+                if not n:
+                    continue
+                frame = bytes(self.dec.buf[:n])
+                kind, seq, app, flags, group = HEADER.unpack_from(frame)
+                if kind == GW_CREDIT:
+                    self.host_limit = seq
+                elif kind in (GW_OPEN, GW_CLOSE):
+                    self.write(GW_STATUS, seq, app, payload=b"\x00")
+                elif kind == GW_SEND:
+                    if not allowed(seq, (self.granted + self.window) & 0xFFFF):
+                        self.violations += 1
+                    self.pending.append((app, flags, group, frame[HEADER.size:]))
+                    self.rx_next = (seq + 1) & 0xFFFF
+                    if ((self.rx_next - self.granted) & 0xFFFF) >= self.window // 2:
+                        self.credit()
+                elif kind == GW_EXIT:
+                    self.port.write(b"gateway 0 sent 0 refused 0 received 0 bad 0 dropped\n\n")
+                    return
+
+            while self.pending and allowed(self.tx_seq & 0xFFFF, self.host_limit):
+                app, flags, group, payload = self.pending.popleft()
+                corrupt = self.rnd.random() < 0.01
+                self.corrupted += corrupt
+                self.write(GW_RECV, self.tx_seq, app, flags ^ GW_FLAG_UP, group, payload, corrupt)
+                self.tx_seq += 1
+                self.echoed += 1
+
+
+class GwDecoder(ctypes.Structure):
+    _fields_ = [("buf", ctypes.c_uint8 * GW_MAX_FRAME), ("len", ctypes.c_uint32), ("esc", ctypes.c_int),
+                ("overflow", ctypes.c_int), ("frames", ctypes.c_uint32), ("bad", ctypes.c_uint32)]
+
+
+def build():
+    out = os.path.join(tempfile.mkdtemp(), "libgwframe.so")
+    subprocess.check_call(["gcc", "-O2", "-shared", "-fPIC", "-I", SRC, "-o", out,
+                           os.path.join(SRC, "gateway_frame.c")])
+    lib = ctypes.CDLL(out)
+    lib.gw_encode.restype = ctypes.c_uint32
+    lib.gw_encode.argtypes = [ctypes.c_char_p, ctypes.c_uint32, ctypes.c_char_p]
+    lib.gw_decode.restype = ctypes.c_uint32
+    lib.gw_decode.argtypes = [ctypes.POINTER(GwDecoder), ctypes.c_uint8]
+    return lib
+
+
+def pty_test():
+    rnd = random.Random(args.seed)
+    lib = build()
+    master, slave = os.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+
+    node = FakeNode(slave, lib, 8, rnd)
+    node.start()
+    gw = Gateway(FdPort(master), window=4)
+    gw.start()
+    gw.open_app(5)
+
+    t0 = time.monotonic()
+    sent = []
+    got = []
+
+    def consume():
+        # Slow at first, so the node runs into our grant.
+        while len(got) + node.corrupted < len(sent) or len(sent) < args.frames:
+            frame = gw.recv(timeout=2.0)
+            if frame is None:
+                break
+            got.append(frame[3])
+            if len(got) < 50:
+                time.sleep(0.005)
+
+    consumer = threading.Thread(target=consume)
+    consumer.start()
+    for i in range(args.frames):
+        payload = struct.pack("<I", i) + bytes(rnd.randrange(256) for _ in range(rnd.randrange(GW_MAX_PAYLOAD - 3)))
+        sent.append(payload)
+        gw.send(5, payload)
+    consumer.join()
+    gw.exit()
+    elapsed = time.monotonic() - t0
+
+    # Corrupted frames are lost, the rest must arrive intact and in order.
+    index = {p: i for i, p in enumerate(sent)}
+    order = [index.get(p, -1) for p in got]
+    intact = all(i >= 0 for i in order) and order == sorted(order)
+    lost = len(sent) - len(got)
+
+    print(f"pty test: {len(sent)} sent, {len(got)} echoed, {lost} lost, {node.corrupted} corrupted on the line, "
+          f"{'in order' if intact else 'OUT OF ORDER'}, {elapsed:.1f}s")
+    print(f"grant violations: node {node.violations} host {gw.violations}, "
+          f"bad frames: node {node.dec.bad} host {gw.decoder.bad}")
+    ok = intact and lost == node.corrupted and not node.violations and not gw.violations and not node.dec.bad
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+def run_device(port):
+    import serial
+
+    ser = serial.Serial(port=port, baudrate=115200, timeout=0.05, write_timeout=10)
+    ser.reset_input_buffer()
+    gw = Gateway(ser, window=args.window)
+    version, node_id, root, window, max_payload = gw.start()
+    print(f"Gateway on node 0x{node_id:02X}{' (root)' if root else ''}, window {window}, payload {max_payload}")
+
+    for app in args.apps:
+        result = gw.open_app(app)
+        print(f"app {app}: {'registered' if result == 0 else f'refused ({result})'}")
+
+    try:
+        while True:
+            frame = gw.recv(timeout=0.5)
+            while not gw.status.empty():
+                seq, app, result = gw.status.get()
+                print(f"send {seq} app {app} refused ({result})")
+            if frame is None:
+                continue
+            app, from_up, group, payload = frame
+            print(f"app {app} {'down' if from_up else 'up'}{f' group {group}' if group else ''} {payload.hex()}")
+            if args.echo:
+                gw.send(app, payload, up=from_up)
+    except KeyboardInterrupt:
+        pass
+
+    gw.exit()
+    while True:
+        line = ser.readline().decode("ascii", "replace").strip()
+        if not line:
+            break
+        print(line)
+
+
+if args.pty_test:
+    sys.exit(pty_test())
+if not args.port_dest:
+    parser.error("a serial port (-D) or the pty test (-t) is needed")
+run_device(args.port_dest[0])
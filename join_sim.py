@@ -0,0 +1,54 @@
+import argparse
+import random
+
+parser = argparse.ArgumentParser("Collatz late joiner: blocks computed in vain after a join, with and without the frame snapshot.")
+parser.add_argument("-n", dest="nodes", type=int, default=8, help="Nodes already computing")
+parser.add_argument("-b", dest="block", type=float, default=20.0, help="Seconds per block and node")
+parser.add_argument("-a", dest="away", type=float, default=600.0, help="Mean seconds the joiner was away (its frame is that stale)")
+parser.add_argument("-r", dest="rtt", type=float, default=0.2, help="Seconds for a snapshot request and its answer")
+parser.add_argument("-j", dest="joins", type=int, default=2000, help="Joins to simulate")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+args = parser.parse_args()
+
+# Mirrors collatz.c.
+BLOCKS = 1024
+
+
+def pick(free, rnd):
+    """pick_block: weight 2 (BLOCKS - i) - 1 over the free blocks of the window."""
+    weights = [2 * (BLOCKS - i) - 1 for i in free]
+    return rnd.choices(free, weights)[0]
+
+
+def join(snapshot, rnd):
+    """Wasted blocks and seconds until the joiner computes a useful one."""
+    rate = args.nodes / args.block           # blocks the mesh finishes per second
+    stale = int(rnd.expovariate(1 / args.away) * rate)  # blocks done while away
+    t = 0.0
+    if snapshot:
+        # Nothing is picked until the answer is in; the frame is then current
+        #  but for what finished during the round trip.
+        t = args.rtt
+        stale = int(rnd.random() < args.rtt * rate)
+    wasted = 0
+    while True:
+        # The joiner still sees its whole window free; the first 'stale'
+        #  blocks of it are done elsewhere.
+        b = pick(list(range(BLOCKS)), rnd)
+        if b >= stale:
+            return wasted, t
+        # The next incremental report raises the frame, but the block runs
+        #  to its end all the same.
+        wasted += 1
+        t += args.block
+        stale = int(rnd.random() < args.block * rate)
+
+
+rnd = random.Random(args.seed)
+print(f"{args.nodes} nodes, {args.block:.0f}s blocks, joiner away {args.away:.0f}s on average, {args.joins} joins")
+for snapshot in (False, True):
+    res = [join(snapshot, rnd) for _ in range(args.joins)]
+    wasted = sum(w for w, _ in res) / len(res)
+    delay = sum(t for _, t in res) / len(res)
+    print(f"{'snapshot' if snapshot else 'reports':>8}: {wasted:.2f} blocks wasted per join, "
+          f"{delay:.1f}s to the first useful block")
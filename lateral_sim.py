@@ -0,0 +1,263 @@
+import argparse
+import heapq
+import random
+from collections import deque
+
+parser = argparse.ArgumentParser("Parent failure and load split: strict tree against NET_LATERAL links.")
+parser.add_argument("-d", dest="depth", type=int, default=4, help="Depth of the tree below the root")
+parser.add_argument("-f", dest="fanout", type=int, default=3, help="Children per node (LINK_TABLE_SIZE - 1)")
+parser.add_argument("-r", dest="rate", type=float, default=1.0, help="Frames generated per node per second")
+parser.add_argument("-p", dest="hear", type=float, default=0.7, help="Chance two neighbours at one depth hear each other")
+parser.add_argument("-k", dest="kill", type=int, default=1, help="Depth of the parent that fails")
+parser.add_argument("-x", dest="hot", type=float, default=8.0, help="Rate multiplier of the hot subtree (load split run)")
+parser.add_argument("-t", dest="time", type=float, default=120.0, help="Simulated seconds")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+args = parser.parse_args()
+
+S = 1000000
+
+# Mirrors net_layer.h.
+WINDOW_SEND = 10000
+QUEUE_SIZE = 16
+OUTBOUND_LOW_WATER = 4
+LATERAL_SIZE = 2
+LATERAL_FAIL_LIMIT = 4
+PERIOD_LOCATE = 25 * S
+WINDOW_LOCATE = 5 * S
+TIMEOUT_LOCATE = 1 * S
+PERIOD_UP_STATUS = 15 * S
+WINDOW_UP_STATUS = 5 * S
+TIMEOUT_STATUS = 1 * S
+BLACKOUT = 2 * S + 1 * S  # exec_blackout(..) delay plus the restart
+
+# One 152 byte NetFrame plus ESP-NOW / 802.11 overhead at 1 Mbps.  Frames
+#  queue per transmitter, collisions are left to tdma_sim.py.
+AIRTIME = 1500
+
+
+class Node:
+    def __init__(self, nid, parent, depth):
+        self.id = nid
+        self.parent = parent
+        self.depth = depth
+        self.children = []
+        self.laterals = []
+        self.queue = deque()
+        self.busy = False
+        self.alive = True
+        self.up = parent        # current parent, None while lost or rebooting
+        self.booted = True
+        self.up_fails = 0
+        self.up_load = 0
+        self.turn = 0
+        self.rate = args.rate
+
+    def subtree(self):
+        out = [self]
+        for c in self.children:
+            out += c.subtree()
+        return out
+
+
+def build_tree(rnd):
+    root = Node(0, None, 0)
+    nodes = [root]
+    level = [root]
+    for d in range(1, args.depth + 1):
+        nxt = []
+        for parent in level:
+            for _ in range(args.fanout):
+                n = Node(len(nodes), parent, d)
+                parent.children.append(n)
+                nodes.append(n)
+                nxt.append(n)
+        # Neighbours in level order hear each other now and then; only
+        #  those under another parent are kept, as exec_lateral(..) does.
+        for i, n in enumerate(nxt):
+            for m in nxt[i + 1:i + 1 + args.fanout]:
+                if m.parent is not n.parent and rnd.random() < args.hear:
+                    if len(n.laterals) < LATERAL_SIZE and len(m.laterals) < LATERAL_SIZE:
+                        n.laterals.append(m)
+                        m.laterals.append(n)
+        level = nxt
+    return nodes
+
+
+def simulate(policy, kill, hot, seed):
+    rnd = random.Random(seed)
+    nodes = build_tree(rnd)
+    root = nodes[0]
+    end = int(args.time * S)
+    t_fail = end // 4
+
+    victim = None
+    if kill:
+        victim = [n for n in nodes if n.depth == args.kill][0]
+    hot_root = None
+    if hot:
+        hot_root = [n for n in nodes if n.depth == 1][0]
+        for n in hot_root.subtree()[1:]:
+            n.rate *= args.hot
+    watched = (victim.subtree()[1:] if victim else hot_root.subtree()[1:])
+    watched_ids = {n.id for n in watched}
+
+    events = []
+    seq = 0
+
+    def push(t, kind, node, data=None):
+        nonlocal seq
+        heapq.heappush(events, (t, seq, kind, node, data))
+        seq += 1
+
+    def usable(m):
+        return m.alive and m.booted and m.up is not None
+
+    def next_hop(n):
+        if policy == "lateral":
+            peers = [m for m in n.laterals if usable(m)]
+            best = min(peers, key=lambda m: max(len(m.queue), m.up_load)) if peers else None
+            if n.up is None:
+                return best
+            if best and n.up_load > OUTBOUND_LOW_WATER and max(len(best.queue), best.up_load) < n.up_load:
+                n.turn += 1
+                if n.turn & 1:
+                    return best
+        return n.up
+
+    def blackout(n, t):
+        for m in n.subtree():
+            if m is root or not m.alive:
+                continue
+            m.booted = False
+            m.up = None
+            m.queue.clear()
+            push(t + BLACKOUT + PERIOD_LOCATE + rnd.randrange(WINDOW_LOCATE), "join", m)
+
+    def failover(n, t):
+        if policy == "lateral" and any(usable(m) for m in n.laterals):
+            n.up = None
+            n.up_fails = 0
+            push(t + rnd.randrange(WINDOW_LOCATE) + TIMEOUT_LOCATE, "join", n)
+            return
+        blackout(n, t)
+
+    def kick(n, t):
+        if n is not root and n.alive and not n.busy and n.queue:
+            n.busy = True
+            push(t + AIRTIME + rnd.randrange(WINDOW_SEND), "sent", n)
+
+    for n in nodes[1:]:
+        push(rnd.expovariate(n.rate) * S, "gen", n)
+        push(PERIOD_UP_STATUS + rnd.randrange(WINDOW_UP_STATUS), "status", n)
+    if victim:
+        push(t_fail, "kill", victim)
+
+    generated = delivered = lost = 0
+    w_gen = w_del = 0
+    first = {}
+
+    while events:
+        t, _, kind, n, data = heapq.heappop(events)
+        if t > end:
+            break
+
+        if kind == "gen":
+            push(t + rnd.expovariate(n.rate) * S, "gen", n)
+            if not n.alive:
+                continue
+            generated += 1
+            frame = (n.id, t)
+            if n.id in watched_ids and t >= t_fail:
+                w_gen += 1
+            if not n.booted or next_hop(n) is None:
+                lost += 1
+            elif len(n.queue) < QUEUE_SIZE:
+                n.queue.append(frame)
+                kick(n, t)
+            else:
+                lost += 1
+        elif kind == "sent":
+            n.busy = False
+            if not n.alive or not n.queue:
+                continue
+            frame = n.queue.popleft()
+            to = next_hop(n) if n.booted else None
+            if to is None or not to.alive or not to.booted:
+                lost += 1
+                if to is n.up and to is not None and policy == "lateral":
+                    n.up_fails += 1
+                    if n.up_fails == LATERAL_FAIL_LIMIT:
+                        failover(n, t)
+            else:
+                if to is n.up:
+                    n.up_fails = 0
+                if to is root:
+                    delivered += 1
+                    src, born = frame
+                    if src in watched_ids and born >= t_fail:
+                        w_del += 1
+                        first.setdefault(src, t)
+                elif len(to.queue) < QUEUE_SIZE:
+                    to.queue.append(frame)
+                    kick(to, t)
+                else:
+                    lost += 1
+            kick(n, t)
+        elif kind == "status":
+            push(t + PERIOD_UP_STATUS + rnd.randrange(WINDOW_UP_STATUS), "status", n)
+            if not n.alive or not n.booted or n.up is None:
+                continue
+            if n.up.alive and n.up.booted:
+                n.up_load = len(n.up.queue)
+            else:
+                push(t + TIMEOUT_STATUS, "lost", n, n.up)
+        elif kind == "lost":
+            if n.up is data and n.alive and n.booted:
+                failover(n, t)
+        elif kind == "join":
+            if not n.alive:
+                continue
+            old = n.parent
+            candidates = [m for m in [old] + n.laterals if m is root or usable(m)]
+            if candidates:
+                n.booted = True
+                n.up = candidates[0]
+                n.up_fails = 0
+                kick(n, t)
+            else:
+                push(t + PERIOD_LOCATE + rnd.randrange(WINDOW_LOCATE), "join", n)
+        elif kind == "kill":
+            n.alive = False
+            n.queue.clear()
+
+    span = (end - t_fail) / S
+    recovery = []
+    if victim:
+        for c in victim.children:
+            ids = {m.id for m in c.subtree()}
+            times = [first[i] for i in ids if i in first]
+            recovery.append((min(times) - t_fail) / S if times else float("inf"))
+    return {
+        "generated": generated,
+        "delivered": delivered,
+        "lost": lost,
+        "watched": f"{w_del}/{w_gen}",
+        "goodput": w_del / span,
+        "recovery": recovery,
+    }
+
+
+print(f"{len(build_tree(random.Random(args.seed))) - 1} nodes, depth {args.depth}, fan-out {args.fanout}, "
+      f"{args.rate} frames/s/node, {args.time:.0f}s")
+
+print(f"Parent at depth {args.kill} fails at {args.time / 4:.0f}s, its subtree after the failure:")
+for policy in ("tree", "lateral"):
+    r = simulate(policy, True, False, args.seed)
+    rec = " ".join(f"{x:.2f}s" for x in r["recovery"])
+    print(f"{policy:>8}: goodput {r['goodput']:.1f} frames/s ({r['watched']}), lost {r['lost']}, "
+          f"recovery per orphaned child {rec}")
+
+print(f"Subtree of one depth 1 node generating x{args.hot:.0f}:")
+for policy in ("tree", "lateral"):
+    r = simulate(policy, False, True, args.seed)
+    print(f"{policy:>8}: goodput {r['goodput']:.1f} frames/s ({r['watched']}), lost {r['lost']}")
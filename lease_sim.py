@@ -0,0 +1,184 @@
+import argparse
+import ctypes
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+parser = argparse.ArgumentParser("Many-node run of the root's node-id lease table (serial/main/net_lease.c).")
+parser.add_argument("-n", dest="nodes", type=int, default=100, help="Boards in the deployment")
+parser.add_argument("-l", dest="late", type=int, default=120, help="Boards joining after the first ones left")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+args = parser.parse_args()
+
+SRC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "serial", "main")
+
+# Mirrors net_lease.h.
+header = open(os.path.join(SRC, "net_lease.h")).read()
+LEASE_MAX = int(re.search(r"#define LEASE_MAX (\w+)", header).group(1), 0)
+LEASE_PROVISIONAL = int(re.search(r"#define LEASE_PROVISIONAL (\w+)", header).group(1), 0)
+
+ROOT_ID = 0x1D
+LIFETIME = 3600 * 1000000
+HOUR = 3600 * 1000000
+
+
+class LeaseEntry(ctypes.Structure):
+    _fields_ = [("mac", ctypes.c_uint8 * 6), ("id", ctypes.c_uint8), ("pad", ctypes.c_uint8),
+                ("renewed", ctypes.c_int64)]
+
+
+class LeaseTable(ctypes.Structure):
+    _fields_ = [("entry", LeaseEntry * LEASE_MAX), ("reserved", ctypes.c_uint8 * 32),
+                ("lifetime", ctypes.c_int64), ("granted", ctypes.c_uint32), ("renewed", ctypes.c_uint32),
+                ("conflicts", ctypes.c_uint32), ("exhausted", ctypes.c_uint32), ("dirty", ctypes.c_int)]
+
+
+def build():
+    out = os.path.join(tempfile.mkdtemp(), "liblease.so")
+    subprocess.check_call(["gcc", "-shared", "-fPIC", "-O2", "-o", out, os.path.join(SRC, "net_lease.c")])
+    lib = ctypes.CDLL(out)
+    lib.lease_grant.restype = ctypes.c_int
+    lib.lease_grant.argtypes = [ctypes.POINTER(LeaseTable), ctypes.c_char_p, ctypes.c_uint8, ctypes.c_int64]
+    return lib
+
+
+class Root:
+    def __init__(self, lib):
+        self.lib = lib
+        self.nvs = None
+        self.boot(0)
+
+    def boot(self, now):
+        # Same order as net_init(..): init, reserve own id, load, restart lifetimes.
+        self.table = LeaseTable()
+        self.lib.lease_init(ctypes.byref(self.table), ctypes.c_int64(LIFETIME))
+        self.lib.lease_reserve(ctypes.byref(self.table), ctypes.c_uint8(ROOT_ID))
+        if self.nvs is not None:
+            ctypes.memmove(self.table.entry, self.nvs, len(self.nvs))
+        self.lib.lease_loaded(ctypes.byref(self.table), ctypes.c_int64(now))
+
+    def grant(self, mac, hint, now):
+        res = self.lib.lease_grant(ctypes.byref(self.table), bytes(mac), hint, ctypes.c_int64(now))
+        if self.table.dirty:
+            self.nvs = bytes(self.table.entry)
+            self.table.dirty = 0
+        return res
+
+
+class Board:
+    def __init__(self, rnd, mac, hand_id=0):
+        self.rnd = rnd
+        self.mac = mac
+        self.stored = hand_id
+        self.id = 0
+        self.leased = False
+
+    def boot(self):
+        self.leased = False
+        self.id = self.stored or LEASE_PROVISIONAL + self.rnd.randrange(0xFF - LEASE_PROVISIONAL)
+
+    def join(self, root, parent_children, now):
+        # LINK is refused when the parent already has a child by that id from
+        #  another MAC.  The board blacks out and comes back with a new id.
+        tries = 0
+        while any(c.id == self.id and c is not self for c in parent_children):
+            tries += 1
+            self.boot()
+        parent_children.append(self)
+        res = root.grant(self.mac, self.id, now)
+        if res > 0:
+            if res != self.id:
+                self.stored = res
+            self.id = res
+            self.leased = True
+        return tries
+
+
+def check(boards, what):
+    live = [b for b in boards if b.leased]
+    ids = [b.id for b in live]
+    bad = len(ids) != len(set(ids)) or any(i >= LEASE_PROVISIONAL or i == ROOT_ID or i == 0 for i in ids)
+    print(f"{what:<34} {len(live):>4} leased, {len(set(ids)):>4} distinct ids  {'FAIL' if bad else 'ok'}")
+    return not bad
+
+
+def main():
+    rnd = random.Random(args.seed)
+    root = Root(build())
+    ok = True
+    now = 0
+
+    def new_mac():
+        # Vendor prefix fixed, so low MAC bytes collide often.
+        return [0x24, 0x0A, 0xC4, rnd.randrange(4), rnd.randrange(256), rnd.randrange(256)]
+
+    boards = [Board(rnd, new_mac()) for _ in range(args.nodes)]
+    retries = 0
+    tree = []
+    for b in boards:
+        b.boot()
+        if not tree or len(tree[-1]) == 3:
+            tree.append([])
+        retries += b.join(root, tree[-1], now)
+    ok &= check(boards, "first join")
+    print(f"  provisional id clashes at a parent: {retries}")
+
+    # Everything restarts: ids must come back from NVS on both sides.
+    before = {id(b): b.id for b in boards if b.leased}
+    now += HOUR // 10
+    root.boot(now)
+    for b in boards:
+        b.boot()
+        b.join(root, [], now)
+    ok &= check(boards, "root and boards restarted")
+    moved = sum(before.get(id(b), b.id) != b.id for b in boards)
+    print(f"  ids moved {moved}, new grants {root.table.granted}")
+    ok &= moved == 0 and root.table.granted == 0
+
+    # Hand-assigned boards whose ids are already leased.
+    taken = rnd.sample([b.id for b in boards if b.leased], 10)
+    hand = [Board(rnd, new_mac(), hand_id=i) for i in taken]
+    conflicts = root.table.conflicts
+    for b in hand:
+        b.boot()
+        b.join(root, [], now)
+    boards += hand
+    ok &= check(boards, "hand-assigned duplicates")
+    print(f"  conflicts detected {root.table.conflicts - conflicts} of {len(hand)}")
+    ok &= root.table.conflicts - conflicts == len(hand)
+
+    # Half the deployment is retired, the rest keeps renewing.  Late boards
+    #  beyond the id range are refused until the retired leases lapse.
+    retired = set(rnd.sample(range(len(boards)), len(boards) // 2))
+    late = [Board(rnd, new_mac()) for _ in range(args.late)]
+    for b in late:
+        b.boot()
+        b.join(root, [], now)
+    refused = sum(not b.leased for b in late)
+    live = [b for i, b in enumerate(boards) if i not in retired] + late
+    ok &= check(live, "late joiners, retired still held")
+    print(f"  refused {refused}, held {sum(e.id != 0 for e in root.table.entry)} of {LEASE_MAX} entries")
+
+    # Live boards renew (PERIOD_LEASE is far below the lifetime), so only the
+    #  retired leases lapse.
+    now += LIFETIME + 1
+    for b in live:
+        if b.leased:
+            b.join(root, [], now)
+    for b in late:
+        if not b.leased:
+            b.boot()
+            b.join(root, [], now)
+    ok &= check(live, "after retired leases lapsed")
+    ok &= all(b.leased for b in live) or len(live) > min(LEASE_MAX, LEASE_PROVISIONAL - 2)
+    print(f"  granted {root.table.granted} renewed {root.table.renewed} conflicts {root.table.conflicts} "
+          f"refused {root.table.exhausted}")
+
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+sys.exit(main())
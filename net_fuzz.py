@@ -0,0 +1,74 @@
+import argparse
+import ctypes
+import os
+import subprocess
+import sys
+import tempfile
+
+parser = argparse.ArgumentParser("Host fuzz of the network layer: seeded frame, timer and API sequences against one node, check_table() after every event.")
+parser.add_argument("-n", dest="events", type=int, default=200000, help="Events per seed")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="First seed")
+parser.add_argument("-k", dest="seeds", type=int, default=8, help="Seeds to run, roots and joiners alternating")
+parser.add_argument("-D", dest="defines", action="append", default=[],
+                    help="Extra define for the build, e.g. -D NET_LATERAL -D NET_TDMA")
+parser.add_argument("-v", dest="verbose", type=int, default=0, help="Node log level, 1 errors .. 3 info")
+parser.add_argument("--mbedtls", dest="mbedtls", default=None,
+                    help="mbedtls prefix (include/, lib/) if not installed system wide")
+args = parser.parse_args()
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+SRC = os.path.join(ROOT, "serial", "main")
+HOST = os.path.join(ROOT, "serial", "host")
+
+# The network layer and what it links against; net_crypto.c needs mbedtls.
+SOURCES = [os.path.join(SRC, f) for f in ("net_layer.c", "net_wheel.c", "net_lease.c", "net_health.c",
+                                          "net_crypto.c", "utils.c")]
+
+
+class FuzzStats(ctypes.Structure):
+    _fields_ = [("events", ctypes.c_uint32), ("frames", ctypes.c_uint32), ("dispatched", ctypes.c_uint32),
+                ("unlinked", ctypes.c_uint32), ("malformed", ctypes.c_uint32), ("timers", ctypes.c_uint32),
+                ("sent", ctypes.c_uint32), ("joined", ctypes.c_uint32), ("max_children", ctypes.c_uint32),
+                ("reboots", ctypes.c_uint32), ("seconds", ctypes.c_double), ("error", ctypes.c_int),
+                ("failed_at", ctypes.c_uint32), ("what", ctypes.c_char * 32)]
+
+
+def host_build(name, sources, defines=(), mbedtls=None):
+    """Builds firmware sources against the stubs in serial/host into a shared library."""
+    out = os.path.join(tempfile.mkdtemp(), name)
+    cmd = ["gcc", "-O2", "-g", "-shared", "-fPIC", "-Wno-int-to-pointer-cast", "-Wno-pointer-to-int-cast",
+           "-I", HOST, "-I", SRC]
+    libs = ["-lmbedcrypto"]
+    if mbedtls:
+        cmd += ["-I", os.path.join(mbedtls, "include")]
+        libs = ["-L", os.path.join(mbedtls, "lib"), "-Wl,-rpath," + os.path.join(mbedtls, "lib")] + libs
+    cmd += ["-D" + d for d in defines]
+    subprocess.check_call(cmd + ["-o", out] + sources + [os.path.join(HOST, "host.c")] + libs)
+    return ctypes.CDLL(out)
+
+
+def build():
+    lib = host_build("libnetfuzz.so", SOURCES + [os.path.join(HOST, "net_fuzz.c")], args.defines, args.mbedtls)
+    lib.fuzz_run.argtypes = [ctypes.c_uint64, ctypes.c_uint32, ctypes.c_int, ctypes.POINTER(FuzzStats)]
+    return lib
+
+
+if __name__ == "__main__":
+    lib = build()
+    lib.fuzz_verbose(args.verbose)
+    print("defines: " + (" ".join(args.defines) or "none"))
+    failures = 0
+    for seed in range(args.seed, args.seed + args.seeds):
+        root = seed % 2
+        st = FuzzStats()
+        err = lib.fuzz_run(seed, args.events, root, ctypes.byref(st))
+        rate = st.frames / st.seconds if st.seconds else 0
+        role = "root" if root else f"node, joined {st.joined / max(st.events, 1):.0%}, {st.reboots} reboots"
+        print(f"seed {seed:4d} {role}: {st.events} events, {st.frames} frames ({st.dispatched} dispatched, "
+              f"{st.unlinked} unlinked, {st.malformed} malformed), {st.sent} sent, up to {st.max_children} children, "
+              f"{rate / 1000:.0f}k frames/s")
+        if err:
+            failures += 1
+            print(f"FAIL seed {seed}: {st.what.decode()} {st.error} after event {st.failed_at}")
+    print("PASS" if not failures else f"FAIL ({failures} seeds)")
+    sys.exit(1 if failures else 0)
@@ -0,0 +1,133 @@
+import argparse
+import random
+
+parser = argparse.ArgumentParser("Collatz report traffic on a tree: one report per block event against batched, merged reports.")
+parser.add_argument("-d", dest="depth", type=int, default=4, help="Tree depth below the root")
+parser.add_argument("-f", dest="fanout", type=int, default=2, help="Children per node")
+parser.add_argument("-b", dest="block", type=float, default=2.0, help="Seconds per block and node")
+parser.add_argument("-w", dest="window", type=float, default=0.25, help="Seconds news is held per hop (REPORT_WINDOW)")
+parser.add_argument("-l", dest="hop", type=float, default=0.02, help="Seconds per hop")
+parser.add_argument("-t", dest="time", type=float, default=2000.0, help="Seconds to simulate")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+args = parser.parse_args()
+
+# Mirrors collatz.c.
+REPORT_HEAD = 12
+REPORT_WORDS = 28
+OLD_REPORT = 8 + 4 + 4 * 10  # magic, type, block id, bigint_t
+TAKEN, DONE = 1, 2
+
+
+class Node:
+    def __init__(self, i, parent, depth):
+        self.i, self.parent, self.depth = i, parent, depth
+        self.children = []
+        self.state = {}
+        self.pend = [{}, {}]       # up, down
+        self.since = [None, None]
+
+
+def tree():
+    nodes = [Node(0, None, 0)]
+    level = [nodes[0]]
+    for d in range(1, args.depth + 1):
+        nxt = []
+        for p in level:
+            for _ in range(args.fanout):
+                n = Node(len(nodes), p, d)
+                p.children.append(n)
+                nodes.append(n)
+                nxt.append(n)
+        level = nxt
+    return nodes
+
+
+def events(nodes, rnd):
+    """(time, node, block, state): every node starts a block and finishes it a block time later."""
+    starts = []
+    for n in nodes:
+        t = rnd.uniform(0, args.block)
+        while t + args.block < args.time:
+            starts.append((t, n.i))
+            t += args.block * rnd.uniform(1.0, 1.1)
+    # blocks are taken from the bottom of the frame, in about the order started
+    ev = []
+    for b, (t, i) in enumerate(sorted(starts)):
+        ev.append((t, i, b, TAKEN))
+        ev.append((t + args.block, i, b, DONE))
+    ev.sort()
+    return ev, len(starts)
+
+
+def per_event(nodes, ev):
+    """collatz_t reports: up hop by hop to the root, then once over every link down."""
+    sends = sum(nodes[e[1]].depth + len(nodes) - 1 for e in ev)
+    hops = max(n.depth for n in nodes)
+    lag = [(nodes[e[1]].depth + hops) * args.hop for e in ev if e[3] == DONE]
+    return sends, sends * OLD_REPORT, sum(lag) / len(lag)
+
+
+def batched(nodes, ev):
+    """report_t: news held for the window, merged at every hop, forwarded only if new."""
+    sends = size = 0
+    inflight = []        # (arrival, node, from_up, news)
+    known = {}           # block -> nodes that know it is DONE, and when it finished
+    lags = []
+    dt = args.hop
+    t, k = 0.0, 0
+
+    def news(n, b, st, from_up, now):
+        if st <= n.state.get(b, 0):
+            return
+        n.state[b] = st
+        if st == DONE:
+            c = known[b]
+            c[0] += 1
+            if c[0] == len(nodes):
+                lags.append(now - c[1])
+        for d in ((1,) if from_up else (0, 1)):
+            if d == 0 and n.parent is None:
+                continue
+            if st > n.pend[d].get(b, 0):
+                n.pend[d][b] = st
+            if n.since[d] is None:
+                n.since[d] = now
+
+    while t < args.time + 10 * args.window:
+        while k < len(ev) and ev[k][0] <= t:
+            _, i, b, st = ev[k]
+            if st == DONE:
+                known[b] = [0, t]
+            news(nodes[i], b, st, False, t)
+            k += 1
+        arrived = [m for m in inflight if m[0] <= t]
+        inflight = [m for m in inflight if m[0] > t]
+        for _, n, from_up, msg in arrived:
+            for b, st in msg.items():
+                news(n, b, st, from_up, t)
+        for n in nodes:
+            for d in (0, 1):
+                if n.since[d] is None or t - n.since[d] < args.window:
+                    continue
+                blocks = sorted(n.pend[d])
+                span = (blocks[-1] // 16 - blocks[0] // 16 + 1) if blocks else 0
+                msgs = max(1, -(-span // REPORT_WORDS))
+                to = [n.parent] if d == 0 else n.children
+                for m in to:
+                    inflight.append((t + args.hop, m, d == 1, dict(n.pend[d])))
+                sends += msgs * len(to)
+                size += (msgs * REPORT_HEAD + 4 * span) * len(to)
+                n.pend[d], n.since[d] = {}, None
+        t += dt
+    return sends, size, sum(lags) / max(len(lags), 1)
+
+
+rnd = random.Random(args.seed)
+nodes = tree()
+ev, blocks = events(nodes, rnd)
+print(f"{len(nodes)} nodes, depth {args.depth}, fanout {args.fanout}, {args.block:.0f}s blocks, "
+      f"{args.window:.2f}s window: {blocks} blocks done")
+for name, run in (("per event", per_event), ("batched", batched)):
+    sends, size, lag = run(nodes, ev)
+    print(f"{name:>9}: {sends / blocks:6.1f} sends {size / blocks:7.0f} bytes per block, "
+          f"{lag:.2f}s until every node knows")
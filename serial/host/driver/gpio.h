@@ -0,0 +1,15 @@
+#ifndef HOST_GPIO_H
+#define HOST_GPIO_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+typedef enum { GPIO_MODE_DISABLE, GPIO_MODE_INPUT, GPIO_MODE_OUTPUT } gpio_mode_t;
+
+void gpio_pad_select_gpio(int pin);
+esp_err_t gpio_set_direction(int pin, gpio_mode_t mode);
+esp_err_t gpio_set_level(int pin, uint32_t level);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef HOST_UART_H
+#define HOST_UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// There is no UART on the host: reads time out empty, writes are dropped.
+esp_err_t uart_driver_install(int port, int rx_size, int tx_size, int queue_size, void* queue, int flags);
+esp_err_t uart_driver_delete(int port);
+int uart_read_bytes(int port, void* buf, uint32_t len, TickType_t wait);
+int uart_write_bytes(int port, const void* buf, size_t len);
+esp_err_t uart_wait_tx_done(int port, TickType_t wait);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include "host.h"
+
+typedef enum {
+    ESP_LOG_NONE = HOST_LOG_NONE,
+    ESP_LOG_ERROR = HOST_LOG_ERROR,
+    ESP_LOG_WARN = HOST_LOG_WARN,
+    ESP_LOG_INFO = HOST_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#define ESP_LOGE(tag, ...) host_log(ESP_LOG_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) host_log(ESP_LOG_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) host_log(ESP_LOG_INFO, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) host_log(ESP_LOG_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) host_log(ESP_LOG_VERBOSE, tag, __VA_ARGS__)
+
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+
+#endif
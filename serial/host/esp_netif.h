@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_NETIF_H
+#define HOST_ESP_NETIF_H
+
+#include "esp_err.h"
+
+esp_err_t esp_netif_init(void);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// The simulated clock, see host_set_time().
+int64_t esp_timer_get_time(void);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void* param);
+
+typedef enum { eRunning, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+// The fields the firmware reads; see host_idle().
+typedef struct {
+    TaskHandle_t xHandle;
+    const char* pcTaskName;
+    eTaskState eCurrentState;
+    uint32_t ulRunTimeCounter;
+} TaskStatus_t;
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack,
+                       void* param, UBaseType_t prio, TaskHandle_t* handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* param, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* last, TickType_t ticks);
+void taskYIELD(void);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xPortGetCoreID(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskGetInfo(TaskHandle_t task, TaskStatus_t* status, BaseType_t stack, eTaskState state);
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t core);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+#endif
@@ -0,0 +1,754 @@
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_now.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include "host.h"
+
+#define HOST_TASKS 16
+#define HOST_NVS_KEYS 32
+#define HOST_NVS_NAME 16
+#define HOST_NVS_SIZE 8192
+
+struct HostQueue {
+    uint32_t    length;
+    uint32_t    size;       // item size, zero for semaphores
+    uint32_t    head;
+    uint32_t    count;
+    uint8_t*    items;
+    struct HostQueue* next; // every queue, for host_reset()
+};
+
+struct HostTask {
+    char            name[16];
+    TaskFunction_t  fn;
+    void*           param;
+};
+
+struct HostGroup {
+    EventBits_t         bits;
+    struct HostGroup*   next;
+};
+
+typedef struct HostNvsEntry {
+    char        space[HOST_NVS_NAME];
+    char        key[HOST_NVS_NAME];
+    uint32_t    len;
+    uint8_t     value[HOST_NVS_SIZE];
+} HostNvsEntry;
+
+static int64_t now_us;
+static uint64_t rng = 1;
+static int log_level = HOST_LOG_NONE;
+
+static struct HostQueue* queues;
+static struct HostGroup* groups;
+static struct HostTask tasks[HOST_TASKS];
+static uint32_t task_count;
+
+static esp_now_recv_cb_t recv_cb;
+static esp_now_send_cb_t send_cb;
+static host_send_t send_hook;
+static host_restart_t restart_hook;
+static uint32_t sends;
+
+static struct HostTask idle_task[portNUM_PROCESSORS];
+static uint32_t idle_run[portNUM_PROCESSORS];
+
+static HostNvsEntry nvs[HOST_NVS_KEYS];
+static uint32_t nvs_count;
+static char nvs_spaces[HOST_NVS_KEYS][HOST_NVS_NAME];
+static uint32_t nvs_space_count;
+
+
+void host_reset(uint64_t seed) {
+    while (queues != NULL) {
+        struct HostQueue* q = queues;
+        queues = q->next;
+        free(q->items);
+        free(q);
+    }
+    while (groups != NULL) {
+        struct HostGroup* g = groups;
+        groups = g->next;
+        free(g);
+    }
+    memset(tasks, 0, sizeof(tasks));
+    task_count = 0;
+    memset(idle_run, 0, sizeof(idle_run));
+    recv_cb = NULL;
+    send_cb = NULL;
+    send_hook = NULL;
+    restart_hook = NULL;
+    sends = 0;
+    now_us = 0;
+    // xorshift64* must not start from zero.
+    rng = seed * 0x9E3779B97F4A7C15ull + 1;
+}
+
+void host_set_time(int64_t us) {
+    assert(us >= now_us);
+    now_us = us;
+}
+
+void host_advance(int64_t us) {
+    assert(us >= 0);
+    now_us += us;
+}
+
+int64_t host_time(void) {
+    return now_us;
+}
+
+uint32_t host_random(void) {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+void host_log_level(int level) {
+    log_level = level;
+}
+
+void host_log(int level, const char* tag, const char* fmt, ...) {
+    if (level > log_level) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    printf("%c (%lld) %s: ", "-EWIDV"[level], (long long)(now_us / 1000), tag);
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+}
+
+void host_espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
+    if (recv_cb != NULL) {
+        recv_cb(mac, data, len);
+    }
+}
+
+void host_espnow_sent(const uint8_t* mac, int ok) {
+    if (send_cb != NULL) {
+        send_cb(mac, ok ? ESP_NOW_SEND_SUCCESS : ESP_NOW_SEND_FAIL);
+    }
+}
+
+void host_on_send(host_send_t cb) {
+    send_hook = cb;
+}
+
+void host_on_restart(host_restart_t cb) {
+    restart_hook = cb;
+}
+
+uint32_t host_sends(void) {
+    return sends;
+}
+
+int host_task_exists(const char* name) {
+    for (uint32_t i = 0; i < task_count; ++i) {
+        if (strcmp(tasks[i].name, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void host_idle(int core, uint32_t us) {
+    assert(core >= 0 && core < portNUM_PROCESSORS);
+
+    idle_run[core] += us;
+}
+
+/*
+* NVS export format: per entry the namespace and key, zero padded to
+*  HOST_NVS_NAME bytes, a little endian uint32 length and the value.
+*/
+int host_nvs_export(uint8_t* buf, int cap) {
+    int at = 0;
+    for (uint32_t i = 0; i < nvs_count; ++i) {
+        int need = 2 * HOST_NVS_NAME + 4 + nvs[i].len;
+        if (at + need > cap) {
+            return -1;
+        }
+        memcpy(buf + at, nvs[i].space, HOST_NVS_NAME);
+        memcpy(buf + at + HOST_NVS_NAME, nvs[i].key, HOST_NVS_NAME);
+        memcpy(buf + at + 2 * HOST_NVS_NAME, &nvs[i].len, 4);
+        memcpy(buf + at + 2 * HOST_NVS_NAME + 4, nvs[i].value, nvs[i].len);
+        at += need;
+    }
+    return at;
+}
+
+int host_nvs_import(const uint8_t* buf, int len) {
+    host_nvs_clear();
+
+    int at = 0;
+    while (at + 2 * HOST_NVS_NAME + 4 <= len && nvs_count < HOST_NVS_KEYS) {
+        HostNvsEntry* e = nvs + nvs_count;
+        memcpy(e->space, buf + at, HOST_NVS_NAME);
+        memcpy(e->key, buf + at + HOST_NVS_NAME, HOST_NVS_NAME);
+        memcpy(&e->len, buf + at + 2 * HOST_NVS_NAME, 4);
+        if (e->len > HOST_NVS_SIZE || at + 2 * HOST_NVS_NAME + 4 + (int)e->len > len) {
+            return -1;
+        }
+        memcpy(e->value, buf + at + 2 * HOST_NVS_NAME + 4, e->len);
+        at += 2 * HOST_NVS_NAME + 4 + e->len;
+        nvs_count++;
+    }
+    return at;
+}
+
+void host_nvs_clear(void) {
+    memset(nvs, 0, sizeof(nvs));
+    nvs_count = 0;
+}
+
+
+// -- FreeRTOS ----------------------------------------------------------------
+
+static struct HostQueue* queue_new(UBaseType_t length, UBaseType_t size) {
+    struct HostQueue* q = calloc(1, sizeof(struct HostQueue));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->items = calloc(length, size ? size : 1);
+    if (q->items == NULL) {
+        free(q);
+        return NULL;
+    }
+    q->length = length;
+    q->size = size;
+    q->next = queues;
+    queues = q;
+    return q;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t size) {
+    return queue_new(length, size);
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    for (struct HostQueue** p = &queues; *p != NULL; p = &(*p)->next) {
+        if (*p == q) {
+            *p = q->next;
+            free(q->items);
+            free(q);
+            return;
+        }
+    }
+}
+
+static BaseType_t queue_put(QueueHandle_t q, const void* item, int front) {
+    assert(q != NULL);
+
+    if (q->count == q->length) {
+        return errQUEUE_FULL;
+    }
+    uint32_t at;
+    if (front) {
+        q->head = (q->head + q->length - 1) % q->length;
+        at = q->head;
+    }
+    else {
+        at = (q->head + q->count) % q->length;
+    }
+    if (q->size) {
+        memcpy(q->items + at * q->size, item, q->size);
+    }
+    q->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t wait) {
+    return queue_put(q, item, 0);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t wait) {
+    return queue_put(q, item, 0);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t wait) {
+    return queue_put(q, item, 1);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return queue_put(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t wait) {
+    assert(q != NULL);
+
+    if (q->count == 0) {
+        return pdFALSE;
+    }
+    if (q->size) {
+        memcpy(item, q->items + q->head * q->size, q->size);
+    }
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t wait) {
+    assert(q != NULL);
+
+    if (q->count == 0) {
+        return pdFALSE;
+    }
+    if (q->size) {
+        memcpy(item, q->items + q->head * q->size, q->size);
+    }
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    return q->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+    return q->length - q->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    q->head = 0;
+    q->count = 0;
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return queue_new(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t s = queue_new(1, 0);
+    if (s != NULL) {
+        s->count = 1;
+    }
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    SemaphoreHandle_t s = queue_new(max, 0);
+    if (s != NULL) {
+        s->count = initial;
+    }
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+    return xQueueReceive(s, NULL, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    return queue_put(s, NULL, 0);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack,
+                       void* param, UBaseType_t prio, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, param, prio, handle, tskNO_AFFINITY);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* param, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core) {
+    if (task_count == HOST_TASKS) {
+        return pdFAIL;
+    }
+    struct HostTask* t = tasks + task_count++;
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t->fn = fn;
+    t->param = param;
+    if (handle != NULL) {
+        *handle = t;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+}
+
+void vTaskDelay(TickType_t ticks) {
+    now_us += (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+void vTaskDelayUntil(TickType_t* last, TickType_t ticks) {
+    *last += ticks;
+    int64_t at = (int64_t)*last * portTICK_PERIOD_MS * 1000;
+    if (at > now_us) {
+        now_us = at;
+    }
+}
+
+void taskYIELD(void) {
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / (portTICK_PERIOD_MS * 1000));
+}
+
+BaseType_t xPortGetCoreID(void) {
+    return 0;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return NULL;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return 0;
+}
+
+void vTaskGetInfo(TaskHandle_t task, TaskStatus_t* status, BaseType_t stack, eTaskState state) {
+    memset(status, 0, sizeof(TaskStatus_t));
+    status->xHandle = task;
+    status->pcTaskName = task->name;
+    status->eCurrentState = state;
+    for (int c = 0; c < portNUM_PROCESSORS; ++c) {
+        if (task == idle_task + c) {
+            status->ulRunTimeCounter = idle_run[c];
+        }
+    }
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t core) {
+    assert(core < portNUM_PROCESSORS);
+
+    return idle_task + core;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return pdPASS;
+}
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct HostGroup* g = calloc(1, sizeof(struct HostGroup));
+    if (g != NULL) {
+        g->next = groups;
+        groups = g;
+    }
+    return g;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    group->bits |= bits;
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    EventBits_t was = group->bits;
+    group->bits &= ~bits;
+    return was;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear, BaseType_t all, TickType_t wait) {
+    EventBits_t was = group->bits;
+    int met = (all ? (was & bits) == bits : (was & bits) != 0);
+    if (met && clear) {
+        group->bits &= ~bits;
+    }
+    return was;
+}
+
+
+// -- esp-idf -----------------------------------------------------------------
+
+const char* esp_err_to_name(esp_err_t err) {
+    return (err == ESP_OK ? "ESP_OK" : "ESP_FAIL");
+}
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+}
+
+int64_t esp_timer_get_time(void) {
+    return now_us;
+}
+
+uint32_t esp_random(void) {
+    return host_random();
+}
+
+void esp_fill_random(void* buf, size_t len) {
+    uint8_t* out = buf;
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = (uint8_t)host_random();
+    }
+}
+
+void esp_restart(void) {
+    host_log(HOST_LOG_INFO, "host", "esp_restart()");
+    if (restart_hook != NULL) {
+        restart_hook();
+    }
+    abort();
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return ESP_RST_POWERON;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return 200000;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return 150000;
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type) {
+    static const uint8_t own[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01 };
+    memcpy(mac, own, 6);
+    return ESP_OK;
+}
+
+esp_err_t esp_efuse_mac_get_default(uint8_t* mac) {
+    return esp_read_mac(mac, ESP_MAC_WIFI_STA);
+}
+
+esp_err_t esp_event_loop_create_default(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t* cfg) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_promiscuous(bool enable) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t cb) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_promiscuous_filter(const wifi_promiscuous_filter_t* filter) {
+    return ESP_OK;
+}
+
+esp_err_t esp_now_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+    recv_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+    send_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+    return ESP_OK;
+}
+
+esp_err_t esp_now_del_peer(const uint8_t* mac) {
+    return ESP_OK;
+}
+
+bool esp_now_is_peer_exist(const uint8_t* mac) {
+    return true;
+}
+
+esp_err_t esp_now_send(const uint8_t* mac, const uint8_t* data, size_t len) {
+    if (mac == NULL || len > ESP_NOW_MAX_DATA_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sends++;
+    if (send_hook != NULL) {
+        send_hook(mac, data, (int)len);
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    host_nvs_clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* space, nvs_open_mode_t mode, nvs_handle_t* handle) {
+    for (uint32_t i = 0; i < nvs_space_count; ++i) {
+        if (strcmp(nvs_spaces[i], space) == 0) {
+            *handle = i;
+            return ESP_OK;
+        }
+    }
+    if (nvs_space_count == HOST_NVS_KEYS || strlen(space) >= HOST_NVS_NAME) {
+        return ESP_ERR_NO_MEM;
+    }
+    strcpy(nvs_spaces[nvs_space_count], space);
+    *handle = nvs_space_count++;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_OK;
+}
+
+static HostNvsEntry* nvs_find(nvs_handle_t handle, const char* key) {
+    for (uint32_t i = 0; i < nvs_count; ++i) {
+        if (strcmp(nvs[i].space, nvs_spaces[handle]) == 0 && strcmp(nvs[i].key, key) == 0) {
+            return nvs + i;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+    HostNvsEntry* e = nvs_find(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *e = nvs[--nvs_count];
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out, size_t* len) {
+    HostNvsEntry* e = nvs_find(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    // As on the device: no buffer asks for the size only.
+    if (out == NULL) {
+        *len = e->len;
+        return ESP_OK;
+    }
+    if (*len < e->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out, e->value, e->len);
+    *len = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t len) {
+    if (len > HOST_NVS_SIZE || strlen(key) >= HOST_NVS_NAME) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    HostNvsEntry* e = nvs_find(handle, key);
+    if (e == NULL) {
+        if (nvs_count == HOST_NVS_KEYS) {
+            return ESP_ERR_NVS_NO_FREE_PAGES;
+        }
+        e = nvs + nvs_count++;
+        strcpy(e->space, nvs_spaces[handle]);
+        strcpy(e->key, key);
+    }
+    memcpy(e->value, value, len);
+    e->len = len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out) {
+    size_t len = 1;
+    return nvs_get_blob(handle, key, out, &len);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value) {
+    return nvs_set_blob(handle, key, &value, 1);
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out) {
+    size_t len = 4;
+    return nvs_get_blob(handle, key, out, &len);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value) {
+    return nvs_set_blob(handle, key, &value, 4);
+}
+
+esp_err_t uart_driver_install(int port, int rx_size, int tx_size, int queue_size, void* queue, int flags) {
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(int port) {
+    return ESP_OK;
+}
+
+int uart_read_bytes(int port, void* buf, uint32_t len, TickType_t wait) {
+    return 0;
+}
+
+int uart_write_bytes(int port, const void* buf, size_t len) {
+    return (int)len;
+}
+
+esp_err_t uart_wait_tx_done(int port, TickType_t wait) {
+    return ESP_OK;
+}
+
+void gpio_pad_select_gpio(int pin) {
+}
+
+esp_err_t gpio_set_direction(int pin, gpio_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(int pin, uint32_t level) {
+    return ESP_OK;
+}
+
+// serial.c owns the console on the device.
+void serial_out(const char* string) {
+    if (log_level >= HOST_LOG_INFO) {
+        fputs(string, stdout);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef HOST_H
+#define HOST_H
+
+/*
+* Linux host build of the firmware modules.  The headers in this directory
+*  stand in for the few FreeRTOS and esp-idf interfaces the network layer and
+*  the Collatz client use, host.c implements them for one process:
+*
+*   - time is simulated, esp_timer_get_time() returns what the driver set,
+*   - esp_random() is a seeded generator, so runs are reproducible,
+*   - queues, semaphores and event groups never block, a receive on an empty
+*     queue fails at once as if its timeout had run out,
+*   - tasks are recorded but never run, the driver calls their bodies,
+*   - NVS lives in memory and can be exported across a simulated reboot,
+*   - ESP-NOW sends go to a driver callback.
+*
+* Build the modules with -I serial/host ahead of serial/main, see
+*  net_fuzz.py, capture.py and collatz_check.py at the top of the repository.
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_LOG_NONE 0
+#define HOST_LOG_ERROR 1
+#define HOST_LOG_WARN 2
+#define HOST_LOG_INFO 3
+
+typedef void (*host_send_t)(const uint8_t* mac, const uint8_t* data, int len);
+typedef void (*host_restart_t)(void);
+
+// Drops every queue, task and peer, keeps NVS.  Seeds esp_random().
+void host_reset(uint64_t seed);
+
+void host_set_time(int64_t us);
+void host_advance(int64_t us);
+int64_t host_time(void);
+
+uint32_t host_random(void);
+void host_log_level(int level);
+void host_log(int level, const char* tag, const char* fmt, ...);
+
+// Delivers a frame through the registered ESP-NOW receive callback, and the
+//  status of a send through the registered send callback.
+void host_espnow_recv(const uint8_t* mac, const uint8_t* data, int len);
+void host_espnow_sent(const uint8_t* mac, int ok);
+void host_on_send(host_send_t cb);
+uint32_t host_sends(void);
+
+// esp_restart() calls this, which must not return (longjmp back into the
+//  driver and boot again).  Without one it aborts.
+void host_on_restart(host_restart_t cb);
+
+// Non-zero if a task of that name has been created since the last reset.
+int host_task_exists(const char* name);
+
+// Adds run time to a core's idle task, as the run-time stats would count it.
+void host_idle(int core, uint32_t us);
+
+// NVS contents as one blob, for carrying across a reboot of the library.
+//  Both return the size in bytes, export fails with -1 if 'cap' is short.
+int host_nvs_export(uint8_t* buf, int cap);
+int host_nvs_import(const uint8_t* buf, int len);
+void host_nvs_clear(void);
+
+#endif
@@ -0,0 +1,439 @@
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "host.h"
+#include "net_fuzz.h"
+#include "net_layer.h"
+#include "network.h"
+
+/*
+* Seeded fuzzer for the network layer, on the host build.  One node runs the
+*  real dispatch_frame, timer wheel and link table code; the generator plays
+*  every other node around it.  It reads the node state to get past the
+*  handshake often enough (LINK to our LOCATE, confirmation to our proposal,
+*  a lease for our MAC) and otherwise sends anything: every control type
+*  with random reserved bytes and contents, from linked and unlinked peers,
+*  spoofed MACs, bad checksums, wrong lengths.  Local sends, group changes
+*  and MAP rounds come in from the application side, time jumps fire the
+*  timers.  A blackout restarts the node, which boots again with what it
+*  kept in NVS.
+*
+* After every event svc_network would handle, check_table() must hold and
+*  every frame handed to ESP-NOW must be well formed.  The first violation
+*  ends the run, the seed and event count reproduce it.
+*/
+
+extern NodeState node;
+extern QueueHandle_t outbound;
+extern LinkEntry link_broadcast;
+
+#define FUZZ_PEERS 8
+#define FUZZ_APP 0x0F00
+
+typedef struct FuzzSource {
+    const uint8_t*  data;   // libFuzzer input, or NULL for the seeded generator
+    size_t          len;
+    size_t          at;
+    uint64_t        rng;
+} FuzzSource;
+
+static FuzzSource src;
+static FuzzStats* stats;
+static int failed;
+static int role;
+static int verbose = HOST_LOG_NONE;
+static jmp_buf reboot;
+
+static uint32_t fuzz_u32() {
+    if (src.data != NULL) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4 && src.at < src.len; ++i) {
+            v = (v << 8) | src.data[src.at++];
+        }
+        return v;
+    }
+    src.rng ^= src.rng << 13;
+    src.rng ^= src.rng >> 7;
+    src.rng ^= src.rng << 17;
+    return (uint32_t)(src.rng >> 16);
+}
+
+static uint32_t fuzz_below(uint32_t n) {
+    return fuzz_u32() % n;
+}
+
+static int fuzz_chance(uint32_t percent) {
+    return fuzz_below(100) < percent;
+}
+
+static void fail(int err, const char* what) {
+    if (!failed) {
+        failed = 1;
+        stats->error = err;
+        stats->failed_at = stats->events;
+        snprintf(stats->what, sizeof(stats->what), "%s", what);
+    }
+}
+
+static void check() {
+    int err = check_table();
+    if (err != 0) {
+        fail(err, "check_table");
+    }
+}
+
+static void on_send(const uint8_t* mac, const uint8_t* data, int len) {
+    const NetFrame* frame = (const NetFrame*)data;
+
+    stats->sent++;
+    if (len != sizeof(NetFrame) || frame->head.version != (NETWORK_TYPE | NETWORK_VERSION) ||
+        frame->head.checksum != pak_checksum(frame) || frame->head.source != node.id) {
+        fail(-100, "malformed send");
+    }
+}
+
+static void peer_mac(int p, uint8_t* mac) {
+    static const uint8_t base[6] = { 0x02, 0x00, 0x5e, 0x10, 0x00, 0x00 };
+    memcpy(mac, base, 6);
+    mac[5] = (uint8_t)p;
+}
+
+static NodeId peer_id(int p) {
+    return (NodeId)(0x10 + p);
+}
+
+/*
+* Runs what svc_network and svc_outbound would: every queued event, the
+*  timers now due, svc_kx's jobs, then the outbound queue straight to ESP-NOW.
+*/
+static void pump() {
+    NetEvent evt;
+    NetFrame frame;
+
+    for (int round = 0; round < 8; ++round) {
+        int busy = 0;
+        while (xQueueReceive(node.inbound, &evt, 0) == pdTRUE) {
+            service_event(&evt);
+            check();
+            busy = 1;
+        }
+        wheel_advance(&node.wheel, esp_timer_get_time());
+        check();
+
+#if defined(NET_LINK_KX)
+        while (kx_work(0)) {
+            busy = 1;
+        }
+#endif
+
+        while (xQueueReceive(outbound, &frame, 0) == pdTRUE) {
+            if (uxQueueMessagesWaiting(outbound) <= OUTBOUND_LOW_WATER) {
+                xEventGroupSetBits(node.events, EVT_OUTBOUND_CLEAR);
+            }
+            transmit_frame(&frame);
+            busy = 1;
+        }
+        if (!busy) {
+            break;
+        }
+    }
+}
+
+static void receive(const uint8_t* mac, NetFrame* frame) {
+    frame->head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    frame->head.checksum = pak_checksum(frame);
+
+    int len = sizeof(NetFrame);
+    if (fuzz_chance(3)) {
+        ((uint8_t*)frame)[fuzz_below(sizeof(NetFrame))] ^= (uint8_t)(1 + fuzz_below(255));
+    }
+    if (fuzz_chance(1)) {
+        len = fuzz_below(sizeof(NetFrame) + 8);
+    }
+
+    stats->frames++;
+    host_espnow_recv(mac, (const uint8_t*)frame, len);
+}
+
+static void random_fill(uint8_t* buf, size_t len, uint32_t percent) {
+    if (!fuzz_chance(percent)) {
+        return;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        buf[i] = (uint8_t)fuzz_u32();
+    }
+}
+
+// A peer the node knows: its parent, a child, or the one it is linking with.
+static int known_peer(uint8_t* mac, NodeId* id) {
+    int pick = fuzz_below(LINK_TABLE_SIZE + 1);
+    if (pick < LINK_TABLE_SIZE && (node.link_table.usage & (1ul << pick)) &&
+        !(pick == LINK_UP && node.isRoot)) {
+        memcpy(mac, node.link_table.entry[pick].mac, 6);
+        *id = node.link_table.entry[pick].id;
+        return 1;
+    }
+    if (node.flags & STATE_PENDING_LINK) {
+        memcpy(mac, node.pending_mac, 6);
+        *id = node.pending_id;
+        return 1;
+    }
+    return 0;
+}
+
+static void fuzz_frame() {
+    uint8_t mac[6];
+    NodeId id;
+    NetFrame frame = {};
+
+    int p = fuzz_below(FUZZ_PEERS);
+    peer_mac(p, mac);
+    id = peer_id(p);
+    if (fuzz_chance(70)) {
+        known_peer(mac, &id);
+    }
+    // Spoofing: right id from another MAC, or another id from the right one.
+    if (fuzz_chance(5)) {
+        mac[5] ^= (uint8_t)(1 + fuzz_below(FUZZ_PEERS - 1));
+    }
+    if (fuzz_chance(3)) {
+        id = (NodeId)fuzz_u32();
+    }
+
+    frame.head.source = id;
+    frame.head.destination = (fuzz_chance(90) ? node.id : link_broadcast.id);
+    frame.head.control = fuzz_below(CONTROL_HEALTH + 2);
+    // The parent answering a status check keeps a joined node joined.
+    if ((node.flags & STATE_UPLINK_STATUS) && fuzz_chance(30)) {
+        memcpy(mac, node.link_table.entry[LINK_UP].mac, 6);
+        id = node.link_table.entry[LINK_UP].id;
+        frame.head.control = CONTROL_STATUS;
+    }
+    // Both end in a reboot or a frozen node, keep them rarer.
+    if ((frame.head.control == CONTROL_BLACKOUT || frame.head.control == CONTROL_FREEZE) && fuzz_chance(80)) {
+        frame.head.control = CONTROL_DEFAULT;
+    }
+    random_fill(frame.head.reserved, sizeof(frame.head.reserved), 50);
+    random_fill(frame.contents, sizeof(frame.contents), 50);
+
+    switch (frame.head.control) {
+    case CONTROL_LOCATE:
+        frame.head.destination = link_broadcast.id;
+        frame.head.reserved[RES_IDENT] = (uint8_t)fuzz_u32();
+        break;
+    case CONTROL_LINK:
+        if ((node.flags & STATE_LOCATING) && fuzz_chance(80)) {
+            frame.head.reserved[RES_IDENT] = node.loc_ident;
+            frame.head.reserved[RES_DEPTH] = fuzz_below(4);
+            frame.head.reserved[RES_BRANCH] = 1 + fuzz_below(TDMA_BRANCHES);
+        }
+        break;
+    case CONTROL_LEASE:
+        if (fuzz_chance(50)) {
+            LeaseRecord rec = {};
+            memcpy(rec.mac, (fuzz_chance(70) ? node.mac : mac), 6);
+            rec.id = (fuzz_chance(80) ? (NodeId)(0x40 + fuzz_below(32)) : (NodeId)fuzz_u32());
+            rec.hops = (fuzz_chance(70) ? 0 : fuzz_below(LEASE_PATH_MAX + 2));
+            for (int i = 0; i < LEASE_PATH_MAX; ++i) {
+                rec.path[i] = fuzz_below(LINK_TABLE_SIZE + 1);
+            }
+            memcpy(frame.contents, &rec, sizeof(LeaseRecord));
+        }
+        break;
+    case CONTROL_STATUS:
+        frame.head.reserved[RES_DEPTH] = fuzz_below(8);
+        break;
+    case CONTROL_DEFAULT: {
+            app_header_t* app = (app_header_t*)frame.contents;
+            app->type = (fuzz_chance(50) ? FUZZ_APP : (uint16_t)fuzz_u32());
+            app->len = fuzz_below(NET_MAX_PAYLOAD + 1);
+            frame.head.reserved[RES_GROUP] = (fuzz_chance(70) ? 0 : fuzz_below(GROUP_MAX + 2));
+            break;
+        }
+    }
+
+    receive(mac, &frame);
+}
+
+static void fuzz_local() {
+    app_header_t head = {};
+    uint8_t data[NET_MAX_PAYLOAD] = {};
+    NetEvent evt = {};
+    uint8_t mac[6];
+
+    head.type = FUZZ_APP;
+    head.len = fuzz_below(NET_MAX_PAYLOAD + 1);
+    random_fill(data, sizeof(data), 30);
+
+    switch (fuzz_below(7)) {
+    case 0:
+        net_send_up(&head, data);
+        break;
+    case 1:
+        net_send_down(&head, data);
+        break;
+    case 2:
+        net_send_group(1 + fuzz_below(GROUP_MAX - 1), &head, data);
+        break;
+    case 3:
+        net_join_group(fuzz_below(GROUP_MAX + 1));
+        break;
+    case 4:
+        net_leave_group(fuzz_below(GROUP_MAX + 1));
+        break;
+    case 5:
+        evt.type = EVENT_MAP;
+        xQueueSend(node.inbound, &evt, 0);
+        break;
+    case 6: {
+            // Send status reports from the radio, NET_LATERAL only.
+            NodeId id;
+            if (known_peer(mac, &id)) {
+                host_espnow_sent(mac, fuzz_chance(70));
+            }
+            break;
+        }
+    }
+    // Drain what the application would have read.
+    while (net_receive(FUZZ_APP, &head, data, 0) == 0) {
+    }
+}
+
+static void fuzz_time() {
+    int64_t next = wheel_next(&node.wheel, esp_timer_get_time());
+    if (next >= 0 && fuzz_chance(40)) {
+        host_advance(next);
+    }
+    else {
+        host_advance(fuzz_below(fuzz_chance(10) ? 2 * US_FACTOR : 50000));
+    }
+    stats->timers++;
+}
+
+static double wall_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void on_restart() {
+    longjmp(reboot, 1);
+}
+
+static void count_boot() {
+    stats->dispatched += node.stats.frames;
+    stats->unlinked += node.stats.unlinked;
+    stats->malformed += node.stats.malformed;
+}
+
+// Boots the node, NVS is kept.
+static int fuzz_boot(uint64_t seed) {
+    free(node.leases);
+    node.leases = NULL;
+    host_reset(seed);
+    host_log_level(verbose);
+    host_on_send(on_send);
+    host_on_restart(on_restart);
+
+    if (net_init(role ? PINODE_ID : 0, role) != 0) {
+        return -1;
+    }
+    net_register_app(FUZZ_APP);
+    return 0;
+}
+
+static int fuzz_start(uint64_t seed, int root) {
+    host_nvs_clear();
+    failed = 0;
+    role = root;
+    return fuzz_boot(seed);
+}
+
+static void fuzz_step() {
+    if (setjmp(reboot) != 0) {
+        stats->reboots++;
+        stats->events++;
+        count_boot();
+        fuzz_boot(fuzz_u32());
+        return;
+    }
+
+    uint32_t pick = fuzz_below(100);
+    if (pick < 70) {
+        fuzz_frame();
+    }
+    else if (pick < 80) {
+        fuzz_local();
+    }
+    else {
+        fuzz_time();
+    }
+    pump();
+
+    stats->events++;
+    if (has_uplink(&node.link_table) && !node.isRoot) {
+        stats->joined++;
+    }
+    uint32_t children = __builtin_popcount(node.link_table.usage & ~(1ul << LINK_UP));
+    if (children > stats->max_children) {
+        stats->max_children = children;
+    }
+}
+
+void fuzz_verbose(int level) {
+    verbose = level;
+}
+
+int fuzz_run(uint64_t seed, uint32_t events, int root, FuzzStats* out) {
+    memset(out, 0, sizeof(FuzzStats));
+    stats = out;
+    src.data = NULL;
+    src.rng = seed * 0x9E3779B97F4A7C15ull + 0x5851F42D4C957F2Dull;
+
+    if (fuzz_start(seed, root) != 0) {
+        return -1;
+    }
+
+    double t0 = wall_time();
+    while (stats->events < events && !failed) {
+        fuzz_step();
+    }
+    out->seconds = wall_time() - t0;
+    count_boot();
+    return failed ? out->error : 0;
+}
+
+#if defined(NET_LIBFUZZER)
+/*
+* libFuzzer entry: the input drives the generator instead of the seed.  The
+*  first byte picks root or not, esp_random() stays seeded.
+*/
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static FuzzStats local;
+
+    if (size < 1) {
+        return 0;
+    }
+    memset(&local, 0, sizeof(FuzzStats));
+    stats = &local;
+    src.data = data + 1;
+    src.len = size - 1;
+    src.at = 0;
+
+    if (fuzz_start(1, data[0] & 1) != 0) {
+        return 0;
+    }
+    while (src.at < src.len && !failed) {
+        fuzz_step();
+    }
+    if (failed) {
+        __builtin_trap();
+    }
+    return 0;
+}
+#endif
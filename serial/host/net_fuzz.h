@@ -0,0 +1,30 @@
+#ifndef NET_FUZZ_H
+#define NET_FUZZ_H
+
+#include <stdint.h>
+
+typedef struct FuzzStats {
+	uint32_t	events;		// frames, local calls and time steps
+	uint32_t	frames;		// offered to espnow_recv
+	uint32_t	dispatched;	// reached dispatch_frame
+	uint32_t	unlinked;
+	uint32_t	malformed;
+	uint32_t	timers;		// time steps
+	uint32_t	sent;		// handed to esp_now_send
+	uint32_t	joined;		// events spent with an up-stream link
+	uint32_t	max_children;
+	uint32_t	reboots;	// blackouts
+	double		seconds;	// wall time of the run
+	int			error;		// first violation, zero if none
+	uint32_t	failed_at;	// event it followed
+	char		what[32];
+} FuzzStats;
+
+// Runs 'events' generated events against a fresh node.  Returns 0, or the
+//  first check_table() code (or -100 for a malformed send) found.
+int fuzz_run(uint64_t seed, uint32_t events, int root, FuzzStats* out);
+
+// Log level of the node under test (host.h), HOST_LOG_NONE by default.
+void fuzz_verbose(int level);
+
+#endif
@@ -0,0 +1,163 @@
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "host.h"
+#include "net_replay.h"
+#include "network.h"
+
+/*
+* Replay of a NET_CAPTURE dump into the host build, see capture.py.  The
+*  captured inbound frames are offered to a freshly booted node at their
+*  capture times, with the timers in between firing when they fall due; what
+*  the node sends is collected for comparison against the captured outbound
+*  frames.  Time and esp_random() are simulated, so a replay of the same
+*  capture always runs the same way.
+*/
+
+extern NodeState node;
+extern QueueHandle_t outbound;
+
+#define REPLAY_SENT 256
+
+static CaptureEntry sent[REPLAY_SENT];
+static uint32_t sent_count;
+static uint32_t reboots;
+static uint64_t boot_seed;
+static NodeId boot_id;
+static int boot_root;
+static int error;
+static jmp_buf reboot;
+
+static void check() {
+    int err = check_table();
+    if (err != 0 && error == 0) {
+        error = err;
+    }
+}
+
+static void on_send(const uint8_t* mac, const uint8_t* data, int len) {
+    if (sent_count >= REPLAY_SENT || len != sizeof(NetFrame)) {
+        return;
+    }
+    CaptureEntry* entry = sent + sent_count++;
+    entry->time = esp_timer_get_time();
+    entry->direction = CAPTURE_OUT;
+    memcpy(entry->mac, mac, 6);
+    memcpy(&entry->frame, data, sizeof(NetFrame));
+}
+
+static void on_restart() {
+    longjmp(reboot, 1);
+}
+
+static int boot() {
+    free(node.leases);
+    node.leases = NULL;
+    host_reset(boot_seed);
+    host_on_send(on_send);
+    host_on_restart(on_restart);
+    return net_init(boot_id, boot_root);
+}
+
+// What svc_network, svc_kx and svc_outbound would run, as in net_fuzz.c.
+static void pump() {
+    NetEvent evt;
+    NetFrame frame;
+
+    for (int round = 0; round < 8; ++round) {
+        int busy = 0;
+        while (xQueueReceive(node.inbound, &evt, 0) == pdTRUE) {
+            service_event(&evt);
+            check();
+            busy = 1;
+        }
+        wheel_advance(&node.wheel, esp_timer_get_time());
+        check();
+
+#if defined(NET_LINK_KX)
+        while (kx_work(0)) {
+            busy = 1;
+        }
+#endif
+
+        while (xQueueReceive(outbound, &frame, 0) == pdTRUE) {
+            if (uxQueueMessagesWaiting(outbound) <= OUTBOUND_LOW_WATER) {
+                xEventGroupSetBits(node.events, EVT_OUTBOUND_CLEAR);
+            }
+            transmit_frame(&frame);
+            busy = 1;
+        }
+        if (!busy) {
+            break;
+        }
+    }
+}
+
+// A blackout reboots the node where the capture had it reboot, keeping NVS.
+static int rebooted() {
+    int64_t now = esp_timer_get_time();
+
+    reboots++;
+    if (boot() != 0) {
+        return -1;
+    }
+    host_set_time(now);
+    return 0;
+}
+
+int replay_boot(uint64_t seed, NodeId id, int root) {
+    host_nvs_clear();
+    sent_count = 0;
+    reboots = 0;
+    error = 0;
+    boot_seed = seed;
+    boot_id = id;
+    boot_root = root;
+    return boot();
+}
+
+int replay_until(int64_t time) {
+    if (setjmp(reboot) != 0) {
+        return rebooted() != 0 ? -1 : error;
+    }
+    pump();
+    while (1) {
+        int64_t now = esp_timer_get_time();
+        int64_t next = wheel_next(&node.wheel, now);
+        if (next < 0 || now + next > time) {
+            break;
+        }
+        host_advance(next > 0 ? next : 1);
+        pump();
+    }
+    if (time > esp_timer_get_time()) {
+        host_set_time(time);
+    }
+    pump();
+    return error;
+}
+
+int replay_frame(const uint8_t* mac, const uint8_t* data, int len) {
+    if (setjmp(reboot) != 0) {
+        return rebooted() != 0 ? -1 : error;
+    }
+    host_espnow_recv(mac, data, len);
+    pump();
+    return error;
+}
+
+int replay_sent(CaptureEntry* out, int cap) {
+    int n = (sent_count < (uint32_t)cap ? (int)sent_count : cap);
+    memcpy(out, sent, n * sizeof(CaptureEntry));
+    sent_count = 0;
+    return n;
+}
+
+uint32_t replay_reboots(void) {
+    return reboots;
+}
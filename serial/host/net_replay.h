@@ -0,0 +1,27 @@
+#ifndef NET_REPLAY_H
+#define NET_REPLAY_H
+
+#include <stdint.h>
+
+#include "net_layer.h"
+
+// Boots a fresh node (NVS cleared) with the captured node's id and role,
+//  esp_random() seeded.  0, or -1 if net_init() failed.
+int replay_boot(uint64_t seed, NodeId id, int root);
+
+// Runs the node up to 'time': timers as they fall due, the events they
+//  queue and the outbound queue.  0, or the first check_table() code.
+int replay_until(int64_t time);
+
+// Offers a frame from 'mac' as espnow_recv would get it and runs what it
+//  causes.  0, or the first check_table() code.
+int replay_frame(const uint8_t* mac, const uint8_t* data, int len);
+
+// Frames handed to ESP-NOW since the last call, as CAPTURE_OUT entries.
+//  Returns how many were copied, at most 'cap'; the rest are lost.
+int replay_sent(CaptureEntry* out, int cap);
+
+// Reboots the node went through (BLACKOUT), NVS kept.
+uint32_t replay_reboots(void);
+
+#endif
@@ -0,0 +1,568 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#include "app_probe.h"
+#include "network.h"
+#include "serial.h"
+
+
+#define PRIO_PROBE_APP 3
+
+#define PROBE_MAGIC 0x31627270ul	// "prb1"
+
+#define PROBE_PING			0
+#define PROBE_PONG			1
+#define PROBE_DATA			2
+#define PROBE_REPORT_REQ	3
+#define PROBE_REPORT		4
+#define PROBE_START			5	// stream to the origin
+#define PROBE_DONE			6	// stream finished, seq holds the frames sent
+
+#define PROBE_SOURCES		32
+#define PROBE_MAX_HOPS		16
+#define PROBE_MAX_PINGS		100
+#define PROBE_MAX_COUNT		10000
+#define PROBE_MAX_RATE		1000
+
+#define WAIT_PONG			1000	// ms
+#define WAIT_REPORT			3000	// ms
+#define REPORT_JITTER		1000	// ms, spreads the answers of a PROBE_ALL request
+#define PING_INTERVAL		50		// ms
+
+static const char* TAG = "app_probe";
+
+typedef struct {
+	uint8_t		used;
+	uint8_t		origin;
+	uint8_t		hops;
+	uint16_t	session;
+	uint32_t	received;
+	uint32_t	reordered;
+	uint32_t	bytes;
+	uint32_t	next_seq;	// highest sequence number seen + 1
+	uint32_t	sent;		// PULL: the source's count from its DONE frame
+	int			done;
+	int64_t		first;
+	int64_t		last;
+} probe_rx_t;
+
+typedef struct {
+	uint8_t		target;
+	uint16_t	session;
+	uint32_t	count;
+	uint16_t	size;
+	uint16_t	rate;
+} probe_job_t;
+
+// Per hop count totals for the summary lines.
+typedef struct {
+	uint32_t	nodes;
+	uint32_t	sent;
+	uint32_t	received;
+	uint32_t	reordered;
+	uint32_t	kbps;
+} probe_hop_t;
+
+static struct {
+	int					root;
+	uint16_t			session;
+	probe_rx_t			rx[PROBE_SOURCES];
+	SemaphoreHandle_t	lock;		// rx table
+	QueueHandle_t		results;	// PONG, REPORT and DONE frames for the running command
+	QueueHandle_t		jobs;		// streams requested by START frames
+	TaskHandle_t		srv_probe;
+	TaskHandle_t		srv_probe_tx;
+} state;
+
+static void probe_header(probe_header_t* p, uint8_t type, uint8_t target, uint16_t session, uint32_t seq) {
+	memset(p, 0, sizeof(probe_header_t));
+	p->magic = PROBE_MAGIC;
+	p->type = type;
+	p->origin = net_node_id();
+	p->target = target;
+	p->session = session;
+	p->seq = seq;
+}
+
+/*
+* Probe frames go up to the root and are flooded down from there, so every
+*  node can reach every other one.  The root sends down directly.
+*/
+static int probe_out(const uint8_t* data, uint8_t len) {
+	app_header_t head = {};
+	head.type = APP_PROBE_ID;
+	head.len = len;
+
+	if (state.root) {
+		return net_send_down(&head, data);
+	}
+	return net_send_up(&head, data);
+}
+
+static void probe_forward(const app_header_t* head, const uint8_t* data, int from_up) {
+	const probe_header_t* p = (const probe_header_t*)data;
+	if (p->target == net_node_id()) {
+		return;
+	}
+	if (from_up || state.root) {
+		net_send_down(head, data);
+	}
+	else {
+		net_send_up(head, data);
+	}
+}
+
+static probe_rx_t* probe_rx_entry(uint8_t origin, uint16_t session, int create) {
+	probe_rx_t* oldest = &state.rx[0];
+	for (int i = 0; i < PROBE_SOURCES; ++i) {
+		probe_rx_t* e = &state.rx[i];
+		if (e->used && e->origin == origin) {
+			if (e->session == session || create) {
+				if (e->session != session) {
+					memset(e, 0, sizeof(probe_rx_t));
+				}
+				return e;
+			}
+			return NULL;
+		}
+		if (!e->used || (oldest->used && e->last < oldest->last)) {
+			oldest = e;
+		}
+	}
+	if (!create) {
+		return NULL;
+	}
+	memset(oldest, 0, sizeof(probe_rx_t));
+	return oldest;
+}
+
+static void probe_rx_data(const app_header_t* head, const probe_header_t* p) {
+	int64_t now = esp_timer_get_time();
+
+	xSemaphoreTake(state.lock, portMAX_DELAY);
+	probe_rx_t* e = probe_rx_entry(p->origin, p->session, 1);
+	if (!e->received) {
+		e->used = 1;
+		e->origin = p->origin;
+		e->session = p->session;
+		e->first = now;
+	}
+	e->hops = p->hops;
+	e->received++;
+	e->bytes += head->len;
+	e->last = now;
+	if (p->seq < e->next_seq) {
+		e->reordered++;
+	}
+	else {
+		e->next_seq = p->seq + 1;
+	}
+	xSemaphoreGive(state.lock);
+}
+
+static void probe_rx_done(const probe_header_t* p) {
+	xSemaphoreTake(state.lock, portMAX_DELAY);
+	probe_rx_t* e = probe_rx_entry(p->origin, p->session, 1);
+	if (!e->used) {
+		// Nothing of the stream arrived.
+		e->used = 1;
+		e->origin = p->origin;
+		e->session = p->session;
+		e->hops = p->hops;
+		e->first = e->last = esp_timer_get_time();
+	}
+	e->sent = p->seq;
+	e->done = 1;
+	xSemaphoreGive(state.lock);
+}
+
+static void probe_report(const probe_header_t* req) {
+	uint8_t data[sizeof(probe_header_t) + sizeof(probe_report_t)];
+	probe_header_t* p = (probe_header_t*)data;
+	probe_report_t* r = (probe_report_t*)(data + sizeof(probe_header_t));
+
+	probe_header(p, PROBE_REPORT, req->origin, req->session, req->seq);
+	memset(r, 0, sizeof(probe_report_t));
+	r->hops = req->hops;
+
+	xSemaphoreTake(state.lock, portMAX_DELAY);
+	probe_rx_t* e = probe_rx_entry(req->origin, req->session, 0);
+	if (e != NULL) {
+		r->hops = e->hops;
+		r->received = e->received;
+		r->reordered = e->reordered;
+		r->bytes = e->bytes;
+		r->span_us = (uint32_t)(e->last - e->first);
+	}
+	xSemaphoreGive(state.lock);
+
+	if (req->target == PROBE_ALL) {
+		vTaskDelay((esp_random() % REPORT_JITTER) / portTICK_PERIOD_MS);
+	}
+	probe_out(data, sizeof(data));
+}
+
+static void probe_deliver(const app_header_t* head, const uint8_t* data) {
+	const probe_header_t* p = (const probe_header_t*)data;
+
+	switch (p->type) {
+	case PROBE_PING: {
+		probe_header_t pong = {};
+		probe_header(&pong, PROBE_PONG, p->origin, p->session, p->seq);
+		pong.out_hops = p->hops;
+		pong.stamp = p->stamp;
+		probe_out((uint8_t*)&pong, sizeof(pong));
+		break;
+	}
+	case PROBE_DATA:
+		probe_rx_data(head, p);
+		break;
+	case PROBE_REPORT_REQ:
+		probe_report(p);
+		break;
+	case PROBE_START: {
+		if (head->len < sizeof(probe_header_t) + sizeof(probe_start_t)) {
+			break;
+		}
+		const probe_start_t* s = (const probe_start_t*)(data + sizeof(probe_header_t));
+		if (s->size < sizeof(probe_header_t) || s->size > NET_MAX_PAYLOAD || !s->rate) {
+			break;
+		}
+		probe_job_t job = { p->origin, p->session, s->count, s->size, s->rate };
+		if (xQueueSend(state.jobs, &job, 0) != pdTRUE) {
+			ESP_LOGW(TAG, "Stream to 0x%02X refused, one is already queued.", p->origin);
+		}
+		break;
+	}
+	case PROBE_DONE:
+		probe_rx_done(p);
+		// fall through, the PULL command waits for these too
+	case PROBE_PONG:
+	case PROBE_REPORT: {
+		uint8_t frame[NET_MAX_PAYLOAD];
+		memcpy(frame, data, head->len);
+		xQueueSend(state.results, frame, 0);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void app_probe_task(void* param) {
+	app_header_t	head = {};
+	uint8_t			data[NET_MAX_PAYLOAD];
+
+	while (1) {
+		if (net_receive(APP_PROBE_ID, &head, data, -1)) {
+			continue;
+		}
+		probe_header_t* p = (probe_header_t*)data;
+		if (head.len < sizeof(probe_header_t) || p->magic != PROBE_MAGIC) {
+			continue;
+		}
+
+		int from_up = head.reserved[0];
+		uint8_t me = net_node_id();
+		p->hops++;
+
+		probe_forward(&head, data, from_up);
+
+		// Frames to every node are taken on the way down, so the nodes between
+		//  the origin and the root see each of them once.
+		if (p->origin != me && (p->target == me || (p->target == PROBE_ALL && (from_up || state.root)))) {
+			probe_deliver(&head, data);
+		}
+	}
+}
+
+/*
+* Sends 'count' DATA frames at 'rate' per second without blocking, returns
+*  the number accepted by the network layer.  Refused frames do not use up a
+*  sequence number, so a gap at the receiver is a loss on the way.
+*/
+static uint32_t probe_stream(uint8_t target, uint16_t session, uint32_t count, uint16_t size, uint16_t rate, uint32_t* blocked) {
+	uint8_t data[NET_MAX_PAYLOAD];
+	probe_header_t* p = (probe_header_t*)data;
+
+	memset(data, 0, sizeof(data));
+	*blocked = 0;
+
+	uint32_t sent = 0;
+	int64_t start = esp_timer_get_time();
+	for (uint32_t i = 0; i < count; ++i) {
+		int64_t due = start + (int64_t)i * 1000000 / rate;
+		int64_t now = esp_timer_get_time();
+		if (due > now) {
+			TickType_t ticks = (due - now) / 1000 / portTICK_PERIOD_MS;
+			vTaskDelay(ticks ? ticks : 1);
+		}
+
+		probe_header(p, PROBE_DATA, target, session, sent);
+		p->stamp = esp_timer_get_time();
+		if (probe_out(data, size) == 0) {
+			sent++;
+		}
+		else {
+			(*blocked)++;
+		}
+	}
+	return sent;
+}
+
+void app_probe_tx_task(void* param) {
+	probe_job_t job;
+
+	while (1) {
+		if (xQueueReceive(state.jobs, &job, portMAX_DELAY) != pdTRUE) {
+			continue;
+		}
+
+		uint32_t blocked = 0;
+		uint32_t sent = probe_stream(job.target, job.session, job.count, job.size, job.rate, &blocked);
+		ESP_LOGI(TAG, "Stream to 0x%02X: %u sent, %u blocked.", job.target, sent, blocked);
+
+		// Let the tail of the stream drain before the count goes out.
+		vTaskDelay((100 + esp_random() % REPORT_JITTER) / portTICK_PERIOD_MS);
+
+		probe_header_t done = {};
+		probe_header(&done, PROBE_DONE, job.target, job.session, sent);
+		probe_out((uint8_t*)&done, sizeof(done));
+	}
+}
+
+void app_probe_init(int root) {
+	memset(&state, 0, sizeof(state));
+	state.root = root;
+	state.session = esp_random();
+	state.lock = xSemaphoreCreateMutex();
+	state.results = xQueueCreate(PROBE_SOURCES, NET_MAX_PAYLOAD);
+	state.jobs = xQueueCreate(1, sizeof(probe_job_t));
+
+	net_register_app(APP_PROBE_ID);
+
+	xTaskCreate(&app_probe_task, "app_probe", 4096, NULL, PRIO_PROBE_APP, &state.srv_probe);
+	xTaskCreate(&app_probe_tx_task, "app_probe_tx", 4096, NULL, PRIO_PROBE_APP - 1, &state.srv_probe_tx);
+}
+
+static int probe_wait_result(uint8_t* frame, uint16_t session, int64_t until) {
+	while (1) {
+		int64_t left = until - esp_timer_get_time();
+		if (left <= 0) {
+			return -1;
+		}
+		TickType_t ticks = left / 1000 / portTICK_PERIOD_MS;
+		if (xQueueReceive(state.results, frame, ticks ? ticks : 1) != pdTRUE) {
+			continue;
+		}
+		if (((probe_header_t*)frame)->session == session) {
+			return 0;
+		}
+	}
+}
+
+static int cmp_u32(const void* a, const void* b) {
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t* sorted, int n, int pct) {
+	return sorted[(n - 1) * pct / 100];
+}
+
+void app_probe_ping(uint8_t target, int count, int size) {
+	static uint32_t rtt[PROBE_MAX_PINGS];
+	uint8_t frame[NET_MAX_PAYLOAD];
+	char out[128];
+
+	if (count > PROBE_MAX_PINGS) {
+		count = PROBE_MAX_PINGS;
+	}
+	if (size < sizeof(probe_header_t)) {
+		size = sizeof(probe_header_t);
+	}
+
+	uint16_t session = ++state.session;
+	xQueueReset(state.results);
+
+	int answered = 0;
+	int hops_out = 0;
+	int hops_back = 0;
+	for (int i = 0; i < count; ++i) {
+		memset(frame, 0, sizeof(frame));
+		probe_header_t* p = (probe_header_t*)frame;
+		probe_header(p, PROBE_PING, target, session, i);
+		p->stamp = esp_timer_get_time();
+		if (probe_out(frame, size) != 0) {
+			vTaskDelay(PING_INTERVAL / portTICK_PERIOD_MS);
+			continue;
+		}
+
+		int64_t until = p->stamp + WAIT_PONG * 1000ll;
+		while (!probe_wait_result(frame, session, until)) {
+			p = (probe_header_t*)frame;
+			if (p->type == PROBE_PONG && p->seq == (uint32_t)i) {
+				rtt[answered++] = (uint32_t)(esp_timer_get_time() - p->stamp);
+				hops_out = p->out_hops;
+				hops_back = p->hops;
+				break;
+			}
+		}
+		vTaskDelay(PING_INTERVAL / portTICK_PERIOD_MS);
+	}
+
+	if (!answered) {
+		snprintf(out, sizeof(out), "0x%02X: no answer, %d lost", target, count);
+		serial_out(out);
+		return;
+	}
+
+	qsort(rtt, answered, sizeof(uint32_t), cmp_u32);
+	snprintf(out, sizeof(out), "0x%02X: %d bytes, hops %d/%d, lost %d/%d", target, size, hops_out, hops_back, count - answered, count);
+	serial_out(out);
+	snprintf(out, sizeof(out), "rtt us min %u p50 %u p90 %u p99 %u max %u",
+		rtt[0], percentile(rtt, answered, 50), percentile(rtt, answered, 90), percentile(rtt, answered, 99), rtt[answered - 1]);
+	serial_out(out);
+}
+
+static uint32_t probe_kbps(uint32_t bytes, uint32_t span_us) {
+	return (span_us ? (uint32_t)((uint64_t)bytes * 8000 / span_us) : 0);
+}
+
+static void probe_line(uint8_t id, uint8_t hops, uint32_t sent, uint32_t received, uint32_t reordered, uint32_t kbps, probe_hop_t* by_hops) {
+	char out[128];
+	uint32_t lost = (sent > received ? sent - received : 0);
+
+	snprintf(out, sizeof(out), "0x%02X hops %u sent %u rx %u lost %u reordered %u goodput %u kbit/s",
+		id, hops, sent, received, lost, reordered, kbps);
+	serial_out(out);
+
+	if (hops < PROBE_MAX_HOPS) {
+		probe_hop_t* h = &by_hops[hops];
+		h->nodes++;
+		h->sent += sent;
+		h->received += received;
+		h->reordered += reordered;
+		h->kbps += kbps;
+	}
+}
+
+static void probe_summary(const probe_hop_t* by_hops) {
+	char out[128];
+
+	for (int i = 0; i < PROBE_MAX_HOPS; ++i) {
+		const probe_hop_t* h = &by_hops[i];
+		if (!h->nodes) {
+			continue;
+		}
+		uint32_t lost = (h->sent > h->received ? h->sent - h->received : 0);
+		snprintf(out, sizeof(out), "hops %d: nodes %u loss %u.%u%% reordered %u goodput %u kbit/s avg",
+			i, h->nodes, (h->sent ? lost * 100 / h->sent : 0), (h->sent ? lost * 1000 / h->sent % 10 : 0),
+			h->reordered, h->kbps / h->nodes);
+		serial_out(out);
+	}
+}
+
+void app_probe_send(uint8_t target, int count, int size, int rate) {
+	static probe_hop_t by_hops[PROBE_MAX_HOPS];
+	uint8_t frame[NET_MAX_PAYLOAD];
+	char out[128];
+
+	uint16_t session = ++state.session;
+	xQueueReset(state.results);
+	memset(by_hops, 0, sizeof(by_hops));
+
+	uint32_t blocked = 0;
+	uint32_t sent = probe_stream(target, session, count, size, rate, &blocked);
+	snprintf(out, sizeof(out), "sent %u of %d, %u refused by the outbound queue", sent, count, blocked);
+	serial_out(out);
+
+	probe_header_t req = {};
+	probe_header(&req, PROBE_REPORT_REQ, target, session, sent);
+	vTaskDelay(100 / portTICK_PERIOD_MS);
+	if (probe_out((uint8_t*)&req, sizeof(req)) != 0) {
+		serial_out("report request refused");
+		return;
+	}
+
+	int64_t until = esp_timer_get_time() + WAIT_REPORT * 1000ll;
+	int reports = 0;
+	while (!probe_wait_result(frame, session, until)) {
+		const probe_header_t* p = (const probe_header_t*)frame;
+		const probe_report_t* r = (const probe_report_t*)(frame + sizeof(probe_header_t));
+		if (p->type != PROBE_REPORT) {
+			continue;
+		}
+		probe_line(p->origin, r->hops, sent, r->received, r->reordered, probe_kbps(r->bytes, r->span_us), by_hops);
+		reports++;
+		if (target != PROBE_ALL) {
+			break;
+		}
+	}
+
+	if (!reports) {
+		serial_out("no reports");
+		return;
+	}
+	probe_summary(by_hops);
+}
+
+void app_probe_pull(uint8_t source, int count, int size, int rate) {
+	static probe_hop_t by_hops[PROBE_MAX_HOPS];
+	uint8_t frame[NET_MAX_PAYLOAD];
+
+	uint16_t session = ++state.session;
+	xQueueReset(state.results);
+	memset(by_hops, 0, sizeof(by_hops));
+
+	memset(frame, 0, sizeof(frame));
+	probe_header((probe_header_t*)frame, PROBE_START, source, session, 0);
+	probe_start_t* s = (probe_start_t*)(frame + sizeof(probe_header_t));
+	s->count = count;
+	s->size = size;
+	s->rate = rate;
+	if (probe_out(frame, sizeof(probe_header_t) + sizeof(probe_start_t)) != 0) {
+		serial_out("start request refused");
+		return;
+	}
+
+	// The streams run in parallel, wait for them plus the jittered DONE frames.
+	int64_t until = esp_timer_get_time() + (int64_t)count * 1000000 / rate + WAIT_REPORT * 1000ll;
+	while (!probe_wait_result(frame, session, until)) {
+		if (source != PROBE_ALL && ((probe_header_t*)frame)->type == PROBE_DONE) {
+			break;
+		}
+	}
+
+	int sources = 0;
+	xSemaphoreTake(state.lock, portMAX_DELAY);
+	for (int i = 0; i < PROBE_SOURCES; ++i) {
+		const probe_rx_t* e = &state.rx[i];
+		if (!e->used || e->session != session) {
+			continue;
+		}
+		// Without a DONE frame the source count is unknown, use the highest sequence seen.
+		uint32_t sent = (e->done ? e->sent : e->next_seq);
+		probe_line(e->origin, e->hops, sent, e->received, e->reordered, probe_kbps(e->bytes, (uint32_t)(e->last - e->first)), by_hops);
+		sources++;
+	}
+	xSemaphoreGive(state.lock);
+
+	if (!sources) {
+		serial_out("nothing received");
+		return;
+	}
+	probe_summary(by_hops);
+}
@@ -0,0 +1,48 @@
+#include <stdint.h>
+
+/*
+* Probe application: multi-hop ping and throughput tests, driven by the
+*  PROBE_* serial commands.  Every node running it forwards probe frames and
+*  answers the ones addressed to it, or to every node.
+*/
+
+#define APP_PROBE_ID 3
+
+#define PROBE_ALL 0xFF
+
+typedef struct __attribute__((packed)) {
+	uint32_t	magic;
+	uint8_t		type;
+	uint8_t		origin;
+	uint8_t		target;		// node-id, PROBE_ALL for every node
+	uint8_t		hops;		// links travelled so far
+	uint16_t	session;
+	uint8_t		out_hops;	// PONG: hops the PING took
+	uint8_t		padding;
+	uint32_t	seq;		// DATA: frame number, REPORT_REQ / DONE: frames sent
+	int64_t		stamp;		// PING: origin's clock, echoed in the PONG
+} probe_header_t;
+
+// Follows the header of START frames.
+typedef struct __attribute__((packed)) {
+	uint32_t	count;
+	uint16_t	size;
+	uint16_t	rate;		// frames per second
+} probe_start_t;
+
+// Follows the header of REPORT frames.
+typedef struct __attribute__((packed)) {
+	uint8_t		hops;
+	uint8_t		padding[3];
+	uint32_t	received;
+	uint32_t	reordered;	// arrived after a later frame
+	uint32_t	bytes;
+	uint32_t	span_us;	// first to last frame
+} probe_report_t;
+
+void app_probe_init(int root);
+
+// Serial front end, results go out through serial_out(..).
+void app_probe_ping(uint8_t target, int count, int size);
+void app_probe_send(uint8_t target, int count, int size, int rate);
+void app_probe_pull(uint8_t source, int count, int size, int rate);
@@ -21,6 +21,8 @@
 
 #define DEFAULT_PERIOD	100ll
 #define FACTOR_PERIOD	100000ll
+#define MAX_BACKOFF		8
+#define SEND_TIMEOUT	100
 
 static const char* TAG = "app_sensor";
 
@@ -43,6 +45,7 @@ struct {
 
 	uint8_t					id;
 	uint16_t				period;
+	uint8_t					backoff;	// period multiplier while the network is congested
 	esp_timer_handle_t		timer;
 	EventGroupHandle_t		events;
 	TaskHandle_t			srv_sensor;
@@ -90,13 +93,20 @@ void app_sensor_task(void* param) {
 
 		int valid = dht_read(&local);
 		process_cache(&remote, (valid == 0 ? &local : NULL));
-		net_send_up(&head, (const uint8_t*)&remote);
+		// Congested: stretch the period rather than queue readings that would be dropped.
+		if (net_send_up_timeout(&head, (const uint8_t*)&remote, SEND_TIMEOUT) == NET_WOULD_BLOCK) {
+			state.backoff = (state.backoff < MAX_BACKOFF ? state.backoff * 2 : MAX_BACKOFF);
+			ESP_LOGW(TAG, "Network congested, backing off x%u", state.backoff);
+		}
+		else if (state.backoff > 1) {
+			state.backoff /= 2;
+		}
 
 		// debug_print(&remote);
 
 		t_delta = esp_timer_get_time() - t_start;
 
-		esp_timer_start_once(state.timer, (state.period * FACTOR_PERIOD) - t_delta);
+		esp_timer_start_once(state.timer, (state.period * FACTOR_PERIOD * state.backoff) - t_delta);
 	}
 }
 
@@ -131,6 +141,7 @@ void app_sensor_init(uint8_t node_id) {
 
 	state.id = node_id;
 	state.period = DEFAULT_PERIOD;
+	state.backoff = 1;
 
 	memset(&(state.cache), 0, sizeof(state.cache));
 
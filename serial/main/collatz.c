@@ -8,6 +8,7 @@
 #include <string.h> // memcpy
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 
 #include "nvs_flash.h"
 #include "esp_wifi.h"
@@ -19,6 +20,9 @@
 #include "network.h"
 #include "collatz.h"
 #include "rl_int.h"
+#include "collatz_kernel.h"
+#include "collatz_sieve.h"
+#include "collatz_frame.h"
 
 /******************************************************************/
 
@@ -36,301 +40,1421 @@ static int led_count = 0;
 
 /*
  * Integer frame:
- * - base offset bd (blocks done)
+ * - base offset bd (blocks done), counted in blocks above the start: job.frame
  * - BLOCKS    = number of blocks
  * - BLOCKSIZE = integers per block
  */
 #if defined(TESTCASE)
-#define BLOCKSIZE (((uint32_t)1) << 4) // 16 and EVEN
+#define BLOCKSHIFT 4 // 16 and EVEN
 #define BLOCKS 4
 #else
-#define BLOCKSIZE (((uint32_t)1) << 22) // about 4M, and EVEN
-#define BLOCKS 32                       // check pick_block if you increase this significantly!
+#define BLOCKSHIFT 22 // about 4M, and EVEN
+#define BLOCKS 1024   // power of two, up to CF_MAX_BLOCKS
 #endif
+#define BLOCKSIZE (((uint32_t)1) << BLOCKSHIFT)
 
-#define BLOCK_FREE 0  // waiting to be processed
-#define BLOCK_TAKEN 1 // someone is supposedly working on it
-#define BLOCK_DONE 2  // reported as completed
-#define BLOCK_MASK 3  // to extract state of computation
+/* cf_init fails at run time otherwise, and snapshots count blocks in uint16_t */
+_Static_assert(BLOCKS <= CF_MAX_BLOCKS && (BLOCKS & (BLOCKS - 1)) == 0,
+               "BLOCKS must be a power of two up to CF_MAX_BLOCKS");
 
-#define BLOCK_UP 8 // for communication, message heading up
+#define BLOCK_FREE CF_FREE   // waiting to be processed
+#define BLOCK_TAKEN CF_TAKEN // someone is supposedly working on it
+#define BLOCK_DONE CF_DONE   // reported as completed
 
 /*
- *  Local computation variables
+ * Residue sieve: only odd n whose class mod 2^SIEVE_K survives are run.
+ * The bitmap takes 2^(SIEVE_K-4) bytes of heap, so 16..20 on the device.
  */
-static bigint_t waterlevel; /* n <= waterlevel are all (conditionally) cleared */
-static bigint_t n;          /* variable we work with, the sequence!            */
+#define SIEVE_K 16
 
 /*
- *  State of the computation and Message frame
+ * Sub-blocks: a block is cut into slices of RANGE_STEP odd numbers, slice s
+ * goes to worker s % WORKERS. Interleaved, the workers meet the same mix of
+ * trajectories and finish together. Worker 0 is the collatz-comp task.
+ * COLLATZ_WORKERS runs the blocks on fewer, to time what the other cores add.
+ */
+#define RANGE_STEP 0x1000          // odd numbers per slice, at most one LED toggle
+#define WORKERS portNUM_PROCESSORS // one per core
+#define SLICE (BLOCKSIZE / 2 < RANGE_STEP ? BLOCKSIZE / 2 : RANGE_STEP)
+#define SLICES (BLOCKSIZE / 2 / SLICE)
+
+/*
+ * Checkpoints: the frame and the DONE blocks go to NVS when they have
+ * changed, at most once per CHECKPOINT_PERIOD. A 180 byte blob every minute
+ * cycles the default NVS partition for decades.
+ */
+#define CHECKPOINT_PERIOD 60000000ll // us
+
+/*
+ * COLLATZ_BENCH runs in the serial task, a tick's yield every BENCH_CHUNK
+ * numbers keeps it off the task watchdog.
+ */
+#define BENCH_CHUNK 4096
+
+/*
+ *  Local computation variables, one set per worker
  */
 typedef struct
 {
-    char magic[4];       /* Unique identifier, "f3n1" (no terminator) */
-    int16_t report_type; /* BLOCK_TAKEN or BLOCK_DONE                 */
-    int16_t block_id;    /* the block we work(ed) on, or -1           */
-    bigint_t base;       /* blocks done -- offset, and ODD!           */
+    int id;               /* slices id, id + block_workers, ...              */
+    bigint_t waterlevel;  /* n <= waterlevel are all (conditionally) cleared */
+    uint32_t tested;      /* numbers run in this block                       */
+    uint32_t slices;      /* ... and slices                                  */
+    volatile uint32_t next; /* first slice of ours not done yet              */
+    int result;           /* 0, or -1 on overflow                            */
+    SemaphoreHandle_t go; /* block set up, start                             */
+} worker_t;
+
+static worker_t worker[WORKERS];
+static int workers_want = WORKERS;            /* COLLATZ_WORKERS, from the next block */
+static int block_workers = WORKERS;           /* running the current block            */
+static SemaphoreHandle_t workers_done = NULL; /* given once per worker 1.. and block */
+static bigint_t block_start;                  /* written by worker 0 before 'go'     */
+static const collatz_sieve_t *block_sieve;    /* NULL: run every number              */
+static uint32_t block_lo;                     /* slices [block_lo, block_end) of it  */
+static volatile uint32_t block_end;           /* lowered if stolen, or done elsewhere */
+
+/*
+ *  State of the computation
+ */
+typedef struct
+{
+    uint32_t frame;   /* blocks done above the start                */
+    int16_t block_id; /* the block we work(ed) on, or -1            */
+    bigint_t base;    /* start + frame * BLOCKSIZE, and ODD!        */
 } collatz_t;
 
-/* These variables are behind the semaphore */
-static SemaphoreHandle_t mutex = NULL;
-static collatz_t job;         // the current frame
-static collatz_t job2;        // for processing incoming reports
-static uint8_t block[BLOCKS]; //
-static int collatz_root;
+/* These variables are behind the semaphore */
+static SemaphoreHandle_t mutex = NULL;
+static collatz_t job;         // the current frame
+static uint32_t block_word[CF_WORDS(BLOCKS)];
+static cf_window_t block;     // BLOCKS states, 2 bits each
+static int collatz_root;
+static collatz_sieve_t sieve; // bits == NULL: run every number
+static collatz_stats_t stats; //
+static int checkpoint_dirty;  // frame shifted or blocks done since the last checkpoint
+
+typedef struct
+{
+    uint32_t blocksize;             /* layout it was written for */
+    uint32_t blocks;                /*                           */
+    uint32_t frame;                 /* job.frame                 */
+    bigint_t base;                  /* job.base, to check start  */
+    uint8_t done[(BLOCKS + 7) / 8]; /* bit i: block i DONE       */
+} checkpoint_t;
+
+static checkpoint_t checkpoint; // as last written, only the compute task (or restart) writes
+static checkpoint_t checkpoint_next; // being written, BLOCKS / 8 bytes are too many for the task stacks
+
+/*
+ *  Reports: the sender's frame and the news since its last report, as the
+ *  block states relative to that frame (FREE is no news). News is held for
+ *  REPORT_WINDOW and goes out in one message, a hop merges what it receives
+ *  into its own pending news, so a report carries the whole subtree's.
+ *  The states only grow, so a duplicate or late report is harmless.
+ */
+#define REPORT_UP 0
+#define REPORT_DOWN 1
+#define REPORT_WINDOW 250000ll // us news may wait for more, per hop
+#define REPORT_WORDS 28        // 448 blocks per message
+#define REPORT_HEAD 12         // bytes before the states
+
+typedef struct
+{
+    char magic[4];                /* "f3nB" (no terminator)                  */
+    uint8_t reserved;             /*                                         */
+    uint8_t words;                /* state words that follow                 */
+    uint16_t first;               /* block of state[0], a multiple of 16     */
+    uint32_t frame;               /* the sender's frame                      */
+    uint32_t state[REPORT_WORDS]; /* 2 bits per block, as in the window      */
+} report_t;
+
+static uint32_t pend_word[2][CF_WORDS(BLOCKS)];
+static cf_window_t pend[2];   // news to go up / down, aligned with our frame
+static int pend_blocks[2];    // ... of which states or the frame
+static int64_t pend_since[2]; // first news held, 0: nothing to send
+static report_t report;       // comm task only
+
+/*
+ *  Leases: a node computing a block, or slices [start, end) of it, claims
+ *  it until the lease runs out and renews the claim with its progress every
+ *  LEASE_RENEW. Slices a stale claim left over are taken over, and a node
+ *  with no FREE block left steals the upper half of the claim with the most
+ *  to go. The claims travel beside the reports and merge the same way:
+ *  progress only grows, the end only shrinks. A block is DONE once the
+ *  finished parts of its claims cover all SLICES.
+ *  A node claims no more than it runs in the time the fastest live claim
+ *  needs for a whole block (claim_span): a slow node takes part of a
+ *  block, the next node the slices left over, and the frame waits on a
+ *  slow node no longer than on a fast one.
+ */
+#define LEASE 12000000ll      // us
+#define LEASE_RENEW 4000000ll // us
+#define LEASE_UNIT 100000ll   // us per step of the ttl on the wire
+#define CLAIMS 64             // claims known, ours and the mesh's
+#define CLAIM_MSG 9           // claims per message
+#define PACE_UNIT 100         // us
+#define STEAL_MIN 4           // slices, the least a thief takes
+#define SPAN_MIN (SLICES >= 16 ? SLICES / 16 : 1) // slices, the least a slow node claims
+#define IDLE_WAIT 1000        // ms, nothing to pick: look again
+
+typedef struct
+{
+    int16_t block;   /* in our frame, -1: unused              */
+    uint8_t owner;   /* node-id                               */
+    uint8_t dirty;   /* news for 1 << REPORT_UP, REPORT_DOWN  */
+    uint16_t start;  /* slices [start, end) claimed           */
+    uint16_t end;    /*                                       */
+    uint16_t done;   /* ... and [start, done) finished        */
+    uint16_t pace;   /* owner's time per slice, PACE_UNIT     */
+    int64_t expires; /* local time                            */
+} claim_t;
+
+typedef struct
+{
+    uint16_t block; /* in the message's frame */
+    uint8_t owner;  /*                        */
+    uint8_t ttl;    /* lease left, LEASE_UNIT */
+    uint16_t start; /*                        */
+    uint16_t end;   /*                        */
+    uint16_t done;  /*                        */
+    uint16_t pace;  /*                        */
+} claim_rec_t;
+
+typedef struct
+{
+    char magic[4];                 /* "f3nL" (no terminator) */
+    uint8_t count;                 /* claims that follow     */
+    uint8_t reserved[3];           /*                        */
+    uint32_t frame;                /* the sender's frame     */
+    claim_rec_t claim[CLAIM_MSG];  /*                        */
+} claims_t;
+
+typedef struct
+{
+    int16_t block;  /* TAKEN, and slices [start, end) of it nobody works on */
+    uint16_t start; /*                                                      */
+    uint16_t end;   /*                                                      */
+} gap_t;
+
+static claim_t claim[CLAIMS];
+static int own = -1;          // our claim, while computing
+static gap_t gap[CLAIMS];     // what claim_takeover picks from
+static int gaps;              // ... how many
+static int gaps_stale = 1;    // ... claims or blocks changed since
+static int64_t gaps_until;    // ... a live lease runs out then
+static uint32_t gap_held[(BLOCKS + 31) / 32]; // blocks with a claim, gaps_update only
+static int64_t block_began;   // ... since
+static uint16_t pace;         // our time per slice, 0: not known yet
+static claims_t claims;       // comm task only
+
+/*
+ *  Snapshot of the frame, for a node that just joined
+ */
+#define SNAP_REQUEST 1
+#define SNAP_PART 2
+#define SNAP_BLOCKS 256 // blocks per part, 2 bits each
+#define SNAP_PARTS ((BLOCKS + SNAP_BLOCKS - 1) / SNAP_BLOCKS)
+#define SNAP_RETRY 2000000ll // us before asking again
+
+typedef struct
+{
+    char magic[4];                   /* "f3nS" (no terminator)        */
+    uint8_t kind;                    /* SNAP_REQUEST or SNAP_PART     */
+    uint8_t requester;               /* node-id of the joining node   */
+    uint16_t seq;                    /* its request number            */
+    uint16_t first;                  /* first block in this part      */
+    uint16_t count;                  /* blocks in this part           */
+    uint32_t frame;                  /* the parent's frame            */
+    uint8_t state[SNAP_BLOCKS / 4];  /* 2 bits per block from 'first' */
+} snapshot_t;
+
+static volatile int in_sync;                   // may pick blocks, set at the root from the start
+static int64_t snap_linked;                    // link-up, for the time to sync
+static snapshot_t snap;                        // comm task only
+static uint16_t snap_seq;                      //
+static uint32_t snap_parts[(SNAP_PARTS + 31) / 32]; // parts of the current answer received
+static uint32_t snap_count;                    // ... how many
+static uint32_t snap_frame;                    // ... and their frame
+static uint32_t snap_word[CF_WORDS(BLOCKS)];   //
+static cf_window_t snap_window;                //
+
+/*
+ *  HW random numbers
+ */
+
+#define DR_REG_RNG_BASE 0x3ff75144
+
+uint32_t hw_random32(void)
+{
+    return (uint32_t)READ_PERI_REG(DR_REG_RNG_BASE);
+}
+
+/*
+ *  Claims, see LEASE
+ *  - Semaphore MUST be acquired before calling these functions
+ */
+#define CLAIM_NOBODY 0xff // TAKEN, but no claim heard of yet: held for a LEASE
+
+static int claim_find(int bi, uint8_t owner, uint16_t start)
+{
+    for (int i = 0; i < CLAIMS; i++)
+        if (claim[i].block == bi && claim[i].owner == owner && claim[i].start == start)
+            return i;
+    return -1;
+}
+
+static int claim_alloc(void)
+{
+    int spare = -1;
+    for (int i = 0; i < CLAIMS; i++)
+    {
+        if (claim[i].block < 0)
+            return i;
+        if (claim[i].owner == CLAIM_NOBODY && spare < 0)
+            spare = i; /* a guess, the first to go */
+    }
+    if (spare < 0)
+        ESP_LOGW(COMP, "Claim table full, a claim is not tracked");
+    return spare;
+}
+
+static int claim_any(int bi)
+{
+    for (int i = 0; i < CLAIMS; i++)
+        if (claim[i].block == bi)
+            return 1;
+    return 0;
+}
+
+static void claim_free_block(int bi)
+{
+    for (int i = 0; i < CLAIMS; i++)
+        if (claim[i].block == bi)
+            claim[i].block = -1;
+    if (own >= 0 && claim[own].block < 0)
+        own = -1;
+    gaps_stale = 1;
+}
+
+static void claims_shift(int done)
+{
+    for (int i = 0; i < CLAIMS; i++)
+        if (claim[i].block >= 0)
+            claim[i].block = claim[i].block >= done ? claim[i].block - done : -1;
+    if (own >= 0 && claim[own].block < 0)
+        own = -1;
+    gaps_stale = 1;
+}
+
+/*
+ *  First slice of block bi not covered by a finished part (or, if 'active',
+ *  by a live claim either), and in *next where the covered run after it starts
+ */
+static uint32_t claim_gap(int bi, int64_t now, int active, uint32_t *next)
+{
+    uint32_t pos = 0;
+    int moved;
+
+    do
+    {
+        moved = 0;
+        for (int i = 0; i < CLAIMS; i++)
+        {
+            claim_t *c = &claim[i];
+            uint32_t hi = (active && c->expires > now && c->end > c->done) ? c->end : c->done;
+            if (c->block == bi && c->start <= pos && pos < hi)
+            {
+                pos = hi;
+                moved = 1;
+            }
+        }
+    } while (moved && pos < SLICES);
+
+    *next = SLICES;
+    for (int i = 0; i < CLAIMS; i++)
+        if (claim[i].block == bi && claim[i].start > pos && claim[i].start < *next)
+            *next = claim[i].start;
+    return pos;
+}
+
+/*
+ *  News of claim i for the next reports: down, and up unless it came from there
+ */
+static void claim_note(int i, int from_up)
+{
+    int64_t now = esp_timer_get_time();
+
+    claim[i].dirty |= 1 << REPORT_DOWN;
+    if (!from_up && !collatz_root)
+        claim[i].dirty |= 1 << REPORT_UP;
+    for (int dir = REPORT_UP; dir <= REPORT_DOWN; dir++)
+        if ((claim[i].dirty & (1 << dir)) && !pend_since[dir])
+            pend_since[dir] = now;
+}
+
+/*
+ *  Claim i takes over from any claim it starts in: the older one ends
+ *  where it starts, what it had beyond claim i is left over for the next
+ *  pick. Of two from the same slice the lower node-id keeps it.
+ */
+static void claim_truncate(int i)
+{
+    const claim_t *c = &claim[i];
+
+    for (int j = 0; j < CLAIMS; j++)
+    {
+        claim_t *e = &claim[j];
+        if (j == i || e->block != c->block || c->start < e->start || c->start >= e->end)
+            continue;
+        if (c->start == e->start && c->owner > e->owner)
+            continue;
+        e->end = c->start > e->done ? c->start : e->done;
+        if (j == own)
+        {
+            ESP_LOGI(COMP, "Slices %u.. of block %d went to node %u", e->end, e->block, c->owner);
+            block_end = e->end > block_lo ? e->end : block_lo;
+        }
+    }
+}
+
+/*
+ *  The TAKEN blocks with slices nobody works on (anymore), found again
+ *  only once the claims or the blocks changed, or a live lease ran out:
+ *  the first CLAIMS of them, the earlier blocks weigh the most anyway
+ */
+static void gaps_update(int64_t now)
+{
+    if (!gaps_stale && now < gaps_until)
+        return;
+    gaps_stale = 0;
+    gaps_until = INT64_MAX;
+    memset(gap_held, 0, sizeof(gap_held));
+    for (int i = 0; i < CLAIMS; i++)
+    {
+        const claim_t *c = &claim[i];
+        if (c->block < 0)
+            continue;
+        gap_held[c->block >> 5] |= 1ul << (c->block & 31);
+        if (c->expires > now && c->end > c->done && c->expires < gaps_until)
+            gaps_until = c->expires; /* what it has left opens up then */
+    }
+
+    gaps = 0;
+    for (int bi = 0; bi < BLOCKS && gaps < CLAIMS; bi++)
+    {
+        if (cf_get(&block, bi) != BLOCK_TAKEN)
+            continue;
+        uint32_t lo = 0, next = SLICES; /* no claim left: all of it */
+        if (gap_held[bi >> 5] & (1ul << (bi & 31)))
+            lo = claim_gap(bi, now, 1, &next);
+        if (lo < SLICES)
+            gap[gaps++] = (gap_t){bi, lo, next};
+    }
+}
+
+/*
+ *  Slices of a TAKEN block nobody works on (anymore): weighted like cf_pick,
+ *  so that nodes that look at the same time mostly take different ones
+ */
+static int claim_takeover(int64_t now, uint16_t *start, uint16_t *end)
+{
+    uint32_t total = 0, r;
+
+    gaps_update(now);
+    for (int g = 0; g < gaps; g++)
+        total += 2 * (BLOCKS - gap[g].block) - 1;
+    if (!total)
+        return -1;
+
+    r = hw_random32() % total;
+    for (int g = 0; g < gaps; g++)
+    {
+        uint32_t weight = 2 * (BLOCKS - gap[g].block) - 1;
+        if (r >= weight)
+        {
+            r -= weight;
+            continue;
+        }
+        int bi = gap[g].block;
+        *start = gap[g].start;
+        *end = gap[g].end;
+        for (int i = 0; i < CLAIMS; i++) /* not just what a part left over */
+        {
+            if (claim[i].block == bi && claim[i].start <= *start && *start < claim[i].end)
+            {
+                stats.takeovers++;
+                break;
+            }
+        }
+        return bi;
+    }
+    return -1;
+}
+
+/*
+ *  Where the owner of claim c should be by now, at its pace
+ */
+static uint32_t claim_estimate(const claim_t *c, int64_t now)
+{
+    int64_t since = now - (c->expires - LEASE); /* its last renewal */
+    uint32_t at = c->done;
+
+    if (c->pace && since > 0)
+        at += since / ((int64_t)c->pace * PACE_UNIT);
+    return at < c->end ? at : c->end;
+}
+
+/*
+ *  The tail of what a live claim has left, split so that its owner and we
+ *  finish together (half, if either pace is not known). The claims are
+ *  weighted by the time they have left: the slow go first, and thieves
+ *  that look at the same time mostly go for different ones.
+ */
+static int claim_steal(int64_t now, uint16_t *start, uint16_t *end)
+{
+    uint32_t total = 0, r = 0;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < CLAIMS; i++)
+        {
+            claim_t *c = &claim[i];
+            if (c->block < 0 || c->owner == CLAIM_NOBODY || c->owner == net_node_id() || c->expires <= now)
+                continue;
+            uint32_t at = claim_estimate(c, now);
+            if (c->end < at + 2 * STEAL_MIN)
+                continue;
+            uint32_t left = c->end - at;
+            uint32_t weight = left * (c->pace ? c->pace : 1);
+            if (!pass)
+            {
+                total += weight;
+                continue;
+            }
+            if (r >= weight)
+            {
+                r -= weight;
+                continue;
+            }
+            /* (mid - at) * their pace == (end - mid) * ours */
+            uint32_t mid = (c->pace && pace) ? (at * c->pace + c->end * pace) / (c->pace + pace) : at + left / 2;
+            if (mid < at + STEAL_MIN)
+                mid = at + STEAL_MIN; /* leave the owner a little */
+            if (mid > c->end - STEAL_MIN)
+                mid = c->end - STEAL_MIN;
+            *start = mid;
+            *end = c->end;
+            stats.steals++;
+            return c->block;
+        }
+        if (!total)
+            return -1;
+        r = hw_random32() % total;
+    }
+    return -1;
+}
+
+/*
+ *  Slices we claim at once: what we run in the time the fastest live
+ *  claim (or we) needs for all SLICES, a whole block while no pace is known
+ */
+static uint32_t claim_span(int64_t now)
+{
+    uint32_t fast = pace;
+
+    for (int i = 0; i < CLAIMS; i++)
+    {
+        const claim_t *c = &claim[i];
+        if (c->block >= 0 && c->pace && c->expires > now && (!fast || c->pace < fast))
+            fast = c->pace;
+    }
+    if (!pace || !fast)
+        return SLICES;
+    uint32_t span = SLICES * fast / pace;
+    return span < SPAN_MIN ? SPAN_MIN : span > SLICES ? SLICES : span;
+}
+
+/*
+ *  How far the workers are with our claim
+ */
+static uint32_t claim_progress(void)
+{
+    uint32_t done = block_end;
+    for (int i = 0; i < block_workers; i++)
+        if (worker[i].next < done)
+            done = worker[i].next;
+    return done > block_lo ? done : block_lo;
+}
+
+/*
+ *  Our time per slice, from 'slices' done since block_began: averaged, and
+ *  not from a few slices (claim_span sizes every node's claims by the fastest)
+ */
+static void pace_measure(uint32_t slices)
+{
+    if (slices < STEAL_MIN * 2)
+        return;
+    int64_t p = (esp_timer_get_time() - block_began) / slices / PACE_UNIT;
+    if (pace)
+        p = (3 * (int64_t)pace + p) / 4;
+    pace = p < 1 ? 1 : p > 0xffff ? 0xffff : p;
+}
+
+/*
+ *  Our claim with the workers' progress, every LEASE_RENEW while computing
+ */
+static void claim_renew(void)
+{
+    static int64_t renewed;
+    int64_t now = esp_timer_get_time();
+
+    if (own < 0 || now - renewed < LEASE_RENEW)
+        return;
+    renewed = now;
+    claim[own].done = claim_progress();
+    pace_measure(claim[own].done - block_lo);
+    claim[own].pace = pace;
+    claim[own].expires = now + LEASE;
+    claim_note(own, 0);
+}
+
+/*
+ *  This function selects the next block in random
+ *  - priority is on slices a stale claim or a part left, then on the free blocks
+ *  - non-uniform selection prefers earlier blocks (integer frame moves earlier)
+ *  - of either, no more than claim_span slices
+ *  - with no free block left, half of the busiest claim
+ *  - returns -1 if there is nothing to do, else the block and its slices
+ *  - Acquires the semaphore itself
+ */
+int pick_block(uint16_t *start, uint16_t *end)
+{
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(mutex, portMAX_DELAY); // we deal with the block window, so lock needed
+    int i = claim_takeover(now, start, end);
+    if (i < 0 && (i = cf_pick(&block, hw_random32)) >= 0)
+    {
+        *start = 0;
+        *end = SLICES;
+    }
+    uint32_t span = claim_span(now);
+    if (i >= 0 && *end - *start > span)
+    {
+        *end = *start + span;
+        stats.parts++;
+    }
+    if (i < 0)
+        i = claim_steal(now, start, end);
+    xSemaphoreGive(mutex);
+    return i;
+}
+
+/*
+ *  Semaphore MUST be acquired before calling this function
+ */
+void shift_blocks(int done)
+{
+    static int64_t moved;
+    int64_t now = esp_timer_get_time();
+
+    if (moved)
+        stats.frame_us = now - moved;
+    moved = now;
+    cf_shift(&block, done);
+    cf_shift(&pend[REPORT_UP], done); /* news below the frame is in the frame */
+    cf_shift(&pend[REPORT_DOWN], done);
+    claims_shift(done);
+    checkpoint_dirty = 1;
+    if (job.block_id >= done)
+        job.block_id -= done; /* still on board! */
+    else
+        job.block_id = -1;
+}
+
+void log_report_blocks(void)
+{
+    char buf[64 + 1];
+    uint32_t count[3];
+    int i;
+
+    for (i = 0; i < BLOCKS && i < 64; i++)
+    {
+        switch (cf_get(&block, i))
+        {
+        default:
+        case BLOCK_FREE:
+            buf[i] = '_';
+            break;
+        case BLOCK_TAKEN:
+            buf[i] = '+';
+            break;
+        case BLOCK_DONE:
+            buf[i] = 'X';
+            break;
+        }
+    }
+    buf[i] = '\0'; // not to be forgotten
+    cf_count(&block, count);
+    ESP_LOGI(COMP, "  blocks: [%s%s] %u free %u taken %u done", buf, BLOCKS > 64 ? "..." : "",
+             count[BLOCK_FREE], count[BLOCK_TAKEN], count[BLOCK_DONE]);
+}
+
+/*
+ *  The frame as a base: start + frame * BLOCKSIZE
+ *  - Semaphore MUST be acquired before calling this function (or no tasks yet)
+ */
+static void set_frame(uint32_t frame)
+{
+    job.frame = frame;
+#if defined(START_FROM_ONE)
+    job.base.len = 1;
+    job.base.a[0] = 0x1;
+#else /* 2^68 */
+    job.base.len = 3;
+    job.base.a[0] = MASK;         // 30
+    job.base.a[1] = MASK;         // 60
+    job.base.a[2] = (1 << 8) - 1; // 68
+#endif
+    rl_add_shl(&job.base, frame, BLOCKSHIFT);
+}
+
+/*
+ *  Hold news for the next report in direction 'dir', max of the states
+ *  - block -1 is no block, only the frame moved
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void report_note(int dir, int bi, int state)
+{
+    if (dir == REPORT_UP && collatz_root)
+        return;
+    if (bi >= 0 && bi < BLOCKS && state > cf_get(&pend[dir], bi))
+        cf_set(&pend[dir], bi, state);
+    pend_blocks[dir] = 1;
+    if (!pend_since[dir])
+        pend_since[dir] = esp_timer_get_time();
+}
+
+/*
+ *  News for everyone who may not have it: the parent did not send it to us
+ *  unless 'from_up', the children got none of it
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void report_news(int bi, int state, int from_up)
+{
+    if (!from_up)
+        report_note(REPORT_UP, bi, state);
+    report_note(REPORT_DOWN, bi, state);
+}
+
+/*
+ *  Send the states and the frame held for 'dir'
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static int report_send(int dir)
+{
+    int lo = BLOCKS, hi = -1;
+    app_header_t hdr;
+
+    if (!pend_blocks[dir])
+        return 0;
+
+    for (int i = 0; i < BLOCKS; i++)
+        if (cf_get(&pend[dir], i) != BLOCK_FREE)
+        {
+            lo = lo < i ? lo : i;
+            hi = i;
+        }
+
+    memcpy(report.magic, "f3nB", 4);
+    report.reserved = 0;
+    report.frame = job.frame;
+    hdr.type = APP_COLLATZ_ID;
+    lo &= ~15;
+    do /* once with no news: the frame alone */
+    {
+        int n = hi < lo ? 0 : (hi - lo) / 16 + 1;
+        report.words = n < REPORT_WORDS ? n : REPORT_WORDS;
+        report.first = hi < lo ? 0 : lo;
+        memset(report.state, 0, sizeof(report.state));
+        for (int i = 0; i < report.words * 16 && lo + i < BLOCKS; i++)
+            report.state[i >> 4] |= cf_get(&pend[dir], lo + i) << ((i & 15) << 1);
+        hdr.len = REPORT_HEAD + 4 * report.words;
+        /* called with the mutex held, so never wait here: keep it all for the next try */
+        if ((dir == REPORT_UP ? net_send_up(&hdr, (const uint8_t *)&report)
+                              : net_send_down(&hdr, (const uint8_t *)&report)) == NET_WOULD_BLOCK)
+        {
+            ESP_LOGW(COMP, "Report delayed, network congested");
+            return -1;
+        }
+        stats.reports++;
+        lo += report.words * 16;
+    } while (lo <= hi);
+
+    cf_init(&pend[dir], pend_word[dir], BLOCKS);
+    pend_blocks[dir] = 0;
+    return 0;
+}
+
+/*
+ *  Send the claims with news for 'dir', CLAIM_MSG per message
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static int claims_send(int dir)
+{
+    int64_t now = esp_timer_get_time();
+    app_header_t hdr;
+
+    memcpy(claims.magic, "f3nL", 4);
+    memset(claims.reserved, 0, sizeof(claims.reserved));
+    claims.frame = job.frame;
+    claims.count = 0;
+    hdr.type = APP_COLLATZ_ID;
+    for (int i = 0; i <= CLAIMS; i++)
+    {
+        if (i < CLAIMS && claim[i].block >= 0 && (claim[i].dirty & (1 << dir)))
+        {
+            claim_rec_t *r = &claims.claim[claims.count++];
+            int64_t ttl = (claim[i].expires - now) / LEASE_UNIT;
+            r->block = claim[i].block;
+            r->owner = claim[i].owner;
+            r->ttl = ttl < 0 ? 0 : ttl > 255 ? 255 : ttl;
+            r->start = claim[i].start;
+            r->end = claim[i].end;
+            r->done = claim[i].done;
+            r->pace = claim[i].pace;
+        }
+        if (claims.count == CLAIM_MSG || (i == CLAIMS && claims.count))
+        {
+            hdr.len = REPORT_HEAD + sizeof(claim_rec_t) * claims.count;
+            /* called with the mutex held, so never wait here: keep it all for the next try */
+            if ((dir == REPORT_UP ? net_send_up(&hdr, (const uint8_t *)&claims)
+                                  : net_send_down(&hdr, (const uint8_t *)&claims)) == NET_WOULD_BLOCK)
+                return -1;
+            stats.reports++;
+            claims.count = 0;
+        }
+    }
+    for (int i = 0; i < CLAIMS; i++)
+        claim[i].dirty &= ~(1 << dir);
+    return 0;
+}
+
+/*
+ *  Send what is held for 'dir', once it is REPORT_WINDOW old
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void report_flush(int dir)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (!pend_since[dir] || now - pend_since[dir] < REPORT_WINDOW)
+        return;
+    if (report_send(dir) == 0 && claims_send(dir) == 0)
+        pend_since[dir] = 0;
+}
+
+/*
+ *  Inform others about my progress, if any:
+ *  - (non-zero) fin indicates we completed job.block_id
+ *  - Semaphore MUST be acquired before calling this function
+ */
+void report_my_progress(int fin)
+{
+    int done;
+
+    if (fin)
+        report_news(job.block_id, BLOCK_DONE, 0); /* what's done is done! */
+
+    done = cf_done_prefix(&block);
+    if (done)
+    {
+        shift_blocks(done); /* a block noted above goes out as part of the frame */
+        set_frame(job.frame + done);
+        ESP_LOGI(COMP, "Shifted %d blocks, the current frame is 0x%s, and block %d (fin %d)",
+                 done, rl_str(&job.base), job.block_id, fin);
+        log_report_blocks();
+    }
+}
+
+/*
+ *  Inform others about my job => BLOCK_TAKEN
+ *  - Semaphore MUST be acquired before calling this function
+ */
+void report_my_start(void)
+{
+    ESP_LOGI(COMP, "Computing block %d from frame 0x%s", job.block_id, rl_str(&job.base));
+    report_news(job.block_id, BLOCK_TAKEN, 0);
+}
+
+/**********************************************************/
+/*
+ *  Checkpoints in NVS
+ */
+static void checkpoint_take(checkpoint_t *cp)
+{
+    memset(cp, 0, sizeof(checkpoint_t));
+    cp->blocksize = BLOCKSIZE;
+    cp->blocks = BLOCKS;
+    cp->frame = job.frame;
+    rl_set(&cp->base, &job.base);
+    for (int i = 0; i < BLOCKS; i++)
+        if (cf_get(&block, i) == BLOCK_DONE)
+            cp->done[i >> 3] |= 1 << (i & 7);
+}
+
+/*
+ *  Writes the checkpoint if it changed; force skips the rate limit
+ *  - Acquires the semaphore itself, and holds it over the write: the
+ *    compute task and restart share checkpoint_next, and a flash write
+ *    stalls both cores anyway
+ */
+void checkpoint_save(int force)
+{
+    static int64_t saved_at;
+    int64_t now = esp_timer_get_time();
+
+    if (!force && (!checkpoint_dirty || now - saved_at < CHECKPOINT_PERIOD))
+        return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    checkpoint_take(&checkpoint_next);
+    checkpoint_dirty = 0;
+    saved_at = now;
+    if (memcmp(&checkpoint_next, &checkpoint, sizeof(checkpoint_t)) == 0)
+    {
+        xSemaphoreGive(mutex);
+        return; /* spare the flash */
+    }
+
+    nvs_handle_t handle;
+    if (nvs_open("collatz", NVS_READWRITE, &handle) != ESP_OK)
+    {
+        ESP_LOGE(COMP, "Failed to open NVS, checkpoint not saved");
+        xSemaphoreGive(mutex);
+        return;
+    }
+    if (nvs_set_blob(handle, "frame", &checkpoint_next, sizeof(checkpoint_t)) != ESP_OK ||
+        nvs_commit(handle) != ESP_OK)
+        ESP_LOGE(COMP, "Failed to save the checkpoint");
+    else
+        memcpy(&checkpoint, &checkpoint_next, sizeof(checkpoint_t));
+    nvs_close(handle);
+    xSemaphoreGive(mutex);
+}
+
+/*
+ *  Resume from the checkpoint, if there is one for this frame layout
+ *  - Called before the tasks exist
+ */
+static void checkpoint_load(void)
+{
+    nvs_handle_t handle;
+    size_t size = sizeof(checkpoint_t);
+
+    if (nvs_open("collatz", NVS_READONLY, &handle) != ESP_OK)
+        return;
+    if (nvs_get_blob(handle, "frame", &checkpoint, &size) != ESP_OK || size != sizeof(checkpoint_t) ||
+        checkpoint.blocksize != BLOCKSIZE || checkpoint.blocks != BLOCKS)
+    {
+        memset(&checkpoint, 0, sizeof(checkpoint_t));
+        nvs_close(handle);
+        return;
+    }
+    nvs_close(handle);
+
+    set_frame(checkpoint.frame);
+    if (rl_equal(&job.base, &checkpoint.base)) /* non-zero: written for another start */
+    {
+        set_frame(0);
+        memset(&checkpoint, 0, sizeof(checkpoint_t));
+        return;
+    }
+    for (int i = 0; i < BLOCKS; i++)
+        if (checkpoint.done[i >> 3] & (1 << (i & 7)))
+            cf_set(&block, i, BLOCK_DONE);
+    stats.resumed = 1;
+    ESP_LOGI(COMP, "Resumed from the checkpoint, frame 0x%s", rl_str(&job.base));
+}
+
+/*
+ *  Move our integer frame up to 'frame' (> job.frame), keeping what overlaps
+ *  - Semaphore MUST be acquired before calling this function
+ */
+void raise_frame(uint32_t frame)
+{
+    uint32_t d = frame - job.frame;
+
+    /* something to preserve?! : shift if so */
+    shift_blocks(d < BLOCKS ? d : BLOCKS);
+    set_frame(frame);
+    ESP_LOGI(COMP, " - raised the integer frame by %u blocks, frame is 0x%s, and block %d",
+             d, rl_str(&job.base), job.block_id);
+    log_report_blocks();
+}
+
+/*
+ *  Merge a block state from elsewhere into ours, non-zero if it was news
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static int merge_block(int bi, int state)
+{
+    if (state == BLOCK_DONE && bi == job.block_id)
+    {
+        ESP_LOGI(COMP, " - our current computation is obsolete!");
+        job.block_id = -1;
+        block_end = block_lo; /* the workers stop after their slice */
+    }
+    if (state <= cf_get(&block, bi))
+        return 0;
+    cf_set(&block, bi, state);
+    gaps_stale = 1;
+    checkpoint_dirty |= (state == BLOCK_DONE);
+    if (state == BLOCK_DONE)
+    {
+        claim_free_block(bi);
+    }
+    else if (!claim_any(bi))
+    {
+        /* a claim we have not heard of yet: give it a LEASE */
+        int i = claim_alloc();
+        if (i >= 0)
+            claim[i] = (claim_t){bi, CLAIM_NOBODY, 0, 0, SLICES, 0, 0, esp_timer_get_time() + LEASE};
+    }
+    return 1;
+}
+
+/*
+ *  Merge a claim into ours, non-zero if it was news
+ *  - A block its finished parts now cover is DONE
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static int claim_set(const claim_t *c, int from_up)
+{
+    int i = claim_find(c->block, c->owner, c->start);
+    uint32_t next;
+
+    if (i < 0)
+    {
+        int p = claim_find(c->block, CLAIM_NOBODY, 0);
+        if (p >= 0 && c->owner != CLAIM_NOBODY)
+            claim[p].block = -1; /* the claim it held the block for */
+        if ((i = claim_alloc()) < 0)
+            return 0;
+        claim[i] = *c;
+        claim[i].dirty = 0;
+    }
+    else if (c->done > claim[i].done || c->end < claim[i].end || c->expires > claim[i].expires + LEASE_UNIT)
+    {
+        claim[i].done = c->done > claim[i].done ? c->done : claim[i].done;
+        if (c->end < claim[i].end)
+        {
+            claim[i].end = c->end > claim[i].done ? c->end : claim[i].done;
+            if (i == own)
+            {
+                ESP_LOGI(COMP, "Slices %u.. of block %d went elsewhere", claim[i].end, c->block);
+                block_end = claim[i].end > block_lo ? claim[i].end : block_lo;
+            }
+        }
+        if (c->expires > claim[i].expires)
+        {
+            claim[i].expires = c->expires;
+            claim[i].pace = c->pace;
+        }
+    }
+    else
+    {
+        return 0;
+    }
+    claim_note(i, from_up);
+    claim_truncate(i);
+    gaps_stale = 1;
+    int bi = c->block;
+    if (claim_gap(bi, 0, 0, &next) >= SLICES)
+    {
+        ESP_LOGI(COMP, "Block %d complete in parts", bi);
+        merge_block(bi, BLOCK_DONE);
+        report_news(bi, BLOCK_DONE, 0);
+    }
+    return 1;
+}
+
+/**********************************************************/
+/*
+ * Process a report received from elsewhere
+ *  - What is news to us goes on to the children, and up unless it came
+ *    from there. What is not, we had and sent on before.
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void report_process(const app_header_t *hdr, const report_t *rpt)
+{
+    int from_up = hdr->reserved[0];
+
+    /* one per merge window and link: debug only */
+    ESP_LOGD(COMP, "Report from the %s for %d blocks %u.., frame %u (ours %u)",
+             from_up ? "parent" : "child", rpt->words * 16, rpt->first, rpt->frame, job.frame);
+
+    /*** First adjust the high water marks to same offset ***/
+    if ((int32_t)(rpt->frame - job.frame) > 0)
+    {
+        raise_frame(rpt->frame);
+        report_news(-1, BLOCK_FREE, from_up);
+    }
+    else if (rpt->frame != job.frame) /* the sender lags us: back to it */
+    {
+        report_note(from_up ? REPORT_UP : REPORT_DOWN, -1, BLOCK_FREE);
+    }
+
+    /* now rpt block j is our block j - offset */
+    uint32_t offset = job.frame - rpt->frame;
+    for (int i = 0; i < rpt->words * 16; i++)
+    {
+        int st = (rpt->state[i >> 4] >> ((i & 15) << 1)) & 3;
+        uint32_t bi = rpt->first + i - offset;
+        if (st == BLOCK_FREE || rpt->first + i < offset || bi >= BLOCKS)
+            continue;
+        if (merge_block(bi, st))
+            report_news(bi, st, from_up);
+    }
+
+    /*
+     * final step: report our follow-up progress!
+     */
+    report_my_progress(0);
+}
 
 /*
- *  HW random numbers
+ *  Claims received from elsewhere, passed on like the reports
+ *  - Semaphore MUST be acquired before calling this function
  */
+static void claims_process(const app_header_t *hdr, const claims_t *msg)
+{
+    int from_up = hdr->reserved[0];
+    int64_t now = esp_timer_get_time();
 
-#define DR_REG_RNG_BASE 0x3ff75144
+    if ((int32_t)(msg->frame - job.frame) > 0)
+    {
+        raise_frame(msg->frame);
+        report_news(-1, BLOCK_FREE, from_up);
+    }
 
-uint32_t hw_random32(void)
-{
-    return (uint32_t)READ_PERI_REG(DR_REG_RNG_BASE);
+    uint32_t offset = job.frame - msg->frame;
+    for (int i = 0; i < msg->count; i++)
+    {
+        const claim_rec_t *r = &msg->claim[i];
+        uint32_t bi = r->block - offset;
+        if (r->block < offset || bi >= BLOCKS || r->start > r->end || r->end > SLICES ||
+            r->owner == CLAIM_NOBODY || cf_get(&block, bi) == BLOCK_DONE)
+            continue;
+        claim_t c = {bi, r->owner, 0, r->start, r->end, r->done, r->pace, now + r->ttl * LEASE_UNIT};
+        if (r->owner == net_node_id() && claim_find(bi, r->owner, r->start) < 0)
+            c.expires = now; /* ours from before a restart: let it go */
+        merge_block(bi, BLOCK_TAKEN);
+        claim_set(&c, from_up);
+    }
 }
 
+/**********************************************************/
 /*
- *  This function selects the next block in random
- *  - priority is on the free blocks
- *  - non-uniform selection prefers earlier blocks (integer frame moves earlier)
- *  - Acquires the semaphore itself
+ *  Snapshots: on link-up a node asks its parent for the frame and the
+ *  state of every block, and picks no block until the answer is in. The
+ *  parent answers only once it is in sync itself (the root always is).
+ *  The answer goes down to all the parent's children, in SNAP_PARTS parts
+ *  that carry the frame each, the others ignore it.
  */
-int pick_block(void)
+static void snapshot_request(void)
 {
-    uint32_t mass = 0;
+    memset(&snap, 0, sizeof(snapshot_t));
+    memcpy(snap.magic, "f3nS", 4);
+    snap.kind = SNAP_REQUEST;
+    snap.requester = net_node_id();
+    snap.seq = ++snap_seq;
+    memset(snap_parts, 0, sizeof(snap_parts));
+    snap_count = 0;
+
+    app_header_t hdr;
+    hdr.type = APP_COLLATZ_ID;
+    hdr.len = sizeof(snapshot_t);
+    net_send_up(&hdr, (const uint8_t *)&snap);
+    stats.sync_requests++;
+}
 
-    xSemaphoreTake(mutex, portMAX_DELAY); // we deal with block[], so lock needed
+/*
+ *  Parent side: our frame, as it is now, down to the children
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void snapshot_answer(const snapshot_t *req)
+{
+    uint8_t requester = req->requester;
+    uint16_t seq = req->seq;
+    app_header_t hdr;
 
-    for (uint32_t i = 0; i < BLOCKS; i++) // no overflow if BLOCKS <= 92681
-        if (block[i] == BLOCK_FREE)
-            mass += BLOCKS - i;
-    if (mass)
+    hdr.type = APP_COLLATZ_ID;
+    hdr.len = sizeof(snapshot_t);
+    for (int first = 0; first < BLOCKS; first += SNAP_BLOCKS)
     {
-        uint32_t rnd = hw_random32() % mass; // ok, assuming that prng is good and mass << 2^32
-        for (int i = 0; i < BLOCKS; i++)
-        {
-            if (block[i] != BLOCK_FREE)
-                continue;
-            uint32_t p = BLOCKS - i;
-            if (rnd < p)
-            {
-                xSemaphoreGive(mutex);
-                return i;
-            }
-            rnd -= p;
-        }
-        /* never reached */
+        memset(&snap, 0, sizeof(snapshot_t));
+        memcpy(snap.magic, "f3nS", 4);
+        snap.kind = SNAP_PART;
+        snap.requester = requester;
+        snap.seq = seq;
+        snap.first = first;
+        snap.count = BLOCKS - first < SNAP_BLOCKS ? BLOCKS - first : SNAP_BLOCKS;
+        snap.frame = job.frame;
+        for (int i = 0; i < snap.count; i++)
+            snap.state[i >> 2] |= cf_get(&block, first + i) << ((i & 3) << 1);
+        /* called with the mutex held, so never wait here: a lost part is asked again */
+        net_send_down(&hdr, (const uint8_t *)&snap);
     }
-    /*
-     *  Everything is TAKEN, so someone probably left ...
-     *  Choose the first block so that we can move on!
-     */
-    xSemaphoreGive(mutex);
-    return 0;
 }
 
 /*
- *  Semaphore MUST be acquired before calling this function
+ *  Joining side: merge the parent's frame into ours, max of the states
+ *  - Semaphore MUST be acquired before calling this function
  */
-void shift_blocks(int done)
+static void snapshot_apply(void)
 {
-    if (done < BLOCKS)
-    {
-        int left = BLOCKS - done;
-        int i, j = done;
+    if ((int32_t)(snap_frame - job.frame) > 0)
+        raise_frame(snap_frame);
+
+    /* blocks the snapshot starts below our frame */
+    uint32_t offset = job.frame - snap_frame;
+    for (uint32_t i = 0; i + offset < BLOCKS; i++)
+        merge_block(i, cf_get(&snap_window, i + offset));
+    report_my_progress(0);
+    /* the parent may lag the mesh, or we may be ahead of it: tell all */
+    report_news(-1, BLOCK_FREE, 0);
+}
 
-        for (i = 0; i < left; i++)
-            block[i] = block[j++];
-        for (; i < BLOCKS; i++)
-            block[i] = BLOCK_FREE;
+/*
+ *  A snapshot frame arrived
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void snapshot_process(const app_header_t *hdr, const snapshot_t *msg)
+{
+    if (msg->kind == SNAP_REQUEST)
+    {
+        if (!hdr->reserved[0] && in_sync) /* from a child */
+            snapshot_answer(msg);
+        return;
+    }
+    if (in_sync || msg->kind != SNAP_PART || !hdr->reserved[0] ||
+        msg->requester != net_node_id() || msg->seq != snap_seq ||
+        msg->first >= BLOCKS || msg->count > SNAP_BLOCKS || msg->first + msg->count > BLOCKS)
+        return;
 
-        if (job.block_id >= done)
-            job.block_id -= done; /* still on board! */
-        else
-            job.block_id = -1;
+    if (!snap_count || msg->frame != snap_frame)
+    {
+        /* first part, or the parent's frame moved: collect again */
+        snap_frame = msg->frame;
+        cf_init(&snap_window, snap_word, BLOCKS);
+        memset(snap_parts, 0, sizeof(snap_parts));
+        snap_count = 0;
     }
-    else /* all done ... */
+    for (int i = 0; i < msg->count; i++)
+        cf_set(&snap_window, msg->first + i, (msg->state[i >> 2] >> ((i & 3) << 1)) & 3);
+    uint32_t part = msg->first / SNAP_BLOCKS;
+    if (!(snap_parts[part >> 5] & (1ul << (part & 31))))
     {
-        for (int i = 0; i < BLOCKS; i++)
-            block[i] = BLOCK_FREE;
-        job.block_id = -1;
+        snap_parts[part >> 5] |= 1ul << (part & 31);
+        snap_count++;
+    }
+
+    if (snap_count == SNAP_PARTS)
+    {
+        snapshot_apply();
+        in_sync = 1;
+        stats.joins++;
+        stats.sync_us = esp_timer_get_time() - snap_linked;
+        ESP_LOGI(COMP, "In sync with the parent after %lld ms, frame 0x%s",
+                 stats.sync_us / 1000, rl_str(&job.base));
     }
 }
 
-void log_report_blocks(void)
+/*
+ *  Link-up starts a snapshot, which is asked again until it is complete
+ */
+static void snapshot_poll(void)
 {
-    char buf[BLOCKS + 1];
-    for (int i = 0; i < BLOCKS; i++)
+    static int was_up;
+    static int64_t asked;
+
+    if (collatz_root)
+        return;
+
+    int up = net_has_uplink();
+    int64_t now = esp_timer_get_time();
+    if (up && !was_up)
     {
-        switch (block[i])
-        {
-        default:
-        case BLOCK_FREE:
-            buf[i] = '_';
-            break;
-        case BLOCK_TAKEN:
-            buf[i] = '+';
-            break;
-        case BLOCK_DONE:
-            buf[i] = 'X';
-            break;
-        }
+        in_sync = 0;
+        snap_linked = now;
+        asked = now - SNAP_RETRY;
+    }
+    was_up = up;
+
+    if (!in_sync && up && now - asked >= SNAP_RETRY)
+    {
+        asked = now;
+        snapshot_request();
     }
-    buf[BLOCKS] = '\0'; // not to be forgotten
-    ESP_LOGI(COMP, "  blocks: [%s]", buf);
 }
 
 /*
- *  Define a way for Collatz computation to send message to other nodes
+ *  Run this worker's slices of the current block
  */
-void broadcast_message(collatz_t *job)
+static void compute_slices(worker_t *w)
 {
-    app_header_t hdr;
-    int len = sizeof(collatz_t);
-
-    if (len <= NET_MAX_PAYLOAD)
+    w->tested = 0;
+    w->slices = 0;
+    w->result = 0;
+    for (uint32_t s = block_lo + w->id; s < block_end; s += block_workers)
     {
-        hdr.type = APP_COLLATZ_ID;
-        hdr.len = len;
-        if (collatz_root)
+        w->next = s;
+        rl_set(&w->waterlevel, &block_start);
+        rl_add(&w->waterlevel, s * SLICE * 2);
+        int t = ck_range(&w->waterlevel, SLICE, block_sieve);
+        if (t < 0)
         {
-            job->report_type &= ~BLOCK_UP; /* make sure! */
-            net_send_down(&hdr, (const uint8_t *)job);
+            w->result = -1;
+            return;
         }
-        else
+        w->tested += t;
+        w->slices++;
+        w->next = s + block_workers;
+#if defined(LED_PIN)
+        if (w->id == 0)
         {
-            job->report_type |= BLOCK_UP;
-            net_send_up(&hdr, (const uint8_t *)job);
+            // 0xffff ~ 1sec, counted for all workers
+            led_count += t * block_workers;
+            if (led_count > 0x1fff)
+            {
+                led_count &= 0x1fff;
+                led_state = led_state ? 0 : 1;
+                gpio_set_level(LED_PIN, led_state);
+            }
         }
+#endif
     }
+    w->next = SLICES; /* nothing of ours left */
 }
 
 /*
- *  Inform others about my progress, if any:
- *  - (non-zero) bid indicates the completed block: 0 => none, 1 => 1st
- *  - Semaphore MUST be acquired before calling this function
+ *  Workers 1.. : wait for a block, run the slices, report back
  */
-void report_my_progress(int fin)
+void collatz_worker(void *pvParameter)
 {
-    int done = 0;
+    worker_t *w = (worker_t *)pvParameter;
 
-    if (block[0] == BLOCK_DONE)
-    {
-        rl_add(&job.base, BLOCKSIZE);
-        for (done = 1; done < BLOCKS && block[done] == BLOCK_DONE; done++)
-            rl_add(&job.base, BLOCKSIZE);
-        shift_blocks(done);
-        ESP_LOGI(COMP, "Shifted %d blocks, the current frame is 0x%s, and block %d (fin %d)",
-                 done, rl_str(&job.base), job.block_id, fin);
-        log_report_blocks();
-    }
-    else if (!fin) /* progress elsewhere did not trigger changes to our state            */
-        return;
-    else /* we have complete an isolated block, report it to avoid double work */
+    while (1)
     {
-        ESP_LOGI(COMP, "Reporting block %d from frame 0x%s", job.block_id, rl_str(&job.base));
+        xSemaphoreTake(w->go, portMAX_DELAY);
+        compute_slices(w);
+        xSemaphoreGive(workers_done);
     }
-
-    /* what's done is done! */
-    job.report_type = BLOCK_DONE;
-    broadcast_message(&job);
 }
 
 /*
- *  Inform others about my job => BLOCK_TAKEN
+ *  Slices of [lo, hi) of block bi that a claim of another node has finished
  *  - Semaphore MUST be acquired before calling this function
  */
-void report_my_start(void)
+static uint32_t claim_overlap(int bi, uint32_t lo, uint32_t hi)
 {
-    ESP_LOGI(COMP, "Computing block %d from frame 0x%s", job.block_id, rl_str(&job.base));
-    job.report_type = BLOCK_TAKEN;
-    broadcast_message(&job);
+    uint32_t n = 0;
+    for (int i = 0; i < CLAIMS; i++)
+    {
+        const claim_t *c = &claim[i];
+        if (c->block != bi || i == own)
+            continue;
+        uint32_t a = c->start > lo ? c->start : lo;
+        uint32_t b = c->done < hi ? c->done : hi;
+        n += b > a ? b - a : 0;
+    }
+    return n;
 }
 
-/**********************************************************/
 /*
- * Process a report received from elsewhere
- *  - This functions acquires the semaphore FIRST and keeps it until the END
- *  - Data is copied only if needed -- green computing!
+ *  Claim slices [start, end) of block bi and set the workers up
  *  - Semaphore MUST be acquired before calling this function
  */
-void process_report(const collatz_t *rpt)
+static int block_begin(int bi, uint16_t start, uint16_t end)
 {
-    int16_t rt = rpt->report_type & BLOCK_MASK;
-    ESP_LOGI(COMP, "Received a report for block %d frame 0x%s %s",
-             rpt->block_id, rl_str(&rpt->base),
-             (rt == BLOCK_TAKEN ? "taken" : "done"));
+    switch (cf_get(&block, bi))
+    {
+    case BLOCK_DONE:
+    default:
+        return -1;
+    case BLOCK_TAKEN: /* slices left over, or stolen */
+        break;
+    case BLOCK_FREE:
+        cf_set(&block, bi, BLOCK_TAKEN);
+        break;
+    }
+    job.block_id = bi;
+    report_my_start(); // inform others: (bd,bi) => BLOCK_TAKEN
+    block_lo = start;
+    block_end = end;
+    block_began = esp_timer_get_time();
+    claim_t c = {bi, net_node_id(), 0, start, end, start, pace, block_began + LEASE};
+    claim_set(&c, 0);
+    own = claim_find(bi, net_node_id(), start);
+    block_workers = workers_want;
+    for (int i = 0; i < block_workers; i++)
+        worker[i].next = start + i;
+    if (start || end < SLICES)
+        ESP_LOGI(COMP, " - slices %u..%u of %u", start, end, SLICES);
 
-    /*** First adjust the high water marks to same offset ***/
-    int d = rl_cmp(&rpt->base, &job.base);
+    /* bd + bi*BLOCKSIZE */
+    rl_set(&block_start, &job.base);
+    rl_add_shl(&block_start, bi, BLOCKSHIFT);
+    return 0;
+}
 
-    if (d < 0) /* rpt.base < our.base */
+/*
+ *  The workers ran 'slices' up to block_end: our part is finished, and
+ *  the block DONE if the finished claims cover it now
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void block_finish(uint32_t slices)
+{
+    if (job.block_id < 0) /* done elsewhere, or the frame moved past it */
     {
-        memcpy(&job2, rpt, sizeof(collatz_t));
-        rpt = &job2; /* use a local (modified) copy in this case */
-        ESP_LOGI(COMP, " - report is with a lower base");
-        do
-        {
-            if (job2.block_id < 0)
-                return; // old news!
-            rl_add(&job2.base, BLOCKSIZE);
-            job2.block_id--;
-        } while (rl_cmp(&job2.base, &job.base) < 0);
-        /* Confirm that base offsets are equal! */
-        if (rl_equal(&job.base, &rpt->base))
-        {
-            ESP_LOGE(COMP, " - job.base != rpt.base = 0x%s (ignored!)", rl_str(&rpt->base));
-            ESP_LOGE(COMP, " -             job.base = 0x%s (ignored!)", rl_str(&job.base));
-        }
-
-        ESP_LOGI(COMP, " - new block id is %d", rpt->block_id);
+        stats.wasted++;
+        stats.duplicates += slices;
     }
-    else if (d > 0) /* rpt.base > our.base : update our integer frame */
+    else /* Check what to do with our effort */
     {
-        int left = BLOCKS;
-        do
+        uint32_t next, ran = block_end; /* all of [block_lo, ran) */
+        pace_measure(slices);
+        stats.duplicates += claim_overlap(job.block_id, block_lo, ran);
+        if (own >= 0)
         {
-            rl_add(&job.base, BLOCKSIZE);
-            left--;
-        } while (left && rl_greater(&rpt->base, &job.base));
-        ESP_LOGI(COMP, " - raising the integer frame by %d blocks", BLOCKS - left);
-
-        /* something to preserve?! : shift if so */
-        shift_blocks(BLOCKS - left);
-        ESP_LOGI(COMP, " - shifted %d blocks, frame is 0x%s, and block %d",
-                 BLOCKS - left, rl_str(&job.base), job.block_id);
-        log_report_blocks();
-
-        if (!left)
-            rl_set(&job.base, &rpt->base);
-    }
-    /* now new base == old base; and block id's are in the integer frame */
-    if (rpt->block_id >= 0)
-    {
-        int16_t nbi = rpt->block_id;
-
-        if (block[nbi] < rt)
-            ESP_LOGI(COMP, " - block %d state updated to %d", nbi, ((int)rt));
-        block[nbi] = (block[nbi] > rt ? block[nbi] : rt); // max(...)
-        if (rt == BLOCK_DONE && nbi == job.block_id)
+            claim[own].done = claim[own].end = ran;
+            claim_note(own, 0);
+            gaps_stale = 1;
+        }
+        if (claim_gap(job.block_id, 0, 0, &next) >= SLICES || (block_lo == 0 && ran >= SLICES))
+        {
+            cf_set(&block, job.block_id, BLOCK_DONE);
+            claim_free_block(job.block_id);
+            checkpoint_dirty = 1;
+            report_my_progress(1);
+        }
+        else
         {
-            ESP_LOGI(COMP, " - our current computation is obsolete!");
-            job.block_id = -1;
+            ESP_LOGI(COMP, " - slices %u..%u done, the block is not complete yet", block_lo, ran);
         }
+        job.block_id = -1; /* computation just finished */
     }
-
-    /*
-     * final step: report our follow-up progress!
-     */
-    report_my_progress(0);
+    own = -1;
 }
 
 /*
- *  The actual work is done here -- compute one block:
+ *  The actual work is done here -- compute slices [start, end) of one block:
  *  -  Semaphore is acquired when needed (at start, and at the end)
+ *  -  The slices are shared with the other workers, this task is worker 0
  */
-int compute_block(int bi)
+int compute_block(int bi, uint16_t start, uint16_t end)
 {
     if (rl_overflow)
     {
@@ -340,68 +1464,115 @@ int compute_block(int bi)
 
     /**********************************************************/
     xSemaphoreTake(mutex, portMAX_DELAY);
-    job.block_id = bi;
-    switch (block[bi])
+    if (block_begin(bi, start, end))
     {
-    case BLOCK_DONE:
-    default:
         xSemaphoreGive(mutex);
         return 0;
-    case BLOCK_TAKEN:
-        ESP_LOGW(COMP, "Recomputing the same block?!");
-        break;
-    case BLOCK_FREE:
-        block[bi] = BLOCK_TAKEN;
-        break;
     }
-    report_my_start(); // inform others: (bd,bi) => BLOCK_TAKEN
-
-    /* bd + bi*BLOCKSIZE */
-    rl_set(&waterlevel, &job.base);
-    for (int i = bi; i; i--)
-        rl_add(&waterlevel, BLOCKSIZE);
-
     xSemaphoreGive(mutex);
     /**********************************************************/
     /* Process the block */
-    for (int i = 0; i < BLOCKSIZE; i += 2)
+    int64_t started = esp_timer_get_time();
+    block_sieve = (sieve.bits != NULL && cs_applies(&sieve, &block_start)) ? &sieve : NULL;
+    for (int i = 1; i < block_workers; i++)
+        xSemaphoreGive(worker[i].go);
+    compute_slices(&worker[0]);
+    for (int i = 1; i < block_workers; i++)
+        xSemaphoreTake(workers_done, portMAX_DELAY);
+
+    uint32_t tested = 0, slices = 0;
+    for (int i = 0; i < block_workers; i++)
     {
-        rl_set(&n, &waterlevel);
-        rl_add(&n, 2);
-        do
-        {
-            rl_f3n1(&n);
-            rl_fdiv2(&n);
-            if (rl_overflow)
-            {
-                ESP_LOGE(COMP, "Overflow detected -- computation terminated");
-                return -1;
-            }
-        } while (rl_greater(&n, &waterlevel));
-        rl_add(&waterlevel, 2);
-#if defined(LED_PIN)
-        // 0xffff ~ 1sec
-        led_count = (led_count + 1) & 0x1ffful;
-        if (!led_count)
+        if (worker[i].result)
         {
-            led_state = led_state ? 0 : 1;
-            gpio_set_level(LED_PIN, led_state);
+            ESP_LOGE(COMP, "Overflow detected -- computation terminated");
+            return -1;
         }
-#endif
+        tested += worker[i].tested;
+        slices += worker[i].slices;
     }
+    int64_t took = esp_timer_get_time() - started;
     /**********************************************************/
     xSemaphoreTake(mutex, portMAX_DELAY);
-    if (job.block_id >= 0) /* Check what to do with our effort */
-    {
-        block[job.block_id] = BLOCK_DONE;
-        report_my_progress(1);
-        job.block_id = -1; /* computation just finished */
-    }
+    stats.blocks++;
+    stats.tested += tested;
+    stats.skipped += slices * SLICE - tested;
+    stats.block_us = took;
+    stats.workers = block_workers;
+    ESP_LOGI(COMP, "Block %d: %u of %u numbers run in %lld ms by %d workers", bi, tested, slices * SLICE,
+             took / 1000, block_workers);
+    block_finish(slices);
     xSemaphoreGive(mutex);
     /**********************************************************/
     return 0;
 }
 
+void collatz_checkpoint(void)
+{
+    if (mutex != NULL)
+        checkpoint_save(1);
+}
+
+void collatz_stats(collatz_stats_t *out)
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(mutex);
+}
+
+int collatz_workers(int n)
+{
+    if (n < 0 || n > WORKERS)
+        return -1;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (n)
+        workers_want = n;
+    n = workers_want;
+    xSemaphoreGive(mutex);
+    return n;
+}
+
+/*
+ *  Time one kernel over the 'count' odd numbers the compute task gets next,
+ *  the block loop if 'descend' is NULL. Runs in BENCH_CHUNK chunks with an
+ *  untimed tick between them: the caller is the serial task, and the idle
+ *  task of its core must get to run for the task watchdog.
+ */
+static int64_t bench_run(ck_descend_t descend, const bigint_t *base, uint32_t count)
+{
+    bigint_t level;
+    int64_t us = 0;
+
+    rl_set(&level, base);
+    for (uint32_t done = 0; done < count; done += BENCH_CHUNK)
+    {
+        uint32_t n = count - done < BENCH_CHUNK ? count - done : BENCH_CHUNK;
+        int64_t t0 = esp_timer_get_time();
+        if (descend ? ck_run(descend, &level, n) : ck_range(&level, n, NULL) < 0)
+            return -1;
+        us += esp_timer_get_time() - t0;
+        if (descend)
+            rl_add(&level, 2 * n); /* ck_range moves level on itself */
+        vTaskDelay(1);
+    }
+    return us;
+}
+
+int collatz_bench(uint32_t count, collatz_bench_t *out)
+{
+    bigint_t base;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    rl_set(&base, &job.base);
+    xSemaphoreGive(mutex);
+
+    out->numbers = count;
+    out->steps = ck_steps();
+    out->plain_us = bench_run(ck_descend_plain, &base, count);
+    out->kernel_us = bench_run(ck_descend, &base, count);
+    out->wide_us = bench_run(NULL, &base, count);
+    return (out->plain_us < 0 || out->kernel_us < 0 || out->wide_us < 0) ? -1 : 0;
+}
+
 /*
  *  Computing task 'Collatz' that never rests and never returns
  */
@@ -415,9 +1586,21 @@ void collatz_compute(void *pvParameter)
      */
     while (1)
     {
-        int b = pick_block();
-        if (compute_block(b))
+        /* no point computing reports the network cannot carry */
+        net_wait_clear(-1);
+        /* nor blocks the mesh may have done while we were away */
+        while (!in_sync)
+            vTaskDelay(100 / portTICK_RATE_MS);
+        uint16_t start, end;
+        int b = pick_block(&start, &end);
+        if (b < 0) /* everything is claimed, and no claim worth a steal */
+        {
+            vTaskDelay(IDLE_WAIT / portTICK_RATE_MS);
+            continue;
+        }
+        if (compute_block(b, start, end))
             break;
+        checkpoint_save(0);
         taskYIELD();
     }
     xSemaphoreTake(mutex, portMAX_DELAY);
@@ -442,6 +1625,61 @@ int magic(const char *buf, const char *key)
     }
 }
 
+/*
+ *  One message from the Collatz app elsewhere
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void collatz_dispatch(const app_header_t *hdr, const uint8_t *pay)
+{
+    if (hdr->len == sizeof(snapshot_t) && !magic((const char *)pay, "f3nS"))
+    {
+        snapshot_process(hdr, (const snapshot_t *)pay);
+    }
+    else if (hdr->len >= REPORT_HEAD && !magic((const char *)pay, "f3nB"))
+    {
+        const report_t *rpt = (const report_t *)pay;
+        if (rpt->words <= REPORT_WORDS && hdr->len == REPORT_HEAD + 4 * rpt->words)
+            report_process(hdr, rpt);
+    }
+    else if (hdr->len >= REPORT_HEAD && !magic((const char *)pay, "f3nL"))
+    {
+        const claims_t *msg = (const claims_t *)pay;
+        if (msg->count <= CLAIM_MSG && hdr->len == REPORT_HEAD + sizeof(claim_rec_t) * msg->count)
+            claims_process(hdr, msg);
+    }
+}
+
+/*
+ *  Renew our claim, and send what is due
+ *  - Semaphore MUST be acquired before calling this function
+ */
+static void collatz_tick(void)
+{
+    claim_renew();
+    report_flush(REPORT_UP);
+    report_flush(REPORT_DOWN);
+}
+
+/*
+ *  One round of the comm task: a message if one comes within 'wait' ms,
+ *  then what is due. Non-zero if a message came.
+ */
+int collatz_comm_step(int32_t wait)
+{
+    static app_header_t hdr;
+    static uint8_t pay[NET_MAX_PAYLOAD];
+
+    snapshot_poll();
+    int got = !net_receive(APP_COLLATZ_ID, &hdr, pay, wait);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (got)
+        collatz_dispatch(&hdr, pay);
+    /* else quiet for a while: what we hold may be old enough by now */
+    collatz_tick();
+    xSemaphoreGive(mutex);
+    return got;
+}
+
 /*
  * Task responsible for communication
  */
@@ -452,30 +1690,8 @@ void collatz_comm(void *pvParameter)
     // printf("Collatz comm task started %s\n", collatz_root ? "(root)" : "");
     while (1)
     {
-        static app_header_t hdr;
-        static uint8_t pay[NET_MAX_PAYLOAD];
-
-        while (!net_receive(APP_COLLATZ_ID, &hdr, pay, 4000))
-        {
-            collatz_t *rpt = (collatz_t *)pay;
-            if (hdr.len != sizeof(collatz_t) || magic((const char *)pay, "f3n1"))
-                continue;
-            if (!(rpt->report_type & BLOCK_UP) || collatz_root)
-            {
-                rpt->report_type &= (~BLOCK_UP);
-                net_send_down(&hdr, pay);
-
-                xSemaphoreTake(mutex, portMAX_DELAY);
-                process_report(rpt);
-                xSemaphoreGive(mutex);
-            }
-            else /* packet on its way up */
-            {
-                net_send_up(&hdr, pay);
-            }
+        if (collatz_comm_step(REPORT_WINDOW / 2000))
             vTaskDelay(20 / portTICK_RATE_MS); // process the incoming reports at faster rate
-        }
-        vTaskDelay(100 / portTICK_RATE_MS); // not needed?!
     }
 }
 
@@ -489,31 +1705,34 @@ void collatz_init(int root)
 #endif
 
     collatz_root = root; // affects our behavior
+    in_sync = root;      // everyone else asks its parent first
 
     net_register_app(APP_COLLATZ_ID);
 
-    /* init data structures */
-    job.magic[0] = 'f';
-    job.magic[1] = '3';
-    job.magic[2] = 'n';
-    job.magic[3] = '1';
-
     /*
      *  Init data structures: case n=1 is the start
      */
     rl_overflow = 0;
-    for (int i = 0; i < BLOCKS; i++)
-        block[i] = BLOCK_FREE;
+    cf_init(&block, block_word, BLOCKS);
+    cf_init(&pend[REPORT_UP], pend_word[REPORT_UP], BLOCKS);
+    cf_init(&pend[REPORT_DOWN], pend_word[REPORT_DOWN], BLOCKS);
+    for (int i = 0; i < CLAIMS; i++)
+        claim[i].block = -1;
+    gaps_stale = 1;
+    set_frame(0);
 
-#if defined(START_FROM_ONE)
-    job.base.len = 1;
-    job.base.a[0] = 0x1;
-#else /* 2^68 */
-    job.base.len = 3;
-    job.base.a[0] = MASK;         // 30
-    job.base.a[1] = MASK;         // 60
-    job.base.a[2] = (1 << 8) - 1; // 68
-#endif
+    checkpoint_load();
+
+    if (cs_init(&sieve, SIEVE_K) == 0)
+    {
+        stats.sieve_k = sieve.k;
+        stats.survivors = sieve.survivors;
+    }
+    else
+    {
+        ESP_LOGE(COMP, "No memory for the residue sieve -- every number is run");
+        sieve.bits = NULL;
+    }
 
     mutex = xSemaphoreCreateMutex(); // to guard computation variables
 
@@ -526,13 +1745,32 @@ void collatz_init(int root)
         1,              // - priority, higher than comp task
         NULL);          // - handle to task (for control)
 
-    xTaskCreate(
+    workers_done = xSemaphoreCreateCounting(WORKERS, 0);
+    for (int i = 0; i < WORKERS; i++)
+    {
+        worker[i].id = i;
+        worker[i].go = xSemaphoreCreateBinary();
+    }
+    for (int i = 1; i < WORKERS; i++)
+    {
+        xTaskCreatePinnedToCore(
+            &collatz_worker, // - function ptr
+            "collatz-work",  // - arbitrary name
+            2048,            // - stack size [byte]
+            &worker[i],      // - the worker state
+            0,               // - priority, "background" computation
+            NULL,            // - handle to task (for control)
+            i);              // - core
+    }
+
+    xTaskCreatePinnedToCore(
         &collatz_compute, // - function ptr
         "collatz-comp",   // - arbitrary name
         2048,             // - stack size [byte]
         NULL,             // - optional data for task
         0,                // - priority, "background" computation
-        NULL);            // - handle to task (for control)
+        NULL,             // - handle to task (for control)
+        0);               // - core of worker 0
 }
 
 /**********************************************************/
@@ -1,6 +1,8 @@
 #ifndef COLLATZ_H
 #define COLLATZ_H
 
+#include <stdint.h>
+
 #define APP_COLLATZ_ID 2
 
 /*
@@ -8,4 +10,69 @@
  */
 void collatz_init(int root);
 
+/*
+ *  Block statistics: odd numbers run and skipped by the residue sieve,
+ *  and the time the last block took
+ */
+typedef struct
+{
+    int sieve_k;        /* 0: no sieve                     */
+    uint32_t survivors; /* odd residues mod 2^k run        */
+    uint32_t blocks;    /* completed by this node          */
+    uint64_t tested;
+    uint64_t skipped;
+    int64_t block_us;   /* last block, 0 before the first */
+    int workers;        /* ... and the workers it ran on  */
+    int resumed;        /* frame restored from NVS        */
+    uint32_t wasted;    /* blocks done elsewhere first    */
+    uint32_t joins;     /* snapshots taken from a parent  */
+    uint32_t sync_requests;
+    int64_t sync_us;    /* link-up to in sync, last join  */
+    uint32_t reports;   /* report messages sent           */
+    uint32_t steals;    /* half claims taken from others  */
+    uint32_t takeovers; /* stale claims taken over        */
+    uint32_t duplicates; /* slices others ran too       */
+    uint32_t parts;     /* blocks claimed only in part    */
+    int64_t frame_us;   /* the frame last stood still     */
+} collatz_stats_t;
+
+void collatz_stats(collatz_stats_t *out);
+
+/*
+ *  One round of the comm task, 'wait' ms at most for a message.
+ *  Non-zero if one came. The host checks drive it in place of the task.
+ */
+int collatz_comm_step(int32_t wait);
+
+/*
+ *  Workers for the blocks from the next one on, 1 up to one per core, or
+ *  0 to ask. With COLLATZ_STATS 'block' this measures what a second core
+ *  gives. Returns the count in effect, -1 if 'n' is out of range.
+ */
+int collatz_workers(int n);
+
+/*
+ *  Write the frame checkpoint to NVS now, e.g. before a deliberate restart
+ */
+void collatz_checkpoint(void);
+
+/*
+ *  Benchmark: the plain step loop against the table kernel, on bigint_t
+ *  and on fixed 128 bits, for 'count' numbers of the current frame.
+ *  Runs in the caller's task, which it blocks for a second or so at
+ *  COLLATZ_BENCH_MAX numbers, yielding a tick between chunks.
+ */
+#define COLLATZ_BENCH_MAX 100000
+
+typedef struct
+{
+    uint32_t numbers; /* odd numbers run by each kernel */
+    int steps;        /* k, steps per table lookup      */
+    int64_t plain_us;
+    int64_t kernel_us; /* table kernel, rl_int */
+    int64_t wide_us;   /* block loop, 128 bit   */
+} collatz_bench_t;
+
+int collatz_bench(uint32_t count, collatz_bench_t *out);
+
 #endif
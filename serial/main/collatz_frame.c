@@ -0,0 +1,135 @@
+/**********************************************************/
+/*                                                        */
+/*  Block window of the Collatz integer frame             */
+/*                                                        */
+/**********************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "collatz_frame.h"
+
+#define PAIRS 0x55555555ul /* low bit of every 2 bit state */
+
+int cf_init(cf_window_t *w, uint32_t *word, uint32_t size)
+{
+    if (!size || size > CF_MAX_BLOCKS || (size & (size - 1)))
+        return -1;
+    w->word = word;
+    w->size = size;
+    w->head = 0;
+    memset(word, 0, CF_WORDS(size) * sizeof(uint32_t));
+    return 0;
+}
+
+/* word positions [p, p + n) back to FREE, no wrap */
+static void clear_run(cf_window_t *w, uint32_t p, uint32_t n)
+{
+    while (n)
+    {
+        uint32_t s = p & 15;
+        uint32_t k = 16 - s < n ? 16 - s : n;
+        if (k == 16)
+            w->word[p >> 4] = 0;
+        else
+            w->word[p >> 4] &= ~(((((uint32_t)1) << (k << 1)) - 1) << (s << 1));
+        p += k;
+        n -= k;
+    }
+}
+
+void cf_shift(cf_window_t *w, uint32_t done)
+{
+    if (done >= w->size)
+    {
+        memset(w->word, 0, CF_WORDS(w->size) * sizeof(uint32_t));
+        w->head = 0;
+        return;
+    }
+    uint32_t first = w->size - w->head; /* positions before the wrap */
+    if (done <= first)
+    {
+        clear_run(w, w->head, done);
+    }
+    else
+    {
+        clear_run(w, w->head, first);
+        clear_run(w, 0, done - first);
+    }
+    w->head = (w->head + done) & (w->size - 1);
+}
+
+uint32_t cf_done_prefix(const cf_window_t *w)
+{
+    uint32_t i = 0;
+    while (i < w->size && cf_get(w, i) == CF_DONE)
+        i++;
+    return i;
+}
+
+/* free blocks of word k as a mask of low bits, positions past size masked out */
+static uint32_t free_mask(const cf_window_t *w, uint32_t k)
+{
+    uint32_t x = w->word[k];
+    uint32_t m = ~(x | x >> 1) & PAIRS;
+    if (w->size < 16)
+        m &= (((uint32_t)1) << (w->size << 1)) - 1;
+    return m;
+}
+
+int cf_pick(const cf_window_t *w, uint32_t (*random32)(void))
+{
+    uint32_t size = w->size;
+
+    for (int t = 0; t < CF_PICK_TRIES; t++)
+    {
+        uint32_t r = random32();
+        uint32_t a = r & (size - 1);
+        uint32_t b = (r >> 16) & (size - 1);
+        uint32_t i = size - 1 - (a > b ? a : b); /* P(i) ~ 2 (size - i) - 1 */
+        if (cf_get(w, i) == CF_FREE)
+            return i;
+    }
+
+    /* mostly taken or done: weigh the free ones */
+    uint32_t mass = 0;
+    for (uint32_t k = 0; k < CF_WORDS(size); k++)
+    {
+        for (uint32_t m = free_mask(w, k); m; m &= m - 1)
+        {
+            uint32_t i = ((k << 4) + (__builtin_ctz(m) >> 1) - w->head) & (size - 1);
+            mass += 2 * (size - i) - 1;
+        }
+    }
+    if (!mass)
+        return -1;
+
+    uint32_t rnd = random32() % mass;
+    for (uint32_t k = 0; k < CF_WORDS(size); k++)
+    {
+        for (uint32_t m = free_mask(w, k); m; m &= m - 1)
+        {
+            uint32_t i = ((k << 4) + (__builtin_ctz(m) >> 1) - w->head) & (size - 1);
+            uint32_t p = 2 * (size - i) - 1;
+            if (rnd < p)
+                return i;
+            rnd -= p;
+        }
+    }
+    return -1; /* never reached */
+}
+
+void cf_count(const cf_window_t *w, uint32_t count[3])
+{
+    count[CF_FREE] = count[CF_TAKEN] = count[CF_DONE] = 0;
+    for (uint32_t k = 0; k < CF_WORDS(w->size); k++)
+    {
+        uint32_t x = w->word[k];
+        uint32_t valid = w->size < 16 ? (((uint32_t)1) << (w->size << 1)) - 1 : ~(uint32_t)0;
+        uint32_t taken = x & ~(x >> 1) & PAIRS & valid;
+        uint32_t done = (x >> 1) & ~x & PAIRS & valid;
+        uint32_t free = ~(x | x >> 1) & PAIRS & valid;
+        count[CF_TAKEN] += __builtin_popcount(taken);
+        count[CF_DONE] += __builtin_popcount(done);
+        count[CF_FREE] += __builtin_popcount(free);
+    }
+}
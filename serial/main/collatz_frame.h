@@ -0,0 +1,75 @@
+#ifndef COLLATZ_FRAME_H
+#define COLLATZ_FRAME_H
+
+/**********************************************************/
+/*                                                        */
+/*  Block window of the Collatz integer frame             */
+/*                                                        */
+/**********************************************************/
+/*
+ * Block states, 2 bits each, 16 to a word, in a ring: block 0 (the one at
+ * the frame base) lives at 'head'. Shifting the frame moves the head and
+ * clears what it passed, a word at a time.
+ *
+ * cf_pick chooses a free block with weight 2 (size - i) - 1, earlier blocks
+ * first: a proposal from that triangle (the larger of two uniform draws) is
+ * taken if the block is free, and only when CF_PICK_TRIES proposals miss
+ * are the free blocks scanned. Expected O(1) while the window is open,
+ * O(size / 16 + free) otherwise.
+ */
+#include <stdint.h>
+
+#define CF_FREE 0
+#define CF_TAKEN 1
+#define CF_DONE 2
+
+#define CF_MAX_BLOCKS (((uint32_t)1) << 15) /* weights sum below 2^30, ids fit int16_t */
+#define CF_WORDS(size) (((size) + 15) / 16)
+#define CF_PICK_TRIES 8
+
+typedef struct
+{
+    uint32_t *word; /* CF_WORDS(size), from the caller   */
+    uint32_t size;  /* blocks, a power of two            */
+    uint32_t head;  /* word position of block 0          */
+} cf_window_t;
+
+/*
+ *  All blocks free, returns -1 if size is not a power of two up to CF_MAX_BLOCKS
+ */
+int cf_init(cf_window_t *w, uint32_t *word, uint32_t size);
+
+static inline int cf_get(const cf_window_t *w, uint32_t i)
+{
+    uint32_t p = (w->head + i) & (w->size - 1);
+    return (w->word[p >> 4] >> ((p & 15) << 1)) & 3;
+}
+
+static inline void cf_set(cf_window_t *w, uint32_t i, int state)
+{
+    uint32_t p = (w->head + i) & (w->size - 1);
+    uint32_t s = (p & 15) << 1;
+    w->word[p >> 4] = (w->word[p >> 4] & ~(((uint32_t)3) << s)) | ((uint32_t)state << s);
+}
+
+/*
+ *  Drop the first 'done' blocks, the window gains as many free ones at its end
+ */
+void cf_shift(cf_window_t *w, uint32_t done);
+
+/*
+ *  Number of leading DONE blocks
+ */
+uint32_t cf_done_prefix(const cf_window_t *w);
+
+/*
+ *  A free block, or -1 if there is none
+ */
+int cf_pick(const cf_window_t *w, uint32_t (*random32)(void));
+
+/*
+ *  count[state] for the three states
+ */
+void cf_count(const cf_window_t *w, uint32_t count[3]);
+
+#endif
@@ -0,0 +1,246 @@
+/**********************************************************/
+/*                                                        */
+/*  Collatz trajectory kernels                            */
+/*                                                        */
+/**********************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "collatz_kernel.h"
+#include "collatz_table.h"
+
+#define CK_D_MASK ((((uint32_t)1) << CK_D_BITS) - 1)
+
+static const uint32_t pow3[] = {
+    1, 3, 9, 27, 81, 243, 729, 2187, 6561, 19683, 59049, 177147,
+    531441, 1594323, 4782969, 14348907, 43046721};
+
+int ck_steps(void)
+{
+    return COLLATZ_TABLE_K;
+}
+
+int ck_descend_plain(bigint_t *x, const bigint_t *limit)
+{
+    do
+    {
+        rl_f3n1(x);
+        rl_fdiv2(x);
+        if (rl_overflow)
+            return -1;
+    } while (rl_greater(x, limit));
+    return 0;
+}
+
+int ck_descend(bigint_t *x, const bigint_t *limit)
+{
+    while (rl_greater(x, limit))
+    {
+        if (x->len > 1)
+        {
+            uint32_t e = collatz_table[rl_low(x, COLLATZ_TABLE_K)];
+            rl_shr(x, COLLATZ_TABLE_K);
+            rl_muladd(x, pow3[e >> CK_D_BITS], e & CK_D_MASK);
+        }
+        else
+        {
+            /* small values: T^k cycles on 1, 2 and would never get to 1 */
+            if (x->a[0] & 1)
+                rl_f3n1(x);
+            rl_fdiv2(x);
+        }
+        if (rl_overflow)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ *  Fixed width: CK_WIDE full 32 bit words, least significant first
+ */
+typedef struct
+{
+    uint32_t w[CK_WIDE];
+} wide_t;
+
+/* 30 bit limbs to 32 bit words, x->len <= 4 so at most 120 bits */
+static void wide_set(wide_t *y, const bigint_t *x)
+{
+    uint32_t a[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < x->len; i++)
+        a[i] = x->a[i];
+    y->w[0] = a[0] | a[1] << 30;
+    y->w[1] = a[1] >> 2 | a[2] << 28;
+    y->w[2] = a[2] >> 4 | a[3] << 26;
+    y->w[3] = a[3] >> 6;
+}
+
+static void wide_get(bigint_t *x, const wide_t *y)
+{
+    x->a[0] = y->w[0] & MASK;
+    x->a[1] = (y->w[0] >> 30 | y->w[1] << 2) & MASK;
+    x->a[2] = (y->w[1] >> 28 | y->w[2] << 4) & MASK;
+    x->a[3] = (y->w[2] >> 26 | y->w[3] << 6) & MASK;
+    x->a[4] = y->w[3] >> 24;
+    x->len = 5;
+    while (x->len && !x->a[x->len - 1])
+        x->len--;
+}
+
+static int wide_greater(const wide_t *x, const wide_t *y)
+{
+    for (int i = CK_WIDE - 1; i >= 0; i--)
+    {
+        if (x->w[i] != y->w[i])
+            return x->w[i] > y->w[i];
+    }
+    return 0;
+}
+
+static void wide_add(wide_t *x, uint32_t c)
+{
+    uint64_t r = c;
+
+    for (int i = 0; i < CK_WIDE && r; i++)
+    {
+        r += x->w[i];
+        x->w[i] = (uint32_t)r;
+        r >>= 32;
+    }
+}
+
+/*
+ *  ck_descend on words: 0 when n <= lim, 1 when the next jump would pass
+ *  2^128 -- n is then the last value that fits
+ */
+static int descend_wide(wide_t *n, const wide_t *lim)
+{
+    const int k = COLLATZ_TABLE_K;
+
+    while (wide_greater(n, lim))
+    {
+        if (n->w[3] | n->w[2] | n->w[1] | (n->w[0] >> BLEN))
+        {
+            /* same jump as ck_descend: n >> k times 3^c plus d */
+            uint32_t e = collatz_table[n->w[0] & ((((uint32_t)1) << k) - 1)];
+            uint32_t m = pow3[e >> CK_D_BITS];
+            uint64_t r0 = (uint64_t)(n->w[0] >> k | n->w[1] << (32 - k)) * m + (e & CK_D_MASK);
+            uint64_t r1 = (uint64_t)(n->w[1] >> k | n->w[2] << (32 - k)) * m + (r0 >> 32);
+            uint64_t r2 = (uint64_t)(n->w[2] >> k | n->w[3] << (32 - k)) * m + (r1 >> 32);
+            uint64_t r3 = (uint64_t)(n->w[3] >> k) * m + (r2 >> 32);
+            if (r3 >> 32)
+                return 1;
+            n->w[0] = (uint32_t)r0;
+            n->w[1] = (uint32_t)r1;
+            n->w[2] = (uint32_t)r2;
+            n->w[3] = (uint32_t)r3;
+        }
+        else
+        {
+            /* below 2^30 as in ck_descend: one odd step, 3n+1 fits */
+            uint32_t v = n->w[0];
+            if (v & 1)
+                v = 3 * v + 1;
+#if defined(__GNUC__)
+            v >>= __builtin_ctz(v);
+#else
+            while (!(v & 1))
+                v >>= 1;
+#endif
+            n->w[0] = v;
+        }
+    }
+    return 0;
+}
+
+int ck_descend_wide(bigint_t *x, const bigint_t *limit)
+{
+    wide_t n, lim;
+
+    if (x->len > 4 || limit->len > 4)
+        return ck_descend(x, limit);
+    wide_set(&n, x);
+    wide_set(&lim, limit);
+    if (descend_wide(&n, &lim))
+    {
+        /* past 2^128, rl_int takes it from here */
+        wide_get(x, &n);
+        return ck_descend(x, limit);
+    }
+    wide_get(x, &n);
+    return 0;
+}
+
+int ck_run(ck_descend_t descend, const bigint_t *base, uint32_t count)
+{
+    bigint_t level, x;
+
+    rl_set(&level, base);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        rl_set(&x, &level);
+        rl_add(&x, 2);
+        if (descend(&x, &level))
+            return -1;
+        rl_add(&level, 2);
+    }
+    return 0;
+}
+
+int ck_range(bigint_t *level, uint32_t count, const collatz_sieve_t *sieve)
+{
+    int tested = 0;
+
+    /* level + 2 count stays below 2^120: whole range on words */
+    if (level->len < 4 || (level->len == 4 && level->a[3] < (((uint32_t)1) << (BLEN - 1))))
+    {
+        wide_t lev, n;
+        wide_set(&lev, level);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (sieve == NULL || cs_survives(sieve, lev.w[0] + 2))
+            {
+                n = lev;
+                wide_add(&n, 2);
+                if (descend_wide(&n, &lev))
+                {
+                    bigint_t x, lim;
+                    wide_get(&x, &n);
+                    wide_get(&lim, &lev);
+                    if (ck_descend(&x, &lim))
+                        return -1;
+                }
+                tested++;
+            }
+            wide_add(&lev, 2);
+        }
+        wide_get(level, &lev);
+        return tested;
+    }
+
+    bigint_t x;
+    uint32_t skip = 0; /* level lags by */
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (sieve != NULL && !cs_survives(sieve, rl_low(level, sieve->k) + skip + 2))
+        {
+            skip += 2;
+            continue;
+        }
+        if (skip)
+        {
+            rl_add(level, skip);
+            skip = 0;
+        }
+        rl_set(&x, level);
+        rl_add(&x, 2);
+        if (ck_descend(&x, level))
+            return -1;
+        rl_add(level, 2);
+        tested++;
+    }
+    if (skip)
+        rl_add(level, skip);
+    return tested;
+}
@@ -0,0 +1,46 @@
+#ifndef COLLATZ_KERNEL_H
+#define COLLATZ_KERNEL_H
+
+/**********************************************************/
+/*                                                        */
+/*  Collatz trajectory kernels                            */
+/*                                                        */
+/**********************************************************/
+/*
+ * Both run x until it is at most 'limit' and return 0, or -1 on rl_overflow.
+ *
+ * ck_descend_plain: one (3n+1)/2^v step per pass, as compute_block did.
+ * ck_descend: k steps of T(n) = n odd ? (3n+1)/2 : n/2 per pass, from the
+ *   2^k table of collatz_table.h: with n = a*2^k + b, T^k(n) = a*3^c[b] + d[b].
+ *   It only looks at every k-th value, so it may run past the first one
+ *   below the limit, but it never stops above it.
+ * ck_descend_wide: ck_descend on fixed 4 x 32 bit words, no length
+ *   bookkeeping. Falls back to ck_descend when x or limit does not fit
+ *   in 120 bits, or from the last value that fits when a jump would pass
+ *   2^128 -- so both return the same x, bit for bit.
+ *
+ * ck_run: 'count' odd numbers above 'base', each run down to at most
+ *   the one before it, by the given kernel. 0, or -1 on rl_overflow.
+ * ck_range: the same for the block loop, from *level on, which ends 2 count
+ *   higher. The whole range stays in 128 bit words while it is below 2^120.
+ *   Numbers whose residue the sieve drops are not run (sieve may be NULL).
+ *   Returns the numbers run, or -1 on rl_overflow.
+ */
+#include "rl_int.h"
+#include "collatz_sieve.h"
+
+#define CK_D_BITS 27 /* table entry: d in the low bits, c above */
+#define CK_WIDE 4    /* 32 bit words of ck_descend_wide     */
+
+int ck_descend_plain(bigint_t *x, const bigint_t *limit);
+int ck_descend(bigint_t *x, const bigint_t *limit);
+int ck_descend_wide(bigint_t *x, const bigint_t *limit);
+
+typedef int (*ck_descend_t)(bigint_t *x, const bigint_t *limit);
+
+int ck_run(ck_descend_t descend, const bigint_t *base, uint32_t count);
+int ck_range(bigint_t *level, uint32_t count, const collatz_sieve_t *sieve);
+
+int ck_steps(void); /* k of the table */
+
+#endif
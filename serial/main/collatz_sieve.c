@@ -0,0 +1,64 @@
+/**********************************************************/
+/*                                                        */
+/*  Residue sieve for Collatz blocks                      */
+/*                                                        */
+/**********************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "collatz_sieve.h"
+
+/*
+ *  Whether odd residue r must be run: no j <= k with 3^c < 2^j
+ */
+static int survives(uint32_t r, int k)
+{
+    uint64_t v = r;  /* T^j(r), below 2^k * 1.5^k */
+    uint64_t p3 = 1; /* 3^c */
+    for (int j = 1; j <= k; j++)
+    {
+        if (v & 1)
+        {
+            v = (3 * v + 1) >> 1;
+            p3 *= 3;
+        }
+        else
+        {
+            v >>= 1;
+        }
+        if (p3 < (((uint64_t)1) << j))
+            return 0;
+    }
+    return 1;
+}
+
+int cs_init(collatz_sieve_t *cs, int k)
+{
+    if (k < CS_K_MIN || k > CS_K_MAX)
+        return -1;
+
+    uint32_t size = ((uint32_t)1) << (k - 4);
+    cs->bits = malloc(size);
+    if (cs->bits == NULL)
+        return -1;
+    memset(cs->bits, 0, size);
+
+    cs->k = k;
+    cs->mask = (((uint32_t)1) << k) - 1;
+    cs->survivors = 0;
+    for (uint32_t r = 1; r <= cs->mask; r += 2)
+    {
+        if (survives(r, k))
+        {
+            cs->bits[r >> 4] |= 1 << ((r >> 1) & 7);
+            cs->survivors++;
+        }
+    }
+    return 0;
+}
+
+int cs_applies(const collatz_sieve_t *cs, const bigint_t *base)
+{
+    return base->len > 1 && (base->len - 1) * BLEN > 2 * cs->k;
+}
@@ -0,0 +1,51 @@
+#ifndef COLLATZ_SIEVE_H
+#define COLLATZ_SIEVE_H
+
+/**********************************************************/
+/*                                                        */
+/*  Residue sieve for Collatz blocks                      */
+/*                                                        */
+/**********************************************************/
+/*
+ * For an odd n = a*2^k + r, the first k steps of T(n) = n odd ? (3n+1)/2 : n/2
+ * depend on r only: after j of them n has become (3^c n + s) / 2^j. Once
+ * 3^c < 2^j, the value is below n for every n > s / (2^j - 3^c), and since
+ * s < 3^c 2^j, that holds for all n > 2^(2k). Such residues need not be run.
+ *
+ * The survivors are kept as a bitmap over the odd residues, 2^(k-4) bytes.
+ */
+#include <stdint.h>
+
+#include "rl_int.h"
+
+#define CS_K_MIN 8
+#define CS_K_MAX 24 /* 1 MB bitmap -- past the RAM of the ESP32, host use */
+
+typedef struct
+{
+    int k;
+    uint32_t mask;      /* 2^k - 1                     */
+    uint32_t survivors; /* odd residues left to run     */
+    uint8_t *bits;      /* bit r/2 set: r must be run   */
+} collatz_sieve_t;
+
+/*
+ *  Builds the bitmap (malloc), returns 0 or -1
+ */
+int cs_init(collatz_sieve_t *cs, int k);
+
+/*
+ *  Whether the sieve is sound for n >= base, i.e. base > 2^(2k)
+ */
+int cs_applies(const collatz_sieve_t *cs, const bigint_t *base);
+
+/*
+ *  r = n mod 2^k, n odd
+ */
+static inline int cs_survives(const collatz_sieve_t *cs, uint32_t r)
+{
+    r = (r & cs->mask) >> 1;
+    return (cs->bits[r >> 3] >> (r & 7)) & 1;
+}
+
+#endif
@@ -0,0 +1,523 @@
+/*
+* Generated by collatz_table.py -k 12, do not edit.  Included by
+*  collatz_kernel.c only: const, so it stays in flash and is read through
+*  the cache mapping instead of taking RAM.
+*
+* Entry b: T^k(b) in the low CK_D_BITS, the odd steps among those k above.
+*/
+#define COLLATZ_TABLE_K 12
+
+static const uint32_t collatz_table[1 << COLLATZ_TABLE_K] = {
+    0x00000000, 0x30000001, 0x30000002, 0x30000002, 0x28000001, 0x28000001, 0x28000001, 0x30000002,
+    0x28000002, 0x30000002, 0x28000002, 0x28000001, 0x28000002, 0x28000002, 0x28000001, 0x28000001,
+    0x20000001, 0x28000002, 0x30000004, 0x30000004, 0x20000001, 0x20000001, 0x28000002, 0x28000002,
+    0x20000001, 0x30000005, 0x20000001, 0x48000089, 0x28000002, 0x28000002, 0x28000002, 0x4800009B,
+    0x20000002, 0x38000014, 0x20000001, 0x20000001, 0x30000008, 0x30000008, 0x30000008, 0x38000016,
+    0x20000002, 0x480000CE, 0x20000002, 0x3800001A, 0x20000001, 0x20000001, 0x20000001, 0x480000E9,
+    0x20000002, 0x3000000A, 0x3000000A, 0x3000000A, 0x20000002, 0x20000002, 0x4000005B, 0x4000005B,
+    0x28000004, 0x3000000B, 0x28000004, 0x3000000B, 0x28000004, 0x28000004, 0x40000067, 0x40000067,
+    0x18000001, 0x3000000D, 0x3000000D, 0x3000000D, 0x20000002, 0x20000002, 0x20000002, 0x4800015E,
+    0x28000005, 0x40000079, 0x28000005, 0x20000002, 0x28000005, 0x28000005, 0x3800002C, 0x3800002C,
+    0x18000001, 0x28000005, 0x40000089, 0x40000089, 0x18000001, 0x18000001, 0x30000011, 0x30000011,
+    0x20000002, 0x30000011, 0x20000002, 0x480001BD, 0x20000002, 0x20000002, 0x4000009B, 0x4000009B,
+    0x18000001, 0x400000A1, 0x30000014, 0x30000014, 0x30000014, 0x30000014, 0x30000014, 0x400000A7,
+    0x18000001, 0x30000013, 0x18000001, 0x400000AF, 0x400000B6, 0x400000B6, 0x400000B6, 0x50000653,
+    0x28000008, 0x18000001, 0x28000007, 0x28000007, 0x28000008, 0x28000008, 0x30000016, 0x30000016,
+    0x28000008, 0x48000251, 0x28000008, 0x38000043, 0x400000CE, 0x400000CE, 0x400000CE, 0x400000CD,
+    0x18000002, 0x38000047, 0x3000001A, 0x3000001A, 0x3000001A, 0x3000001A, 0x3000001A, 0x3800004A,
+    0x18000001, 0x4800029C, 0x18000001, 0x3800004C, 0x18000001, 0x18000001, 0x400000E9, 0x400000E9,
+    0x2800000A, 0x400000F2, 0x400000F2, 0x400000F2, 0x2800000A, 0x2800000A, 0x18000001, 0x18000001,
+    0x2800000A, 0x3000001C, 0x2800000A, 0x400000FB, 0x3000001D, 0x3000001D, 0x3000001D, 0x50000904,
+    0x18000002, 0x40000107, 0x2800000A, 0x2800000A, 0x3800005B, 0x3800005B, 0x3800005B, 0x5000097D,
+    0x18000002, 0x48000334, 0x18000002, 0x3000001F, 0x2800000B, 0x2800000B, 0x2800000B, 0x4000011B,
+    0x20000004, 0x2800000B, 0x2800000B, 0x2800000B, 0x20000004, 0x20000004, 0x4800037A, 0x4800037A,
+    0x20000004, 0x38000065, 0x20000004, 0x38000065, 0x38000067, 0x38000067, 0x38000067, 0x40000134,
+    0x18000002, 0x3800006B, 0x3800006B, 0x3800006B, 0x2800000D, 0x2800000D, 0x2800000D, 0x40000143,
+    0x2800000D, 0x20000004, 0x2800000D, 0x30000025, 0x2800000D, 0x2800000D, 0x4000014E, 0x4000014E,
+    0x18000002, 0x30000026, 0x30000026, 0x30000026, 0x18000002, 0x18000002, 0x4000015E, 0x4000015E,
+    0x38000079, 0x30000028, 0x38000079, 0x38000076, 0x38000079, 0x38000079, 0x48000437, 0x48000437,
+    0x20000005, 0x48000445, 0x18000002, 0x18000002, 0x2800000E, 0x2800000E, 0x2800000E, 0x3800007C,
+    0x20000005, 0x40000179, 0x20000005, 0x4000017C, 0x3000002C, 0x3000002C, 0x3000002C, 0x48000482,
+    0x20000005, 0x20000005, 0x4000018B, 0x4000018B, 0x20000005, 0x20000005, 0x38000086, 0x38000086,
+    0x38000089, 0x40000194, 0x38000089, 0x50000E3C, 0x38000089, 0x38000089, 0x4000019A, 0x4000019A,
+    0x10000001, 0x3000002F, 0x3000002F, 0x3000002F, 0x28000011, 0x28000011, 0x28000011, 0x400001A9,
+    0x28000011, 0x3800008F, 0x28000011, 0x28000010, 0x28000011, 0x28000011, 0x30000031, 0x30000031,
+    0x18000002, 0x28000011, 0x400001BD, 0x400001BD, 0x18000002, 0x18000002, 0x38000098, 0x38000098,
+    0x18000002, 0x38000098, 0x18000002, 0x48000557, 0x3800009B, 0x3800009B, 0x3800009B, 0x3800009A,
+    0x28000014, 0x30000035, 0x380000A1, 0x380000A1, 0x380000A1, 0x380000A1, 0x380000A1, 0x400001DC,
+    0x28000014, 0x400001DF, 0x28000014, 0x400001E5, 0x18000002, 0x18000002, 0x18000002, 0x400001E8,
+    0x28000014, 0x30000038, 0x30000038, 0x30000038, 0x28000014, 0x28000014, 0x380000A7, 0x380000A7,
+    0x28000013, 0x400001FA, 0x28000013, 0x28000013, 0x28000013, 0x28000013, 0x50001208, 0x50001208,
+    0x10000001, 0x28000014, 0x380000AF, 0x380000AF, 0x28000014, 0x28000014, 0x28000014, 0x4800062B,
+    0x380000B6, 0x3000003B, 0x380000B6, 0x28000014, 0x380000B6, 0x380000B6, 0x48000653, 0x48000653,
+    0x10000001, 0x380000B6, 0x48000668, 0x48000668, 0x10000001, 0x10000001, 0x3000003E, 0x3000003E,
+    0x20000007, 0x380000BC, 0x20000007, 0x3000003E, 0x20000007, 0x20000007, 0x40000236, 0x40000236,
+    0x20000008, 0x380000BE, 0x28000016, 0x28000016, 0x28000016, 0x28000016, 0x28000016, 0x40000241,
+    0x20000008, 0x30000041, 0x20000008, 0x30000041, 0x40000251, 0x40000251, 0x40000251, 0x380000C5,
+    0x20000008, 0x20000008, 0x30000043, 0x30000043, 0x20000008, 0x20000008, 0x380000CA, 0x380000CA,
+    0x380000CE, 0x4800071E, 0x380000CE, 0x40000263, 0x380000CE, 0x380000CE, 0x380000CD, 0x380000CD,
+    0x10000001, 0x28000017, 0x30000047, 0x30000047, 0x30000047, 0x30000047, 0x30000047, 0x30000047,
+    0x2800001A, 0x380000D3, 0x2800001A, 0x4000027E, 0x2800001A, 0x2800001A, 0x380000D7, 0x380000D7,
+    0x2800001A, 0x20000008, 0x20000008, 0x20000008, 0x2800001A, 0x2800001A, 0x3000004A, 0x3000004A,
+    0x2800001A, 0x3000004A, 0x2800001A, 0x40000295, 0x4000029C, 0x4000029C, 0x4000029C, 0x480007D0,
+    0x10000001, 0x400002A2, 0x3000004C, 0x3000004C, 0x3000004C, 0x3000004C, 0x3000004C, 0x380000E3,
+    0x10000001, 0x48000803, 0x10000001, 0x400002B0, 0x380000E9, 0x380000E9, 0x380000E9, 0x3000004D,
+    0x380000F2, 0x30000050, 0x30000050, 0x30000050, 0x380000F2, 0x380000F2, 0x380000EC, 0x380000EC,
+    0x380000F2, 0x30000050, 0x380000F2, 0x380000EE, 0x400002CF, 0x400002CF, 0x400002CF, 0x48000869,
+    0x2000000A, 0x400002D8, 0x4800088A, 0x4800088A, 0x10000001, 0x10000001, 0x10000001, 0x380000F4,
+    0x2800001C, 0x30000052, 0x2800001C, 0x30000053, 0x2800001C, 0x2800001C, 0x380000F8, 0x380000F8,
+    0x2000000A, 0x2800001C, 0x380000FB, 0x380000FB, 0x2000000A, 0x2000000A, 0x380000FD, 0x380000FD,
+    0x2800001D, 0x2800001D, 0x2800001D, 0x30000055, 0x2800001D, 0x2800001D, 0x48000904, 0x48000904,
+    0x2000000A, 0x30000056, 0x2000000A, 0x2000000A, 0x38000107, 0x38000107, 0x38000107, 0x4800092C,
+    0x2000000A, 0x38000106, 0x2000000A, 0x48000941, 0x30000059, 0x30000059, 0x30000059, 0x50001BF2,
+    0x3000005B, 0x2000000A, 0x3800010D, 0x3800010D, 0x3000005B, 0x3000005B, 0x4800097D, 0x4800097D,
+    0x3000005B, 0x3800010F, 0x3000005B, 0x38000110, 0x40000334, 0x40000334, 0x40000334, 0x50001CD5,
+    0x10000002, 0x3000005C, 0x2800001F, 0x2800001F, 0x3000005E, 0x3000005E, 0x3000005E, 0x40000344,
+    0x2000000B, 0x2800001F, 0x2000000B, 0x3000005E, 0x2000000B, 0x2000000B, 0x3800011B, 0x3800011B,
+    0x2000000B, 0x2000000B, 0x3000005F, 0x3000005F, 0x2000000B, 0x2000000B, 0x28000020, 0x28000020,
+    0x2000000B, 0x28000020, 0x2000000B, 0x40000362, 0x30000062, 0x30000062, 0x30000062, 0x40000368,
+    0x18000004, 0x30000062, 0x2000000B, 0x2000000B, 0x4000037A, 0x4000037A, 0x4000037A, 0x38000128,
+    0x18000004, 0x48000A6A, 0x18000004, 0x2000000B, 0x30000065, 0x30000065, 0x30000065, 0x48000A85,
+    0x18000004, 0x30000065, 0x30000065, 0x30000065, 0x18000004, 0x18000004, 0x4000038F, 0x4000038F,
+    0x30000067, 0x40000395, 0x30000067, 0x28000022, 0x30000067, 0x30000067, 0x38000134, 0x38000134,
+    0x2000000D, 0x28000023, 0x28000023, 0x28000023, 0x3000006B, 0x3000006B, 0x3000006B, 0x30000068,
+    0x3000006B, 0x3800013A, 0x3000006B, 0x3000006B, 0x3000006B, 0x3000006B, 0x3800013D, 0x3800013D,
+    0x2000000D, 0x3800013F, 0x3800013F, 0x3800013F, 0x2000000D, 0x2000000D, 0x38000143, 0x38000143,
+    0x18000004, 0x400003CB, 0x18000004, 0x48000B5A, 0x18000004, 0x18000004, 0x38000145, 0x38000145,
+    0x2000000D, 0x3000006D, 0x28000025, 0x28000025, 0x28000025, 0x28000025, 0x28000025, 0x38000149,
+    0x2000000D, 0x400003E0, 0x2000000D, 0x3800014C, 0x3800014E, 0x3800014E, 0x3800014E, 0x400003E8,
+    0x28000026, 0x2000000D, 0x38000151, 0x38000151, 0x28000026, 0x28000026, 0x28000026, 0x28000026,
+    0x28000026, 0x30000071, 0x28000026, 0x38000155, 0x48000C05, 0x48000C05, 0x48000C05, 0x5000240B,
+    0x10000002, 0x38000158, 0x2000000D, 0x2000000D, 0x3800015E, 0x3800015E, 0x3800015E, 0x30000074,
+    0x28000028, 0x40000413, 0x28000028, 0x3800015E, 0x28000028, 0x28000028, 0x48000C56, 0x48000C56,
+    0x30000079, 0x30000076, 0x30000076, 0x30000076, 0x30000079, 0x30000079, 0x28000028, 0x28000028,
+    0x30000079, 0x30000077, 0x30000079, 0x500025A6, 0x40000437, 0x40000437, 0x40000437, 0x48000C9E,
+    0x10000002, 0x38000169, 0x3800016C, 0x3800016C, 0x40000445, 0x40000445, 0x40000445, 0x40000442,
+    0x10000002, 0x50002671, 0x10000002, 0x3000007A, 0x28000029, 0x28000029, 0x28000029, 0x38000170,
+    0x2000000E, 0x3000007D, 0x3000007D, 0x3000007D, 0x2000000E, 0x2000000E, 0x3000007C, 0x3000007C,
+    0x2000000E, 0x3000007D, 0x2000000E, 0x40000464, 0x38000179, 0x38000179, 0x38000179, 0x500027A7,
+    0x18000005, 0x2000000E, 0x3800017C, 0x3800017C, 0x2800002C, 0x2800002C, 0x2800002C, 0x3000007F,
+    0x2800002C, 0x30000080, 0x2800002C, 0x30000080, 0x2800002C, 0x2800002C, 0x40000482, 0x40000482,
+    0x18000005, 0x2800002B, 0x2800002B, 0x2800002B, 0x18000005, 0x18000005, 0x30000082, 0x30000082,
+    0x3800018B, 0x2800002C, 0x3800018B, 0x40000496, 0x3800018B, 0x3800018B, 0x30000083, 0x30000083,
+    0x18000005, 0x48000DE2, 0x18000005, 0x18000005, 0x30000086, 0x30000086, 0x30000086, 0x48000DF9,
+    0x18000005, 0x48000E06, 0x18000005, 0x38000190, 0x38000194, 0x38000194, 0x38000194, 0x50002A5C,
+    0x30000089, 0x18000005, 0x48000E3C, 0x48000E3C, 0x30000089, 0x30000089, 0x38000197, 0x38000197,
+    0x30000089, 0x30000088, 0x30000089, 0x400004C9, 0x3800019A, 0x3800019A, 0x3800019A, 0x50002B40,
+    0x10000002, 0x2800002E, 0x2800002E, 0x2800002E, 0x2800002F, 0x2800002F, 0x2800002F, 0x3800019F,
+    0x2800002F, 0x380001A0, 0x2800002F, 0x380001A2, 0x2800002F, 0x2800002F, 0x2800002F, 0x2800002F,
+    0x20000011, 0x2800002F, 0x380001A6, 0x380001A6, 0x20000011, 0x20000011, 0x380001A9, 0x380001A9,
+    0x20000011, 0x380001A9, 0x20000011, 0x48000EF3, 0x3000008F, 0x3000008F, 0x3000008F, 0x40000502,
+    0x20000011, 0x380001AF, 0x20000010, 0x20000010, 0x20000010, 0x20000010, 0x20000010, 0x48000F2F,
+    0x20000011, 0x380001B1, 0x20000011, 0x30000091, 0x28000031, 0x28000031, 0x28000031, 0x380001B4,
+    0x20000011, 0x28000031, 0x28000031, 0x28000031, 0x20000011, 0x20000011, 0x4000052A, 0x4000052A,
+    0x380001BD, 0x380001BA, 0x380001BD, 0x30000094, 0x380001BD, 0x380001BD, 0x40000535, 0x40000535,
+    0x10000002, 0x20000011, 0x380001C1, 0x380001C1, 0x30000098, 0x30000098, 0x30000098, 0x48000FC8,
+    0x30000098, 0x28000032, 0x30000098, 0x30000098, 0x30000098, 0x30000098, 0x30000097, 0x30000097,
+    0x10000002, 0x40000557, 0x40000557, 0x40000557, 0x10000002, 0x10000002, 0x40000560, 0x40000560,
+    0x3000009B, 0x20000011, 0x3000009B, 0x40000563, 0x3000009B, 0x3000009B, 0x3000009A, 0x3000009A,
+    0x300000A1, 0x4000056E, 0x28000035, 0x28000035, 0x28000035, 0x28000035, 0x28000035, 0x5000311F,
+    0x300000A1, 0x4000057B, 0x300000A1, 0x28000034, 0x3000009D, 0x3000009D, 0x3000009D, 0x380001D6,
+    0x300000A1, 0x300000A1, 0x28000035, 0x28000035, 0x300000A1, 0x300000A1, 0x380001DC, 0x380001DC,
+    0x380001DF, 0x480010BB, 0x380001DF, 0x480010C4, 0x380001DF, 0x380001DF, 0x480010D2, 0x480010D2,
+    0x20000014, 0x380001E1, 0x380001E5, 0x380001E5, 0x400005B1, 0x400005B1, 0x400005B1, 0x380001E5,
+    0x10000002, 0x400005AD, 0x10000002, 0x48001115, 0x10000002, 0x10000002, 0x380001E8, 0x380001E8,
+    0x28000038, 0x300000A4, 0x300000A4, 0x300000A4, 0x28000038, 0x28000038, 0x28000037, 0x28000037,
+    0x28000038, 0x28000037, 0x28000038, 0x380001EE, 0x380001F0, 0x380001F0, 0x380001F0, 0x400005CF,
+    0x20000014, 0x300000A6, 0x28000038, 0x28000038, 0x300000A7, 0x300000A7, 0x300000A7, 0x380001F4,
+    0x20000014, 0x4800119F, 0x20000014, 0x380001F7, 0x380001FA, 0x380001FA, 0x380001FA, 0x28000038,
+    0x20000013, 0x20000013, 0x20000013, 0x20000013, 0x20000013, 0x20000013, 0x300000AA, 0x300000AA,
+    0x20000013, 0x38000200, 0x20000013, 0x38000200, 0x48001208, 0x48001208, 0x48001208, 0x50003611,
+    0x20000014, 0x300000AC, 0x300000AC, 0x300000AC, 0x20000014, 0x20000014, 0x20000014, 0x40000610,
+    0x300000AF, 0x300000AD, 0x300000AF, 0x2800003A, 0x300000AF, 0x300000AF, 0x4000061D, 0x4000061D,
+    0x20000014, 0x300000AF, 0x3800020C, 0x3800020C, 0x20000014, 0x20000014, 0x4000062B, 0x4000062B,
+    0x2800003B, 0x20000014, 0x2800003B, 0x300000B0, 0x2800003B, 0x2800003B, 0x480012A1, 0x480012A1,
+    0x300000B6, 0x4000063B, 0x20000014, 0x20000014, 0x300000B3, 0x300000B3, 0x300000B3, 0x300000B2,
+    0x300000B6, 0x480012D3, 0x300000B6, 0x4000064A, 0x40000653, 0x40000653, 0x40000653, 0x4000064F,
+    0x300000B6, 0x300000B6, 0x3800021E, 0x3800021E, 0x300000B6, 0x300000B6, 0x300000B5, 0x300000B5,
+    0x40000668, 0x40000661, 0x40000668, 0x38000221, 0x40000668, 0x40000668, 0x500039AA, 0x500039AA,
+    0x08000001, 0x2800003D, 0x300000B8, 0x300000B8, 0x2800003E, 0x2800003E, 0x2800003E, 0x300000B8,
+    0x300000BC, 0x38000229, 0x300000BC, 0x2800003E, 0x300000BC, 0x300000BC, 0x3800022D, 0x3800022D,
+    0x18000007, 0x300000BC, 0x2800003E, 0x2800003E, 0x18000007, 0x18000007, 0x300000BC, 0x300000BC,
+    0x18000007, 0x38000232, 0x18000007, 0x50003B45, 0x38000236, 0x38000236, 0x38000236, 0x50003B7B,
+    0x20000016, 0x400006A4, 0x18000007, 0x18000007, 0x300000BE, 0x300000BE, 0x300000BE, 0x38000239,
+    0x20000016, 0x400006AD, 0x20000016, 0x300000BF, 0x28000040, 0x28000040, 0x28000040, 0x400006B6,
+    0x20000016, 0x28000040, 0x28000040, 0x28000040, 0x20000016, 0x20000016, 0x38000241, 0x38000241,
+    0x28000041, 0x300000C1, 0x28000041, 0x38000244, 0x28000041, 0x28000041, 0x38000245, 0x38000245,
+    0x18000008, 0x28000041, 0x28000041, 0x28000041, 0x20000016, 0x20000016, 0x20000016, 0x400006DD,
+    0x38000251, 0x3800024B, 0x38000251, 0x20000016, 0x38000251, 0x38000251, 0x300000C5, 0x300000C5,
+    0x18000008, 0x38000251, 0x400006F1, 0x400006F1, 0x18000008, 0x18000008, 0x20000016, 0x20000016,
+    0x28000043, 0x300000C7, 0x28000043, 0x480014F6, 0x28000043, 0x28000043, 0x40000703, 0x40000703,
+    0x18000008, 0x300000C8, 0x300000CA, 0x300000CA, 0x300000CA, 0x300000CA, 0x300000CA, 0x4800152E,
+    0x18000008, 0x3800025C, 0x18000008, 0x3800025D, 0x4000071E, 0x4000071E, 0x4000071E, 0x4000071C,
+    0x300000CE, 0x18000008, 0x38000263, 0x38000263, 0x300000CE, 0x300000CE, 0x28000044, 0x28000044,
+    0x300000CE, 0x4000072E, 0x300000CE, 0x38000266, 0x300000CD, 0x300000CD, 0x300000CD, 0x480015A0,
+    0x2000001A, 0x4000073D, 0x20000017, 0x20000017, 0x20000017, 0x20000017, 0x20000017, 0x40000746,
+    0x28000047, 0x5000417E, 0x28000047, 0x3800026F, 0x28000047, 0x28000047, 0x300000D0, 0x300000D0,
+    0x28000047, 0x300000D1, 0x300000D1, 0x300000D1, 0x28000047, 0x28000047, 0x28000047, 0x28000047,
+    0x28000047, 0x28000046, 0x28000047, 0x40000763, 0x300000D3, 0x300000D3, 0x300000D3, 0x4800163A,
+    0x2000001A, 0x4000076F, 0x3800027E, 0x3800027E, 0x3800027E, 0x3800027E, 0x3800027E, 0x40000776,
+    0x2000001A, 0x4800166D, 0x2000001A, 0x28000047, 0x300000D7, 0x300000D7, 0x300000D7, 0x38000281,
+    0x18000008, 0x38000287, 0x38000287, 0x38000287, 0x18000008, 0x18000008, 0x40000791, 0x40000791,
+    0x18000008, 0x40000797, 0x18000008, 0x480016C7, 0x3800028A, 0x3800028A, 0x3800028A, 0x4000079C,
+    0x2000001A, 0x300000DA, 0x300000DA, 0x300000DA, 0x2800004A, 0x2800004A, 0x2800004A, 0x300000DA,
+    0x2800004A, 0x28000049, 0x2800004A, 0x28000049, 0x2800004A, 0x2800004A, 0x38000292, 0x38000292,
+    0x2000001A, 0x38000295, 0x38000295, 0x38000295, 0x2000001A, 0x2000001A, 0x300000DD, 0x300000DD,
+    0x3800029C, 0x2800004A, 0x3800029C, 0x38000299, 0x3800029C, 0x3800029C, 0x400007D0, 0x400007D0,
+    0x2800004C, 0x4800177E, 0x2000001A, 0x2000001A, 0x380002A2, 0x380002A2, 0x380002A2, 0x48001796,
+    0x2800004C, 0x300000E0, 0x2800004C, 0x400007E4, 0x20000019, 0x20000019, 0x20000019, 0x5800D592,
+    0x2800004C, 0x2800004C, 0x300000E2, 0x300000E2, 0x2800004C, 0x2800004C, 0x300000E3, 0x300000E3,
+    0x40000803, 0x300000E3, 0x40000803, 0x400007FD, 0x40000803, 0x40000803, 0x48001807, 0x48001807,
+    0x08000001, 0x300000E5, 0x380002B0, 0x380002B0, 0x2000001A, 0x2000001A, 0x2000001A, 0x40000811,
+    0x300000E9, 0x40000815, 0x300000E9, 0x380002B4, 0x300000E9, 0x300000E9, 0x2800004D, 0x2800004D,
+    0x28000050, 0x300000E9, 0x380002B7, 0x380002B7, 0x28000050, 0x28000050, 0x300000E9, 0x300000E9,
+    0x28000050, 0x40000830, 0x28000050, 0x500049AF, 0x40000839, 0x40000839, 0x40000839, 0x380002BD,
+    0x300000F2, 0x2000001A, 0x300000EC, 0x300000EC, 0x300000EC, 0x300000EC, 0x300000EC, 0x300000EB,
+    0x300000F2, 0x40000847, 0x300000F2, 0x300000EC, 0x28000050, 0x28000050, 0x28000050, 0x40000850,
+    0x300000F2, 0x300000EE, 0x300000EE, 0x300000EE, 0x300000F2, 0x300000F2, 0x48001919, 0x48001919,
+    0x380002CF, 0x40000862, 0x380002CF, 0x28000050, 0x380002CF, 0x380002CF, 0x40000869, 0x40000869,
+    0x08000001, 0x300000F2, 0x380002D2, 0x380002D2, 0x380002D8, 0x380002D8, 0x380002D8, 0x48001964,
+    0x4000088A, 0x380002D4, 0x4000088A, 0x380002D8, 0x4000088A, 0x4000088A, 0x40000884, 0x40000884,
+    0x08000001, 0x480019A0, 0x50004CE2, 0x50004CE2, 0x08000001, 0x08000001, 0x300000F4, 0x300000F4,
+    0x28000052, 0x300000F5, 0x28000052, 0x380002DD, 0x28000052, 0x28000052, 0x300000F5, 0x300000F5,
+    0x2000001C, 0x380002E1, 0x28000053, 0x28000053, 0x28000053, 0x28000053, 0x28000053, 0x480019FC,
+    0x2000001C, 0x300000F7, 0x2000001C, 0x380002E6, 0x300000F8, 0x300000F8, 0x300000F8, 0x400008B7,
+    0x2000001C, 0x2000001C, 0x28000053, 0x28000053, 0x2000001C, 0x2000001C, 0x380002ED, 0x380002ED,
+    0x300000FB, 0x48001A57, 0x300000FB, 0x300000FA, 0x300000FB, 0x300000FB, 0x48001A6F, 0x48001A6F,
+    0x1800000A, 0x380002F3, 0x2000001C, 0x2000001C, 0x300000FD, 0x300000FD, 0x300000FD, 0x2000001C,
+    0x2000001D, 0x380002F6, 0x2000001D, 0x300000FD, 0x2000001D, 0x2000001D, 0x300000FE, 0x300000FE,
+    0x2000001D, 0x28000055, 0x28000055, 0x28000055, 0x2000001D, 0x2000001D, 0x30000100, 0x30000100,
+    0x2000001D, 0x30000100, 0x2000001D, 0x380002FF, 0x40000904, 0x40000904, 0x40000904, 0x5000511A,
+    0x1800000A, 0x30000101, 0x28000056, 0x28000056, 0x28000056, 0x28000056, 0x28000056, 0x40000911,
+    0x1800000A, 0x40000914, 0x1800000A, 0x38000308, 0x30000104, 0x30000104, 0x30000104, 0x3800030A,
+    0x30000107, 0x2000001D, 0x2000001D, 0x2000001D, 0x30000107, 0x30000107, 0x4000092C, 0x4000092C,
+    0x30000107, 0x2000001D, 0x30000107, 0x38000311, 0x30000106, 0x30000106, 0x30000106, 0x5800F8B1,
+    0x1800000A, 0x30000107, 0x40000941, 0x40000941, 0x1800000A, 0x1800000A, 0x1800000A, 0x38000317,
+    0x28000059, 0x28000058, 0x28000059, 0x30000109, 0x28000059, 0x28000059, 0x48001BF2, 0x48001BF2,
+    0x1800000A, 0x28000059, 0x40000959, 0x40000959, 0x1800000A, 0x1800000A, 0x38000320, 0x38000320,
+    0x3000010D, 0x3000010D, 0x3000010D, 0x28000059, 0x3000010D, 0x3000010D, 0x48001C3D, 0x48001C3D,
+    0x2800005B, 0x38000325, 0x1800000A, 0x1800000A, 0x4000097D, 0x4000097D, 0x4000097D, 0x40000977,
+    0x2800005B, 0x48001C70, 0x2800005B, 0x5000556D, 0x3000010F, 0x3000010F, 0x3000010F, 0x40000983,
+    0x2800005B, 0x2800005B, 0x30000110, 0x30000110, 0x2800005B, 0x2800005B, 0x40000992, 0x40000992,
+    0x38000334, 0x38000332, 0x38000334, 0x40000998, 0x38000334, 0x38000334, 0x48001CD5, 0x48001CD5,
+    0x10000004, 0x38000337, 0x2800005C, 0x2800005C, 0x2800005C, 0x2800005C, 0x2800005C, 0x30000113,
+    0x2000001F, 0x3800033B, 0x2000001F, 0x2800005C, 0x2000001F, 0x2000001F, 0x3800033E, 0x3800033E,
+    0x2800005E, 0x2000001F, 0x38000340, 0x38000340, 0x2800005E, 0x2800005E, 0x38000344, 0x38000344,
+    0x2800005E, 0x38000344, 0x2800005E, 0x400009CA, 0x2000001F, 0x2000001F, 0x2000001F, 0x400009D0,
+    0x1800000B, 0x30000118, 0x2800005E, 0x2800005E, 0x30000119, 0x30000119, 0x30000119, 0x30000119,
+    0x1800000B, 0x500058E8, 0x1800000B, 0x2800005E, 0x3000011B, 0x3000011B, 0x3000011B, 0x50005939,
+    0x1800000B, 0x38000352, 0x38000352, 0x38000352, 0x1800000B, 0x1800000B, 0x48001DE6, 0x48001DE6,
+    0x2800005F, 0x3000011C, 0x2800005F, 0x38000356, 0x2800005F, 0x2800005F, 0x40000A04, 0x40000A04,
+    0x1800000B, 0x3000011F, 0x3000011F, 0x3000011F, 0x20000020, 0x20000020, 0x20000020, 0x3800035B,
+    0x20000020, 0x40000A16, 0x20000020, 0x20000020, 0x20000020, 0x20000020, 0x40000A1F, 0x40000A1F,
+    0x1800000B, 0x38000362, 0x38000362, 0x38000362, 0x1800000B, 0x1800000B, 0x30000122, 0x30000122,
+    0x28000062, 0x30000122, 0x28000062, 0x40000A31, 0x28000062, 0x28000062, 0x38000368, 0x38000368,
+    0x1800000B, 0x28000061, 0x28000062, 0x28000062, 0x28000062, 0x28000062, 0x28000062, 0x48001ECB,
+    0x1800000B, 0x40000A48, 0x1800000B, 0x40000A4C, 0x38000371, 0x38000371, 0x38000371, 0x38000370,
+    0x3800037A, 0x1800000B, 0x38000374, 0x38000374, 0x3800037A, 0x3800037A, 0x30000128, 0x30000128,
+    0x3800037A, 0x38000376, 0x3800037A, 0x30000128, 0x40000A6A, 0x40000A6A, 0x40000A6A, 0x50005DB5,
+    0x10000004, 0x48001F52, 0x1800000B, 0x1800000B, 0x3000012B, 0x3000012B, 0x3000012B, 0x3000012A,
+    0x28000065, 0x40000A7B, 0x28000065, 0x3000012B, 0x28000065, 0x28000065, 0x40000A85, 0x40000A85,
+    0x28000065, 0x28000064, 0x28000064, 0x28000064, 0x28000065, 0x28000065, 0x28000065, 0x28000065,
+    0x28000065, 0x38000388, 0x28000065, 0x40000A97, 0x3000012E, 0x3000012E, 0x3000012E, 0x50005F84,
+    0x10000004, 0x3800038C, 0x3800038F, 0x3800038F, 0x3800038F, 0x3800038F, 0x3800038F, 0x3800038E,
+    0x10000004, 0x48002009, 0x10000004, 0x38000391, 0x38000395, 0x38000395, 0x38000395, 0x40000AB8,
+    0x28000067, 0x20000022, 0x20000022, 0x20000022, 0x28000067, 0x28000067, 0x38000397, 0x38000397,
+    0x28000067, 0x30000133, 0x28000067, 0x30000133, 0x30000134, 0x30000134, 0x30000134, 0x40000AD0,
+    0x2800006B, 0x28000067, 0x40000ADC, 0x40000ADC, 0x20000023, 0x20000023, 0x20000023, 0x28000067,
+    0x20000023, 0x30000136, 0x20000023, 0x380003A3, 0x20000023, 0x20000023, 0x480020BF, 0x480020BF,
+    0x2800006B, 0x380003A7, 0x380003A7, 0x380003A7, 0x2800006B, 0x2800006B, 0x28000068, 0x28000068,
+    0x3000013A, 0x3000013A, 0x3000013A, 0x380003AA, 0x3000013A, 0x3000013A, 0x380003AC, 0x380003AC,
+    0x2800006B, 0x40000B09, 0x2800006B, 0x2800006B, 0x20000023, 0x20000023, 0x20000023, 0x48002132,
+    0x2800006B, 0x40000B15, 0x2800006B, 0x380003B3, 0x3000013D, 0x3000013D, 0x3000013D, 0x40000B1D,
+    0x3000013F, 0x2800006B, 0x40000B27, 0x40000B27, 0x3000013F, 0x3000013F, 0x40000B2D, 0x40000B2D,
+    0x3000013F, 0x2800006A, 0x3000013F, 0x380003BB, 0x480021A4, 0x480021A4, 0x480021A4, 0x500064EA,
+    0x1800000D, 0x2800006B, 0x380003C2, 0x380003C2, 0x30000143, 0x30000143, 0x30000143, 0x380003C2,
+    0x380003CB, 0x480021DA, 0x380003CB, 0x380003C5, 0x380003CB, 0x380003CB, 0x30000143, 0x30000143,
+    0x10000004, 0x380003CB, 0x40000B5A, 0x40000B5A, 0x10000004, 0x10000004, 0x40000B63, 0x40000B63,
+    0x10000004, 0x4800222B, 0x10000004, 0x5801338B, 0x30000145, 0x30000145, 0x30000145, 0x380003CE,
+    0x20000025, 0x30000146, 0x2800006D, 0x2800006D, 0x2800006D, 0x2800006D, 0x2800006D, 0x40000B78,
+    0x20000025, 0x380003D4, 0x20000025, 0x2800006D, 0x2800006E, 0x2800006E, 0x2800006E, 0x380003D7,
+    0x20000025, 0x2800006E, 0x2800006E, 0x2800006E, 0x20000025, 0x20000025, 0x30000149, 0x30000149,
+    0x380003E0, 0x380003DD, 0x380003E0, 0x2800006E, 0x380003E0, 0x380003E0, 0x380003DF, 0x380003DF,
+    0x1800000D, 0x20000025, 0x3000014C, 0x3000014C, 0x20000025, 0x20000025, 0x20000025, 0x40000BAB,
+    0x3000014E, 0x380003E6, 0x3000014E, 0x20000025, 0x3000014E, 0x3000014E, 0x380003E8, 0x380003E8,
+    0x1800000D, 0x3000014E, 0x40000BBF, 0x40000BBF, 0x1800000D, 0x1800000D, 0x3000014F, 0x3000014F,
+    0x30000151, 0x28000070, 0x30000151, 0x40000BCB, 0x30000151, 0x30000151, 0x28000070, 0x28000070,
+    0x20000026, 0x380003F2, 0x20000026, 0x20000026, 0x20000026, 0x20000026, 0x20000026, 0x50006AC9,
+    0x20000026, 0x30000152, 0x20000026, 0x380003F8, 0x28000071, 0x28000071, 0x28000071, 0x480023C0,
+    0x20000026, 0x20000026, 0x30000155, 0x30000155, 0x20000026, 0x20000026, 0x30000155, 0x30000155,
+    0x40000C05, 0x40000BFC, 0x40000C05, 0x40000BFF, 0x40000C05, 0x40000C05, 0x4800240B, 0x4800240B,
+    0x20000028, 0x38000404, 0x30000158, 0x30000158, 0x30000158, 0x30000158, 0x30000158, 0x30000158,
+    0x1800000D, 0x38000407, 0x1800000D, 0x40000C1A, 0x1800000D, 0x1800000D, 0x40000C20, 0x40000C20,
+    0x3000015E, 0x3000015A, 0x3000015A, 0x3000015A, 0x3000015E, 0x3000015E, 0x28000074, 0x28000074,
+    0x3000015E, 0x28000074, 0x3000015E, 0x40000C32, 0x38000413, 0x38000413, 0x38000413, 0x40000C37,
+    0x20000028, 0x28000074, 0x3000015E, 0x3000015E, 0x38000418, 0x38000418, 0x38000418, 0x480024CE,
+    0x20000028, 0x50006E87, 0x20000028, 0x40000C4D, 0x40000C56, 0x40000C56, 0x40000C56, 0x3800041C,
+    0x28000076, 0x1800000D, 0x1800000D, 0x1800000D, 0x28000076, 0x28000076, 0x30000160, 0x30000160,
+    0x28000076, 0x30000161, 0x28000076, 0x30000161, 0x40000C6B, 0x40000C6B, 0x40000C6B, 0x40000C6A,
+    0x28000079, 0x28000076, 0x38000427, 0x38000427, 0x20000028, 0x20000028, 0x20000028, 0x38000428,
+    0x28000077, 0x3800042A, 0x28000077, 0x28000077, 0x28000077, 0x28000077, 0x30000164, 0x30000164,
+    0x28000079, 0x28000077, 0x480025A6, 0x480025A6, 0x28000079, 0x28000079, 0x38000431, 0x38000431,
+    0x38000437, 0x20000028, 0x38000437, 0x38000433, 0x38000437, 0x38000437, 0x40000C9E, 0x40000C9E,
+    0x3000016C, 0x40000CA3, 0x28000079, 0x28000079, 0x30000169, 0x30000169, 0x30000169, 0x38000439,
+    0x3000016C, 0x4800260C, 0x3000016C, 0x40000CB2, 0x3000016A, 0x3000016A, 0x3000016A, 0x3800043D,
+    0x38000445, 0x3000016C, 0x40000CC2, 0x40000CC2, 0x38000445, 0x38000445, 0x38000442, 0x38000442,
+    0x40000CD0, 0x38000443, 0x40000CD0, 0x48002663, 0x48002671, 0x48002671, 0x50007354, 0x580159FD,
+    0x08000002, 0x38000449, 0x2800007A, 0x2800007A, 0x30000170, 0x30000170, 0x30000170, 0x2800007A,
+    0x20000029, 0x3800044C, 0x20000029, 0x30000170, 0x20000029, 0x20000029, 0x30000170, 0x30000170,
+    0x2800007D, 0x20000029, 0x38000452, 0x38000452, 0x2800007D, 0x2800007D, 0x20000029, 0x20000029,
+    0x2800007D, 0x38000455, 0x2800007D, 0x40000CFE, 0x30000173, 0x30000173, 0x30000173, 0x40000D04,
+    0x1800000E, 0x30000173, 0x2800007D, 0x2800007D, 0x2800007C, 0x2800007C, 0x2800007C, 0x40000D13,
+    0x1800000E, 0x40000D15, 0x1800000E, 0x30000175, 0x2800007D, 0x2800007D, 0x2800007D, 0x40000D1E,
+    0x1800000E, 0x38000464, 0x38000464, 0x38000464, 0x1800000E, 0x1800000E, 0x48002783, 0x48002783,
+    0x30000179, 0x2800007D, 0x30000179, 0x38000467, 0x30000179, 0x30000179, 0x480027A7, 0x480027A7,
+    0x2000002C, 0x3800046D, 0x3800046D, 0x3800046D, 0x1800000E, 0x1800000E, 0x1800000E, 0x40000D45,
+    0x3000017C, 0x480027DD, 0x3000017C, 0x1800000E, 0x3000017C, 0x3000017C, 0x3000017B, 0x3000017B,
+    0x2000002C, 0x3000017C, 0x38000473, 0x38000473, 0x2000002C, 0x2000002C, 0x2800007F, 0x2800007F,
+    0x28000080, 0x2800007F, 0x28000080, 0x5000788C, 0x28000080, 0x28000080, 0x38000479, 0x38000479,
+    0x2000002C, 0x3800047B, 0x28000080, 0x28000080, 0x28000080, 0x28000080, 0x28000080, 0x48002867,
+    0x2000002C, 0x3800047F, 0x2000002C, 0x4800287F, 0x38000482, 0x38000482, 0x38000482, 0x4800288D,
+    0x2000002B, 0x2000002C, 0x30000182, 0x30000182, 0x2000002B, 0x2000002B, 0x38000488, 0x38000488,
+    0x2000002B, 0x40000D96, 0x2000002B, 0x40000D9A, 0x3800048A, 0x3800048A, 0x3800048A, 0x480028D9,
+    0x10000005, 0x30000184, 0x28000082, 0x28000082, 0x28000082, 0x28000082, 0x28000082, 0x30000185,
+    0x2000002C, 0x40000DAF, 0x2000002C, 0x40000DB5, 0x2000002C, 0x2000002C, 0x38000493, 0x38000493,
+    0x3000018B, 0x38000496, 0x38000496, 0x38000496, 0x3000018B, 0x3000018B, 0x2000002C, 0x2000002C,
+    0x3000018B, 0x3800049A, 0x3000018B, 0x38000499, 0x28000083, 0x28000083, 0x28000083, 0x5801750A,
+    0x10000005, 0x3800049D, 0x3000018B, 0x3000018B, 0x40000DE2, 0x40000DE2, 0x40000DE2, 0x4800299B,
+    0x10000005, 0x50007CF1, 0x10000005, 0x380004A3, 0x2000002C, 0x2000002C, 0x2000002C, 0x480029C3,
+    0x28000086, 0x3000018E, 0x3000018E, 0x3000018E, 0x28000086, 0x28000086, 0x40000DF9, 0x40000DF9,
+    0x28000086, 0x3000018E, 0x28000086, 0x40000E00, 0x40000E06, 0x40000E06, 0x40000E06, 0x380004AC,
+    0x10000005, 0x30000190, 0x30000190, 0x30000190, 0x30000194, 0x30000194, 0x30000194, 0x380004B1,
+    0x30000194, 0x28000086, 0x30000194, 0x380004B5, 0x30000194, 0x30000194, 0x48002A5C, 0x48002A5C,
+    0x10000005, 0x380004B8, 0x380004B8, 0x380004B8, 0x10000005, 0x10000005, 0x380004BA, 0x380004BA,
+    0x40000E3C, 0x380004BE, 0x40000E3C, 0x40000E33, 0x40000E3C, 0x40000E3C, 0x40000E38, 0x40000E38,
+    0x28000089, 0x50008024, 0x10000005, 0x10000005, 0x30000197, 0x30000197, 0x30000197, 0x40000E45,
+    0x28000089, 0x380004C3, 0x28000089, 0x380004C4, 0x28000088, 0x28000088, 0x28000088, 0x500080DB,
+    0x28000089, 0x28000089, 0x380004C9, 0x380004C9, 0x28000089, 0x28000089, 0x30000199, 0x30000199,
+    0x3000019A, 0x380004CC, 0x3000019A, 0x48002B30, 0x3000019A, 0x3000019A, 0x48002B40, 0x48002B40,
+    0x18000011, 0x28000089, 0x380004D3, 0x380004D3, 0x2000002E, 0x2000002E, 0x2000002E, 0x380004D3,
+    0x2000002E, 0x3000019C, 0x2000002E, 0x3000019D, 0x2000002E, 0x2000002E, 0x380004D9, 0x380004D9,
+    0x2000002F, 0x2000002E, 0x48002BA9, 0x48002BA9, 0x2000002F, 0x2000002F, 0x3000019F, 0x3000019F,
+    0x2000002F, 0x3000019F, 0x2000002F, 0x40000E98, 0x300001A0, 0x300001A0, 0x300001A0, 0x40000E9F,
+    0x2000002F, 0x2800008B, 0x300001A2, 0x300001A2, 0x300001A2, 0x300001A2, 0x300001A2, 0x380004E4,
+    0x2000002F, 0x380004E5, 0x2000002F, 0x380004E7, 0x2000002F, 0x2000002F, 0x2000002F, 0x380004E8,
+    0x2000002F, 0x2800008C, 0x2800008C, 0x2800008C, 0x2000002F, 0x2000002F, 0x40000EC6, 0x40000EC6,
+    0x300001A6, 0x380004EE, 0x300001A6, 0x300001A6, 0x300001A6, 0x300001A6, 0x48002C74, 0x48002C74,
+    0x18000011, 0x2000002F, 0x40000EDE, 0x40000EDE, 0x300001A9, 0x300001A9, 0x300001A9, 0x500085D6,
+    0x300001A9, 0x380004F7, 0x300001A9, 0x300001A9, 0x300001A9, 0x300001A9, 0x40000EEC, 0x40000EEC,
+    0x18000011, 0x40000EF3, 0x40000EF3, 0x40000EF3, 0x18000011, 0x18000011, 0x2800008E, 0x2800008E,
+    0x2800008F, 0x300001AB, 0x2800008F, 0x38000500, 0x2800008F, 0x2800008F, 0x38000502, 0x38000502,
+    0x18000010, 0x40000F0B, 0x300001AF, 0x300001AF, 0x300001AF, 0x300001AF, 0x300001AF, 0x48002D35,
+    0x18000010, 0x2800008F, 0x18000010, 0x38000509, 0x3800050B, 0x3800050B, 0x3800050B, 0x300001AE,
+    0x18000010, 0x18000010, 0x3800050F, 0x3800050F, 0x18000010, 0x18000010, 0x40000F2F, 0x40000F2F,
+    0x300001B1, 0x500088AF, 0x300001B1, 0x38000511, 0x300001B1, 0x300001B1, 0x40000F38, 0x40000F38,
+    0x18000011, 0x300001B2, 0x28000091, 0x28000091, 0x28000091, 0x28000091, 0x28000091, 0x28000091,
+    0x20000031, 0x40000F4A, 0x20000031, 0x3800051A, 0x20000031, 0x20000031, 0x300001B4, 0x300001B4,
+    0x20000031, 0x28000092, 0x28000092, 0x28000092, 0x20000031, 0x20000031, 0x28000092, 0x28000092,
+    0x20000031, 0x28000092, 0x20000031, 0x48002E31, 0x38000524, 0x38000524, 0x38000524, 0x40000F6B,
+    0x18000011, 0x38000526, 0x3800052A, 0x3800052A, 0x3800052A, 0x3800052A, 0x3800052A, 0x300001B8,
+    0x18000011, 0x40000F7C, 0x18000011, 0x48002E82, 0x300001BA, 0x300001BA, 0x300001BA, 0x3800052D,
+    0x300001BD, 0x28000094, 0x28000094, 0x28000094, 0x300001BD, 0x300001BD, 0x300001BB, 0x300001BB,
+    0x300001BD, 0x28000094, 0x300001BD, 0x40000F9B, 0x38000535, 0x38000535, 0x38000535, 0x50008C90,
+    0x28000098, 0x38000538, 0x40000FA9, 0x40000FA9, 0x18000011, 0x18000011, 0x18000011, 0x40000FAD,
+    0x300001C1, 0x3800053C, 0x300001C1, 0x28000095, 0x300001C1, 0x300001C1, 0x40000FB9, 0x40000FB9,
+    0x28000098, 0x300001C1, 0x300001C0, 0x300001C0, 0x28000098, 0x28000098, 0x40000FC8, 0x40000FC8,
+    0x20000032, 0x20000032, 0x20000032, 0x38000545, 0x20000032, 0x20000032, 0x50008E61, 0x50008E61,
+    0x28000098, 0x38000548, 0x28000098, 0x28000098, 0x300001C4, 0x300001C4, 0x300001C4, 0x40000FDF,
+    0x28000098, 0x40000FE3, 0x28000098, 0x40000FE6, 0x28000097, 0x28000097, 0x28000097, 0x48002FC2,
+    0x38000557, 0x28000098, 0x300001C6, 0x300001C6, 0x38000557, 0x38000557, 0x40000FFA, 0x40000FFA,
+    0x38000557, 0x40000FFE, 0x38000557, 0x300001C7, 0x4800300E, 0x4800300E, 0x4800300E, 0x5801B07D,
+    0x08000002, 0x3800055A, 0x300001CA, 0x300001CA, 0x38000560, 0x38000560, 0x38000560, 0x3800055C,
+    0x18000011, 0x300001CA, 0x18000011, 0x38000560, 0x18000011, 0x18000011, 0x40001022, 0x40001022,
+    0x2800009B, 0x18000011, 0x38000563, 0x38000563, 0x2800009B, 0x2800009B, 0x300001CD, 0x300001CD,
+    0x2800009B, 0x300001CD, 0x2800009B, 0x38000566, 0x2800009A, 0x2800009A, 0x2800009A, 0x38000568,
+    0x20000035, 0x2800009A, 0x2800009B, 0x2800009B, 0x3800056E, 0x3800056E, 0x3800056E, 0x300001CF,
+    0x20000035, 0x40001049, 0x20000035, 0x2800009B, 0x2800009B, 0x2800009B, 0x2800009B, 0x40001052,
+    0x20000035, 0x38000575, 0x38000575, 0x38000575, 0x20000035, 0x20000035, 0x4800311F, 0x4800311F,
+    0x3800057B, 0x38000577, 0x3800057B, 0x300001D3, 0x3800057B, 0x3800057B, 0x300001D3, 0x300001D3,
+    0x280000A1, 0x20000034, 0x20000034, 0x20000034, 0x2800009D, 0x2800009D, 0x2800009D, 0x3800057E,
+    0x2800009D, 0x300001D5, 0x2800009D, 0x2800009D, 0x2800009D, 0x2800009D, 0x300001D6, 0x300001D6,
+    0x280000A1, 0x4000108E, 0x4000108E, 0x4000108E, 0x280000A1, 0x280000A1, 0x300001D8, 0x300001D8,
+    0x20000035, 0x38000589, 0x20000035, 0x40001099, 0x20000035, 0x20000035, 0x400010A0, 0x400010A0,
+    0x280000A1, 0x3800058D, 0x300001DC, 0x300001DC, 0x300001DC, 0x300001DC, 0x300001DC, 0x400010AC,
+    0x280000A1, 0x38000590, 0x280000A1, 0x300001DB, 0x400010BB, 0x400010BB, 0x400010BB, 0x4800322A,
+    0x300001DF, 0x280000A1, 0x400010C4, 0x400010C4, 0x300001DF, 0x300001DF, 0x20000035, 0x20000035,
+    0x300001DF, 0x38000599, 0x300001DF, 0x300001DE, 0x400010D2, 0x400010D2, 0x400010D2, 0x48003275,
+    0x08000002, 0x400010D9, 0x280000A1, 0x280000A1, 0x300001E1, 0x300001E1, 0x300001E1, 0x280000A0,
+    0x300001E5, 0x380005A1, 0x300001E5, 0x300001E1, 0x300001E5, 0x300001E5, 0x400010ED, 0x400010ED,
+    0x380005B1, 0x380005A8, 0x380005A8, 0x380005A8, 0x380005B1, 0x380005B1, 0x300001E5, 0x300001E5,
+    0x380005B1, 0x380005AB, 0x380005B1, 0x480032FE, 0x380005AD, 0x380005AD, 0x380005AD, 0x40001105,
+    0x08000002, 0x4000110C, 0x40001115, 0x40001115, 0x48003341, 0x48003341, 0x48003341, 0x48003338,
+    0x08000002, 0x5801CD51, 0x08000002, 0x380005B4, 0x300001E8, 0x300001E8, 0x300001E8, 0x300001E7,
+    0x280000A4, 0x280000A3, 0x280000A3, 0x280000A3, 0x280000A4, 0x280000A4, 0x380005BA, 0x380005BA,
+    0x280000A4, 0x280000A3, 0x280000A4, 0x380005BC, 0x300001EA, 0x300001EA, 0x300001EA, 0x480033A9,
+    0x20000038, 0x280000A4, 0x300001EB, 0x300001EB, 0x20000037, 0x20000037, 0x20000037, 0x380005C3,
+    0x20000037, 0x280000A4, 0x20000037, 0x380005C6, 0x20000037, 0x20000037, 0x480033F8, 0x480033F8,
+    0x20000038, 0x300001EE, 0x300001EE, 0x300001EE, 0x20000038, 0x20000038, 0x380005CC, 0x380005CC,
+    0x300001F0, 0x20000037, 0x300001F0, 0x48003434, 0x300001F0, 0x300001F0, 0x380005CF, 0x380005CF,
+    0x20000038, 0x40001171, 0x20000038, 0x20000038, 0x280000A6, 0x280000A6, 0x280000A6, 0x50009D40,
+    0x20000038, 0x4000117D, 0x20000038, 0x40001181, 0x300001F3, 0x300001F3, 0x300001F3, 0x48003490,
+    0x280000A7, 0x20000038, 0x4000118F, 0x4000118F, 0x280000A7, 0x280000A7, 0x300001F4, 0x300001F4,
+    0x280000A7, 0x380005DE, 0x280000A7, 0x480034CD, 0x4000119F, 0x4000119F, 0x4000119F, 0x480034DC,
+    0x18000014, 0x300001F7, 0x300001F7, 0x300001F7, 0x20000038, 0x20000038, 0x20000038, 0x400011AE,
+    0x300001FA, 0x400011B1, 0x300001FA, 0x400011B7, 0x300001FA, 0x300001FA, 0x20000038, 0x20000038,
+    0x18000013, 0x300001FA, 0x300001F9, 0x300001F9, 0x18000013, 0x18000013, 0x300001FA, 0x300001FA,
+    0x18000013, 0x400011CC, 0x18000013, 0x5000A02E, 0x280000A9, 0x280000A9, 0x280000A9, 0x48003578,
+    0x18000013, 0x300001FC, 0x280000AA, 0x280000AA, 0x280000AA, 0x280000AA, 0x280000AA, 0x400011E0,
+    0x18000013, 0x400011E4, 0x18000013, 0x380005F9, 0x30000200, 0x30000200, 0x30000200, 0x400011ED,
+    0x18000013, 0x30000200, 0x30000200, 0x30000200, 0x18000013, 0x18000013, 0x380005FE, 0x380005FE,
+    0x40001208, 0x400011FF, 0x40001208, 0x38000602, 0x40001208, 0x40001208, 0x48003611, 0x48003611,
+    0x18000014, 0x18000013, 0x30000202, 0x30000202, 0x280000AC, 0x280000AC, 0x280000AC, 0x40001213,
+    0x280000AC, 0x30000203, 0x280000AC, 0x280000AC, 0x280000AC, 0x280000AC, 0x3800060B, 0x3800060B,
+    0x18000014, 0x3800060D, 0x3800060D, 0x3800060D, 0x18000014, 0x18000014, 0x38000610, 0x38000610,
+    0x280000AD, 0x280000AD, 0x280000AD, 0x38000611, 0x280000AD, 0x280000AD, 0x38000614, 0x38000614,
+    0x280000AF, 0x480036BC, 0x2000003A, 0x2000003A, 0x2000003A, 0x2000003A, 0x2000003A, 0x480036D1,
+    0x280000AF, 0x38000619, 0x280000AF, 0x30000209, 0x3800061D, 0x3800061D, 0x3800061D, 0x40001253,
+    0x280000AF, 0x280000AF, 0x2000003A, 0x2000003A, 0x280000AF, 0x280000AF, 0x3000020B, 0x3000020B,
+    0x3000020C, 0x40001264, 0x3000020C, 0x40001267, 0x3000020C, 0x3000020C, 0x5000A5CB, 0x5000A5CB,
+    0x18000014, 0x40001274, 0x3000020E, 0x3000020E, 0x3800062B, 0x3800062B, 0x3800062B, 0x3000020E,
+    0x18000014, 0x48003779, 0x18000014, 0x40001282, 0x18000014, 0x18000014, 0x3000020F, 0x3000020F,
+    0x2000003B, 0x280000B0, 0x280000B0, 0x280000B0, 0x2000003B, 0x2000003B, 0x30000212, 0x30000212,
+    0x2000003B, 0x30000212, 0x2000003B, 0x30000211, 0x400012A1, 0x400012A1, 0x400012A1, 0x38000635,
+    0x18000014, 0x38000638, 0x2000003B, 0x2000003B, 0x3800063B, 0x3800063B, 0x3800063B, 0x400012AD,
+    0x18000014, 0x400012B0, 0x18000014, 0x30000214, 0x30000215, 0x30000215, 0x30000215, 0x30000215,
+    0x280000B3, 0x280000B3, 0x280000B3, 0x280000B3, 0x280000B3, 0x280000B3, 0x280000B2, 0x280000B2,
+    0x280000B3, 0x30000217, 0x280000B3, 0x30000217, 0x400012D3, 0x400012D3, 0x400012D3, 0x48003877,
+    0x280000B6, 0x3800064A, 0x3800064A, 0x3800064A, 0x18000014, 0x18000014, 0x18000014, 0x480038A2,
+    0x38000653, 0x3800064D, 0x38000653, 0x3000021B, 0x38000653, 0x38000653, 0x3800064F, 0x3800064F,
+    0x280000B6, 0x38000653, 0x400012F5, 0x400012F5, 0x280000B6, 0x280000B6, 0x480038F3, 0x480038F3,
+    0x3000021E, 0x18000014, 0x3000021E, 0x38000656, 0x3000021E, 0x3000021E, 0x40001306, 0x40001306,
+    0x280000B6, 0x38000659, 0x280000B6, 0x280000B6, 0x280000B5, 0x280000B5, 0x280000B5, 0x3800065C,
+    0x280000B6, 0x5000ABCE, 0x280000B6, 0x3800065E, 0x38000661, 0x38000661, 0x38000661, 0x4800395F,
+    0x38000668, 0x280000B6, 0x30000221, 0x30000221, 0x38000668, 0x38000668, 0x38000665, 0x38000665,
+    0x38000668, 0x48003995, 0x38000668, 0x40001334, 0x480039AA, 0x480039AA, 0x480039AA, 0x580206FC,
+    0x10000008, 0x30000224, 0x3800066E, 0x3800066E, 0x2000003D, 0x2000003D, 0x2000003D, 0x3800066E,
+    0x280000B8, 0x4000134C, 0x280000B8, 0x2000003D, 0x280000B8, 0x280000B8, 0x30000226, 0x30000226,
+    0x2000003E, 0x280000B8, 0x30000227, 0x30000227, 0x2000003E, 0x2000003E, 0x280000B8, 0x280000B8,
+    0x2000003E, 0x40001367, 0x2000003E, 0x48003A33, 0x30000229, 0x30000229, 0x30000229, 0x48003A45,
+    0x280000BC, 0x3800067C, 0x2000003E, 0x2000003E, 0x38000680, 0x38000680, 0x38000680, 0x3000022A,
+    0x280000BC, 0x3800067F, 0x280000BC, 0x280000B9, 0x3000022D, 0x3000022D, 0x3000022D, 0x38000682,
+    0x280000BC, 0x3000022D, 0x3000022D, 0x3000022D, 0x280000BC, 0x280000BC, 0x40001394, 0x40001394,
+    0x2000003E, 0x38000689, 0x2000003E, 0x4000139D, 0x2000003E, 0x2000003E, 0x400013A0, 0x400013A0,
+    0x10000007, 0x30000230, 0x30000230, 0x30000230, 0x280000BC, 0x280000BC, 0x280000BC, 0x3800068F,
+    0x30000232, 0x400013B2, 0x30000232, 0x280000BC, 0x30000232, 0x30000232, 0x280000BB, 0x280000BB,
+    0x10000007, 0x30000232, 0x48003B45, 0x48003B45, 0x10000007, 0x10000007, 0x280000BC, 0x280000BC,
+    0x30000236, 0x3800069B, 0x30000236, 0x400013CD, 0x30000236, 0x30000236, 0x48003B7B, 0x48003B7B,
+    0x10000007, 0x3800069E, 0x380006A4, 0x380006A4, 0x380006A4, 0x380006A4, 0x380006A4, 0x5000B2DF,
+    0x10000007, 0x400013E5, 0x10000007, 0x400013E8, 0x48003BCC, 0x48003BCC, 0x48003BCC, 0x48003BC6,
+    0x280000BE, 0x10000007, 0x30000238, 0x30000238, 0x280000BE, 0x280000BE, 0x30000239, 0x30000239,
+    0x280000BE, 0x380006AA, 0x280000BE, 0x30000239, 0x380006AD, 0x380006AD, 0x380006AD, 0x5000B435,
+    0x18000016, 0x380006AF, 0x280000BF, 0x280000BF, 0x280000BF, 0x280000BF, 0x280000BF, 0x380006B2,
+    0x20000040, 0x48003C46, 0x20000040, 0x3000023C, 0x20000040, 0x20000040, 0x380006B6, 0x380006B6,
+    0x20000040, 0x380006B9, 0x380006B9, 0x380006B9, 0x20000040, 0x20000040, 0x20000040, 0x20000040,
+    0x20000040, 0x3000023F, 0x20000040, 0x48003C9B, 0x380006BF, 0x380006BF, 0x380006BF, 0x5000B603,
+    0x18000016, 0x48003CBF, 0x30000241, 0x30000241, 0x30000241, 0x30000241, 0x30000241, 0x48003CD4,
+    0x18000016, 0x4000144A, 0x18000016, 0x30000242, 0x280000C1, 0x280000C1, 0x280000C1, 0x40001454,
+    0x20000041, 0x30000244, 0x30000244, 0x30000244, 0x20000041, 0x20000041, 0x380006CB, 0x380006CB,
+    0x20000041, 0x380006CD, 0x20000041, 0x40001468, 0x30000245, 0x30000245, 0x30000245, 0x48003D46,
+    0x18000016, 0x280000C2, 0x280000C2, 0x280000C2, 0x20000041, 0x20000041, 0x20000041, 0x380006D4,
+    0x20000041, 0x30000248, 0x20000041, 0x30000248, 0x20000041, 0x20000041, 0x40001487, 0x40001487,
+    0x18000016, 0x40001490, 0x40001490, 0x40001490, 0x18000016, 0x18000016, 0x380006DD, 0x380006DD,
+    0x3000024B, 0x3000024B, 0x3000024B, 0x3000024A, 0x3000024B, 0x3000024B, 0x380006E0, 0x380006E0,
+    0x30000251, 0x400014A5, 0x18000016, 0x18000016, 0x3000024D, 0x3000024D, 0x3000024D, 0x400014AD,
+    0x30000251, 0x380006E6, 0x30000251, 0x48003E1E, 0x280000C5, 0x280000C5, 0x280000C5, 0x5000BA85,
+    0x30000251, 0x30000251, 0x380006EC, 0x380006EC, 0x30000251, 0x30000251, 0x280000C5, 0x280000C5,
+    0x380006F1, 0x380006EF, 0x380006F1, 0x48003E69, 0x380006F1, 0x380006F1, 0x5000BB6A, 0x5000BB6A,
+    0x10000008, 0x380006F5, 0x400014E1, 0x400014E1, 0x18000016, 0x18000016, 0x18000016, 0x48003EA5,
+    0x280000C7, 0x380006F7, 0x280000C7, 0x30000253, 0x280000C7, 0x280000C7, 0x30000254, 0x30000254,
+    0x20000043, 0x280000C7, 0x400014F6, 0x400014F6, 0x20000043, 0x20000043, 0x280000C7, 0x280000C7,
+    0x20000043, 0x38000700, 0x20000043, 0x48003F01, 0x38000703, 0x38000703, 0x38000703, 0x30000256,
+    0x280000CA, 0x280000C8, 0x280000C8, 0x280000C8, 0x280000C8, 0x280000C8, 0x280000C8, 0x38000707,
+    0x280000CA, 0x48003F47, 0x280000CA, 0x3800070A, 0x20000043, 0x20000043, 0x20000043, 0x48003F62,
+    0x280000CA, 0x38000710, 0x38000710, 0x38000710, 0x280000CA, 0x280000CA, 0x4000152E, 0x4000152E,
+    0x3000025C, 0x48003F98, 0x3000025C, 0x20000043, 0x3000025C, 0x3000025C, 0x48003FAD, 0x48003FAD,
+    0x10000008, 0x280000CA, 0x3000025D, 0x3000025D, 0x3000025F, 0x3000025F, 0x3000025F, 0x40001547,
+    0x3800071E, 0x4000154D, 0x3800071E, 0x3000025F, 0x3800071E, 0x3800071E, 0x3800071C, 0x3800071C,
+    0x10000008, 0x4000155B, 0x48004012, 0x48004012, 0x10000008, 0x10000008, 0x38000722, 0x38000722,
+    0x30000263, 0x280000CB, 0x30000263, 0x40001568, 0x30000263, 0x30000263, 0x38000725, 0x38000725,
+    0x280000CE, 0x30000262, 0x20000044, 0x20000044, 0x20000044, 0x20000044, 0x20000044, 0x5000C149,
+    0x280000CE, 0x3800072B, 0x280000CE, 0x40001583, 0x3800072E, 0x3800072E, 0x3800072E, 0x3800072D,
+    0x280000CE, 0x280000CE, 0x30000266, 0x30000266, 0x280000CE, 0x280000CE, 0x30000266, 0x30000266,
+    0x280000CD, 0x40001598, 0x280000CD, 0x38000734, 0x280000CD, 0x280000CD, 0x400015A0, 0x400015A0,
+    0x20000047, 0x30000268, 0x280000CE, 0x280000CE, 0x3800073D, 0x3800073D, 0x3800073D, 0x280000CE,
+    0x18000017, 0x30000269, 0x18000017, 0x3800073D, 0x18000017, 0x18000017, 0x280000CE, 0x280000CE,
+    0x18000017, 0x3000026C, 0x3000026C, 0x3000026C, 0x18000017, 0x18000017, 0x38000746, 0x38000746,
+    0x18000017, 0x38000746, 0x18000017, 0x400015CE, 0x4800417E, 0x4800417E, 0x4800417E, 0x4800417A,
+    0x20000047, 0x38000749, 0x3000026F, 0x3000026F, 0x3000026F, 0x3000026F, 0x3000026F, 0x3800074B,
+    0x20000047, 0x3800074C, 0x20000047, 0x400015E9, 0x280000D0, 0x280000D0, 0x280000D0, 0x400015EF,
+    0x280000D1, 0x280000D1, 0x280000D1, 0x280000D1, 0x280000D1, 0x280000D1, 0x38000754, 0x38000754,
+    0x280000D1, 0x280000D1, 0x280000D1, 0x30000272, 0x38000758, 0x38000758, 0x38000758, 0x5000C63A,
+    0x20000047, 0x3800075B, 0x3800075B, 0x3800075B, 0x20000047, 0x20000047, 0x20000047, 0x30000274,
+    0x20000046, 0x30000275, 0x20000046, 0x38000761, 0x20000046, 0x20000046, 0x40001621, 0x40001621,
+    0x20000047, 0x20000046, 0x38000763, 0x38000763, 0x20000047, 0x20000047, 0x30000277, 0x30000277,
+    0x280000D3, 0x280000D3, 0x280000D3, 0x30000278, 0x280000D3, 0x280000D3, 0x4000163A, 0x4000163A,
+    0x3000027E, 0x40001640, 0x20000047, 0x20000047, 0x3800076F, 0x3800076F, 0x3800076F, 0x3800076D,
+    0x3000027E, 0x4000164B, 0x3000027E, 0x480042EB, 0x38000773, 0x38000773, 0x38000773, 0x480042FB,
+    0x3000027E, 0x3000027E, 0x280000D4, 0x280000D4, 0x3000027E, 0x3000027E, 0x38000776, 0x38000776,
+    0x4000166D, 0x3000027D, 0x4000166D, 0x38000778, 0x4000166D, 0x4000166D, 0x5000C9D4, 0x5000C9D4,
+    0x1800001A, 0x40001676, 0x20000047, 0x20000047, 0x30000281, 0x30000281, 0x30000281, 0x3800077F,
+    0x280000D7, 0x30000280, 0x280000D7, 0x30000281, 0x280000D7, 0x280000D7, 0x30000281, 0x30000281,
+    0x30000287, 0x280000D7, 0x40001691, 0x40001691, 0x30000287, 0x30000287, 0x30000283, 0x30000283,
+    0x30000287, 0x30000283, 0x30000287, 0x480043D0, 0x280000D7, 0x280000D7, 0x280000D7, 0x480043E2,
+    0x10000008, 0x3800078E, 0x30000287, 0x30000287, 0x38000791, 0x38000791, 0x38000791, 0x280000D7,
+    0x10000008, 0x48004414, 0x10000008, 0x30000287, 0x38000797, 0x38000797, 0x38000797, 0x4800442F,
+    0x10000008, 0x400016C7, 0x400016C7, 0x400016C7, 0x10000008, 0x10000008, 0x5000CD07, 0x5000CD07,
+    0x3000028A, 0x3800079A, 0x3000028A, 0x30000289, 0x3000028A, 0x3000028A, 0x3800079C, 0x3800079C,
+    0x2000004A, 0x280000D9, 0x280000D9, 0x280000D9, 0x280000DA, 0x280000DA, 0x280000DA, 0x400016E2,
+    0x280000DA, 0x380007A2, 0x280000DA, 0x280000DA, 0x280000DA, 0x280000DA, 0x380007A5, 0x380007A5,
+    0x2000004A, 0x3000028D, 0x3000028D, 0x3000028D, 0x2000004A, 0x2000004A, 0x280000DA, 0x280000DA,
+    0x20000049, 0x380007AC, 0x20000049, 0x380007AB, 0x20000049, 0x20000049, 0x3000028F, 0x3000028F,
+    0x2000004A, 0x30000290, 0x20000049, 0x20000049, 0x20000049, 0x20000049, 0x20000049, 0x40001714,
+    0x2000004A, 0x4800454A, 0x2000004A, 0x380007B4, 0x30000292, 0x30000292, 0x30000292, 0x40001721,
+    0x30000295, 0x2000004A, 0x30000293, 0x30000293, 0x30000295, 0x30000295, 0x280000DC, 0x280000DC,
+    0x30000295, 0x40001733, 0x30000295, 0x280000DC, 0x380007BE, 0x380007BE, 0x380007BE, 0x5802731D,
+    0x1800001A, 0x40001741, 0x2000004A, 0x2000004A, 0x280000DD, 0x280000DD, 0x280000DD, 0x380007C4,
+    0x2000004A, 0x480045E3, 0x2000004A, 0x280000DD, 0x2000004A, 0x2000004A, 0x380007C7, 0x380007C7,
+    0x3000029C, 0x30000299, 0x30000299, 0x30000299, 0x3000029C, 0x3000029C, 0x2000004A, 0x2000004A,
+    0x3000029C, 0x40001769, 0x3000029C, 0x48004637, 0x380007D0, 0x380007D0, 0x380007D0, 0x48004648,
+    0x1800001A, 0x3000029B, 0x3000029C, 0x3000029C, 0x4000177E, 0x4000177E, 0x4000177E, 0x4000177B,
+    0x1800001A, 0x5000D370, 0x1800001A, 0x40001784, 0x3000029E, 0x3000029E, 0x3000029E, 0x380007D8,
+    0x300002A2, 0x280000E0, 0x280000E0, 0x280000E0, 0x300002A2, 0x300002A2, 0x40001796, 0x40001796,
+    0x300002A2, 0x380007DF, 0x300002A2, 0x380007DF, 0x280000E0, 0x280000E0, 0x280000E0, 0x480046E2,
+    0x2000004C, 0x300002A2, 0x380007E4, 0x380007E4, 0x18000019, 0x18000019, 0x18000019, 0x300002A2,
+    0x18000019, 0x380007E8, 0x18000019, 0x400017BA, 0x18000019, 0x18000019, 0x5000D592, 0x5000D592,
+    0x2000004C, 0x300002A4, 0x300002A4, 0x300002A4, 0x2000004C, 0x2000004C, 0x300002A5, 0x300002A5,
+    0x280000E2, 0x280000E2, 0x280000E2, 0x400017CF, 0x280000E2, 0x280000E2, 0x400017D5, 0x400017D5,
+    0x2000004C, 0x380007F3, 0x2000004C, 0x2000004C, 0x280000E3, 0x280000E3, 0x280000E3, 0x400017E1,
+    0x2000004C, 0x380007F7, 0x2000004C, 0x300002A8, 0x280000E3, 0x280000E3, 0x280000E3, 0x480047C9,
+    0x38000803, 0x2000004C, 0x380007FD, 0x380007FD, 0x38000803, 0x38000803, 0x380007FF, 0x380007FF,
+    0x38000803, 0x300002AB, 0x38000803, 0x40001802, 0x40001807, 0x40001807, 0x40001807, 0x580288BC,
+    0x20000050, 0x2000004C, 0x300002AD, 0x300002AD, 0x280000E5, 0x280000E5, 0x280000E5, 0x300002AD,
+    0x300002B0, 0x40001819, 0x300002B0, 0x300002AE, 0x300002B0, 0x300002B0, 0x280000E5, 0x280000E5,
+    0x1800001A, 0x300002B0, 0x3800080E, 0x3800080E, 0x1800001A, 0x1800001A, 0x38000811, 0x38000811,
+    0x1800001A, 0x40001834, 0x1800001A, 0x5000D9D8, 0x38000815, 0x38000815, 0x38000815, 0x4000183B,
+    0x280000E9, 0x280000E6, 0x300002B4, 0x300002B4, 0x300002B4, 0x300002B4, 0x300002B4, 0x38000818,
+    0x280000E9, 0x300002B3, 0x280000E9, 0x300002B4, 0x2000004D, 0x2000004D, 0x2000004D, 0x300002B4,
+    0x280000E9, 0x2000004D, 0x2000004D, 0x2000004D, 0x280000E9, 0x280000E9, 0x38000821, 0x38000821,
+    0x300002B7, 0x300002B6, 0x300002B7, 0x300002B7, 0x300002B7, 0x300002B7, 0x4000186E, 0x4000186E,
+    0x20000050, 0x280000E9, 0x280000E8, 0x280000E8, 0x280000E9, 0x280000E9, 0x280000E9, 0x38000829,
+    0x38000830, 0x300002B9, 0x38000830, 0x280000E9, 0x38000830, 0x38000830, 0x40001889, 0x40001889,
+    0x20000050, 0x38000830, 0x480049AF, 0x480049AF, 0x20000050, 0x20000050, 0x38000833, 0x38000833,
+    0x38000839, 0x300002BD, 0x38000839, 0x480049D3, 0x38000839, 0x38000839, 0x300002BD, 0x300002BD,
+    0x280000EC, 0x400018A7, 0x1800001A, 0x1800001A, 0x1800001A, 0x1800001A, 0x1800001A, 0x58029A59,
+    0x280000EC, 0x3800083C, 0x280000EC, 0x300002BF, 0x300002C0, 0x300002C0, 0x300002C0, 0x400018BB,
+    0x280000EC, 0x280000EC, 0x280000EB, 0x280000EB, 0x280000EC, 0x280000EC, 0x280000EB, 0x280000EB,
+    0x38000847, 0x38000844, 0x38000847, 0x38000845, 0x38000847, 0x38000847, 0x400018D4, 0x400018D4,
+    0x280000F2, 0x300002C3, 0x280000EC, 0x280000EC, 0x3800084E, 0x3800084E, 0x3800084E, 0x280000EC,
+    0x20000050, 0x400018E6, 0x20000050, 0x3800084E, 0x20000050, 0x20000050, 0x38000850, 0x38000850,
+    0x280000EE, 0x38000854, 0x38000854, 0x38000854, 0x280000EE, 0x280000EE, 0x2000004F, 0x2000004F,
+    0x280000EE, 0x2000004F, 0x280000EE, 0x38000856, 0x300002C8, 0x300002C8, 0x300002C8, 0x48004B17,
+    0x280000F2, 0x300002C9, 0x280000EE, 0x280000EE, 0x40001919, 0x40001919, 0x40001919, 0x40001915,
+    0x280000F2, 0x48004B49, 0x280000F2, 0x3800085F, 0x38000862, 0x38000862, 0x38000862, 0x300002CB,
+    0x300002CF, 0x20000050, 0x20000050, 0x20000050, 0x300002CF, 0x300002CF, 0x38000866, 0x38000866,
+    0x300002CF, 0x280000EF, 0x300002CF, 0x280000EF, 0x38000869, 0x38000869, 0x38000869, 0x48004BB0,
+    0x300002D8, 0x300002CF, 0x40001946, 0x40001946, 0x280000F2, 0x280000F2, 0x280000F2, 0x40001949,
+    0x300002D2, 0x4000194F, 0x300002D2, 0x20000050, 0x300002D2, 0x300002D2, 0x38000872, 0x38000872,
+    0x300002D8, 0x300002D2, 0x4000195D, 0x4000195D, 0x300002D8, 0x300002D8, 0x40001964, 0x40001964,
+    0x300002D4, 0x280000F2, 0x300002D4, 0x4000196A, 0x300002D4, 0x300002D4, 0x3800087A, 0x3800087A,
+    0x3800088A, 0x48004C5B, 0x300002D8, 0x300002D8, 0x38000881, 0x38000881, 0x38000881, 0x4000197C,
+    0x3800088A, 0x4000197F, 0x3800088A, 0x48004C88, 0x38000884, 0x38000884, 0x38000884, 0x40001988,
+    0x400019A0, 0x3800088A, 0x38000886, 0x38000886, 0x400019A0, 0x400019A0, 0x40001997, 0x40001997,
+    0x48004CE2, 0x4000199A, 0x48004CE2, 0x4000199C, 0x5000E6A8, 0x5000E6A8, 0x5802B3FA, 0x60081BF0,
+};
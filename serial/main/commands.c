@@ -14,6 +14,11 @@
 #include "client.h"
 #include "data_tasks.h"
 #include "net_layer.h"
+#include "net_crypto.h"
+#include "network.h"
+#include "app_probe.h"
+#include "gateway.h"
+#include "collatz.h"
 
 #define MSG_BUFFER_LENGTH 256
 
@@ -707,6 +712,343 @@ void command_net_table()
     net_info();
 }
 
+/**
+ * Prints the topology of the mesh, one edge per line ( root only )
+ */
+void command_net_map()
+{
+    net_map_info();
+}
+
+/**
+ * Prints the network dispatch counters and link table check
+ */
+void command_net_stats()
+{
+    net_stats_info();
+}
+
+/**
+ * Prints the mesh time and its error bound, and at root the
+ * error bound per hop count
+ */
+void command_net_time()
+{
+    net_time_info();
+}
+
+/**
+ * Prints the health records held by this node, at root those
+ * of every node in the mesh, and the telemetry overhead
+ */
+void command_net_health()
+{
+    net_health_info();
+}
+
+/**
+ * Switches the console to the binary gateway framing until the
+ * host leaves ( see gateway.py ), then reports the traffic as
+ * "gateway <sent> sent <refused> refused <received> received <bad> bad <dropped> dropped"
+ */
+void command_gateway()
+{
+    char buf[96];
+    gateway_stats_t stats;
+
+    if (gateway_run(&stats) != 0)
+    {
+        serial_out("gateway unavailable");
+        return;
+    }
+
+    snprintf(buf, sizeof(buf), "gateway %u sent %u refused %u received %u bad %u dropped",
+             stats.sent, stats.refused, stats.received, stats.bad, stats.dropped);
+    serial_out(buf);
+}
+
+/**
+ * Prints the residue sieve of the Collatz blocks, the share of odd
+ * numbers it skipped, the completion time of the last block,
+ * whether the frame was resumed from its NVS checkpoint, the
+ * snapshots taken on link-up with the time the last one took,
+ * and the blocks computed that the mesh had done first.
+ * The block time comes with the workers that ran the block
+ */
+void command_collatz_stats()
+{
+    char buf[MSG_BUFFER_LENGTH];
+    collatz_stats_t st;
+
+    collatz_stats(&st);
+    uint64_t all = st.tested + st.skipped;
+    snprintf(buf, sizeof(buf), "sieve k %d survivors %u skip %llu.%02llu%% blocks %u block %lld ms workers %d%s "
+                               "joins %u sync %lld ms wasted %u reports %u "
+                               "steals %u takeovers %u dup %u parts %u frame %lld ms",
+             st.sieve_k, st.survivors,
+             all ? st.skipped * 100 / all : 0ULL,
+             all ? st.skipped * 10000 / all % 100 : 0ULL,
+             st.blocks, st.block_us / 1000, st.workers, st.resumed ? " resumed" : "",
+             st.joins, st.sync_us / 1000, st.wasted, st.reports,
+             st.steals, st.takeovers, st.duplicates, st.parts, st.frame_us / 1000);
+    serial_out(buf);
+}
+
+/**
+ * Sets the workers a Collatz block is split over, from the next block on,
+ * and prints "workers <n>". Without an argument it only prints the count.
+ * COLLATZ_WORKERS 1 and back against COLLATZ_STATS 'block' is the speedup
+ * of the other core
+ *
+ * @param num_args      number of delimiter split inputs
+ * @param vars          COLLATZ_WORKERS [n]
+ */
+void command_collatz_workers(int num_args, char **vars)
+{
+    char buf[32];
+    int n = 0;
+
+    if (num_args > 2 || (num_args == 2 && (parse_int(vars[1], &n) != 0 || n < 1)) ||
+        (n = collatz_workers(n)) < 0)
+    {
+        serial_out("argument error");
+        return;
+    }
+
+    snprintf(buf, sizeof(buf), "workers %d", n);
+    serial_out(buf);
+}
+
+/**
+ * Runs the plain Collatz step loop and the 2^k-step table kernel, on
+ * rl_int and on 128 bit words, over the same numbers and prints
+ * "<plain> plain <table> table <wide> wide numbers/s" and the speedup
+ * of the 128 bit kernel in hundredths
+ *
+ * @param num_args      number of delimiter split inputs
+ * @param vars          COLLATZ_BENCH [count], at most COLLATZ_BENCH_MAX
+ */
+void command_collatz_bench(int num_args, char **vars)
+{
+    char buf[96];
+    int count = 4096;
+    collatz_bench_t bench;
+
+    if (num_args > 2 ||
+        (num_args == 2 && (parse_int(vars[1], &count) != 0 || count < 1 || count > COLLATZ_BENCH_MAX)))
+    {
+        serial_out("argument error");
+        return;
+    }
+
+    if (collatz_bench(count, &bench) != 0 || bench.plain_us <= 0 || bench.kernel_us <= 0 || bench.wide_us <= 0)
+    {
+        serial_out("bench error");
+        return;
+    }
+
+    snprintf(buf, sizeof(buf), "%lld plain %lld table %lld wide numbers/s k %d speedup %lld",
+             (long long)bench.numbers * 1000000 / bench.plain_us,
+             (long long)bench.numbers * 1000000 / bench.kernel_us,
+             (long long)bench.numbers * 1000000 / bench.wide_us,
+             bench.steps,
+             (long long)bench.plain_us * 100 / bench.wide_us);
+    serial_out(buf);
+}
+
+/**
+ * Parses a node-id given in hex ( as NET_MAP prints them ), or ALL
+ *
+ * @param str           the argument
+ * @param id            receives the node-id, PROBE_ALL for ALL
+ * @param allow_all     whether ALL is accepted
+ * @return 0 on success, -1 otherwise
+ */
+static int parse_node(char *str, uint8_t *id, int allow_all)
+{
+    char tmp[8];
+    memset(tmp, '\0', sizeof(tmp));
+    strncpy(tmp, str, sizeof(tmp) - 1);
+    strupr(tmp);
+
+    if (strcmp(tmp, "ALL") == 0)
+    {
+        *id = PROBE_ALL;
+        return (allow_all ? 0 : -1);
+    }
+
+    char *end = NULL;
+    long value = strtol(tmp, &end, 16);
+    if (end == tmp || *end != '\0' || value < 1 || value >= PROBE_ALL)
+    {
+        return -1;
+    }
+    *id = (uint8_t)value;
+    return 0;
+}
+
+/**
+ * Parses the <count> <size> <rate> arguments of the PROBE stream commands
+ *
+ * @return 0 on success, -1 otherwise
+ */
+static int parse_stream(char **vars, int *count, int *size, int *rate)
+{
+    if (parse_int(vars[0], count) != 0 || parse_int(vars[1], size) != 0 || parse_int(vars[2], rate) != 0)
+    {
+        return -1;
+    }
+    if (*count < 1 || *count > 10000 || *rate < 1 || *rate > 1000 ||
+        *size < (int)sizeof(probe_header_t) || *size > NET_MAX_PAYLOAD)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Pings a node through the mesh and prints the round trip
+ * time percentiles, losses and hop counts both ways
+ *
+ * @param num_args      number of delimiter split inputs
+ * @param vars          PROBE_PING <node-id> [count]
+ */
+void command_probe_ping(int num_args, char **vars)
+{
+    uint8_t target;
+    int count = 10;
+
+    if (num_args < 2 || num_args > 3 || parse_node(vars[1], &target, 0) != 0 ||
+        (num_args == 3 && (parse_int(vars[2], &count) != 0 || count < 1 || count > 100)))
+    {
+        serial_out("argument error");
+        return;
+    }
+
+    app_probe_ping(target, count, sizeof(probe_header_t));
+}
+
+/**
+ * Streams frames from this node to one node or all of them,
+ * then prints loss, reordering and goodput per node and per hop count
+ *
+ * @param num_args      number of delimiter split inputs
+ * @param vars          PROBE_SEND <node-id|ALL> <count> <size> <rate>
+ */
+void command_probe_send(int num_args, char **vars)
+{
+    uint8_t target;
+    int count, size, rate;
+
+    if (num_args != 5 || parse_node(vars[1], &target, 1) != 0 || parse_stream(&vars[2], &count, &size, &rate) != 0)
+    {
+        serial_out("argument error");
+        return;
+    }
+
+    app_probe_send(target, count, size, rate);
+}
+
+/**
+ * Has one node or all of them stream frames to this node,
+ * then prints loss, reordering and goodput per source and per hop count
+ *
+ * @param num_args      number of delimiter split inputs
+ * @param vars          PROBE_PULL <node-id|ALL> <count> <size> <rate>
+ */
+void command_probe_pull(int num_args, char **vars)
+{
+    uint8_t source;
+    int count, size, rate;
+
+    if (num_args != 5 || parse_node(vars[1], &source, 1) != 0 || parse_stream(&vars[2], &count, &size, &rate) != 0)
+    {
+        serial_out("argument error");
+        return;
+    }
+
+    app_probe_pull(source, count, size, rate);
+}
+
+/**
+ * Benchmarks payload encryption of one full application frame
+ * against a plain copy of the same frame, one side of the LINK
+ * key exchange, and reports the last handshake on this node
+ */
+void command_net_crypto()
+{
+    char buf[80];
+    crypto_bench_t bench;
+
+    crypto_bench(&bench, 500, sizeof(app_header_t) + NET_MAX_PAYLOAD);
+
+    snprintf(buf, sizeof(buf), "%u frames of %u bytes", bench.frames, bench.bytes);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "plain %.2fus/frame", bench.copy_us);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "key setup %.2fus", bench.key_us);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "seal %.2fus/frame %.2f MB/s", bench.seal_us, bench.bytes / bench.seal_us);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "open %.2fus/frame %.2f MB/s", bench.open_us, bench.bytes / bench.open_us);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "x25519 %.0fus %u cycles", bench.kx_us, bench.kx_cycles);
+    serial_out(buf);
+    net_kx_info();
+}
+
+/**
+ * Controls the network frame capture ring
+ *
+ * ON and OFF toggle recording, CLEAR empties the ring and
+ * DUMP prints the captured frames ( see net_capture_dump ).
+ * Answers "capture disabled" unless built with NET_CAPTURE
+ *
+ * @param num_args      number of delimiter split inputs
+ * @param vars          the query variables provided to the device
+ */
+void command_net_capture(int num_args, char **vars)
+{
+    if (num_args != 2)
+    {
+        serial_out("argument error");
+        return;
+    }
+
+#if !defined(NET_CAPTURE)
+    serial_out("capture disabled");
+#else
+    char tmp[8];
+    memset(tmp, '\0', sizeof(tmp));
+    strncpy(tmp, vars[1], sizeof(tmp) - 1);
+    strupr(tmp);
+
+    if (strcmp(tmp, "ON") == 0)
+    {
+        net_capture_enable(1);
+        serial_out("capture on");
+    }
+    else if (strcmp(tmp, "OFF") == 0)
+    {
+        net_capture_enable(0);
+        serial_out("capture off");
+    }
+    else if (strcmp(tmp, "CLEAR") == 0)
+    {
+        net_capture_clear();
+        serial_out("capture cleared");
+    }
+    else if (strcmp(tmp, "DUMP") == 0)
+    {
+        net_capture_dump();
+    }
+    else
+    {
+        serial_out("argument error");
+    }
+#endif
+}
+
 // /**
 //  * Empties the ESPNOW networking table of the device
 //  */
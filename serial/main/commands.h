@@ -28,5 +28,18 @@ void command_net_locate();
 void command_net_table();
 void command_net_reset();
 void command_net_status();
+void command_net_capture(int num_args, char **vars);
+void command_net_map();
+void command_net_stats();
+void command_net_time();
+void command_net_health();
+void command_gateway();
+void command_collatz_stats();
+void command_collatz_workers(int num_args, char **vars);
+void command_collatz_bench(int num_args, char **vars);
+void command_probe_ping(int num_args, char **vars);
+void command_probe_send(int num_args, char **vars);
+void command_probe_pull(int num_args, char **vars);
+void command_net_crypto();
 
 #endif
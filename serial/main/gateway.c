@@ -0,0 +1,289 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <driver/uart.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+
+#include "gateway.h"
+#include "gateway_frame.h"
+#include "network.h"
+
+
+#define PRIO_GATEWAY 4
+
+#define GW_UART CONFIG_ESP_CONSOLE_UART_NUM
+#define GW_RX_BUFFER 2048
+#define GW_APPS 4
+#define GW_WINDOW 8				// host frames in flight
+#define GW_SEND_TIMEOUT 100		// ms a host frame may wait for outbound room
+#define GW_READ_TIMEOUT 20		// ms
+#define GW_CREDIT_PERIOD 500	// ms, the grant is repeated this often
+#define GW_HOST_TIMEOUT 10000	// ms without a frame from the host ends gateway mode
+
+static struct {
+	int					root;
+	volatile int		running;
+	uint16_t			apps[GW_APPS];		// virtual app ids, zero if free
+	TaskHandle_t		tasks[GW_APPS];
+	uint16_t			tx_seq;				// next GW_RECV
+	volatile uint16_t	host_limit;			// host's grant for GW_RECV
+	uint16_t			rx_next;			// host frame expected next
+	uint16_t			granted;			// rx_next at our last grant
+	gw_decoder_t		dec;
+	gateway_stats_t		stats;
+	SemaphoreHandle_t	tx_lock;
+} gw;
+
+// Writes one frame to the host, tx_lock held.
+static void gw_put(uint8_t type, uint16_t seq, uint16_t app, uint8_t flags, uint8_t group, const void* payload, uint32_t len) {
+	uint8_t frame[GW_MAX_FRAME];
+	uint8_t out[GW_MAX_ENCODED];
+
+	gw_header_t* h = (gw_header_t*)frame;
+	h->type = type;
+	h->seq = seq;
+	h->app = app;
+	h->flags = flags;
+	h->group = group;
+	memcpy(frame + sizeof(gw_header_t), payload, len);
+
+	uint32_t n = gw_encode(frame, sizeof(gw_header_t) + len, out);
+	uart_write_bytes(GW_UART, (const char*)out, n);
+}
+
+static void gw_write(uint8_t type, uint16_t seq, uint16_t app, const void* payload, uint32_t len) {
+	xSemaphoreTake(gw.tx_lock, portMAX_DELAY);
+	gw_put(type, seq, app, 0, 0, payload, len);
+	xSemaphoreGive(gw.tx_lock);
+}
+
+static void gw_credit() {
+	gw.granted = gw.rx_next;
+	gw_write(GW_CREDIT, gw.rx_next + GW_WINDOW, 0, NULL, 0);
+}
+
+static void gw_status(uint16_t seq, uint16_t app, int result) {
+	int8_t status = result;
+	gw_write(GW_STATUS, seq, app, &status, 1);
+}
+
+/*
+* One per virtual app: passes its frames to the host while the host's grant
+*  allows.  Without a grant frames stay queued in the network layer, which
+*  drops (and counts) them once the app's inbound queue is full.
+*/
+static void gw_app_task(void* param) {
+	int slot = (int)param;
+	uint16_t app = gw.apps[slot];
+
+	app_header_t	head = {};
+	uint8_t			data[NET_MAX_PAYLOAD];
+
+	while (gw.running && gw.apps[slot] == app) {
+		if (!gw_allowed(gw.tx_seq, gw.host_limit)) {
+			vTaskDelay(1);
+			continue;
+		}
+		if (net_receive(app, &head, data, GW_READ_TIMEOUT)) {
+			continue;
+		}
+
+		// Other apps may have used up the grant meanwhile.  The grant only moves
+		//  in gateway_run, which waits in gw_close for this task to end: give the
+		//  frame up once the app is closed.
+		int passed = 0;
+		while (gw.running && gw.apps[slot] == app) {
+			xSemaphoreTake(gw.tx_lock, portMAX_DELAY);
+			if (gw_allowed(gw.tx_seq, gw.host_limit)) {
+				gw_put(GW_RECV, gw.tx_seq++, app, (head.reserved[0] ? GW_FLAG_UP : 0), head.reserved[1], data, head.len);
+				gw.stats.received++;
+				passed = 1;
+			}
+			xSemaphoreGive(gw.tx_lock);
+			if (passed) {
+				break;
+			}
+			vTaskDelay(1);
+		}
+		if (!passed) {
+			gw.stats.dropped++;
+		}
+	}
+
+	gw.tasks[slot] = NULL;
+	vTaskDelete(NULL);
+}
+
+static int gw_open(uint16_t app) {
+	int slot = -1;
+	for (int i = 0; i < GW_APPS; ++i) {
+		if (gw.apps[i] == app) {
+			return 0;
+		}
+		if (gw.apps[i] == 0 && gw.tasks[i] == NULL && slot < 0) {
+			slot = i;
+		}
+	}
+	if (slot < 0 || app == 0) {
+		return -2;
+	}
+	if (net_register_app(app) != 0) {
+		return -1;
+	}
+
+	gw.apps[slot] = app;
+	if (xTaskCreate(&gw_app_task, "gateway_app", 3072, (void*)slot, PRIO_GATEWAY, &gw.tasks[slot]) != pdPASS) {
+		gw.apps[slot] = 0;
+		net_unregister_app(app);
+		return -3;
+	}
+	return 0;
+}
+
+// Stops the app's task and waits for it, then gives the app id back.
+static int gw_close(uint16_t app) {
+	for (int i = 0; i < GW_APPS; ++i) {
+		if (gw.apps[i] != app || app == 0) {
+			continue;
+		}
+		gw.apps[i] = 0;
+		while (gw.tasks[i] != NULL) {
+			vTaskDelay(1);
+		}
+		return net_unregister_app(app);
+	}
+	return -1;
+}
+
+static void gw_send(const gw_header_t* h, const uint8_t* payload, uint32_t len) {
+	app_header_t head = {};
+	head.type = h->app;
+	head.len = len;
+
+	int result;
+	if (len > NET_MAX_PAYLOAD || h->app == 0) {
+		result = -1;
+	}
+	else if (h->group) {
+		result = net_send_group(h->group, &head, payload);
+	}
+	else if (h->flags & GW_FLAG_UP) {
+		result = net_send_up_timeout(&head, payload, GW_SEND_TIMEOUT);
+	}
+	else {
+		result = net_send_down_timeout(&head, payload, GW_SEND_TIMEOUT);
+	}
+
+	if (result != 0) {
+		gw.stats.refused++;
+		gw_status(h->seq, h->app, result);
+	}
+	else {
+		gw.stats.sent++;
+	}
+}
+
+static void gw_handle(const uint8_t* frame, uint32_t len) {
+	gw_header_t h;
+	memcpy(&h, frame, sizeof(gw_header_t));
+	const uint8_t* payload = frame + sizeof(gw_header_t);
+	len -= sizeof(gw_header_t);
+
+	switch (h.type) {
+	case GW_CREDIT:
+		gw.host_limit = h.seq;
+		break;
+	case GW_OPEN:
+		gw_status(h.seq, h.app, gw_open(h.app));
+		break;
+	case GW_CLOSE:
+		gw_status(h.seq, h.app, gw_close(h.app));
+		break;
+	case GW_SEND:
+		gw_send(&h, payload, len);
+
+		// Host frames are numbered for the grant, gaps are frames lost on the line.
+		gw.rx_next = h.seq + 1;
+		if ((uint16_t)(gw.rx_next - gw.granted) >= GW_WINDOW / 2) {
+			gw_credit();
+		}
+		break;
+	case GW_EXIT:
+		gw.running = 0;
+		break;
+	default:
+		break;
+	}
+}
+
+void gateway_init(int root) {
+	memset(&gw, 0, sizeof(gw));
+	gw.root = root;
+	gw.tx_lock = xSemaphoreCreateMutex();
+}
+
+int gateway_run(gateway_stats_t* stats) {
+	// The driver buffers what arrives while a host frame waits for outbound
+	//  room, and its writes skip the console's line ending translation.
+	if (uart_driver_install(GW_UART, GW_RX_BUFFER, 0, 0, NULL, 0) != ESP_OK) {
+		return -1;
+	}
+	esp_log_level_set("*", ESP_LOG_NONE);
+	fflush(stdout);
+
+	gw_decoder_init(&gw.dec);
+	memset(&gw.stats, 0, sizeof(gw.stats));
+	gw.tx_seq = 0;
+	gw.host_limit = 0;
+	gw.rx_next = 0;
+	gw.granted = 0;
+	gw.running = 1;
+
+	gw_hello_t hello = { GW_VERSION, net_node_id(), gw.root, GW_WINDOW, NET_MAX_PAYLOAD };
+	gw_write(GW_HELLO, GW_WINDOW, 0, &hello, sizeof(hello));
+
+	int64_t last_credit = esp_timer_get_time();
+	int64_t last_host = last_credit;
+	while (gw.running) {
+		uint8_t buf[64];
+		int n = uart_read_bytes(GW_UART, buf, sizeof(buf), GW_READ_TIMEOUT / portTICK_PERIOD_MS);
+		for (int i = 0; i < n && gw.running; ++i) {
+			uint32_t len = gw_decode(&gw.dec, buf[i]);
+			if (len) {
+				last_host = esp_timer_get_time();
+				gw_handle(gw.dec.buf, len);
+			}
+		}
+
+		int64_t now = esp_timer_get_time();
+		if (now - last_host > GW_HOST_TIMEOUT * 1000ll) {
+			break;
+		}
+		if (now - last_credit > GW_CREDIT_PERIOD * 1000ll) {
+			last_credit = now;
+			gw_credit();
+		}
+	}
+	gw.running = 0;
+
+	for (int i = 0; i < GW_APPS; ++i) {
+		gw_close(gw.apps[i]);
+	}
+
+	uart_wait_tx_done(GW_UART, portMAX_DELAY);
+	uart_driver_delete(GW_UART);
+	esp_log_level_set("*", CONFIG_LOG_DEFAULT_LEVEL);
+
+	gw.stats.bad = gw.dec.bad;
+	if (stats != NULL) {
+		*stats = gw.stats;
+	}
+	return 0;
+}
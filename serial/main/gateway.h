@@ -0,0 +1,26 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <stdint.h>
+
+/*
+* Serial gateway: the console UART switches to the binary framing of
+*  gateway_frame.h, and host processes register app ids on this node as
+*  virtual apps.  App frames for them go to the host, frames from the host go
+*  into the mesh.  Meant for the root, works on any node.
+*/
+
+typedef struct {
+	uint32_t	sent;		// host frames into the mesh
+	uint32_t	refused;	// host frames the network layer refused
+	uint32_t	received;	// app frames passed to the host
+	uint32_t	bad;		// undecodable frames from the host
+	uint32_t	dropped;	// app frames given up when their app closed
+} gateway_stats_t;
+
+void gateway_init(int root);
+
+// Runs gateway mode in the calling task until the host sends GW_EXIT or goes silent.
+int gateway_run(gateway_stats_t* stats);
+
+#endif
@@ -0,0 +1,104 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "gateway_frame.h"
+
+uint16_t gw_crc16(const uint8_t* data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t put_escaped(uint8_t* out, uint32_t at, uint8_t byte) {
+    if (byte == GW_END) {
+        out[at++] = GW_ESC;
+        out[at++] = GW_ESC_END;
+    }
+    else if (byte == GW_ESC) {
+        out[at++] = GW_ESC;
+        out[at++] = GW_ESC_ESC;
+    }
+    else {
+        out[at++] = byte;
+    }
+    return at;
+}
+
+uint32_t gw_encode(const uint8_t* frame, uint32_t len, uint8_t* out) {
+    uint16_t crc = gw_crc16(frame, len);
+    uint32_t at = 0;
+
+    // The leading delimiter ends whatever noise came before.
+    out[at++] = GW_END;
+    for (uint32_t i = 0; i < len; ++i) {
+        at = put_escaped(out, at, frame[i]);
+    }
+    at = put_escaped(out, at, crc & 0xFF);
+    at = put_escaped(out, at, crc >> 8);
+    out[at++] = GW_END;
+    return at;
+}
+
+void gw_decoder_init(gw_decoder_t* dec) {
+    memset(dec, 0, sizeof(gw_decoder_t));
+}
+
+uint32_t gw_decode(gw_decoder_t* dec, uint8_t byte) {
+    if (byte == GW_END) {
+        uint32_t len = dec->len;
+        int broken = dec->overflow || dec->esc;
+
+        dec->len = 0;
+        dec->esc = 0;
+        dec->overflow = 0;
+
+        // Back to back delimiters are not frames.
+        if (len == 0 && !broken) {
+            return 0;
+        }
+        if (broken || len < sizeof(gw_header_t) + 2 ||
+            gw_crc16(dec->buf, len - 2) != (dec->buf[len - 2] | (dec->buf[len - 1] << 8))) {
+            dec->bad++;
+            return 0;
+        }
+        dec->frames++;
+        return len - 2;
+    }
+
+    if (dec->overflow) {
+        return 0;
+    }
+    if (dec->esc) {
+        dec->esc = 0;
+        if (byte == GW_ESC_END) {
+            byte = GW_END;
+        }
+        else if (byte == GW_ESC_ESC) {
+            byte = GW_ESC;
+        }
+        else {
+            dec->overflow = 1;
+            return 0;
+        }
+    }
+    else if (byte == GW_ESC) {
+        dec->esc = 1;
+        return 0;
+    }
+
+    if (dec->len == sizeof(dec->buf)) {
+        dec->overflow = 1;
+        return 0;
+    }
+    dec->buf[dec->len++] = byte;
+    return 0;
+}
+
+int gw_allowed(uint16_t seq, uint16_t limit) {
+    return (int16_t)(limit - seq) > 0;
+}
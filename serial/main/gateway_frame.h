@@ -0,0 +1,86 @@
+#ifndef GATEWAY_FRAME_H
+#define GATEWAY_FRAME_H
+
+/*
+* Binary framing of the serial gateway.  A frame is a gw_header_t, up to
+*  GW_MAX_PAYLOAD bytes of payload and a CRC-16 (CCITT, little endian), SLIP
+*  escaped and delimited by GW_END on both sides.  Anything between two
+*  GW_END bytes that does not check out is dropped, so stray console output
+*  costs at most the frame it landed in.
+*
+* Flow control is by sequence number: each side numbers its frames and the
+*  other grants, in GW_CREDIT frames, the first sequence number it may NOT
+*  send yet.  Grants are absolute, a lost GW_CREDIT is repaired by the next.
+*
+* No I/O here, gateway.c and gateway.py both build on it.
+*/
+#include <stdint.h>
+
+#define GW_VERSION 1
+
+#define GW_END 0xC0
+#define GW_ESC 0xDB
+#define GW_ESC_END 0xDC
+#define GW_ESC_ESC 0xDD
+
+#define GW_MAX_PAYLOAD 128
+
+// Frame types, (n) -> node to host, (h) -> host to node.
+#define GW_HELLO 1		// (n) gw_hello_t, gateway mode entered
+#define GW_OPEN 2		// (h) register 'app' as a virtual app
+#define GW_CLOSE 3		// (h) unregister 'app'
+#define GW_SEND 4		// (h) app frame into the mesh
+#define GW_RECV 5		// (n) app frame from the mesh
+#define GW_CREDIT 6		// (both) 'seq' is the grant
+#define GW_EXIT 7		// (h) back to text commands
+#define GW_STATUS 8		// (n) int8_t result of the host frame 'seq', 'app' of it
+
+// gw_header_t.flags
+#define GW_FLAG_UP 0x01	// GW_SEND: send up-stream, GW_RECV: came from up-stream
+
+typedef struct __attribute__((packed)) gw_header_t {
+	uint8_t		type;
+	uint16_t	seq;
+	uint16_t	app;
+	uint8_t		flags;
+	uint8_t		group;	// GW_SEND: group to send to, GW_RECV: group received on
+} gw_header_t;
+
+typedef struct __attribute__((packed)) gw_hello_t {
+	uint8_t		version;
+	uint8_t		node_id;
+	uint8_t		root;
+	uint8_t		window;		// frames the host may have in flight
+	uint8_t		max_payload;
+} gw_hello_t;
+
+#define GW_MAX_FRAME (sizeof(gw_header_t) + GW_MAX_PAYLOAD + 2)
+// Worst case: every byte escaped, plus both delimiters.
+#define GW_MAX_ENCODED (2 * GW_MAX_FRAME + 2)
+
+typedef struct gw_decoder_t {
+	uint8_t		buf[GW_MAX_FRAME];
+	uint32_t	len;
+	int			esc;
+	int			overflow;	// frame too long, skipping to the next GW_END
+	uint32_t	frames;
+	uint32_t	bad;		// CRC, length or escape errors
+} gw_decoder_t;
+
+uint16_t gw_crc16(const uint8_t* data, uint32_t len);
+
+// Escapes 'len' bytes of frame into 'out' (GW_MAX_ENCODED bytes), returns the encoded length.
+uint32_t gw_encode(const uint8_t* frame, uint32_t len, uint8_t* out);
+
+void gw_decoder_init(gw_decoder_t* dec);
+
+/*
+* Feeds one received byte.  Returns the length of the frame in dec->buf,
+*  CRC stripped, once a valid one is complete, otherwise zero.
+*/
+uint32_t gw_decode(gw_decoder_t* dec, uint8_t byte);
+
+// Non-zero if sequence number 'seq' is below the grant 'limit'.
+int gw_allowed(uint16_t seq, uint16_t limit);
+
+#endif
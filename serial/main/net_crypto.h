@@ -0,0 +1,102 @@
+#ifndef NET_CRYPTO_H
+#define NET_CRYPTO_H
+
+/*
+ * Payload encryption for the network layer: AES-128-CCM through mbedtls,
+ *  and the X25519 key exchange that derives per-link keys during LINK.
+ *
+ * On the ESP32 mbedtls is built with CONFIG_MBEDTLS_HARDWARE_AES, so the
+ * block cipher runs on the AES peripheral.  Nothing here depends on
+ * esp-idf or FreeRTOS, which keeps the file buildable on a Linux host
+ * against a stock (software) mbedtls for testing and comparison.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mbedtls/ccm.h>
+
+#define CRYPTO_KEY_SIZE 16
+#define CRYPTO_NONCE_SIZE 13
+#define CRYPTO_TAG_SIZE 6
+#define CRYPTO_PUB_SIZE 32
+#define CRYPTO_MAC_SIZE 16
+
+// Pre-provisioned mesh key.  Change this per deployment!
+#define MESH_KEY                                        \
+    {                                                   \
+        0x54, 0x4f, 0x4c, 0x31, 0x30, 0x33, 0x4d, 0x2d, \
+        0x6d, 0x65, 0x73, 0x68, 0x2d, 0x6b, 0x65, 0x79  \
+    }
+
+// Pre-provisioned mesh identity, authenticates key exchanges.  Only nodes
+//  holding it can join, and it never encrypts traffic directly.
+#define MESH_IDENTITY                                   \
+    {                                                   \
+        0x8a, 0x1f, 0x3c, 0x77, 0x05, 0xd2, 0x6e, 0x91, \
+        0x4b, 0xe0, 0x2a, 0x58, 0xc3, 0x19, 0xf6, 0x0d, \
+        0x72, 0xa4, 0x3e, 0xbb, 0x60, 0x0c, 0x95, 0x27, \
+        0xde, 0x41, 0x8f, 0x13, 0x5a, 0xe7, 0x36, 0xc8  \
+    }
+
+// Ephemeral X25519 key pair, both halves little endian as on the wire.
+typedef struct
+{
+    uint8_t secret[CRYPTO_PUB_SIZE];
+    uint8_t pub[CRYPTO_PUB_SIZE];
+} crypto_kx_t;
+
+// A key with its CCM context set up, see crypto_key_set.  Zero-initialised
+//  it holds no key.
+typedef struct
+{
+    mbedtls_ccm_context ccm;
+    int ready;
+} crypto_key_t;
+
+typedef struct
+{
+    uint32_t frames;  /* frames sealed / opened per measurement */
+    uint32_t bytes;   /* payload bytes per frame                */
+    float copy_us;    /* plaintext copy, per frame              */
+    float key_us;     /* CCM context set up for one key         */
+    float seal_us;    /* encrypt and tag, per frame             */
+    float open_us;    /* verify and decrypt, per frame          */
+    float kx_us;      /* key pair plus key derivation, one side */
+    uint32_t kx_cycles;
+} crypto_bench_t;
+
+extern const uint8_t mesh_key[CRYPTO_KEY_SIZE];
+extern const uint8_t mesh_identity[32];
+
+uint32_t crypto_cycles(void);
+
+// Expands 'key' into 'k' once, for every frame sealed or opened with it.
+//  Not while another task seals or opens with 'k'.
+int crypto_key_set(crypto_key_t *k, const uint8_t *key);
+void crypto_key_free(crypto_key_t *k);
+
+// Both return 0 on success, crypto_open fails if the tag does not verify.
+//  Tasks may share a key, the context is only read.
+int crypto_seal(crypto_key_t *key, const uint8_t *nonce,
+                const uint8_t *aad, size_t aad_len,
+                uint8_t *data, size_t len, uint8_t *tag);
+int crypto_open(crypto_key_t *key, const uint8_t *nonce,
+                const uint8_t *aad, size_t aad_len,
+                uint8_t *data, size_t len, const uint8_t *tag);
+
+// Key exchange.  crypto_kx_derive hashes the shared secret and 'info' (the
+//  transcript both sides agree on) into a CRYPTO_KEY_SIZE link key.
+int crypto_kx_keypair(crypto_kx_t *kx);
+int crypto_kx_derive(const crypto_kx_t *kx, const uint8_t *peer_pub,
+                     const uint8_t *info, size_t info_len, uint8_t *key);
+
+// Truncated HMAC-SHA256.  crypto_mac_verify returns 0 if the mac matches.
+int crypto_mac(const uint8_t *key, size_t key_len,
+               const uint8_t *data, size_t len, uint8_t *mac);
+int crypto_mac_verify(const uint8_t *key, size_t key_len,
+                      const uint8_t *data, size_t len, const uint8_t *mac);
+
+// Measures seal / open cost of 'frames' payloads of 'len' bytes against a plain copy.
+void crypto_bench(crypto_bench_t *out, uint32_t frames, size_t len);
+
+#endif
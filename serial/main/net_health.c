@@ -0,0 +1,112 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "net_health.h"
+
+// Unused budget is kept for at most this many frames.
+#define HEALTH_BURST 2
+
+static HealthEntry* find_entry(HealthTable* table, uint8_t id) {
+    for (uint32_t i = 0; i < table->count; ++i) {
+        if (table->entry[i].rec.id == id) {
+            return table->entry + i;
+        }
+    }
+    return NULL;
+}
+
+static void remove_entry(HealthTable* table, uint32_t i) {
+    table->entry[i] = table->entry[--table->count];
+    table->evicted++;
+}
+
+static void refill(HealthTable* table, uint32_t cost, int64_t now) {
+    int64_t cap = (int64_t)HEALTH_BURST * cost * 1000000;
+
+    table->tokens += (now - table->refill) * table->budget;
+    table->refill = now;
+    if (table->tokens > cap) {
+        table->tokens = cap;
+    }
+}
+
+void health_init(HealthTable* table, uint32_t budget, int64_t now) {
+    memset(table, 0, sizeof(HealthTable));
+    table->budget = budget;
+    table->refill = now;
+}
+
+void health_put(HealthTable* table, const HealthRecord* rec, int64_t now) {
+    HealthEntry* entry = find_entry(table, rec->id);
+    if (entry != NULL) {
+        if (entry->dirty) {
+            table->merged++;
+        }
+    }
+    else {
+        if (table->count == HEALTH_SIZE) {
+            uint32_t oldest = 0;
+            for (uint32_t i = 1; i < table->count; ++i) {
+                if (table->entry[i].time < table->entry[oldest].time) {
+                    oldest = i;
+                }
+            }
+            remove_entry(table, oldest);
+        }
+        entry = table->entry + table->count++;
+    }
+
+    entry->rec = *rec;
+    entry->time = now;
+    entry->dirty = 1;
+    table->stored++;
+}
+
+const HealthEntry* health_find(const HealthTable* table, uint8_t id) {
+    return find_entry((HealthTable*)table, id);
+}
+
+void health_expire(HealthTable* table, int64_t age, int64_t now) {
+    for (uint32_t i = 0; i < table->count; ) {
+        if (now - table->entry[i].time > age) {
+            remove_entry(table, i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+uint32_t health_take(HealthTable* table, HealthRecord* out, uint32_t max, uint32_t cost, int64_t now) {
+    uint32_t dirty = 0;
+    for (uint32_t i = 0; i < table->count; ++i) {
+        dirty += (table->entry[i].dirty != 0);
+    }
+    if (dirty == 0) {
+        return 0;
+    }
+
+    refill(table, cost, now);
+    if (table->tokens < (int64_t)cost * 1000000) {
+        table->deferred++;
+        return 0;
+    }
+
+    uint32_t n = 0;
+    while (n < max && n < dirty) {
+        HealthEntry* oldest = NULL;
+        for (uint32_t i = 0; i < table->count; ++i) {
+            HealthEntry* entry = table->entry + i;
+            if (entry->dirty && (oldest == NULL || entry->time < oldest->time)) {
+                oldest = entry;
+            }
+        }
+        oldest->dirty = 0;
+        out[n++] = oldest->rec;
+    }
+
+    table->tokens -= (int64_t)cost * 1000000;
+    table->frames++;
+    table->records += n;
+    return n;
+}
@@ -0,0 +1,71 @@
+#ifndef NET_HEALTH_H
+#define NET_HEALTH_H
+
+/*
+* Health records of the subtree, kept by every node and merged on the way up:
+*  there is one entry per node, and a newer record replaces the older one
+*  whether that went up-stream yet or not.  Sending is paced by a byte budget
+*  (token bucket), so the telemetry on a link stays within it however large
+*  the subtree below is; larger subtrees only see their records refreshed
+*  less often.
+*
+* The table does no locking and no I/O.
+*/
+#include <stdint.h>
+
+#define HEALTH_SIZE 48
+#define HEALTH_APPS 3
+
+typedef struct __attribute__((packed)) HealthRecord {
+	uint8_t		id;
+	uint8_t		parent;		// zero for the root
+	int8_t		rssi;		// link to parent, dBm
+	uint8_t		reset;		// esp_reset_reason() of the last start
+	uint8_t		cpu[2];		// load per core, percent
+	uint8_t		out_hwm;	// outbound queue high-water mark since the last record
+	uint8_t		pad;
+	uint16_t	heap;		// free heap, 16 byte units
+	uint16_t	heap_min;	// lowest free heap since start, 16 byte units
+	uint32_t	uptime;		// seconds
+	uint8_t		app[HEALTH_APPS];	// apps with the most inbound drops, zero if unused
+	uint16_t	drops[HEALTH_APPS];	// saturating
+} HealthRecord;
+
+typedef struct HealthEntry {
+	HealthRecord	rec;
+	int64_t			time;	// stored, microseconds
+	int				dirty;	// changed since last taken
+} HealthEntry;
+
+typedef struct HealthTable {
+	HealthEntry	entry[HEALTH_SIZE];
+	uint32_t	count;
+	uint32_t	budget;		// bytes per second
+	int64_t		tokens;		// bytes per second times microseconds
+	int64_t		refill;		// last refill
+	uint32_t	stored;
+	uint32_t	merged;		// records replaced before they were taken
+	uint32_t	evicted;	// entries dropped for space or age
+	uint32_t	frames;		// taken, one frame each
+	uint32_t	records;
+	uint32_t	deferred;	// takes refused by the budget
+} HealthTable;
+
+void health_init(HealthTable* table, uint32_t budget, int64_t now);
+
+// Stores 'rec' by its id, evicting the oldest entry if the table is full.
+void health_put(HealthTable* table, const HealthRecord* rec, int64_t now);
+
+const HealthEntry* health_find(const HealthTable* table, uint8_t id);
+
+// Drops the entries not refreshed within 'age'.
+void health_expire(HealthTable* table, int64_t age, int64_t now);
+
+/*
+* Takes up to 'max' changed records for one frame costing 'cost' bytes, oldest
+*  first, and charges the budget.  Returns the number taken, zero when nothing
+*  changed or the budget does not allow the frame yet.
+*/
+uint32_t health_take(HealthTable* table, HealthRecord* out, uint32_t max, uint32_t cost, int64_t now);
+
+#endif
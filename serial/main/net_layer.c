@@ -1,6 +1,8 @@
 #include <assert.h>
 #include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <freertos/FreeRTOS.h>
@@ -9,7 +11,9 @@
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 
+#include <nvs.h>
 #include <nvs_flash.h>
+#include <esp_system.h>
 #include <esp_wifi.h>
 #include <esp_now.h>
 #include <esp_netif.h>
@@ -18,42 +22,112 @@
 
 #include "network.h"
 #include "net_layer.h"
+#include "net_crypto.h"
 #include "serial.h"
+#include "utils.h"
 
 static const char* TAG = "NetworkLayer";
 
 NodeState node;
 LinkEntry link_broadcast = {
     {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
-    0xFF,
-    NULL
+    0xFF
 };
 
 QueueHandle_t outbound;
 
+static portMUX_TYPE counter_lock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE time_lock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE group_lock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE health_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// CCM contexts set up once per key, NET_ENCRYPT only: the mesh key and, with
+//  NET_LINK_KX, the key of each link table entry.  Application tasks seal with them while
+//  svc_network re-keys entries, key_lock keeps the two apart.
+static crypto_key_t mesh_ccm;
+static crypto_key_t link_ccm[LINK_TABLE_SIZE];
+static SemaphoreHandle_t key_lock;
+
+#if defined(NET_CAPTURE)
+static CaptureRing capture = { .lock = portMUX_INITIALIZER_UNLOCKED };
+#endif
 
 
 int net_init(uint8_t node_id, int isDebugRoot) {
-    assert(node_id != 0);
+    // The root hands out the leases, so it cannot get its own id from one.
+    assert(node_id != 0 || !isDebugRoot);
 
     init_sys();
+
+    if (node_id == 0) {
+        node_id = lease_stored_id();
+    }
+    if (node_id == 0) {
+        node_id = LEASE_PROVISIONAL + esp_random() % (link_broadcast.id - LEASE_PROVISIONAL);
+        ESP_LOGI(TAG, "No node-id, joining as 0x%02X until the root grants a lease.", node_id);
+    }
     init_node(&node, node_id);
 
     if (isDebugRoot) {
         node.link_table.usage |= (1ul << LINK_UP);
         node.isRoot = 1;
+        node.flags |= STATE_LEASED;
+        // The root's clock is the network time base.
+        node.clock.synced = 1;
+
+        node.leases = calloc(1, sizeof(LeaseTable));
+        if (node.leases == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate lease table.");
+            return -1;
+        }
+        lease_init(node.leases, LEASE_LIFETIME);
+        lease_reserve(node.leases, node.id);
+        lease_load();
     }
     else {
         uint64_t wnd = PERIOD_LOCATE + (esp_random() % WINDOW_LOCATE);
-        if (esp_timer_start_once(node.join_timer, wnd) != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to start network join timer.");
-            return -1;
-        }
+        wheel_start(&node.wheel, &node.join_timer, wnd);
+#if defined(NET_LATERAL)
+        wheel_start(&node.wheel, &node.lateral.beacon, PERIOD_LATERAL);
+#endif
     }
 
+    wheel_start(&node.wheel, &node.health.timer, TICK_HEALTH + (esp_random() % WINDOW_HEALTH));
+
+    // From here on only svc_network touches the timer wheel.
+    xTaskCreatePinnedToCore(
+        worker_network,
+        "svc_network",
+        8192,
+        NULL,
+        7,
+        &node.svc_network,
+        1);
+
+#if defined(NET_LINK_KX)
+    // The X25519 work of the LINK key exchange, below the network tasks and
+    //  on the other core.  The stack is sized for the mbedtls ECP code.
+    xTaskCreatePinnedToCore(
+        worker_kx,
+        "svc_kx",
+        8192,
+        NULL,
+        2,
+        &node.svc_kx,
+        0);
+#endif
+
     return 0;
 }
 
+uint8_t net_node_id() {
+    return node.id;
+}
+
+int net_has_uplink() {
+    return has_uplink(&node.link_table);
+}
+
 /**
  * Basic adaptation of net_table
  *
@@ -84,12 +158,339 @@ void net_info()
         }
     }
 
+#if defined(NET_LATERAL)
+    for (int i = 0; i < LATERAL_SIZE; ++i)
+    {
+        if (node.lateral.usage & (1ul << i))
+        {
+            const LinkEntry *peer = node.lateral.entry + i;
+            results++;
+            snprintf(buf, sizeof(buf), "L%d %02X %02X:%02X:%02X:%02X:%02X:%02X",
+                     i, peer->id, peer->mac[0], peer->mac[1], peer->mac[2],
+                     peer->mac[3], peer->mac[4], peer->mac[5]);
+            serial_out(buf);
+        }
+    }
+#endif
+
     if (!results)
     {
         serial_out("empty table");
     }
 }
 
+/**
+ * Collects the topology of the tree below this node and prints
+ * one "<id> <parent> <rssi>" line per node to serial out
+ *
+ * NOTE: Blocks the calling task for up to TIMEOUT_MAP, root only
+ */
+void net_map_info()
+{
+    char buf[40];
+
+    if (!node.isRoot)
+    {
+        serial_out("not root");
+        return;
+    }
+    if (map_collect() != 0)
+    {
+        serial_out("network busy");
+        return;
+    }
+
+    for (uint32_t i = 0; i < node.map.count; ++i)
+    {
+        snprintf(buf, sizeof(buf), "%02X %02X %d %u",
+                 node.map.record[i].id,
+                 node.map.record[i].parent,
+                 node.map.record[i].rssi,
+                 node.map.record[i].time_err);
+        serial_out(buf);
+    }
+}
+
+/*
+* Runs a MAP collection round from the root and waits for it, for at most
+*  TIMEOUT_MAP.  Returns 0 once node.map holds the result.
+*/
+int map_collect()
+{
+    // The round itself runs on svc_network, like every other timer user.
+    NetEvent evt = {};
+    evt.type = EVENT_MAP;
+
+    xEventGroupClearBits(node.events, EVT_MAP_DONE);
+    if (xQueueSend(node.inbound, &evt, WAIT_LOCK) != pdTRUE) {
+        return -1;
+    }
+    xEventGroupWaitBits(node.events, EVT_MAP_DONE, pdTRUE, pdTRUE,
+                        (TIMEOUT_MAP / 1000 + 500) / portTICK_PERIOD_MS);
+    return 0;
+}
+
+/**
+ * Prints this node's mesh time state as
+ * "time <us> err <us> drift <ppb> delay <us> samples <n> rejected <n>"
+ *
+ * At root also collects the map and prints the error bound
+ * against hop count, "hop <n> nodes <n> err <avg us> <max us>"
+ */
+void net_time_info()
+{
+    char buf[80];
+    uint32_t err;
+    int64_t now = net_time_us(&err);
+
+    snprintf(buf, sizeof(buf), "time %lld err %d drift %d delay %u samples %u rejected %u",
+             now, (err == UINT32_MAX ? -1 : (int)err), node.clock.drift,
+             node.clock.delay, node.clock.samples, node.clock.rejected);
+    serial_out(buf);
+
+    if (!node.isRoot)
+    {
+        return;
+    }
+    if (map_collect() != 0)
+    {
+        serial_out("network busy");
+        return;
+    }
+
+    // Hop count of every record, parents are listed before their children.
+    uint8_t hops[MAP_SIZE] = {};
+    for (uint32_t i = 1; i < node.map.count; ++i)
+    {
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            if (node.map.record[j].id == node.map.record[i].parent)
+            {
+                hops[i] = hops[j] + 1;
+                break;
+            }
+        }
+    }
+
+    for (uint8_t h = 1; h < MAP_SIZE; ++h)
+    {
+        uint32_t count = 0, unknown = 0, sum = 0, max = 0;
+        for (uint32_t i = 1; i < node.map.count; ++i)
+        {
+            if (hops[i] != h)
+                continue;
+            if (node.map.record[i].time_err == UINT16_MAX)
+            {
+                unknown++;
+                continue;
+            }
+            count++;
+            sum += node.map.record[i].time_err;
+            max = (node.map.record[i].time_err > max ? node.map.record[i].time_err : max);
+        }
+        if (!count && !unknown)
+            break;
+
+        snprintf(buf, sizeof(buf), "hop %u nodes %u err %u %u unsynced %u",
+                 h, count, (count ? sum / count : 0), max, unknown);
+        serial_out(buf);
+    }
+}
+
+/**
+ * Prints the cost of the last LINK handshake on this node
+ * as "kx <crypto us> <crypto cycles> <join us>"
+ *
+ * NOTE: join is LOCATE to up-stream link and zero at root
+ */
+void net_kx_info()
+{
+    char buf[64];
+
+    snprintf(buf, sizeof(buf), "kx %lld %u %lld",
+             node.kx.cost_us, node.kx.cost_cycles, node.kx.join_us);
+    serial_out(buf);
+}
+
+/**
+ * Prints the dispatch counters of svc_network and the result of
+ * the link table consistency check
+ *
+ * frames/s is what the dispatcher could sustain at its average cost
+ */
+void net_stats_info()
+{
+    char buf[80];
+    float avg = (node.stats.frames ? (float)node.stats.busy_us / node.stats.frames : 0);
+
+    snprintf(buf, sizeof(buf), "frames %u malformed %u dropped %u unlinked %u",
+             node.stats.frames, node.stats.malformed, node.stats.dropped, node.stats.unlinked);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "dispatch %.1fus avg %lldus max %.0f frames/s",
+             avg, node.stats.max_us, (avg > 0 ? 1000000.0f / avg : 0));
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "outbound %u queued %u would block %s",
+             uxQueueMessagesWaiting(outbound), node.stats.would_block,
+             (net_congested() ? "congested" : "clear"));
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "group %u sent %u frames %u pruned %08X subtree",
+             node.stats.group_sends, node.stats.group_frames, node.stats.group_pruned,
+             subtree_groups());
+    serial_out(buf);
+#if defined(NET_LATERAL)
+    snprintf(buf, sizeof(buf), "lateral %d peers %u failovers %lldus recovery %u sent %u relayed",
+             __builtin_popcount(node.lateral.usage), node.lateral.failovers,
+             node.lateral.recovery_us, node.lateral.sent, node.lateral.relayed);
+    serial_out(buf);
+#endif
+    if (node.isRoot) {
+        snprintf(buf, sizeof(buf), "lease %d held %u granted %u renewed %u conflicts %u refused",
+                 lease_count(node.leases), node.leases->granted, node.leases->renewed,
+                 node.leases->conflicts, node.leases->exhausted);
+    }
+    else {
+        snprintf(buf, sizeof(buf), "lease %02X %s %u conflicts", node.id,
+                 (node.flags & STATE_LEASED ? "leased" : "provisional"), node.stats.lease_conflicts);
+    }
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "table %d", check_table());
+    serial_out(buf);
+}
+
+/**
+ * Prints the health records this node holds, the whole tree at root,
+ * one line per node:
+ * "<id> <parent> <rssi> up <s> reset <n> heap <B> <min B> cpu <%> <%> hwm <n> age <s> drops <app>:<n>.."
+ *
+ * Then the telemetry counters, and what it cost up-stream against the budget
+ */
+void net_health_info()
+{
+    char buf[128];
+    HealthTable *table = malloc(sizeof(HealthTable));
+    if (table == NULL)
+    {
+        serial_out("out of memory");
+        return;
+    }
+
+    portENTER_CRITICAL(&health_lock);
+    memcpy(table, &node.health.table, sizeof(HealthTable));
+    portEXIT_CRITICAL(&health_lock);
+
+    int64_t now = esp_timer_get_time();
+    for (uint32_t i = 0; i < table->count; ++i)
+    {
+        const HealthRecord *rec = &table->entry[i].rec;
+        int len = snprintf(buf, sizeof(buf), "%02X %02X %d up %u reset %u heap %u %u cpu %u %u hwm %u age %lld drops",
+                           rec->id, rec->parent, rec->rssi, rec->uptime, rec->reset,
+                           rec->heap * 16, rec->heap_min * 16, rec->cpu[0], rec->cpu[1], rec->out_hwm,
+                           (now - table->entry[i].time) / US_FACTOR);
+        for (int a = 0; a < HEALTH_APPS && rec->app[a]; ++a)
+        {
+            len += snprintf(buf + len, sizeof(buf) - len, " %u:%u", rec->app[a], rec->drops[a]);
+        }
+        serial_out(buf);
+    }
+
+    snprintf(buf, sizeof(buf), "health %u nodes %u stored %u merged %u evicted",
+             table->count, table->stored, table->merged, table->evicted);
+    serial_out(buf);
+    snprintf(buf, sizeof(buf), "up %u frames %u records %u deferred %lld B/s budget %u B/s",
+             table->frames, table->records, table->deferred,
+             table->frames * (int64_t)sizeof(NetFrame) * US_FACTOR / (now > 0 ? now : 1), table->budget);
+    serial_out(buf);
+    free(table);
+}
+
+/*
+* Records a raw frame into the capture ring along with a microsecond timestamp,
+*  its direction and the peer's MAC (NULL if not known).  Called from the
+*  esp-now receive callback and the send worker, so the ring is guarded by a
+*  spinlock rather than a semaphore.
+*/
+void capture_frame(const uint8_t* mac, const uint8_t* data, uint8_t direction) {
+#if defined(NET_CAPTURE)
+    if (!capture.enabled) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&capture.lock);
+    CaptureEntry* entry = capture.entry + capture.next;
+    entry->time = now;
+    entry->direction = direction;
+    if (mac != NULL) {
+        memcpy(entry->mac, mac, 6);
+    }
+    else {
+        memset(entry->mac, 0, 6);
+    }
+    memcpy(&entry->frame, data, sizeof(NetFrame));
+
+    capture.next = (capture.next + 1) % CAPTURE_SIZE;
+    if (capture.count < CAPTURE_SIZE) {
+        capture.count++;
+    }
+    capture.total++;
+    portEXIT_CRITICAL(&capture.lock);
+#endif
+}
+
+void net_capture_enable(int enabled) {
+#if defined(NET_CAPTURE)
+    capture.enabled = enabled;
+#endif
+}
+
+void net_capture_clear() {
+#if defined(NET_CAPTURE)
+    portENTER_CRITICAL(&capture.lock);
+    capture.next = 0;
+    capture.count = 0;
+    capture.total = 0;
+    portEXIT_CRITICAL(&capture.lock);
+#endif
+}
+
+/**
+ * Dumps the capture ring to serial out, oldest entry first
+ *
+ * The first line is "capture <count> <total> <entry size>", followed by one
+ * base64 encoded CaptureEntry per line.  stdout translates line endings so the
+ * entries cannot be written as raw bytes.
+ */
+void net_capture_dump()
+{
+#if defined(NET_CAPTURE)
+    char buf[MSG_BUFFER_LENGTH];
+    CaptureEntry entry;
+
+    portENTER_CRITICAL(&capture.lock);
+    uint32_t count = capture.count;
+    uint32_t total = capture.total;
+    uint32_t first = (capture.next + CAPTURE_SIZE - count) % CAPTURE_SIZE;
+    portEXIT_CRITICAL(&capture.lock);
+
+    snprintf(buf, sizeof(buf), "capture %u %u %u", count, total, sizeof(CaptureEntry));
+    serial_out(buf);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // Copy out under the lock so a concurrent capture cannot tear the entry.
+        portENTER_CRITICAL(&capture.lock);
+        memcpy(&entry, capture.entry + ((first + i) % CAPTURE_SIZE), sizeof(CaptureEntry));
+        portEXIT_CRITICAL(&capture.lock);
+
+        base64_encode((const uint8_t*)&entry, sizeof(CaptureEntry), buf, sizeof(buf));
+        serial_out(buf);
+    }
+#else
+    serial_out("capture disabled");
+#endif
+}
+
 
 int net_register_app(uint16_t app_id) {
     assert(app_id > 0);
@@ -98,7 +499,8 @@ int net_register_app(uint16_t app_id) {
     for (int i = 0; i < 32; ++i) {
         uint32_t mask = (1ul << i);
         if (!(node.app_table.usage & mask)) {
-            if (node.app_table.apps[i].id == 0 && slot >= 32) {
+            // Prefer the slot the app held before, its queue is still there.
+            if (node.app_table.apps[i].id == app_id || (node.app_table.apps[i].id == 0 && slot >= 32)) {
                 slot = i;
             }
         }
@@ -119,19 +521,62 @@ int net_register_app(uint16_t app_id) {
     }
     node.app_table.usage |= (1ul << slot);
     node.app_table.apps[slot].id = app_id;
-    node.app_table.apps[slot].inbound = xQueueCreate(INBOUND_QUEUE_SIZE, sizeof(app_header_t) + NET_MAX_PAYLOAD);
+    if (node.app_table.apps[slot].inbound == NULL) {
+        node.app_table.apps[slot].inbound = xQueueCreate(INBOUND_QUEUE_SIZE, sizeof(app_header_t) + NET_MAX_PAYLOAD);
+    }
+    else {
+        xQueueReset(node.app_table.apps[slot].inbound);
+    }
     xSemaphoreGive(node.app_table.lock);
     return 0;
 }
 
 
+/*
+* The slot keeps its id and queue: svc_network may still hold the handle from
+*  a lookup, and registering the app again reuses both.  The caller must not
+*  be waiting in net_receive(..) for the app any more.
+*/
 int net_unregister_app(uint16_t app_id) {
-    ESP_LOGW(TAG, "net_unregister_app(..) is currently stubbed in.  Functionality reserved for future versions.");
-    return -1;
+    int result = -1;
+
+    while (xSemaphoreTake(node.app_table.lock, WAIT_LOCK) != pdTRUE) {
+        // Spin..
+    }
+    for (int i = 0; i < 32; ++i) {
+        uint32_t mask = (1ul << i);
+        if ((node.app_table.usage & mask) && node.app_table.apps[i].id == app_id) {
+            node.app_table.usage &= ~mask;
+            result = 0;
+            break;
+        }
+    }
+    xSemaphoreGive(node.app_table.lock);
+
+    if (result != 0) {
+        ESP_LOGW(TAG, "Application type %d is not registered.", app_id);
+    }
+    return result;
 }
 
 
 int net_send_up(const app_header_t* head, const uint8_t* data) {
+    return send_up(head, data, 0);
+}
+
+
+int net_send_up_timeout(const app_header_t* head, const uint8_t* data, int32_t timeout) {
+    return send_up(head, data, to_ticks(timeout));
+}
+
+/*
+* Converts a net_* timeout in milliseconds to ticks, negative waits forever.
+*/
+TickType_t to_ticks(int32_t timeout) {
+    return (timeout < 0 ? portMAX_DELAY : timeout / portTICK_RATE_MS);
+}
+
+int send_up(const app_header_t* head, const uint8_t* data, TickType_t wait) {
     assert(head != NULL);
     assert(data != NULL);
 
@@ -142,7 +587,14 @@ int net_send_up(const app_header_t* head, const uint8_t* data) {
 
     // NOTE: This method does NOT verify that outbound packets have a valid app-id.
 
-    if (!has_uplink(&node.link_table)) {
+    NodeId via = (has_uplink(&node.link_table) ? node.link_table.entry[LINK_UP].id : 0);
+#if defined(NET_LATERAL)
+    LinkEntry* lateral = lateral_route();
+    if (lateral != NULL) {
+        via = lateral->id;
+    }
+#endif
+    if (via == 0) {
         ESP_LOGW(TAG, "net_send_up(..) failure.  No up-stream link.");
         return -1;
     }
@@ -154,7 +606,7 @@ int net_send_up(const app_header_t* head, const uint8_t* data) {
     NetFrame out = {};
     out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
     out.head.source = node.id;
-    out.head.destination = node.link_table.entry[LINK_UP].id;
+    out.head.destination = via;
     out.head.control = CONTROL_DEFAULT;
 
     memcpy(out.contents, head, sizeof(app_header_t));
@@ -162,13 +614,66 @@ int net_send_up(const app_header_t* head, const uint8_t* data) {
     // NOTE: Is this still well-behaved if len == 0?  Verify.
     memcpy(out.contents + sizeof(app_header_t), data, head->len);
 
+    if (seal_frame(&out) != 0) {
+        ESP_LOGE(TAG, "net_send_up(..) failure.  Could not encrypt frame.");
+        return -3;
+    }
+
     out.head.checksum = pak_checksum(&out);
-    net_send_raw(&out);
-    return 0;
+
+    int result = net_queue_frame(&out, wait);
+#if defined(NET_LATERAL)
+    if (lateral != NULL && result == 0) {
+        node.lateral.sent++;
+        if (node.lateral.lost_time && !node.lateral.recovery_us) {
+            node.lateral.recovery_us = esp_timer_get_time() - node.lateral.lost_time;
+        }
+    }
+#endif
+    return result;
 }
 
 
 int net_send_down(const app_header_t* head, const uint8_t* data) {
+    return send_down(0, head, data, 0);
+}
+
+
+int net_send_down_timeout(const app_header_t* head, const uint8_t* data, int32_t timeout) {
+    return send_down(0, head, data, to_ticks(timeout));
+}
+
+
+int net_send_group(uint8_t group, const app_header_t* head, const uint8_t* data) {
+    if (group == 0 || group >= GROUP_MAX) {
+        ESP_LOGW(TAG, "net_send_group(..) failure.  Invalid group: %d", group);
+        return -3;
+    }
+    return send_down(group, head, data, 0);
+}
+
+
+int net_join_group(uint8_t group) {
+    if (group == 0 || group >= GROUP_MAX) {
+        return -1;
+    }
+    return set_group(group, 1);
+}
+
+
+int net_leave_group(uint8_t group) {
+    if (group == 0 || group >= GROUP_MAX) {
+        return -1;
+    }
+    return set_group(group, 0);
+}
+
+/*
+* Sends an application frame to every down-stream link, or with a non-zero
+*  group only to the links whose subtree has members of that group.  'wait'
+*  bounds the whole call, not each copy.
+*/
+int send_down(uint8_t group, const app_header_t* head, const uint8_t* data, TickType_t wait) {
     assert(head != NULL);
     assert(data != NULL);
 
@@ -177,68 +682,167 @@ int net_send_down(const app_header_t* head, const uint8_t* data) {
         return -2;
     }
 
-    NetFrame out = {};
-    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
-    out.head.source = node.id;
-    out.head.control = CONTROL_DEFAULT;
+    NetFrame plain = {};
+    plain.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    plain.head.source = node.id;
+    plain.head.control = CONTROL_DEFAULT;
+    plain.head.reserved[RES_GROUP] = group;
 
-    memcpy(out.contents, head, sizeof(app_header_t));
+    memcpy(plain.contents, head, sizeof(app_header_t));
     // NOTE: Is this still well-behaved if len == 0?  Verify.
-    memcpy(out.contents + sizeof(app_header_t), data, head->len);
+    memcpy(plain.contents + sizeof(app_header_t), data, head->len);
 
+    TickType_t start = xTaskGetTickCount();
+    int result = 0;
+
+    NetFrame out;
     for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
         if (i == LINK_UP)
             continue;
 
         if (node.link_table.usage & (1ul << i)) {
+            if (group && !(node.link_table.entry[i].groups & (1ul << group))) {
+                node.stats.group_pruned++;
+                continue;
+            }
+            if (group) {
+                node.stats.group_frames++;
+            }
+
+            // Each copy is sealed for its own destination.
+            memcpy(&out, &plain, sizeof(NetFrame));
             out.head.destination = node.link_table.entry[i].id;
+            if (seal_frame(&out) != 0) {
+                ESP_LOGE(TAG, "net_send_down(..) failure.  Could not encrypt frame.");
+                continue;
+            }
             out.head.checksum = pak_checksum(&out);
-            net_send_raw(&out);
+
+            TickType_t left = wait;
+            if (wait != portMAX_DELAY) {
+                TickType_t spent = xTaskGetTickCount() - start;
+                left = (spent < wait ? wait - spent : 0);
+            }
+            if (net_queue_frame(&out, left) != 0) {
+                result = NET_WOULD_BLOCK;
+            }
         }
     }
-    return 0;
-}
-
-int net_receive(uint16_t app_id, app_header_t* h, uint8_t* d, int32_t timeout) {
-    assert(app_id > 0);
-    assert(h != NULL);
-    assert(d != NULL);
 
-    uint8_t buffer[NET_MAX_PAYLOAD + sizeof(app_header_t)];
-
-    // Some offset pointers for convenience into the buffer.
-    app_header_t* head = (app_header_t*)buffer;
-    uint8_t* data = buffer + sizeof(app_header_t);
+    if (group) {
+        node.stats.group_sends++;
+    }
+    return result;
+}
 
-    QueueHandle_t qh = find_app(app_id);
+/*
+* Changes this node's own membership.  The subtree mask is reported up-stream
+*  by svc_network, so the change is handed to it as an event: -2 before
+*  net_init() has set it up.
+*/
+int set_group(uint8_t group, int member) {
+    NetEvent evt = {};
+    evt.type = EVENT_GROUP;
 
-    if (qh == NULL) {
-        ESP_LOGE(TAG, "Error: Application type %d not registered.", app_id);
-        return -1;
+    if (node.inbound == NULL) {
+        ESP_LOGW(TAG, "Group change refused, the network layer is not initialized.");
+        return -2;
     }
 
-    if (timeout < 0) {
-        while (xQueueReceive(qh, buffer, UINT32_MAX) != pdTRUE) {
-            // Spin...
-        }
+    portENTER_CRITICAL(&group_lock);
+    if (member) {
+        node.groups |= (1ul << group);
     }
     else {
-        if (xQueueReceive(qh, buffer, timeout / portTICK_RATE_MS) != pdTRUE) {
-            return -2;
-        }
+        node.groups &= ~(1ul << group);
     }
+    portEXIT_CRITICAL(&group_lock);
 
-    if (head->len > NET_MAX_PAYLOAD) {
-        ESP_LOGW(TAG, "Received nominally overlength (%d) packet, truncating.", head->len);
-        head->len = NET_MAX_PAYLOAD;
+    if (xQueueSend(node.inbound, &evt, WAIT_LOCK) != pdTRUE) {
+        // The next STATUS request carries the mask anyway.
+        ESP_LOGW(TAG, "Group change not reported, network event queue full.");
     }
-    memcpy(h, head, sizeof(app_header_t));
-    memcpy(d, data, head->len);
     return 0;
 }
 
+/*
+* Returns the groups with members in the subtree rooted at this node.
+*/
+uint32_t subtree_groups() {
+    portENTER_CRITICAL(&group_lock);
+    uint32_t groups = node.groups;
+    portEXIT_CRITICAL(&group_lock);
+
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        if (i != LINK_UP && node.link_table.usage & (1ul << i)) {
+            groups |= node.link_table.entry[i].groups;
+        }
+    }
+    return groups;
+}
+
+/*
+* Reports the subtree mask up-stream if it changed since the last report.
+*/
+void group_update() {
+    uint32_t groups = subtree_groups();
+
+    if (node.isRoot || !has_uplink(&node.link_table) || groups == node.groups_reported) {
+        return;
+    }
+    node.groups_reported = groups;
+
+    NetFrame out = {};
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = node.link_table.entry[LINK_UP].id;
+    out.head.control = CONTROL_GROUP;
+    memcpy(out.head.reserved + RES_GROUPS, &groups, sizeof(uint32_t));
+    out.head.checksum = pak_checksum(&out);
+
+    net_send_raw(&out);
+}
+
+int net_receive(uint16_t app_id, app_header_t* h, uint8_t* d, int32_t timeout) {
+    assert(app_id > 0);
+    assert(h != NULL);
+    assert(d != NULL);
+
+    uint8_t buffer[NET_MAX_PAYLOAD + sizeof(app_header_t)];
+
+    // Some offset pointers for convenience into the buffer.
+    app_header_t* head = (app_header_t*)buffer;
+    uint8_t* data = buffer + sizeof(app_header_t);
+
+    QueueHandle_t qh = find_app(app_id);
+
+    if (qh == NULL) {
+        ESP_LOGE(TAG, "Error: Application type %d not registered.", app_id);
+        return -1;
+    }
+
+    if (timeout < 0) {
+        while (xQueueReceive(qh, buffer, UINT32_MAX) != pdTRUE) {
+            // Spin...
+        }
+    }
+    else {
+        if (xQueueReceive(qh, buffer, timeout / portTICK_RATE_MS) != pdTRUE) {
+            return -2;
+        }
+    }
+
+    if (head->len > NET_MAX_PAYLOAD) {
+        ESP_LOGW(TAG, "Received nominally overlength (%d) packet, truncating.", head->len);
+        head->len = NET_MAX_PAYLOAD;
+    }
+    memcpy(h, head, sizeof(app_header_t));
+    memcpy(d, data, head->len);
+    return 0;
+}
+
+
 
-
 /*
 * TIMER CALLBACK method for the LINK proposals originating from this node.
 *  This callback only fires if the timeout for response has elapsed.
@@ -248,6 +852,7 @@ void timer_cb_pending_link(void* param) {
     esp_now_del_peer(node.pending_mac);
     memset(node.pending_mac, 0, 6);
     node.pending_id = 0;
+    node.pending_branch = 0;
 }
 
 /*
@@ -264,17 +869,42 @@ void timer_cb_locating(void* param) {
         ESP_LOGW(TAG, "Failed to join network -- no nodes proposed LINK.");
 
         uint64_t wnd = PERIOD_LOCATE + (esp_random() % WINDOW_LOCATE);
-        if (esp_timer_start_once(node.join_timer, wnd) != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to start network join timer.");
-        }
+        wheel_start(&node.wheel, &node.join_timer, wnd);
         return;
     }
 
+    // Pick a random node of those that responded.  With NET_LINK_KX the link
+    //  key is derived on svc_kx and join_uplink() follows on its EVENT_KX.
+    uint32_t x = esp_random() % node.loc_count;
+    if (kx_confirm(x) != 0) {
+        ESP_LOGE(TAG, "Failed to derive up-stream link key.");
+        node.loc_count = 0;
+        wheel_start(&node.wheel, &node.join_timer, PERIOD_LOCATE);
+    }
+}
+
+/*
+* Links up to proposal 'x' of the last LOCATE round with the derived link key
+*  (zero without NET_LINK_KX), confirming it to the proposer in our LINK.
+*/
+void join_uplink(uint32_t x, const uint8_t* key) {
     NetFrame out = {};
     esp_now_peer_info_t peerInfo = {};
 
-    // Pick a random node of those that responded.
-    uint32_t x = esp_random() % node.loc_count;
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = node.loc_response[x].id;
+    out.head.control = CONTROL_LINK;
+    out.head.reserved[RES_IDENT] = node.loc_ident;
+
+    if (kx_prove(x, &out, key) != 0) {
+        ESP_LOGE(TAG, "Failed to confirm up-stream link key.");
+        node.loc_count = 0;
+        wheel_start(&node.wheel, &node.join_timer, PERIOD_LOCATE);
+        return;
+    }
+    out.head.checksum = pak_checksum(&out);
+
     memcpy(peerInfo.peer_addr, node.loc_response[x].mac, 6);
     peerInfo.channel = 0;
     peerInfo.ifidx = ESP_IF_WIFI_STA;
@@ -284,21 +914,36 @@ void timer_cb_locating(void* param) {
         return;
     }
 
-    form_uplink(&node.link_table, node.loc_response[x].mac, node.loc_response[x].id);
+    // The retry armed while svc_kx derived the key.
+    wheel_stop(&node.wheel, &node.join_timer);
 
-    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
-    out.head.source = node.id;
-    out.head.destination = node.loc_response[x].id;
-    out.head.control = CONTROL_LINK;
-    out.head.reserved[RES_IDENT] = node.loc_ident;
-    out.head.checksum = pak_checksum(&out);
+    form_uplink(&node.link_table, node.loc_response[x].mac, node.loc_response[x].id);
+    node.lateral.lost_time = 0;
+    node.lateral.up_fails = 0;
+    node.tdma.depth = node.tdma.offer_depth[x] + 1;
+    node.tdma.branch = node.tdma.offer_branch[x];
+    node.clock.min_delay = 0;
+    link_rekey(node.link_table.entry + LINK_UP, key);
 
     net_send_raw(&out);
 
-    ESP_LOGI(TAG, "Added up-stream link 0x%02X", node.loc_response[x].id);
+    // Learn depth and time from the new parent now rather than in a period.
+    wheel_start(&node.wheel, &node.link_table.entry[LINK_UP].timer, CLOCK_FIRST_SYNC);
+
+    // The new parent knows nothing of this subtree's groups yet.
+    node.groups_reported = 0;
+    group_update();
+
+    // Confirm (or obtain) our node-id, the LINK frame is queued ahead.
+    wheel_start(&node.wheel, &node.lease_timer, 0);
+
+    node.kx.join_us = esp_timer_get_time() - node.kx.locate_time;
+    ESP_LOGI(TAG, "Added up-stream link 0x%02X after %lld us, key exchange %lld us / %u cycles",
+             node.loc_response[x].id, node.kx.join_us, node.kx.cost_us, node.kx.cost_cycles);
 
     node.loc_count = 0;
     memset(node.loc_response, 0, sizeof(LinkEntry) * LOCATE_SIZE);
+    memset(node.kx.offer, 0, sizeof(node.kx.offer));
 }
 
 /*
@@ -308,6 +953,11 @@ void timer_cb_locating(void* param) {
 void timer_cb_up_status(void* param) {
     ESP_LOGE(TAG, "Failed to receive up-stream status response.");
 
+#if defined(NET_LATERAL)
+    if (lateral_failover()) {
+        return;
+    }
+#endif
     exec_blackout();
 }
 
@@ -327,23 +977,21 @@ void timer_cb_upstream(void* param) {
     out.head.source = node.id;
     out.head.destination = node.link_table.entry[LINK_UP].id;
     out.head.control = CONTROL_STATUS;
+
+    // Refresh the subtree mask in case a CONTROL_GROUP report was lost.
+    node.groups_reported = subtree_groups();
+    memcpy(out.head.reserved + RES_GROUPS, &node.groups_reported, sizeof(uint32_t));
     out.head.checksum = pak_checksum(&out);
 
     net_send_raw(&out);
 
-    if (esp_timer_start_once(node.status_timer, TIMEOUT_STATUS) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start STATUS check timer.");
-        return;
-    }
+    wheel_start(&node.wheel, &node.status_timer, TIMEOUT_STATUS);
 
     node.flags |= STATE_UPLINK_STATUS;
 
     // Restart the up-stream check timer.
     uint64_t wnd = PERIOD_UP_STATUS + (esp_random() % WINDOW_UP_STATUS);
-    if (esp_timer_start_once(node.link_table.entry[LINK_UP].timer, wnd) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to restart up-stream status timer.");
-        return;
-    }
+    wheel_start(&node.wheel, &node.link_table.entry[LINK_UP].timer, wnd);
 }
 
 /*
@@ -361,7 +1009,20 @@ void timer_cb_downstream(void* param) {
 
     node.link_table.usage &= ~(1ul << x);
     node.link_table.entry[x].id = 0;
+    node.link_table.entry[x].groups = 0;
     memset(node.link_table.entry[x].mac, 0, 6);
+
+    group_update();
+}
+
+/*
+* TIMER CALLBACK method -- the budget for a MAP collection round has elapsed
+*  before every child replied.  Answer with whatever has been merged so far.
+*/
+void timer_cb_map(void* param) {
+    ESP_LOGW(TAG, "MAP collection budget elapsed, replying with %u records.", node.map.count);
+
+    map_complete();
 }
 
 /*
@@ -369,37 +1030,219 @@ void timer_cb_downstream(void* param) {
 *  a network, by sending out a LOCATE packet.
 */
 void timer_cb_join(void* param) {
-    node.flags |= STATE_LOCATING;
-
     NetFrame out = {};
     out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
     out.head.source = node.id;
     out.head.destination = link_broadcast.id;
     out.head.control = CONTROL_LOCATE;
     out.head.reserved[RES_IDENT] = ++node.loc_ident;
+
+    // Offers of a round whose key derivation never came back.
+    node.loc_count = 0;
+    node.kx.locate_time = esp_timer_get_time();
+    if (kx_locate(&out) != 0) {
+        ESP_LOGE(TAG, "Failed to prepare LOCATE key exchange.");
+        wheel_start(&node.wheel, &node.join_timer, PERIOD_LOCATE);
+        return;
+    }
+    out.head.checksum = pak_checksum(&out);
+
+    node.flags |= STATE_LOCATING;
+
+    net_send_raw(&out);
+
+    wheel_start(&node.wheel, &node.loc_timer, TIMEOUT_LOCATE);
+}
+
+/*
+* TIMER CALLBACK method -- broadcasts our LATERAL beacon: depth, parent and the
+*  load of our way up.  Nodes without an up-stream link stay silent.
+*/
+void timer_cb_beacon(void* param) {
+    uint64_t wnd = PERIOD_LATERAL + (esp_random() % WINDOW_LATERAL);
+    wheel_start(&node.wheel, &node.lateral.beacon, wnd);
+
+    if (!has_uplink(&node.link_table) || !(node.flags & STATE_LEASED) ||
+        (node.flags & STATE_FROZEN)) {
+        return;
+    }
+
+    uint32_t load = uxQueueMessagesWaiting(outbound);
+
+    NetFrame out = {};
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = link_broadcast.id;
+    out.head.control = CONTROL_LATERAL;
+    out.head.reserved[RES_DEPTH] = node.tdma.depth;
+    out.head.reserved[RES_LAT_PARENT] = node.link_table.entry[LINK_UP].id;
+    out.head.reserved[RES_LAT_LOAD] = (load > node.lateral.up_load ? load : node.lateral.up_load);
+    out.head.checksum = pak_checksum(&out);
+
+    net_send_raw(&out);
+}
+
+/*
+* TIMER CALLBACK method -- a lateral peer has not been heard from within
+*  TIMEOUT_LATERAL and is forgotten.
+*/
+void timer_cb_lateral(void* param) {
+    int x = (int)param;
+
+    assert(x < LATERAL_SIZE && (node.lateral.usage & (1ul << x)));
+
+    ESP_LOGI(TAG, "Lateral link %d, %02X decayed.", x, node.lateral.entry[x].id);
+
+    esp_now_del_peer(node.lateral.entry[x].mac);
+    node.lateral.usage &= ~(1ul << x);
+    node.lateral.entry[x].id = 0;
+    memset(node.lateral.entry[x].mac, 0, 6);
+
+    // Parent lost and no way up left: fall back to the blackout.
+    if (!node.isRoot && !has_uplink(&node.link_table) && node.lateral.lost_time &&
+        !node.lateral.usage) {
+        exec_blackout();
+    }
+}
+
+/*
+* TIMER CALLBACK method -- requests a node-id lease from the root, or renews
+*  the one we hold.  Retries every TIMEOUT_LEASE until a grant arrives.
+*/
+void timer_cb_lease(void* param) {
+    if (!has_uplink(&node.link_table) || node.isRoot) {
+        return;
+    }
+
+    LeaseRecord rec = {};
+    memcpy(rec.mac, node.mac, 6);
+    rec.id = node.id;
+
+    NetFrame out = {};
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = node.link_table.entry[LINK_UP].id;
+    out.head.control = CONTROL_LEASE;
+    memcpy(out.contents, &rec, sizeof(LeaseRecord));
     out.head.checksum = pak_checksum(&out);
 
     net_send_raw(&out);
 
-    if (esp_timer_start_once(node.loc_timer, TIMEOUT_LOCATE) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start LOCATE timer.");
+    wheel_start(&node.wheel, &node.lease_timer,
+                (node.flags & STATE_LEASED ? PERIOD_LEASE : TIMEOUT_LEASE));
+}
+
+/*
+* TIMER CALLBACK method -- refreshes our own health record when it is due and
+*  sends the changed records of the subtree up-stream, as far as the budget
+*  allows.  The root only keeps its table.
+*/
+void timer_cb_health(void* param) {
+    uint64_t wnd = TICK_HEALTH + (esp_random() % WINDOW_HEALTH);
+    wheel_start(&node.wheel, &node.health.timer, wnd);
+
+    int64_t now = esp_timer_get_time();
+    if (!node.health.sampled || now - node.health.sampled >= PERIOD_HEALTH) {
+        HealthRecord rec;
+        health_sample(&rec);
+
+        portENTER_CRITICAL(&health_lock);
+        health_put(&node.health.table, &rec, now);
+        health_expire(&node.health.table, TIMEOUT_HEALTH, now);
+        portEXIT_CRITICAL(&health_lock);
+    }
+
+    if (node.isRoot || !has_uplink(&node.link_table) || (node.flags & STATE_FROZEN)) {
+        return;
+    }
+
+    NetFrame out = {};
+    portENTER_CRITICAL(&health_lock);
+    uint32_t count = health_take(&node.health.table, (HealthRecord*)out.contents,
+                                 HEALTH_PER_FRAME, sizeof(NetFrame), now);
+    portEXIT_CRITICAL(&health_lock);
+    if (count == 0) {
         return;
     }
+
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = node.link_table.entry[LINK_UP].id;
+    out.head.control = CONTROL_HEALTH;
+    out.head.reserved[RES_HEALTH_COUNT] = count;
+    out.head.checksum = pak_checksum(&out);
+
+    net_send_raw(&out);
 }
 
 /*
-* The callback method for esp-now packet receival serves as a dispatch function.
-*  It does simple verification of network layer state, and determines where the
-*  packet needs to be enqueued for processing or immediately dealt with.
+* The callback method for esp-now packet receival.  It runs in the WiFi task,
+*  so it only drops malformed frames and hands the rest to svc_network.
 */
 void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
+    if (len == sizeof(NetFrame)) {
+        capture_frame(mac, data, CAPTURE_IN);
+    }
+
+    if (node.inbound == NULL) {
+        return;
+    }
     if (!valid_packet(mac, data, len)) {
+        node.stats.malformed++;
         return;
     }
 
-    const NetFrame* frame = (const NetFrame*)data;
+    NetEvent evt;
+    evt.type = EVENT_FRAME;
+    evt.time = esp_timer_get_time();
+    memcpy(evt.mac, mac, 6);
+    memcpy(&evt.frame, data, sizeof(NetFrame));
+
+    if (xQueueSend(node.inbound, &evt, 0) != pdTRUE) {
+        node.stats.dropped++;
+        ESP_LOGW(TAG, "Dropped frame from 0x%02X -- network event queue full.", evt.frame.head.source);
+    }
+}
+
+/*
+* The callback method for esp-now send status, NET_LATERAL only.  Runs in the
+*  WiFi task, so it only hands the status to svc_network, which owns the link
+*  table (count_sent).  A status lost to a full queue is one count less.
+*/
+void espnow_sent(const uint8_t* mac, esp_now_send_status_t status) {
+    if (node.inbound == NULL) {
+        return;
+    }
+
+    NetEvent evt;
+    evt.type = EVENT_SENT;
+    memcpy(evt.mac, mac, 6);
+    evt.ok = (status == ESP_NOW_SEND_SUCCESS);
+    xQueueSend(node.inbound, &evt, 0);
+}
+
+/*
+* Dispatch function for received frames, run by svc_network.  It does simple
+*  verification of network layer state, and determines where the packet needs
+*  to be enqueued for processing or immediately dealt with.
+*/
+void dispatch_frame(const uint8_t* mac, const NetFrame* frame) {
     NodeId src = frame->head.source;
 
+    // Past the handshake, frames must come from the MAC the link was formed
+    //  with, not just carry a linked node-id.
+    if (frame->head.control != CONTROL_LOCATE && frame->head.control != CONTROL_LINK &&
+        frame->head.control != CONTROL_LATERAL && !valid_link(mac, src)) {
+#if defined(NET_LATERAL)
+        LinkEntry* peer = find_lateral(src);
+        if (frame->head.control != CONTROL_DEFAULT || peer == NULL || !cmp_mac(mac, peer->mac))
+#endif
+        {
+            node.stats.unlinked++;
+            return;
+        }
+    }
+
     NetFrame out = {};
 
     esp_now_peer_info_t peerInfo = {};
@@ -415,7 +1258,13 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
         //      - not already be awaiting a response to a LINK proposal.
         if (has_uplink(&node.link_table) &&
             has_available_downlinks(&node.link_table) > 0 &&
-            !(node.flags & STATE_PENDING_LINK)) {
+            !(node.flags & STATE_PENDING_LINK) &&
+            (node.flags & STATE_LEASED)) {
+            if (kx_propose(frame, &out) != 0) {
+                ESP_LOGW(TAG, "Ignored LOCATE from 0x%02X, key exchange failed.", src);
+                break;
+            }
+
             // Set the pending flag (link proposal) and then
             //  enqueue the LINK packet.
             node.flags |= STATE_PENDING_LINK;
@@ -424,9 +1273,14 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
             out.head.destination = src;
             out.head.control = CONTROL_LINK;
             out.head.reserved[RES_IDENT] = frame->head.reserved[RES_IDENT];
+            out.head.reserved[RES_DEPTH] = node.tdma.depth;
+            out.head.reserved[RES_BRANCH] = has_available_downlinks(&node.link_table);
             out.head.checksum = pak_checksum(&out);
 
+            // The joiner takes its TDMA slot from the entry offered here, it
+            //  must get that entry and no other.
             node.pending_id = src;
+            node.pending_branch = out.head.reserved[RES_BRANCH];
             memcpy(node.pending_mac, mac, 6);
             memcpy(peerInfo.peer_addr, mac, 6);
             peerInfo.channel = 0;
@@ -434,15 +1288,16 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
             peerInfo.encrypt = false;
             if (esp_now_add_peer(&peerInfo) != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to add pending link peer.");
+                node.flags &= ~STATE_PENDING_LINK;
+                node.pending_id = 0;
+                node.pending_branch = 0;
+                memset(node.pending_mac, 0, 6);
                 break;
             }
 
             net_send_raw(&out);
 
-            if (esp_timer_start_once(node.pending_timer, TIMEOUT_PROPOSE_LINK) != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to start LINK proposal timer.");
-                break;
-            }
+            wheel_start(&node.wheel, &node.pending_timer, TIMEOUT_PROPOSE_LINK);
         }
         break;
 
@@ -453,7 +1308,14 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
         //  nodes are proposing linkage (after our LOCATE), or they are confirming a
         //  linkage we proposed in response to _their_ LOCATE.
         if (node.flags & STATE_LOCATING && frame->head.reserved[RES_IDENT] == node.loc_ident) {
-            if (node.loc_count < LOCATE_SIZE) {
+            // Rejoining with a subtree, which must not offer us a parent.
+            //  Everything below us is deeper than we were.
+            if (node.tdma.depth && frame->head.reserved[RES_DEPTH] > node.tdma.depth) {
+                break;
+            }
+            if (node.loc_count < LOCATE_SIZE && kx_offer(frame, node.loc_count) == 0) {
+                node.tdma.offer_depth[node.loc_count] = frame->head.reserved[RES_DEPTH];
+                node.tdma.offer_branch[node.loc_count] = frame->head.reserved[RES_BRANCH];
                 node.loc_response[node.loc_count].id = src;
                 memcpy(node.loc_response[node.loc_count].mac, mac, 6);
                 node.loc_count++;
@@ -469,13 +1331,47 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
                 break;
             }
 
-            ESP_LOGI(TAG, "Added down-stream link 0x%02X", src);
+            // Our own parent may not become our child.
+            if (is_upstream(src)) {
+                break;
+            }
+
+            // Two nodes picked the same provisional id, or one holds a stale
+            //  lease.  The joiner loses its up-stream link and starts over.
+            LinkEntry* other = find_entry(src);
+            if (other != NULL && !cmp_mac(other->mac, mac)) {
+                node.stats.lease_conflicts++;
+                ESP_LOGW(TAG, "Rejected LINK from 0x%02X, id already linked from another MAC.", src);
+                break;
+            }
+
+            uint8_t key[CRYPTO_KEY_SIZE];
+            if (kx_accept(frame, key) != 0) {
+                ESP_LOGW(TAG, "Rejected LINK from 0x%02X, key confirmation failed.", src);
+                break;
+            }
 
-            esp_timer_stop(node.pending_timer);
+            ESP_LOGI(TAG, "Added down-stream link 0x%02X, key exchange %lld us / %u cycles",
+                     src, node.kx.cost_us, node.kx.cost_cycles);
+
+            wheel_stop(&node.wheel, &node.pending_timer);
             node.flags &= ~(STATE_PENDING_LINK);
-            form_downlink(&node.link_table, mac, src);
+
+            // A child that rebooted links again before its old entry decays,
+            //  reuse the peer (same MAC) but never keep two entries for one id.
+            LinkEntry* stale = find_entry(src);
+            if (stale != NULL) {
+                wheel_stop(&node.wheel, &stale->timer);
+                node.link_table.usage &= ~(1ul << (stale - node.link_table.entry));
+                stale->id = 0;
+                stale->groups = 0;
+            }
+            if (form_downlink(&node.link_table, mac, src, node.pending_branch) == 0) {
+                link_rekey(find_entry(src), key);
+            }
             memset(node.pending_mac, 0, 6);
             node.pending_id = 0;
+            node.pending_branch = 0;
         }
         break;
 
@@ -491,24 +1387,41 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
         if (node.flags & STATE_UPLINK_STATUS && is_upstream(src)) {
             // Up-stream STATUS response detected.
             node.flags &= ~(STATE_UPLINK_STATUS);
-            esp_timer_stop(node.status_timer);
+            wheel_stop(&node.wheel, &node.status_timer);
+
+            node.tdma.depth = frame->head.reserved[RES_DEPTH] + 1;
+            node.lateral.up_load = frame->head.reserved[RES_LOAD];
+            if (frame->head.reserved[RES_SYNCED]) {
+                TimeRecord rec;
+                memcpy(&rec, frame->contents, sizeof(TimeRecord));
+                clock_sample(&rec, node.rx_time);
+            }
         }
         else if (is_downstream(src)) {
             // Down-stream STATUS request detected.
             
             // Restart the link decay timer for the link.
             LinkEntry* link = find_entry(src);
-            esp_timer_stop(link->timer);
-            if (esp_timer_start_once(link->timer, TIMEOUT_LINK_DECAY) != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to restart down-stream link decay timer.");
-                break;
-            }
+            wheel_start(&node.wheel, &link->timer, TIMEOUT_LINK_DECAY);
+
+            memcpy(&link->groups, frame->head.reserved + RES_GROUPS, sizeof(uint32_t));
+            group_update();
+
+            // Respond with a STATUS packet, answering the time request in it.
+            TimeRecord req, res = {};
+            memcpy(&req, frame->contents, sizeof(TimeRecord));
+            res.echo = req.tx;
+            res.rx = clock_at(node.rx_time);
+            res.err = clock_error();
 
-            // Respond with a STATUS packet.
             out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
             out.head.source = node.id;
             out.head.destination = src;
             out.head.control = CONTROL_STATUS;
+            out.head.reserved[RES_DEPTH] = node.tdma.depth;
+            out.head.reserved[RES_SYNCED] = node.clock.synced;
+            memcpy(out.contents, &res, sizeof(TimeRecord));
+            out.head.reserved[RES_LOAD] = uxQueueMessagesWaiting(outbound);
             out.head.checksum = pak_checksum(&out);
 
             // TODO: Replace with queue mechanism.
@@ -516,42 +1429,51 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
         }
         break;
 
+    case CONTROL_GROUP:
+        if (!is_downstream(src)) break;
+
+        memcpy(&find_entry(src)->groups, frame->head.reserved + RES_GROUPS, sizeof(uint32_t));
+        group_update();
+        break;
+
+    case CONTROL_LEASE:
+        if (node.flags & STATE_FROZEN) break;
+
+        if (is_downstream(src)) {
+            exec_lease_request(src, frame);
+        }
+        else if (is_upstream(src)) {
+            exec_lease_reply(frame);
+        }
+        break;
+
+    case CONTROL_LATERAL:
+#if defined(NET_LATERAL)
+        if (node.flags & STATE_FROZEN) break;
+
+        exec_lateral(mac, frame);
+#endif
+        break;
+
+    case CONTROL_HEALTH:
+        if (node.flags & STATE_FROZEN) break;
+
+        if (is_downstream(src)) {
+            exec_health(src, frame);
+        }
+        break;
+
     case CONTROL_MAP:
         if (!is_linked(src)) break;
 
-        // Two scenarios -- either this is coming from up-stream, in which case 
-        //  we compose a response and also forward downstream.  Alternately, if
-        //  this comes from down-stream, forward it upwards.
+        // Requests travel down the tree and replies travel back up.  Every node
+        //  merges the replies of its children with its own edge before answering
+        //  up-stream, so each link carries one reply per collection round.
         if (is_upstream(src)) {
-            // Send local map info back upstream.
-            out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
-            out.head.source = node.id;
-            out.head.destination = src;
-            out.head.control = CONTROL_MAP;
-            out.head.reserved[RES_ORIGIN] = node.id;
-            out.head.reserved[RES_UPSTREAM] = src;
-            out.head.checksum = pak_checksum(&out);
-            net_send_raw(&out);
-
-            // Forward original packet downstream.
-            memcpy(&out, frame, sizeof(NetFrame));
-            out.head.source = node.id;
-            for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
-                if (i == LINK_UP)
-                    continue;
-                if (node.link_table.usage & (1ul << i)) {
-                    out.head.destination = node.link_table.entry[i].id;
-                    out.head.checksum = pak_checksum(&out);
-                    net_send_raw(&out);
-                }
-            }
+            exec_map_request(src, frame);
         }
-        else if (is_downstream(src) && !node.isRoot) {
-            memcpy(&out, frame, sizeof(NetFrame));
-            out.head.source = node.id;
-            out.head.destination = node.link_table.entry[LINK_UP].id;
-            out.head.checksum = pak_checksum(&out);
-            net_send_raw(&out);
+        else if (is_downstream(src)) {
+            exec_map_reply(src, frame);
         }
         break;
 
@@ -578,17 +1500,11 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
                     if (i == LINK_UP) {
                         if (!node.isRoot) {
                             uint64_t wnd = PERIOD_UP_STATUS + (esp_random() % WINDOW_UP_STATUS);
-                            if (esp_timer_start_once(node.link_table.entry[i].timer, wnd) != ESP_OK) {
-                                ESP_LOGE(TAG, "Failed to restart up-stream status timer after freeze.");
-                                return;
-                            }
+                            wheel_start(&node.wheel, &node.link_table.entry[i].timer, wnd);
                         }
                     }
                     else {
-                        if (esp_timer_start_once(node.link_table.entry[i].timer, TIMEOUT_LINK_DECAY) != ESP_OK) {
-                            ESP_LOGE(TAG, "Failed to restart down-stream link decay timer after freeze.");
-                            return;
-                        }
+                        wheel_start(&node.wheel, &node.link_table.entry[i].timer, TIMEOUT_LINK_DECAY);
                     }
                 }
             }
@@ -604,12 +1520,12 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
             *       packet upstream and then FREEZE arrives before response).
             */
             node.flags &= ~(STATE_UPLINK_STATUS);
-            esp_timer_stop(node.status_timer);
+            wheel_stop(&node.wheel, &node.status_timer);
 
             for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
                 if (node.link_table.usage & (1ul << i)) {
                     if ((i == LINK_UP && !node.isRoot) || i != LINK_UP) {
-                        esp_timer_stop(node.link_table.entry[i].timer);
+                        wheel_stop(&node.wheel, &node.link_table.entry[i].timer);
                     }
                 }
             }
@@ -621,11 +1537,28 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
             // TODO: Re-evaluate default behaviour.  Maybe.. no default behaviour?
             //  Let the applicates decide what packet forwarding behaviour is appropriate
             //  for their application type.
-            if (!is_linked(src))
+            LinkEntry* link = find_entry(src);
+#if defined(NET_LATERAL)
+            // A peer sending up through us, it is handled as one of our children.
+            if (link == NULL && has_uplink(&node.link_table)) {
+                link = find_lateral(src);
+                if (link != NULL) {
+                    node.lateral.relayed++;
+                }
+            }
+#endif
+            if (link == NULL)
                 break;
 
+            NetFrame plain;
+            memcpy(&plain, frame, sizeof(NetFrame));
+            if (open_frame(&plain, link) != 0) {
+                ESP_LOGW(TAG, "Dropped frame from 0x%02X, failed authentication.", src);
+                break;
+            }
+
             uint8_t app_pkt[NET_MAX_PAYLOAD + sizeof(app_header_t)];
-            memcpy(&app_pkt, frame->contents, sizeof(app_header_t) + NET_MAX_PAYLOAD);
+            memcpy(&app_pkt, plain.contents, sizeof(app_header_t) + NET_MAX_PAYLOAD);
 
             // NOTE: This is a bit of a hack.  Encode first app header reserved byte as
             //  0x01 if the packet came from upstream, otherwise 0x00.  This behaviour is
@@ -636,8 +1569,22 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
             uint16_t app_id = ((app_header_t*)app_pkt)->type;
 
             QueueHandle_t qh = find_app(app_id);
+
+            // Group frames only travel down, the network layer forwards them to
+            //  subscribed branches and delivers them here only to members.  The
+            //  group id is passed in the second app header reserved byte.
+            uint8_t group = plain.head.reserved[RES_GROUP];
+            if (group && group < GROUP_MAX && is_upstream(src)) {
+                ((app_header_t*)app_pkt)->reserved[1] = group;
+                send_down(group, (app_header_t*)app_pkt, app_pkt + sizeof(app_header_t), 0);
+                if (qh != NULL && (node.groups & (1ul << group))) {
+                    deliver_app(qh, app_pkt);
+                }
+                break;
+            }
+
             if (qh != NULL) {
-                xQueueSend(qh, app_pkt, 0);
+                deliver_app(qh, app_pkt);
             }
             else {
                 // No application registered for the app type.  Engage default behaviour.
@@ -651,6 +1598,10 @@ void espnow_recv(const uint8_t* mac, const uint8_t* data, int len) {
 
             break;
         }
+
+    default:
+        node.stats.malformed++;
+        break;
     }
 }
 
@@ -679,6 +1630,545 @@ void exec_blackout() {
     esp_restart();
 }
 
+/*
+* A LATERAL beacon was heard.  Peers at our depth under another parent are
+*  kept while there is room, siblings share our parent and are of no use.
+*/
+void exec_lateral(const uint8_t* mac, const NetFrame* frame) {
+    NodeId src = frame->head.source;
+
+    if (node.isRoot || !has_uplink(&node.link_table) || is_linked(src)) {
+        return;
+    }
+    if (frame->head.reserved[RES_DEPTH] != node.tdma.depth ||
+        frame->head.reserved[RES_LAT_PARENT] == node.link_table.entry[LINK_UP].id) {
+        return;
+    }
+
+    LinkEntry* peer = find_lateral(src);
+    if (peer != NULL && !cmp_mac(peer->mac, mac)) {
+        return;
+    }
+    if (peer == NULL) {
+        int x = 0;
+        while (x < LATERAL_SIZE && (node.lateral.usage & (1ul << x))) {
+            x++;
+        }
+        if (x == LATERAL_SIZE) {
+            return;
+        }
+
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, mac, 6);
+        peerInfo.channel = 0;
+        peerInfo.ifidx = ESP_IF_WIFI_STA;
+        peerInfo.encrypt = false;
+        if (esp_now_add_peer(&peerInfo) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to add lateral link peer.");
+            return;
+        }
+
+        peer = node.lateral.entry + x;
+        memcpy(peer->mac, mac, 6);
+        peer->id = src;
+        peer->rx_counter = 0;
+        node.lateral.usage |= (1ul << x);
+        ESP_LOGI(TAG, "Added lateral link 0x%02X (parent 0x%02X).", src, frame->head.reserved[RES_LAT_PARENT]);
+    }
+
+    int x = peer - node.lateral.entry;
+    node.lateral.parent[x] = frame->head.reserved[RES_LAT_PARENT];
+    node.lateral.load[x] = frame->head.reserved[RES_LAT_LOAD];
+    wheel_start(&node.wheel, &peer->timer, TIMEOUT_LATERAL);
+}
+
+/*
+* Our parent is gone.  With a lateral left we drop the up-stream link, keep
+*  our children and look for a new parent while frames go up sideways.
+*  Returns zero if there is no lateral and the caller should black out.
+*/
+int lateral_failover() {
+    if (!node.lateral.usage || !has_uplink(&node.link_table) || node.isRoot) {
+        return 0;
+    }
+
+    LinkEntry* up = node.link_table.entry + LINK_UP;
+    ESP_LOGW(TAG, "Up-stream link 0x%02X lost, going up via %d lateral links.",
+             up->id, __builtin_popcount(node.lateral.usage));
+
+    node.flags &= ~(STATE_UPLINK_STATUS);
+    wheel_stop(&node.wheel, &node.status_timer);
+    wheel_stop(&node.wheel, &up->timer);
+    esp_now_del_peer(up->mac);
+    node.link_table.usage &= ~(1ul << LINK_UP);
+    up->id = 0;
+    memset(up->mac, 0, 6);
+
+    node.lateral.lost_time = esp_timer_get_time();
+    node.lateral.recovery_us = 0;
+    node.lateral.up_fails = 0;
+    node.lateral.failovers++;
+
+    wheel_start(&node.wheel, &node.join_timer, esp_random() % WINDOW_LOCATE);
+    return 1;
+}
+
+/*
+* Counts unacknowledged sends to our parent in a row, run by svc_network for
+*  espnow_sent.  LATERAL_FAIL_LIMIT of them and the parent is taken for lost.
+*/
+void count_sent(const uint8_t* mac, int ok) {
+    if (node.isRoot || !has_uplink(&node.link_table) ||
+        !cmp_mac(mac, node.link_table.entry[LINK_UP].mac)) {
+        return;
+    }
+
+    if (ok) {
+        node.lateral.up_fails = 0;
+    }
+    else if (++node.lateral.up_fails == LATERAL_FAIL_LIMIT) {
+        lateral_failover();
+    }
+}
+
+LinkEntry* find_lateral(NodeId id) {
+    for (int i = 0; i < LATERAL_SIZE; ++i) {
+        if (node.lateral.usage & (1ul << i) && node.lateral.entry[i].id == id) {
+            return node.lateral.entry + i;
+        }
+    }
+    return NULL;
+}
+
+/*
+* Picks the lateral an up-stream frame should take, NULL for our own parent.
+*  Without a parent that is the least loaded lateral, otherwise it only takes
+*  every other frame while our parent is busier than the lateral's path.
+*/
+LinkEntry* lateral_route() {
+    int best = -1;
+    for (int i = 0; i < LATERAL_SIZE; ++i) {
+        if (node.lateral.usage & (1ul << i) &&
+            (best < 0 || node.lateral.load[i] < node.lateral.load[best])) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return NULL;
+    }
+    if (!has_uplink(&node.link_table)) {
+        return node.lateral.entry + best;
+    }
+    if (node.lateral.up_load > OUTBOUND_LOW_WATER && node.lateral.load[best] < node.lateral.up_load &&
+        (node.lateral.turn++ & 1)) {
+        return node.lateral.entry + best;
+    }
+    return NULL;
+}
+
+/*
+* A LEASE request arrived from down-stream.  The root answers it, everyone
+*  else adds the link it came in on to the path and passes it up.
+*/
+void exec_lease_request(NodeId src, const NetFrame* frame) {
+    LeaseRecord rec;
+    memcpy(&rec, frame->contents, sizeof(LeaseRecord));
+
+    if (rec.hops >= LEASE_PATH_MAX) {
+        return;
+    }
+    rec.path[rec.hops++] = (uint8_t)(find_entry(src) - node.link_table.entry);
+
+    if (!node.isRoot) {
+        NetFrame out = {};
+        out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+        out.head.source = node.id;
+        out.head.destination = node.link_table.entry[LINK_UP].id;
+        out.head.control = CONTROL_LEASE;
+        memcpy(out.contents, &rec, sizeof(LeaseRecord));
+        out.head.checksum = pak_checksum(&out);
+
+        net_send_raw(&out);
+        return;
+    }
+
+    int id = lease_grant(node.leases, rec.mac, rec.id, esp_timer_get_time());
+    if (id < 0) {
+        ESP_LOGW(TAG, "No node-id left to lease to 0x%02X.", rec.id);
+        return;
+    }
+    if (id != rec.id) {
+        ESP_LOGI(TAG, "Leased node-id 0x%02X to %02X:%02X:%02X:%02X:%02X:%02X (was 0x%02X).",
+                 id, rec.mac[0], rec.mac[1], rec.mac[2], rec.mac[3], rec.mac[4], rec.mac[5], rec.id);
+    }
+    if (node.leases->dirty) {
+        lease_save();
+    }
+
+    rec.id = id;
+    route_lease(&rec);
+}
+
+/*
+* A LEASE grant arrived from up-stream, either for us or to pass down.
+*/
+void exec_lease_reply(const NetFrame* frame) {
+    LeaseRecord rec;
+    memcpy(&rec, frame->contents, sizeof(LeaseRecord));
+
+    if (rec.hops > 0) {
+        route_lease(&rec);
+        return;
+    }
+    if (!cmp_mac(rec.mac, node.mac) || rec.id == 0 || lease_provisional(rec.id)) {
+        return;
+    }
+    // Never take the id of a node we are linked with, our parent included.
+    if (rec.id != node.id && is_linked(rec.id)) {
+        ESP_LOGW(TAG, "Ignored lease of node-id 0x%02X, it is linked to us.", rec.id);
+        return;
+    }
+
+    if (rec.id != node.id) {
+        ESP_LOGI(TAG, "Node-id 0x%02X leased, was 0x%02X.", rec.id, node.id);
+        lease_store_id(rec.id);
+
+        // Our children know us by the old id.  Only a root that lost its
+        //  leases can move a node that has any, so start over.
+        if (node.link_table.usage & ~(1ul << LINK_UP)) {
+            exec_blackout();
+        }
+        node.id = rec.id;
+    }
+
+    node.flags |= STATE_LEASED;
+    wheel_start(&node.wheel, &node.lease_timer, PERIOD_LEASE);
+}
+
+/*
+* Passes a LEASE grant one hop down its path.  The last hop renames the child
+*  before sending, so the grant already goes out under the new id.
+*/
+void route_lease(LeaseRecord* rec) {
+    uint8_t i = rec->path[--rec->hops];
+    if (i == LINK_UP || i >= LINK_TABLE_SIZE || !(node.link_table.usage & (1ul << i))) {
+        return;
+    }
+
+    LinkEntry* link = node.link_table.entry + i;
+    if (rec->hops == 0 && link->id != rec->id) {
+        // The child may have been replaced while the request was under way.
+        if (!cmp_mac(link->mac, rec->mac) || find_entry(rec->id) != NULL) {
+            return;
+        }
+        link->id = rec->id;
+    }
+
+    NetFrame out = {};
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = link->id;
+    out.head.control = CONTROL_LEASE;
+    memcpy(out.contents, rec, sizeof(LeaseRecord));
+    out.head.checksum = pak_checksum(&out);
+
+    net_send_raw(&out);
+}
+
+/*
+* Node-id granted by the last lease, zero if there is none.
+*/
+NodeId lease_stored_id() {
+    nvs_handle_t handle;
+    uint8_t id = 0;
+
+    if (nvs_open("net", NVS_READONLY, &handle) != ESP_OK) {
+        return 0;
+    }
+    if (nvs_get_u8(handle, "lease_id", &id) != ESP_OK || lease_provisional(id)) {
+        id = 0;
+    }
+    nvs_close(handle);
+    return id;
+}
+
+void lease_store_id(NodeId id) {
+    nvs_handle_t handle;
+
+    if (nvs_open("net", NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS, node-id lease not stored.");
+        return;
+    }
+    if (nvs_set_u8(handle, "lease_id", id) != ESP_OK || nvs_commit(handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to store node-id lease.");
+    }
+    nvs_close(handle);
+}
+
+/*
+* Root only.  Restores the lease table, every lease gets a full lifetime
+*  since renewal times do not survive the restart.
+*/
+void lease_load() {
+    nvs_handle_t handle;
+    size_t size = sizeof(node.leases->entry);
+
+    if (nvs_open("net", NVS_READONLY, &handle) == ESP_OK) {
+        if (nvs_get_blob(handle, "leases", node.leases->entry, &size) != ESP_OK ||
+            size != sizeof(node.leases->entry)) {
+            memset(node.leases->entry, 0, sizeof(node.leases->entry));
+        }
+        nvs_close(handle);
+    }
+    lease_loaded(node.leases, esp_timer_get_time());
+
+    ESP_LOGI(TAG, "Loaded %d node-id leases.", lease_count(node.leases));
+}
+
+void lease_save() {
+    nvs_handle_t handle;
+
+    if (nvs_open("net", NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS, leases not saved.");
+        return;
+    }
+    if (nvs_set_blob(handle, "leases", node.leases->entry, sizeof(node.leases->entry)) != ESP_OK ||
+        nvs_commit(handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save leases.");
+    }
+    else {
+        node.leases->dirty = 0;
+    }
+    nvs_close(handle);
+}
+
+/*
+* A MAP request arrived from up-stream.  The budget in the request is the time
+*  this node has to answer, and is reduced before being passed further down.
+*/
+void exec_map_request(NodeId src, const NetFrame* frame) {
+    uint64_t budget = frame->head.reserved[RES_MAP_BUDGET] * MAP_BUDGET_UNIT;
+
+    map_begin(frame->head.reserved[RES_MAP_SEQ], budget);
+}
+
+/*
+* Merges the health records of a child's frame into our table, they go on
+*  up-stream with the next frames we send.
+*/
+void exec_health(NodeId src, const NetFrame* frame) {
+    uint32_t count = frame->head.reserved[RES_HEALTH_COUNT];
+    if (count > HEALTH_PER_FRAME) {
+        node.stats.malformed++;
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&health_lock);
+    for (uint32_t i = 0; i < count; ++i) {
+        HealthRecord rec;
+        memcpy(&rec, frame->contents + i * sizeof(HealthRecord), sizeof(HealthRecord));
+        if (rec.id != 0 && rec.id != node.id) {
+            health_put(&node.health.table, &rec, now);
+        }
+    }
+    portEXIT_CRITICAL(&health_lock);
+}
+
+/*
+* Run time of a core's idle task in microseconds, from the FreeRTOS run-time
+*  stats (esp_timer based).  Zero without them.
+*/
+static uint32_t idle_time(int core) {
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+    TaskStatus_t status;
+    vTaskGetInfo(xTaskGetIdleTaskHandleForCPU(core), &status, pdFALSE, eRunning);
+    return status.ulRunTimeCounter;
+#else
+    return 0;
+#endif
+}
+
+/*
+* Fills in our own health record.  CPU load is the share of time each core
+*  spent outside its idle task since the last record, zero if unknown.
+*/
+void health_sample(HealthRecord* rec) {
+    int64_t now = esp_timer_get_time();
+
+    memset(rec, 0, sizeof(HealthRecord));
+    rec->id = node.id;
+    if (!node.isRoot && has_uplink(&node.link_table)) {
+        rec->parent = node.link_table.entry[LINK_UP].id;
+        rec->rssi = node.link_table.entry[LINK_UP].rssi;
+    }
+    rec->reset = esp_reset_reason();
+    uint32_t heap = esp_get_free_heap_size() / 16;
+    uint32_t heap_min = esp_get_minimum_free_heap_size() / 16;
+    rec->heap = (heap > UINT16_MAX ? UINT16_MAX : heap);
+    rec->heap_min = (heap_min > UINT16_MAX ? UINT16_MAX : heap_min);
+    rec->uptime = now / US_FACTOR;
+
+    rec->out_hwm = node.stats.out_hwm;
+    node.stats.out_hwm = uxQueueMessagesWaiting(outbound);
+
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+    int64_t span = now - node.health.sampled;
+    for (int c = 0; c < portNUM_PROCESSORS && c < 2; ++c) {
+        uint32_t total = idle_time(c);
+        uint32_t idle = total - node.health.idle_us[c];
+        node.health.idle_us[c] = total;
+        rec->cpu[c] = (span > 0 && idle < span ? 100 - (uint32_t)(idle * 100ll / span) : 0);
+    }
+#endif
+    node.health.sampled = now;
+
+    // Keep the HEALTH_APPS apps with the most drops, in descending order.
+    if (xSemaphoreTake(node.app_table.lock, WAIT_LOCK) != pdTRUE) {
+        return;
+    }
+    for (int i = 0; i < 32; ++i) {
+        const AppQueue* app = node.app_table.apps + i;
+        if (!(node.app_table.usage & (1ul << i)) || app->drops == 0) {
+            continue;
+        }
+        uint16_t drops = (app->drops > UINT16_MAX ? UINT16_MAX : app->drops);
+        for (int k = 0; k < HEALTH_APPS; ++k) {
+            if (rec->app[k] == 0 || drops > rec->drops[k]) {
+                memmove(rec->app + k + 1, rec->app + k, HEALTH_APPS - k - 1);
+                memmove(rec->drops + k + 1, rec->drops + k, (HEALTH_APPS - k - 1) * sizeof(uint16_t));
+                rec->app[k] = app->id;
+                rec->drops[k] = drops;
+                break;
+            }
+        }
+    }
+    xSemaphoreGive(node.app_table.lock);
+}
+
+
+/*
+* A MAP reply arrived from down-stream.  Merge its records, and complete the
+*  round once every child has answered.
+*/
+void exec_map_reply(NodeId src, const NetFrame* frame) {
+    if (!node.map.active || frame->head.reserved[RES_MAP_SEQ] != node.map.seq) {
+        return;
+    }
+
+    uint32_t x = find_entry(src) - node.link_table.entry;
+    if (!(node.map.pending & (1ul << x))) {
+        return;
+    }
+
+    uint32_t count = frame->head.reserved[RES_MAP_COUNT];
+    if (count > MAP_PER_FRAME) {
+        count = MAP_PER_FRAME;
+    }
+
+    const MapRecord* record = (const MapRecord*)frame->contents;
+    for (uint32_t i = 0; i < count && node.map.count < MAP_SIZE; ++i) {
+        node.map.record[node.map.count++] = record[i];
+    }
+
+    // Large subtrees answer in several frames, only the last one settles the link.
+    if (!frame->head.reserved[RES_MAP_MORE]) {
+        node.map.pending &= ~(1ul << x);
+    }
+
+    if (!node.map.pending) {
+        wheel_stop(&node.wheel, &node.map.timer);
+        map_complete();
+    }
+}
+
+/*
+* Starts a map collection round: records this node's own edge and forwards the
+*  request to every down-stream link.  Leaves complete immediately.
+*/
+void map_begin(uint8_t seq, uint64_t budget) {
+    wheel_stop(&node.wheel, &node.map.timer);
+
+    node.map.active = 1;
+    node.map.seq = seq;
+    node.map.count = 1;
+    node.map.record[0].id = node.id;
+    node.map.record[0].parent = (node.isRoot ? 0 : node.link_table.entry[LINK_UP].id);
+    node.map.record[0].rssi = (node.isRoot ? 0 : node.link_table.entry[LINK_UP].rssi);
+    uint32_t err = clock_error();
+    node.map.record[0].time_err = (err < UINT16_MAX ? err : UINT16_MAX);
+
+    node.map.pending = node.link_table.usage & ~(1ul << LINK_UP);
+    if (!node.map.pending) {
+        map_complete();
+        return;
+    }
+
+    uint64_t child_budget = (budget > TIMEOUT_MAP_HOP ? budget - TIMEOUT_MAP_HOP : 0) / MAP_BUDGET_UNIT;
+
+    NetFrame out = {};
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.control = CONTROL_MAP;
+    out.head.reserved[RES_MAP_SEQ] = seq;
+    out.head.reserved[RES_MAP_BUDGET] = (child_budget > UINT8_MAX ? UINT8_MAX : child_budget);
+
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        if (i == LINK_UP)
+            continue;
+        if (node.map.pending & (1ul << i)) {
+            out.head.destination = node.link_table.entry[i].id;
+            out.head.checksum = pak_checksum(&out);
+            net_send_raw(&out);
+        }
+    }
+
+    if (budget < MAP_BUDGET_UNIT) {
+        budget = MAP_BUDGET_UNIT;
+    }
+    wheel_start(&node.wheel, &node.map.timer, budget);
+}
+
+/*
+* Finishes a map collection round.  The root signals the waiting NET_MAP
+*  command, every other node sends its merged records up-stream.
+*/
+void map_complete() {
+    if (!node.map.active) {
+        return;
+    }
+    node.map.active = 0;
+
+    if (node.isRoot) {
+        xEventGroupSetBits(node.events, EVT_MAP_DONE);
+        return;
+    }
+    if (!has_uplink(&node.link_table)) {
+        return;
+    }
+
+    NetFrame out = {};
+    out.head.version = (NETWORK_TYPE | NETWORK_VERSION);
+    out.head.source = node.id;
+    out.head.destination = node.link_table.entry[LINK_UP].id;
+    out.head.control = CONTROL_MAP;
+    out.head.reserved[RES_MAP_SEQ] = node.map.seq;
+
+    for (uint32_t at = 0; at < node.map.count; at += MAP_PER_FRAME) {
+        uint32_t count = node.map.count - at;
+        if (count > MAP_PER_FRAME) {
+            count = MAP_PER_FRAME;
+        }
+
+        out.head.reserved[RES_MAP_COUNT] = count;
+        out.head.reserved[RES_MAP_MORE] = (at + count < node.map.count ? 1 : 0);
+        memset(out.contents, 0, sizeof(out.contents));
+        memcpy(out.contents, node.map.record + at, count * sizeof(MapRecord));
+        out.head.checksum = pak_checksum(&out);
+        net_send_raw(&out);
+    }
+}
+
 /*
 * Predicate method.  Returns non-zero if true.
 */
@@ -724,154 +2214,630 @@ int form_uplink(LinkTable* table, const uint8_t* mac, NodeId id) {
 
     table->usage |= (1ul << LINK_UP);
     table->entry[LINK_UP].id = id;
+    table->entry[LINK_UP].rx_counter = 0;
     memcpy(table->entry[LINK_UP].mac, mac, 6);
 
     uint64_t wnd = PERIOD_UP_STATUS + (esp_random() % WINDOW_UP_STATUS);
-    if (esp_timer_start_once(table->entry[LINK_UP].timer, wnd) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start up-stream status timer.");
+    wheel_start(&node.wheel, &table->entry[LINK_UP].timer, wnd);
+
+    return 0;
+}
+
+/*
+* Forms the down-stream link in entry 'x', the one offered in the LINK
+*  proposal.  Method returns 0 on success, non-zero otherwise.
+*/
+int form_downlink(LinkTable* table, const uint8_t* mac, NodeId id, int x) {
+    assert(table != NULL);
+    assert(mac != NULL);
+    assert(id > 0);
+
+    if (x <= LINK_UP || x >= LINK_TABLE_SIZE || (table->usage & (1ul << x))) {
+        ESP_LOGE(TAG, "Cannot form down-stream link, entry %d not available.", x);
+        return -1;
+    }
+
+    table->usage |= (1ul << x);
+    table->entry[x].id = id;
+    table->entry[x].rx_counter = 0;
+    table->entry[x].groups = 0;
+    memcpy(table->entry[x].mac, mac, 6);
+
+    wheel_start(&node.wheel, &table->entry[x].timer, TIMEOUT_LINK_DECAY);
+
+    return 0;
+}
+
+/*
+* Method returns zero if packet is obviously invalid or malformed.
+*/
+int valid_packet(const uint8_t* mac, const uint8_t* data, int len) {
+    const NetFrame* frame = (const NetFrame*)data;
+
+
+    if (len != sizeof(NetFrame)) {
+        return 0;
+    }
+    
+    if (frame->head.version != (NETWORK_TYPE | NETWORK_VERSION)) {
+        return 0;
+    }
+
+    if (frame->head.checksum != pak_checksum(frame)) {
+        return 0;
+    }
+
+    // Node-id 0 is never assigned and 0xFF is broadcast, neither can send.
+    //  Our own id as source is a loop or a duplicate id.
+    if (frame->head.source == 0 ||
+        frame->head.source == link_broadcast.id ||
+        frame->head.source == node.id) {
+        return 0;
+    }
+
+    // A LEASE grant is addressed to the id it grants, the parent renamed the
+    //  link before sending.
+    if (frame->head.destination != node.id &&
+        frame->head.destination != link_broadcast.id &&
+        frame->head.control != CONTROL_LEASE) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+* Checks the link table and flags against each other.  Returns 0 if they are
+*  consistent, otherwise a negative code for the first violation found.
+*/
+int check_table() {
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        if (!(node.link_table.usage & (1ul << i)))
+            continue;
+        if (i == LINK_UP && node.isRoot)
+            continue;
+
+        const LinkEntry* entry = node.link_table.entry + i;
+        if (entry->id == 0 || entry->id == node.id || entry->id == link_broadcast.id) {
+            return -1;
+        }
+        for (int j = i + 1; j < LINK_TABLE_SIZE; ++j) {
+            if (node.link_table.usage & (1ul << j) && node.link_table.entry[j].id == entry->id) {
+                return -2;
+            }
+        }
+        // Every live link is either decaying or due a status check, unless frozen.
+        if (!entry->timer.active && !(node.flags & STATE_FROZEN)) {
+            return -3;
+        }
+    }
+
+    if (!(node.flags & STATE_PENDING_LINK) != !node.pending_id) {
+        return -4;
+    }
+    // The entry offered to a pending joiner stays free until it confirms.
+    if (node.flags & STATE_PENDING_LINK && (node.link_table.usage & (1ul << node.pending_branch))) {
+        return -5;
+    }
+    return 0;
+}
+/*
+* Method checks whether the (MAC, node-id) pair matches an existing link in
+*  the link table.
+*/
+int valid_link(const uint8_t* mac, NodeId id) {
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        if (node.link_table.usage & (1ul << i)) {
+            int match = 1;
+            if (!cmp_mac(mac, node.link_table.entry[i].mac)) {
+                match = 0;
+            }
+            if (node.link_table.entry[i].id != id) {
+                match = 0;
+            }
+            if (match) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+* Predicate method, returns non-zero if the node-id is a node to which we are
+*  virtually linked, upstream or down.
+*/
+int is_linked(NodeId id) {
+    return ((is_upstream(id) | is_downstream(id)) != 0 ? 1 : 0);
+}
+
+/*
+* Predicate method, returns non-zero if node-id is the up-stream link for
+*  this node.
+*/
+int is_upstream(NodeId id) {
+    assert(id != 0);
+
+    return (id == node.link_table.entry[LINK_UP].id ? 1 : 0);
+}
+
+/*
+* Predicate method, returns non-zero if node-id is a down-stream link for
+*  this node.
+*/
+int is_downstream(NodeId id) {
+    assert(id != 0);
+
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        if (i == LINK_UP)
+            continue;
+
+        if (node.link_table.usage & (1ul << i) && node.link_table.entry[i].id == id) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+* Predicate method, returns non-zero if the two mac addresses provided
+*  are identical.
+*/
+int cmp_mac(const uint8_t* mac_a, const uint8_t* mac_b) {
+    assert(mac_a != NULL);
+    assert(mac_b != NULL);
+
+    if (mac_a == mac_b) {
+        ESP_LOGW(TAG, "Warning: cmp_mac(..) called on identical pointers.");
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        if (mac_a[i] != mac_b[i])
+            return 0;
+    }
+    return 1;
+}
+
+uint8_t pak_checksum(const NetFrame* frame) {
+    int offset_check = 3;
+
+    uint8_t  balance = 0;
+    const uint8_t* work = (const uint8_t*)frame;
+
+    for (int i = 0; i < sizeof(NetFrame); ++i) {
+        if (i != offset_check) {
+            balance = balance ^ work[i];
+        }
+    }
+    return balance;
+}
+
+/*
+* Returns the key application frames exchanged with a node are sealed with.
+*/
+crypto_key_t* link_key(NodeId id) {
+#if defined(NET_LINK_KX)
+    LinkEntry* link = find_entry(id);
+    return (link != NULL ? link_ccm + (link - node.link_table.entry) : &mesh_ccm);
+#else
+    return &mesh_ccm;
+#endif
+}
+
+/*
+* Gives a link table entry its key, svc_network only.
+*/
+void link_rekey(LinkEntry* link, const uint8_t* key) {
+    memcpy(link->key, key, CRYPTO_KEY_SIZE);
+#if defined(NET_ENCRYPT) && defined(NET_LINK_KX)
+    xSemaphoreTake(key_lock, portMAX_DELAY);
+    crypto_key_set(link_ccm + (link - node.link_table.entry), key);
+    xSemaphoreGive(key_lock);
+#endif
+}
+
+/*
+* Sets up the CCM contexts.  Each link entry starts with the key it holds.
+*/
+void init_keys() {
+#if defined(NET_ENCRYPT)
+    key_lock = xSemaphoreCreateMutex();
+    if (key_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create key lock.");
+        return;
+    }
+    crypto_key_set(&mesh_ccm, mesh_key);
+#if defined(NET_LINK_KX)
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        crypto_key_set(link_ccm + i, node.link_table.entry[i].key);
+    }
+#endif
+#endif
+}
+
+/*
+* Builds the CCM nonce and additional data for a frame.  The nonce is the
+*  source id followed by the frame counter, the additional data is the whole
+*  header minus the checksum and tag (both written after sealing).
+*/
+static void frame_nonce(const NetFrame* frame, uint8_t* nonce, uint8_t* aad) {
+    memset(nonce, 0, CRYPTO_NONCE_SIZE);
+    nonce[0] = frame->head.source;
+    memcpy(nonce + 1, frame->head.reserved + RES_NONCE, sizeof(uint32_t));
+
+    memcpy(aad, &frame->head, sizeof(NetFrameHeader));
+    ((NetFrameHeader*)aad)->checksum = 0;
+    memset(((NetFrameHeader*)aad)->reserved + RES_TAG, 0, CRYPTO_TAG_SIZE);
+}
+
+/*
+* Encrypts the contents of an outbound application frame in place.  The frame
+*  must already carry its destination.  Method returns 0 on success.
+*/
+int seal_frame(NetFrame* frame) {
+#if defined(NET_ENCRYPT)
+    uint8_t nonce[CRYPTO_NONCE_SIZE];
+    uint8_t aad[sizeof(NetFrameHeader)];
+
+    // Counters are shared by every sending task, a repeated nonce would break CCM.
+    portENTER_CRITICAL(&counter_lock);
+    if (++node.tx_counter == 0) {
+        ++node.tx_counter;
+    }
+    memcpy(frame->head.reserved + RES_NONCE, &node.tx_counter, sizeof(uint32_t));
+    portEXIT_CRITICAL(&counter_lock);
+
+    frame_nonce(frame, nonce, aad);
+    if (xSemaphoreTake(key_lock, WAIT_LOCK) != pdTRUE) {
+        return -1;
+    }
+    int ret = crypto_seal(link_key(frame->head.destination), nonce, aad, sizeof(aad),
+                          frame->contents, sizeof(frame->contents),
+                          frame->head.reserved + RES_TAG);
+    xSemaphoreGive(key_lock);
+    return ret;
+#else
+    return 0;
+#endif
+}
+
+/*
+* Authenticates and decrypts an inbound application frame in place.  Frames
+*  whose counter does not advance past the last one accepted from the link
+*  are replays and rejected.  Method returns 0 on success.
+*/
+int open_frame(NetFrame* frame, LinkEntry* link) {
+#if defined(NET_ENCRYPT)
+    uint8_t nonce[CRYPTO_NONCE_SIZE];
+    uint8_t aad[sizeof(NetFrameHeader)];
+    uint32_t counter;
+
+    memcpy(&counter, frame->head.reserved + RES_NONCE, sizeof(uint32_t));
+    if (link->rx_counter != 0 && (int32_t)(counter - link->rx_counter) <= 0) {
+        return -1;
+    }
+
+    // svc_network re-keys links itself, no need for key_lock here.
+    frame_nonce(frame, nonce, aad);
+    if (crypto_open(link_key(frame->head.source), nonce, aad, sizeof(aad),
+                    frame->contents, sizeof(frame->contents),
+                    frame->head.reserved + RES_TAG) != 0) {
         return -2;
     }
 
-    return 0;
+    link->rx_counter = counter;
+#endif
+    return 0;
+}
+
+#if defined(NET_LINK_KX)
+/*
+* Serializes what both ends of a LINK handshake agree on.  LOCATE is sent
+*  before a proposer is known, so it covers the joiner's key only.
+*/
+static size_t kx_transcript(uint8_t* buf, uint8_t control, NodeId joiner, NodeId proposer,
+                            uint8_t ident, const uint8_t* joiner_pub, const uint8_t* proposer_pub) {
+    size_t len = 0;
+
+    buf[len++] = control;
+    buf[len++] = joiner;
+    buf[len++] = proposer;
+    buf[len++] = ident;
+    memcpy(buf + len, joiner_pub, CRYPTO_PUB_SIZE);
+    len += CRYPTO_PUB_SIZE;
+    if (proposer_pub != NULL) {
+        memcpy(buf + len, proposer_pub, CRYPTO_PUB_SIZE);
+        len += CRYPTO_PUB_SIZE;
+    }
+    return len;
+}
+
+static void kx_cost(int64_t t0, uint32_t c0) {
+    node.kx.cost_us += esp_timer_get_time() - t0;
+    node.kx.cost_cycles += crypto_cycles() - c0;
 }
 
 /*
-* Method returns 0 on success, non-zero otherwise.
+* Hands svc_kx a job.  A derivation is answered on node.inbound as EVENT_KX.
 */
-int form_downlink(LinkTable* table, const uint8_t* mac, NodeId id) {
-    assert(table != NULL);
-    assert(mac != NULL);
-    assert(id > 0);
+static int kx_hand(const KxJob* job) {
+    return (xQueueSend(node.kx.jobs, job, 0) == pdTRUE ? 0 : -1);
+}
 
-    int x = has_available_downlinks(table);
-    if (x < 0) {
-        ESP_LOGE(TAG, "Cannot form down-stream link, link table full.");
+/*
+* Takes the spare key pair svc_kx keeps ready and asks it for the next one.
+*  Fails if it has not been made yet.
+*/
+static int kx_spare(crypto_kx_t* pair) {
+    KxJob refill = { .role = KX_PAIR };
+
+    if (xQueueReceive(node.kx.pairs, pair, 0) != pdTRUE) {
         return -1;
     }
+    kx_hand(&refill);
+    return 0;
+}
+#endif
 
-    table->usage |= (1ul << x);
-    table->entry[x].id = id;
-    memcpy(table->entry[x].mac, mac, 6);
+/*
+* Joiner, before LOCATE: a fresh key pair, announced with an identity MAC so
+*  only mesh members answer.
+*/
+int kx_locate(NetFrame* out) {
+#if defined(NET_LINK_KX)
+    uint8_t t[4 + 2 * CRYPTO_PUB_SIZE];
+    KxRecord* rec = (KxRecord*)out->contents;
+    int64_t t0 = esp_timer_get_time();
+    uint32_t c0 = crypto_cycles();
 
-    if (esp_timer_start_once(table->entry[x].timer, TIMEOUT_LINK_DECAY) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start down-stream link decay timer.");
-        return -2;
-    }
+    node.kx.cost_us = 0;
+    node.kx.cost_cycles = 0;
 
+    if (kx_spare(&node.kx.own) != 0) {
+        return -1;
+    }
+    memcpy(rec->pub, node.kx.own.pub, CRYPTO_PUB_SIZE);
+
+    size_t len = kx_transcript(t, CONTROL_LOCATE, node.id, link_broadcast.id,
+                               out->head.reserved[RES_IDENT], rec->pub, NULL);
+    int ret = crypto_mac(mesh_identity, sizeof(mesh_identity), t, len, rec->mac);
+    kx_cost(t0, c0);
+    return ret;
+#else
     return 0;
+#endif
 }
 
 /*
-* Method returns zero if packet is obviously invalid or malformed.
+* Proposer, on LOCATE: checks the joiner's identity MAC and answers with a
+*  spare key of its own.  svc_kx derives the pending link key meanwhile, the
+*  joiner's confirmation cannot verify before it is back.
 */
-int valid_packet(const uint8_t* mac, const uint8_t* data, int len) {
-    const NetFrame* frame = (const NetFrame*)data;
+int kx_propose(const NetFrame* locate, NetFrame* out) {
+#if defined(NET_LINK_KX)
+    uint8_t t[4 + 2 * CRYPTO_PUB_SIZE];
+    const KxRecord* req = (const KxRecord*)locate->contents;
+    KxRecord* rec = (KxRecord*)out->contents;
+    NodeId joiner = locate->head.source;
+    uint8_t ident = locate->head.reserved[RES_IDENT];
+    int64_t t0 = esp_timer_get_time();
+    uint32_t c0 = crypto_cycles();
+    KxJob job = { .role = KX_PROPOSER };
+    size_t len;
+
+    len = kx_transcript(t, CONTROL_LOCATE, joiner, link_broadcast.id, ident, req->pub, NULL);
+    if (crypto_mac_verify(mesh_identity, sizeof(mesh_identity), t, len, req->mac) != 0) {
+        return -1;
+    }
 
+    node.kx.cost_us = 0;
+    node.kx.cost_cycles = 0;
 
-    if (len != sizeof(NetFrame)) {
-        return 0;
-    }
-    
-    if (frame->head.version != (NETWORK_TYPE | NETWORK_VERSION)) {
-        return 0;
+    if (kx_spare(&job.own) != 0) {
+        return -2;
     }
+    memcpy(node.kx.peer, req->pub, CRYPTO_PUB_SIZE);
+    memcpy(node.kx.sent, job.own.pub, CRYPTO_PUB_SIZE);
+    memcpy(rec->pub, job.own.pub, CRYPTO_PUB_SIZE);
 
-    if (frame->head.checksum != pak_checksum(frame)) {
-        return 0;
+    len = kx_transcript(t, CONTROL_LINK, joiner, node.id, ident, req->pub, rec->pub);
+    if (crypto_mac(mesh_identity, sizeof(mesh_identity), t, len, rec->mac) != 0) {
+        return -3;
     }
 
-    return 1;
+    memcpy(job.peer, req->pub, CRYPTO_PUB_SIZE);
+    memcpy(job.info, t, len);
+    job.info_len = len;
+    job.seq = ++node.kx.seq[KX_PROPOSER];
+    node.kx.pending_ready = 0;
+    int ret = kx_hand(&job);
+    memset(&job, 0, sizeof(job));
+    kx_cost(t0, c0);
+    if (ret != 0) {
+        return -4;
+    }
+#endif
+    return 0;
 }
+
 /*
-* Method checks whether the (MAC, node-id) pair matches an existing link in
-*  the link table.
+* Joiner, on a LINK proposal: keeps the proposer's key if its identity MAC
+*  verifies.  Derivation waits until one proposal has been picked.
 */
-int valid_link(const uint8_t* mac, NodeId id) {
-    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
-        if (node.link_table.usage & (1ul << i)) {
-            int match = 1;
-            if (!cmp_mac(mac, node.link_table.entry[i].mac)) {
-                match = 0;
-            }
-            if (node.link_table.entry[i].id != id) {
-                match = 0;
-            }
-            if (match) {
-                return 1;
-            }
-        }
+int kx_offer(const NetFrame* link, uint32_t slot) {
+#if defined(NET_LINK_KX)
+    uint8_t t[4 + 2 * CRYPTO_PUB_SIZE];
+    const KxRecord* rec = (const KxRecord*)link->contents;
+
+    size_t len = kx_transcript(t, CONTROL_LINK, node.id, link->head.source,
+                               node.loc_ident, node.kx.own.pub, rec->pub);
+    if (crypto_mac_verify(mesh_identity, sizeof(mesh_identity), t, len, rec->mac) != 0) {
+        return -1;
     }
+    memcpy(node.kx.offer[slot], rec->pub, CRYPTO_PUB_SIZE);
+#endif
     return 0;
 }
 
 /*
-* Predicate method, returns non-zero if the node-id is a node to which we are
-*  virtually linked, upstream or down.
+* Joiner, accepting proposal 'slot': hands the link key derivation to svc_kx
+*  and retries the join in a period should the key never come back.  Without
+*  NET_LINK_KX the join goes on right away.
 */
-int is_linked(NodeId id) {
-    return ((is_upstream(id) | is_downstream(id)) != 0 ? 1 : 0);
+int kx_confirm(uint32_t slot) {
+#if defined(NET_LINK_KX)
+    KxJob job = { .role = KX_JOINER };
+
+    job.own = node.kx.own;
+    memcpy(job.peer, node.kx.offer[slot], CRYPTO_PUB_SIZE);
+    job.info_len = kx_transcript(job.info, CONTROL_LINK, node.id, node.loc_response[slot].id,
+                                 node.loc_ident, node.kx.own.pub, node.kx.offer[slot]);
+    job.seq = ++node.kx.seq[KX_JOINER];
+    node.kx.slot = slot;
+    int ret = kx_hand(&job);
+    memset(&job, 0, sizeof(job));
+    if (ret != 0) {
+        return -1;
+    }
+    wheel_start(&node.wheel, &node.join_timer, PERIOD_LOCATE);
+#else
+    uint8_t key[CRYPTO_KEY_SIZE] = {};
+
+    join_uplink(slot, key);
+#endif
+    return 0;
 }
 
 /*
-* Predicate method, returns non-zero if node-id is the up-stream link for
-*  this node.
+* Joiner, with the link key of proposal 'slot': proves it to the proposer
+*  with a MAC under that key.
 */
-int is_upstream(NodeId id) {
-    assert(id != 0);
-
-    return (id == node.link_table.entry[LINK_UP].id ? 1 : 0);
+int kx_prove(uint32_t slot, NetFrame* out, const uint8_t* key) {
+#if defined(NET_LINK_KX)
+    uint8_t t[4 + 2 * CRYPTO_PUB_SIZE];
+    KxRecord* rec = (KxRecord*)out->contents;
+    int64_t t0 = esp_timer_get_time();
+    uint32_t c0 = crypto_cycles();
+
+    size_t len = kx_transcript(t, CONTROL_LINK, node.id, node.loc_response[slot].id,
+                               node.loc_ident, node.kx.own.pub, node.kx.offer[slot]);
+    memcpy(rec->pub, node.kx.own.pub, CRYPTO_PUB_SIZE);
+    int ret = crypto_mac(key, CRYPTO_KEY_SIZE, t, len, rec->mac);
+    kx_cost(t0, c0);
+    return ret;
+#else
+    return 0;
+#endif
 }
 
 /*
-* Predicate method, returns non-zero if node-id is a down-stream link for
-*  this node.
+* Proposer, on the joiner's LINK confirmation: the MAC only verifies if both
+*  sides derived the same key.
 */
-int is_downstream(NodeId id) {
-    assert(id != 0);
+int kx_accept(const NetFrame* link, uint8_t* key) {
+    memset(key, 0, CRYPTO_KEY_SIZE);
+#if defined(NET_LINK_KX)
+    uint8_t t[4 + 2 * CRYPTO_PUB_SIZE];
+    const KxRecord* rec = (const KxRecord*)link->contents;
+    int64_t t0 = esp_timer_get_time();
+    uint32_t c0 = crypto_cycles();
+
+    if (!node.kx.pending_ready) {
+        return -1;
+    }
+    size_t len = kx_transcript(t, CONTROL_LINK, link->head.source, node.id,
+                               link->head.reserved[RES_IDENT], node.kx.peer, node.kx.sent);
+    int ret = crypto_mac_verify(node.kx.pending_key, CRYPTO_KEY_SIZE, t, len, rec->mac);
+    kx_cost(t0, c0);
+    if (ret != 0) {
+        return -1;
+    }
+    memcpy(key, node.kx.pending_key, CRYPTO_KEY_SIZE);
+    memset(node.kx.pending_key, 0, CRYPTO_KEY_SIZE);
+    node.kx.pending_ready = 0;
+#endif
+    return 0;
+}
 
-    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
-        if (i == LINK_UP)
-            continue;
+/*
+* EVENT_KX, a link key back from svc_kx.  Results of an exchange that has
+*  since been given up or started over are dropped.
+*/
+void kx_derived(const KxResult* res) {
+#if defined(NET_LINK_KX)
+    if (res->role > KX_PROPOSER || res->seq != node.kx.seq[res->role]) {
+        return;
+    }
+    node.kx.cost_us += res->us;
+    node.kx.cost_cycles += res->cycles;
 
-        if (node.link_table.usage & (1ul << i) && node.link_table.entry[i].id == id) {
-            return 1;
+    if (res->role == KX_PROPOSER) {
+        if (res->ok && (node.flags & STATE_PENDING_LINK)) {
+            memcpy(node.kx.pending_key, res->key, CRYPTO_KEY_SIZE);
+            node.kx.pending_ready = 1;
         }
     }
-    return 0;
+    else if (!(node.flags & STATE_LOCATING) && node.kx.slot < node.loc_count &&
+             !has_uplink(&node.link_table)) {
+        if (!res->ok) {
+            ESP_LOGE(TAG, "Failed to derive up-stream link key.");
+            node.loc_count = 0;
+            return;
+        }
+        join_uplink(node.kx.slot, res->key);
+    }
+#endif
 }
 
+#if defined(NET_LINK_KX)
 /*
-* Predicate method, returns non-zero if the two mac addresses provided
-*  are identical.
+* One job of svc_kx, waiting up to 'wait' for it.  Returns non-zero if there
+*  was one.  The X25519 work runs here, not on svc_network.
 */
-int cmp_mac(const uint8_t* mac_a, const uint8_t* mac_b) {
-    assert(mac_a != NULL);
-    assert(mac_b != NULL);
+int kx_work(TickType_t wait) {
+    KxJob job;
+    NetEvent evt = { .type = EVENT_KX };
+    KxResult* res = (KxResult*)evt.frame.contents;
 
-    if (mac_a == mac_b) {
-        ESP_LOGW(TAG, "Warning: cmp_mac(..) called on identical pointers.");
+    if (xQueueReceive(node.kx.jobs, &job, wait) != pdTRUE) {
+        return 0;
     }
 
-    for (int i = 0; i < 6; ++i) {
-        if (mac_a[i] != mac_b[i])
-            return 0;
+    if (job.role == KX_PAIR) {
+        crypto_kx_t pair;
+        if (uxQueueSpacesAvailable(node.kx.pairs) > 0 && crypto_kx_keypair(&pair) == 0) {
+            xQueueSend(node.kx.pairs, &pair, 0);
+        }
+        memset(&pair, 0, sizeof(pair));
+        return 1;
     }
+
+    int64_t t0 = esp_timer_get_time();
+    uint32_t c0 = crypto_cycles();
+    res->role = job.role;
+    res->seq = job.seq;
+    res->ok = (crypto_kx_derive(&job.own, job.peer, job.info, job.info_len, res->key) == 0);
+    res->us = esp_timer_get_time() - t0;
+    res->cycles = crypto_cycles() - c0;
+    memset(&job, 0, sizeof(job));
+
+    if (xQueueSend(node.inbound, &evt, WAIT_LOCK) != pdTRUE) {
+        ESP_LOGW(TAG, "Dropped a link key, network event queue full.");
+    }
+    memset(res->key, 0, CRYPTO_KEY_SIZE);
     return 1;
 }
 
-uint8_t pak_checksum(const NetFrame* frame) {
-    int offset_check = 3;
-
-    uint8_t  balance = 0;
-    const uint8_t* work = (const uint8_t*)frame;
-
-    for (int i = 0; i < sizeof(NetFrame); ++i) {
-        if (i != offset_check) {
-            balance = balance ^ work[i];
-        }
+/*
+* The key exchange task.  Makes the spare key pairs and derives link keys,
+*  so svc_network is not held up by a scalar multiplication.
+*/
+void worker_kx(void* param) {
+    while (1) {
+        kx_work(portMAX_DELAY);
     }
-    return balance;
 }
+#endif
 
 void init_sys() {
     esp_now_peer_info_t peerInfo = {};
@@ -891,6 +2857,17 @@ void init_sys() {
         return;
     }
     esp_now_register_recv_cb(espnow_recv);
+#if defined(NET_LATERAL)
+    esp_now_register_send_cb(espnow_sent);
+#endif
+
+    // ESP-NOW does not report signal strength, so sample it from the
+    //  management frames (ESP-NOW action frames) seen in promiscuous mode.
+    wifi_promiscuous_filter_t filter = {};
+    filter.filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT;
+    esp_wifi_set_promiscuous_filter(&filter);
+    esp_wifi_set_promiscuous_rx_cb(wifi_sniffer);
+    esp_wifi_set_promiscuous(true);
 
     //  register the broadcast address
     memcpy(peerInfo.peer_addr, link_broadcast.mac, 6);
@@ -903,7 +2880,7 @@ void init_sys() {
     }
 
     // Initialize the outbound packet queue.
-    outbound = xQueueCreate(16, sizeof(NetFrame));
+    outbound = xQueueCreate(OUTBOUND_QUEUE_SIZE, sizeof(NetFrame));
     if (!outbound) {
         ESP_LOGE(TAG, "Failed to create outbound packet queue.");
         return;
@@ -928,75 +2905,67 @@ void init_sys() {
 void init_node(NodeState* node, NodeId id) {
     // NOTE: Method assumes node has ALREADY been zero-initialized.
 
-    esp_timer_create_args_t timer_init = {};
-
     init_table(&node->link_table);
     init_hooks(&node->app_table);
 
     // Pick a random initial identifier.
     node->id = id;
+    esp_read_mac(node->mac, ESP_MAC_WIFI_STA);
     node->loc_ident = esp_random() % 256;
+    node->tx_counter = esp_random();
     
 
     // Set up the timers associated with the network layer.
-    timer_init.callback = timer_cb_pending_link;
-    timer_init.arg = NULL;
-    timer_init.dispatch_method = ESP_TIMER_TASK;
-    timer_init.name = "LinkProposal";
-    if (esp_timer_create(&timer_init, &node->pending_timer) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create timer.");
-        return;
+    wheel_init(&node->wheel, esp_timer_get_time());
+    wheel_timer_init(&node->pending_timer, timer_cb_pending_link, NULL);
+    wheel_timer_init(&node->loc_timer, timer_cb_locating, NULL);
+    wheel_timer_init(&node->status_timer, timer_cb_up_status, NULL);
+    wheel_timer_init(&node->join_timer, timer_cb_join, NULL);
+    wheel_timer_init(&node->map.timer, timer_cb_map, NULL);
+    wheel_timer_init(&node->lease_timer, timer_cb_lease, NULL);
+    wheel_timer_init(&node->lateral.beacon, timer_cb_beacon, NULL);
+    for (int i = 0; i < LATERAL_SIZE; ++i) {
+        wheel_timer_init(&node->lateral.entry[i].timer, timer_cb_lateral, (void*)i);
     }
+    wheel_timer_init(&node->health.timer, timer_cb_health, NULL);
+    health_init(&node->health.table, HEALTH_BUDGET, esp_timer_get_time());
 
-    timer_init.callback = timer_cb_locating;
-    timer_init.arg = NULL;
-    timer_init.dispatch_method = ESP_TIMER_TASK;
-    timer_init.name = "Locate";
-    if (esp_timer_create(&timer_init, &node->loc_timer) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create timer.");
+    node->inbound = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(NetEvent));
+    if (node->inbound == NULL) {
+        ESP_LOGE(TAG, "Failed to create network event queue.");
         return;
     }
 
-    timer_init.callback = timer_cb_up_status;
-    timer_init.arg = NULL;
-    timer_init.dispatch_method = ESP_TIMER_TASK;
-    timer_init.name = "UpStatus";
-    if (esp_timer_create(&timer_init, &node->status_timer) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create timer.");
+    node->events = xEventGroupCreate();
+    if (node->events == NULL) {
+        ESP_LOGE(TAG, "Failed to create network event group.");
         return;
     }
+    xEventGroupSetBits(node->events, EVT_OUTBOUND_CLEAR);
 
-    timer_init.callback = timer_cb_join;
-    timer_init.arg = NULL;
-    timer_init.dispatch_method = ESP_TIMER_TASK;
-    timer_init.name = "NetJoin";
-    if (esp_timer_create(&timer_init, &node->join_timer) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create timer.");
+    init_keys();
+
+#if defined(NET_LINK_KX)
+    // svc_kx makes the first spare key pair as soon as it runs.
+    node->kx.jobs = xQueueCreate(KX_JOBS, sizeof(KxJob));
+    node->kx.pairs = xQueueCreate(1, sizeof(crypto_kx_t));
+    if (node->kx.jobs == NULL || node->kx.pairs == NULL) {
+        ESP_LOGE(TAG, "Failed to create key exchange queues.");
         return;
     }
+    KxJob refill = { .role = KX_PAIR };
+    xQueueSend(node->kx.jobs, &refill, 0);
+#endif
 }
 
 void init_table(LinkTable* table) {
     // NOTE: Method assumes table has ALREADY been zero-initialized.
 
-    esp_timer_create_args_t timer_init = {};
     for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
-        if (i == 0) {
-            timer_init.callback = timer_cb_upstream;
-            timer_init.name = "UpStreamDecay";
-        }
-        else {
-            timer_init.callback = timer_cb_downstream;
-            timer_init.name = "DownStreamDecay";
-        }
         // NOTE: We stash the INDEX of the relevant entry in the timer cb argument.
-        timer_init.arg = (void*)i;
-        timer_init.dispatch_method = ESP_TIMER_TASK;
-
-        if (esp_timer_create(&timer_init, &(table->entry[i].timer)) != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to create virtual link timer.");
-            return;
-        }
+        wheel_timer_init(&table->entry[i].timer,
+                         (i == LINK_UP ? timer_cb_upstream : timer_cb_downstream),
+                         (void*)i);
     }
 }
 
@@ -1011,6 +2980,22 @@ void init_hooks(AppTable* table) {
     xSemaphoreGive(table->lock);
 }
 
+/*
+* Promiscuous receive callback, only used to sample the RSSI of frames sent by
+*  linked peers.  Address 2 of the 802.11 header is the transmitter.
+*/
+void wifi_sniffer(void* buf, wifi_promiscuous_pkt_type_t type) {
+    const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buf;
+    const uint8_t* mac = pkt->payload + 10;
+
+    for (int i = 0; i < LINK_TABLE_SIZE; ++i) {
+        if (node.link_table.usage & (1ul << i) && cmp_mac(mac, node.link_table.entry[i].mac)) {
+            node.link_table.entry[i].rssi = pkt->rx_ctrl.rssi;
+            return;
+        }
+    }
+}
+
 /*
 * Method looks up the MAC address associated with a node-id in the link table.
 *  Note that this method will also check the broadcast id and any pending link
@@ -1030,6 +3015,12 @@ const uint8_t* find_mac(NodeId id) {
             return node.link_table.entry[i].mac;
         }
     }
+#if defined(NET_LATERAL)
+    LinkEntry* peer = find_lateral(id);
+    if (peer != NULL) {
+        return peer->mac;
+    }
+#endif
     return NULL;
 }
 
@@ -1094,19 +3085,203 @@ QueueHandle_t find_app(uint16_t app_id) {
     return result;
 }
 
+/*
+* Hands a received frame to its app, counting it against the app when the
+*  inbound queue is full.
+*/
+void deliver_app(QueueHandle_t qh, const uint8_t* app_pkt) {
+    if (xQueueSend(qh, app_pkt, 0) == pdTRUE) {
+        return;
+    }
+
+    uint16_t app_id = ((const app_header_t*)app_pkt)->type;
+    for (int i = 0; i < 32; ++i) {
+        if (node.app_table.usage & (1ul << i) && node.app_table.apps[i].id == app_id) {
+            node.app_table.apps[i].drops++;
+            break;
+        }
+    }
+}
+
+
+int net_send_raw(NetFrame* frame) {
+    return net_queue_frame(frame, 0);
+}
 
-void net_send_raw(NetFrame* frame) {
+/*
+* Queues a frame for worker_send, waiting up to 'wait' ticks for room.  When
+*  the queue is full the frame is dropped, the congestion bit is cleared and
+*  NET_WOULD_BLOCK returned.
+*/
+int net_queue_frame(NetFrame* frame, TickType_t wait) {
     assert(frame != NULL);
 
     // Simple validation -- any outbound packets must have as a destination
-    //  a node-id associated with one of our virtual links, or the broadcast
-    //  address.
-    assert(is_linked(frame->head.destination) || 
-        frame->head.destination == link_broadcast.id ||
-        frame->head.destination == node.pending_id);
+    //  a node-id associated with one of our virtual links (lateral ones too),
+    //  or the broadcast address.
+    assert(find_mac(frame->head.destination) != NULL);
+
+    if (xQueueSend(outbound, frame, wait) != pdTRUE) {
+        xEventGroupClearBits(node.events, EVT_OUTBOUND_CLEAR);
+        node.stats.would_block++;
+        ESP_LOGW(TAG, "Failed to send packet -- outbound queue full.");
+        return NET_WOULD_BLOCK;
+    }
+
+    uint32_t waiting = uxQueueMessagesWaiting(outbound);
+    if (waiting > node.stats.out_hwm) {
+        node.stats.out_hwm = waiting;
+    }
+    return 0;
+}
+
+int64_t net_time_us(uint32_t* err) {
+    if (err != NULL) {
+        *err = clock_error();
+    }
+    return network_time();
+}
+
+int net_congested() {
+    return (xEventGroupGetBits(node.events) & EVT_OUTBOUND_CLEAR ? 0 : 1);
+}
+
+int net_wait_clear(int32_t timeout) {
+    EventBits_t bits = xEventGroupWaitBits(node.events, EVT_OUTBOUND_CLEAR, pdFALSE, pdTRUE, to_ticks(timeout));
+    return (bits & EVT_OUTBOUND_CLEAR ? 0 : NET_WOULD_BLOCK);
+}
+
+/*
+* Returns the network time in microseconds: the root's esp_timer clock, as
+*  last learned from the parent's STATUS response.
+*/
+int64_t network_time() {
+    return clock_at(esp_timer_get_time());
+}
+
+/*
+* Network time at a given esp_timer_get_time() value.
+*/
+int64_t clock_at(int64_t local) {
+    portENTER_CRITICAL(&time_lock);
+    int64_t base = node.clock.base;
+    int64_t offset = node.clock.offset;
+    int64_t drift = node.clock.drift;
+    portEXIT_CRITICAL(&time_lock);
+
+    return local + offset + (local - base) * drift / 1000000000;
+}
+
+/*
+* Bound on the error of network_time(), microseconds.  It grows from the last
+*  sample at the rate the drift may still be off by.
+*/
+uint32_t clock_error() {
+    if (node.isRoot) {
+        return 0;
+    }
+    if (!node.clock.synced) {
+        return UINT32_MAX;
+    }
+
+    int64_t age = esp_timer_get_time() - node.clock.base;
+    int64_t rate = (node.clock.samples > 1 ? CLOCK_RESIDUAL_PPB : CLOCK_WANDER_PPB);
+    int64_t err = node.clock.err + age * rate / 1000000000;
+    return (err < UINT32_MAX ? err : UINT32_MAX);
+}
+
+/*
+* Takes the time from a STATUS response.  With t1 our request sent, t2 its
+*  arrival at the parent, t3 the response sent and t4 its arrival here, the
+*  offset is ((t2 - t1) + (t3 - t4)) / 2, off by at most half the round trip
+*  (t4 - t1) - (t3 - t2) plus the parent's own error.
+*/
+void clock_sample(const TimeRecord* rec, int64_t rx) {
+    if (rec->echo == 0 || rec->err == UINT32_MAX) {
+        return;
+    }
 
-    if (xQueueSend(outbound, frame, 0) != pdTRUE) {
-        ESP_LOGE(TAG, "Failed to send packet -- outbound queue full.");
+    int64_t delay = (rx - rec->echo) - (rec->tx - rec->rx);
+    if (delay < 0 || delay > CLOCK_MAX_DELAY) {
+        node.clock.rejected++;
+        return;
+    }
+
+    // The best round trip creeps up again, a new path may be slower for good.
+    if (!node.clock.min_delay || delay < node.clock.min_delay) {
+        node.clock.min_delay = delay;
+    }
+    else {
+        node.clock.min_delay += (node.clock.min_delay >> 3) + 1;
+    }
+    if (node.clock.synced && delay > 2 * node.clock.min_delay + CLOCK_SLACK_US) {
+        node.clock.rejected++;
+        return;
+    }
+
+    int64_t offset = ((rec->rx - rec->echo) + (rec->tx - rx)) / 2;
+    int64_t drift = node.clock.drift;
+    int64_t span = rx - node.clock.base;
+
+    // Drift from successive offsets, smoothed once there is an estimate.
+    if (node.clock.synced && node.clock.samples > 0 && span > US_FACTOR) {
+        int64_t measured = (offset - node.clock.offset) * 1000000000 / span;
+        drift = (node.clock.samples > 1 ? drift + (measured - drift) / 4 : measured);
+        if (drift > CLOCK_MAX_DRIFT) {
+            drift = CLOCK_MAX_DRIFT;
+        }
+        else if (drift < -CLOCK_MAX_DRIFT) {
+            drift = -CLOCK_MAX_DRIFT;
+        }
+    }
+
+    portENTER_CRITICAL(&time_lock);
+    node.clock.base = rx;
+    node.clock.offset = offset;
+    node.clock.drift = drift;
+    portEXIT_CRITICAL(&time_lock);
+
+    node.clock.err = rec->err + delay / 2;
+    node.clock.delay = delay;
+    node.clock.samples++;
+    node.clock.synced = 1;
+}
+
+/*
+* Returns this node's transmission slot.  The root, with no branch, takes the
+*  first slot of depth zero.
+*/
+int tdma_slot() {
+    int branch = (node.tdma.branch > 0 ? node.tdma.branch - 1 : 0);
+    return (node.tdma.depth % TDMA_DEPTH_CYCLE) * TDMA_BRANCHES + branch;
+}
+
+/*
+* Holds the calling task until the node's slot.  Until the node is synced,
+*  and for the LOCATE / LINK handshake with nodes that are not, the random
+*  send jitter is used instead.
+*/
+void tdma_wait(NetFrame* frame) {
+    if (!node.clock.synced ||
+        frame->head.control == CONTROL_LOCATE ||
+        frame->head.control == CONTROL_LINK) {
+        vTaskDelay(((esp_random() % WINDOW_SEND) / 1000) / portTICK_RATE_MS);
+        return;
+    }
+
+    const int64_t period = TDMA_SLOTS * TDMA_SLOT_US;
+    const int64_t start = tdma_slot() * TDMA_SLOT_US;
+    const int64_t tick = portTICK_PERIOD_MS * 1000;
+
+    while (1) {
+        int64_t pos = network_time() % period;
+        if (pos >= start && pos < start + TDMA_SLOT_US - TDMA_GUARD_US) {
+            return;
+        }
+
+        int64_t wait = (start - pos + period) % period;
+        TickType_t ticks = (wait + tick - 1) / tick;
+        vTaskDelay(ticks > 0 ? ticks : 1);
     }
 }
 
@@ -1121,11 +3296,103 @@ void worker_send(void* param) {
             // Spin.
         }
 
+        // Senders held back by a full queue may go again once it has drained.
+        if (uxQueueMessagesWaiting(outbound) <= OUTBOUND_LOW_WATER) {
+            xEventGroupSetBits(node.events, EVT_OUTBOUND_CLEAR);
+        }
+
+#if defined(NET_TDMA)
+        tdma_wait(&packet);
+#else
         // Add a minor random delay to packet transmission to mitigate spiky traffic.
         vTaskDelay(((esp_random() % WINDOW_SEND) / 1000) / portTICK_RATE_MS);
+#endif
+
+        transmit_frame(&packet);
+    }
+}
+
+/*
+* Hands one frame from the outbound queue to ESP-NOW, once its time has come.
+*/
+void transmit_frame(NetFrame* packet) {
+    // STATUS frames carry the time of transmission: requests go up with
+    //  our own clock, responses down with the network time.
+    if (packet->head.control == CONTROL_STATUS) {
+        int64_t now = (is_upstream(packet->head.destination) ? esp_timer_get_time() : network_time());
+        memcpy(packet->contents + offsetof(TimeRecord, tx), &now, sizeof(int64_t));
+        packet->head.checksum = pak_checksum(packet);
+    }
+
+    const uint8_t* mac = find_mac(packet->head.destination);
+    capture_frame(mac, (const uint8_t*)packet, CAPTURE_OUT);
+    if (esp_now_send(mac, (const uint8_t*)packet, sizeof(NetFrame)) != ESP_OK) {
+        ESP_LOGE(TAG, "Packet send failure.");
+    }
+}
+
+/*
+* The network service task.  Received frames, requests from other tasks and
+*  timer expiries are all handled here, one at a time, so none of them need
+*  to lock the node state against each other.
+*/
+void worker_network(void* param) {
+    NetEvent evt;
+    while (1) {
+        int64_t next = wheel_next(&node.wheel, esp_timer_get_time());
+        // Round up, waking before the slot is due would only spin.
+        TickType_t wait = portMAX_DELAY;
+        if (next >= 0) {
+            wait = (TickType_t)((next + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+        }
+
+        if (xQueueReceive(node.inbound, &evt, wait) == pdTRUE) {
+            service_event(&evt);
+        }
+
+        wheel_advance(&node.wheel, esp_timer_get_time());
+
+#if defined(NET_CHECK)
+        int err = check_table();
+        if (err != 0) {
+            ESP_LOGE(TAG, "Link table inconsistent (%d) after event %d, control %d.",
+                     err, evt.type, evt.frame.head.control);
+        }
+#endif
+    }
+}
 
-        if (esp_now_send(find_mac(packet.head.destination), (const uint8_t*)&packet, sizeof(NetFrame)) != ESP_OK) {
-            ESP_LOGE(TAG, "Packet send failure.");
+/*
+* Handles one event taken from node.inbound, svc_network only.
+*/
+void service_event(const NetEvent* evt) {
+    switch (evt->type) {
+    case EVENT_FRAME: {
+            int64_t t0 = esp_timer_get_time();
+            node.rx_time = evt->time;
+            dispatch_frame(evt->mac, &evt->frame);
+            int64_t dt = esp_timer_get_time() - t0;
+
+            node.stats.frames++;
+            node.stats.busy_us += dt;
+            if (dt > node.stats.max_us) {
+                node.stats.max_us = dt;
+            }
+            break;
         }
+    case EVENT_MAP:
+        map_begin(node.map.seq + 1, TIMEOUT_MAP);
+        break;
+    case EVENT_GROUP:
+        group_update();
+        break;
+#if defined(NET_LATERAL)
+    case EVENT_SENT:
+        count_sent(evt->mac, evt->ok);
+        break;
+#endif
+    case EVENT_KX:
+        kx_derived((const KxResult*)evt->frame.contents);
+        break;
     }
 }
@@ -5,7 +5,15 @@
 #include <freertos/queue.h>
 #include <freertos/task.h>
 
+#include <esp_now.h>
 #include <esp_timer.h>
+#include <esp_wifi.h>
+
+#include "net_crypto.h"
+#include "net_health.h"
+#include "net_lease.h"
+#include "net_wheel.h"
+#include "network.h"
 
 #define PINODE_ID 0x01
 
@@ -16,9 +24,29 @@
 #define LINK_UP 0
 
 #define INBOUND_QUEUE_SIZE 6
+#define EVENT_QUEUE_SIZE 16
+#define OUTBOUND_QUEUE_SIZE 16
+#define OUTBOUND_LOW_WATER 4
+
+// Application payload encryption with the mesh key (AES-CCM, see net_crypto.h).
+//  Every node in the mesh must agree on this setting, rename to NET_ENCRYPT
+//  to enable it.
+#define noNET_ENCRYPT
+
+// Authenticated X25519 exchange in LOCATE / LINK, deriving a key per link
+//  instead of sealing everything with the mesh key.  Nodes without the mesh
+//  identity cannot join.  Rename to NET_LINK_KX to enable it, mesh-wide.
+#define noNET_LINK_KX
+
+// Check link table invariants after every event handled by svc_network and
+//  log violations.  Meant for soak tests, rename to NET_CHECK to enable it.
+#define noNET_CHECK
 
 #define LOCATE_SIZE 16
 
+// Group ids 1 .. GROUP_MAX - 1, one bit each in the subtree masks.
+#define GROUP_MAX 32
+
 #define WAIT_LOCK ((TickType_t)(10 / portTICK_PERIOD_MS))
 
 // Microsecond timer values.
@@ -38,12 +66,89 @@
 
 #define WINDOW_SEND				(10000)
 
+// Slotted transmission.  Every node learns its depth and its branch (index in
+//  the parent's link table) during LINK, and a network time base from the
+//  STATUS responses of its parent.  worker_send then holds frames until the
+//  node's slot: depths TDMA_DEPTH_CYCLE apart and cousins share a slot, no
+//  two nodes within two hops do.  A depth 1 node forwards its whole subtree
+//  in one slot per cycle, which bounds the mesh's up-stream rate (tdma_sim.py).
+//  Rename to NET_TDMA to enable it, mesh-wide.
+#define noNET_TDMA
+
+#define TDMA_SLOT_US			(20000)
+#define TDMA_GUARD_US			(4000)
+#define TDMA_DEPTH_CYCLE		4
+#define TDMA_BRANCHES			(LINK_TABLE_SIZE - 1)
+#define TDMA_SLOTS				(TDMA_DEPTH_CYCLE * TDMA_BRANCHES)
+
+// Mesh time.  The root's clock is the reference, every node estimates its
+//  offset and drift against its parent from the four timestamps of a STATUS
+//  exchange, like NTP.  Exchanges with a round trip far above the best one
+//  seen are queued or retried on the way and skipped.
+#define CLOCK_FIRST_SYNC		(1 * US_FACTOR)		// first STATUS after linking
+#define CLOCK_MAX_DELAY			(50000)
+#define CLOCK_SLACK_US			(500)
+#define CLOCK_MAX_DRIFT			(200000)	// ppb, beyond any crystal
+#define CLOCK_WANDER_PPB		(40000)		// error growth, drift unknown
+#define CLOCK_RESIDUAL_PPB		(2000)		// error growth, drift estimated
+
+// Map collection: the root grants TIMEOUT_MAP to the whole tree, and every
+//  level keeps TIMEOUT_MAP_HOP of its budget back for its own reply.
+#define TIMEOUT_MAP				(2 * US_FACTOR)
+#if defined(NET_TDMA)
+#define TIMEOUT_MAP_HOP			(150000 + TDMA_SLOTS * TDMA_SLOT_US)
+#else
+#define TIMEOUT_MAP_HOP			(150000)
+#endif
+#define MAP_BUDGET_UNIT			(10000)
+
+#define MAP_SIZE 48
+
+// Lateral links between nodes at the same depth under different parents.
+//  Nodes with an up-stream link broadcast a LATERAL beacon every
+//  PERIOD_LATERAL and keep the peers they hear.  Frames go up through a
+//  lateral while our parent is lost, and every other one does while the
+//  parent reports a fuller queue than the lateral's path.  Losing the parent
+//  no longer blacks out the subtree as long as a lateral is live.  Lateral
+//  frames are sealed with the mesh key, also under NET_LINK_KX.  Rename to
+//  NET_LATERAL to enable it, mesh-wide.
+#define noNET_LATERAL
+
+#define LATERAL_SIZE			2
+#define PERIOD_LATERAL			(10 * US_FACTOR)
+#define WINDOW_LATERAL			(2 * US_FACTOR)
+#define TIMEOUT_LATERAL			(25 * US_FACTOR)
+// Unacknowledged sends in a row before the parent is taken for lost.
+#define LATERAL_FAIL_LIMIT		4
+
+// Node-id leases: a node started without an id joins under a random
+//  provisional one and asks the root for a lease right after linking.  It
+//  takes no children until the grant arrives, and renews every PERIOD_LEASE.
+#define TIMEOUT_LEASE			(2 * US_FACTOR)
+#define PERIOD_LEASE			(300ll * US_FACTOR)
+#define LEASE_LIFETIME			(3600ll * US_FACTOR)
+#define LEASE_PATH_MAX			16
+
+// Health telemetry: every node refreshes its own record each PERIOD_HEALTH
+//  and, every TICK_HEALTH, sends what changed in its subtree up-stream in one
+//  CONTROL_HEALTH frame.  Those frames stay within HEALTH_BUDGET bytes per
+//  second on each link, records merge on the way up (see net_health.h).
+#define HEALTH_BUDGET			16
+#define PERIOD_HEALTH			(30 * US_FACTOR)
+#define TICK_HEALTH				(5 * US_FACTOR)
+#define WINDOW_HEALTH			(1 * US_FACTOR)
+#define TIMEOUT_HEALTH			(300ll * US_FACTOR)
+
 typedef uint8_t NodeId;
 
 typedef struct LinkEntry {
 	uint8_t mac[6];
 	NodeId id;
-	esp_timer_handle_t timer;
+	int8_t rssi;	// last received signal strength from this peer, dBm
+	uint32_t rx_counter;	// highest frame counter accepted from this peer
+	uint8_t key[CRYPTO_KEY_SIZE];	// per-link key, NET_LINK_KX only
+	uint32_t groups;	// groups with members in this child's subtree
+	WheelTimer timer;
 } LinkEntry;
 
 typedef struct LinkTable {
@@ -54,6 +159,7 @@ typedef struct LinkTable {
 typedef struct AppQueue {
 	uint16_t        id;
 	QueueHandle_t   inbound;
+	uint32_t        drops;	// frames lost to a full inbound queue
 } AppQueue;
 
 typedef struct AppTable {
@@ -62,9 +168,153 @@ typedef struct AppTable {
 	SemaphoreHandle_t   lock;
 } AppTable;
 
+// One edge of the topology, as collected by CONTROL_MAP.
+typedef struct __attribute__((packed)) MapRecord {
+	NodeId	id;
+	NodeId	parent;		// zero for the root
+	int8_t	rssi;		// quality of the link to parent
+	uint16_t	time_err;	// mesh time error bound, us, UINT16_MAX if unknown
+} MapRecord;
+
+// Key exchange contents of LOCATE and LINK frames.
+typedef struct __attribute__((packed)) KxRecord {
+	uint8_t	pub[CRYPTO_PUB_SIZE];	// sender's ephemeral X25519 key
+	uint8_t	mac[CRYPTO_MAC_SIZE];	// identity (or link key) HMAC of the transcript
+} KxRecord;
+
+// Key derivations run on svc_kx, which also keeps a spare key pair ready.
+#define KX_JOINER 0
+#define KX_PROPOSER 1
+#define KX_PAIR 2		// make the next spare key pair
+#define KX_JOBS 4
+
+typedef struct KxJob {
+	uint8_t		role;
+	uint8_t		seq;		// KxState seq of the role when handed over
+	uint8_t		info_len;
+	crypto_kx_t	own;
+	uint8_t		peer[CRYPTO_PUB_SIZE];
+	uint8_t		info[4 + 2 * CRYPTO_PUB_SIZE];	// transcript
+} KxJob;
+
+// EVENT_KX, in the event's frame contents.
+typedef struct KxResult {
+	uint8_t		role;
+	uint8_t		seq;
+	uint8_t		ok;			// derived
+	uint32_t	us;			// spent on svc_kx
+	uint32_t	cycles;
+	uint8_t		key[CRYPTO_KEY_SIZE];
+} KxResult;
+
+typedef struct KxState {
+	crypto_kx_t	own;						// joiner side: pair of the running LOCATE
+	uint8_t		peer[CRYPTO_PUB_SIZE];		// proposer side: joiner's key
+	uint8_t		sent[CRYPTO_PUB_SIZE];		// proposer side: our key
+	uint8_t		pending_key[CRYPTO_KEY_SIZE];
+	uint8_t		pending_ready;				// pending_key is back from svc_kx
+	uint8_t		offer[LOCATE_SIZE][CRYPTO_PUB_SIZE];	// joiner side: one per loc_response
+	uint32_t	slot;						// joiner side: offer being derived
+	uint8_t		seq[2];						// last derivation handed over, per role
+	QueueHandle_t	jobs;					// KxJob, for svc_kx
+	QueueHandle_t	pairs;					// the spare crypto_kx_t
+	int64_t		locate_time;	// LOCATE sent, for join latency
+	int64_t		cost_us;		// crypto time spent on the last handshake
+	uint32_t	cost_cycles;
+	int64_t		join_us;		// LOCATE to up-stream link, last join
+} KxState;
+
+// Contents of LEASE frames.  Requests travel up and collect the link table
+//  index of every hop in 'path', the grant travels back down along it.
+typedef struct __attribute__((packed)) LeaseRecord {
+	uint8_t	mac[6];		// requesting node
+	NodeId	id;			// current id up, granted id down
+	uint8_t	hops;
+	uint8_t	path[LEASE_PATH_MAX];
+} LeaseRecord;
+
+typedef struct LateralState {
+	LinkEntry	entry[LATERAL_SIZE];	// the timer forgets a silent peer
+	uint32_t	usage;
+	NodeId		parent[LATERAL_SIZE];	// the peer's up-stream link
+	uint8_t		load[LATERAL_SIZE];		// fuller of the peer's and its parent's queue
+	uint8_t		up_load;		// our parent's outbound queue, from its last STATUS
+	uint32_t	up_fails;		// unacknowledged sends to the parent in a row
+	uint32_t	turn;			// alternates frames while splitting
+	int64_t		lost_time;		// parent lost, zero once linked again
+	int64_t		recovery_us;	// parent lost to first frame sent via a lateral
+	uint32_t	failovers;
+	uint32_t	sent;			// own up-stream frames sent via a lateral
+	uint32_t	relayed;		// frames taken from a lateral peer
+	WheelTimer	beacon;
+} LateralState;
+
+typedef struct MapState {
+	int			active;
+	uint8_t		seq;
+	uint32_t	pending;	// link table indices still owing a reply
+	uint32_t	count;
+	MapRecord	record[MAP_SIZE];
+	WheelTimer	timer;
+} MapState;
+
+typedef struct TdmaState {
+	uint8_t		depth;		// hops to the root
+	uint8_t		branch;		// our index in the parent's link table
+	uint8_t		offer_depth[LOCATE_SIZE];	// per loc_response, while locating
+	uint8_t		offer_branch[LOCATE_SIZE];
+} TdmaState;
+
+// Contents of STATUS frames.  worker_send stamps 'tx' right before sending:
+//  our own clock on requests, network time on responses.
+typedef struct __attribute__((packed)) TimeRecord {
+	int64_t		tx;
+	int64_t		echo;	// response: 'tx' of the request answered
+	int64_t		rx;		// response: network time the request arrived
+	uint32_t	err;	// response: the parent's own error bound, us
+} TimeRecord;
+
+typedef struct HealthState {
+	HealthTable	table;		// own record and the subtree's
+	int64_t		sampled;	// own record last refreshed
+	uint32_t	idle_us[2];	// idle task run time per core at that time
+	WheelTimer	timer;
+} HealthState;
+
+typedef struct ClockState {
+	int			synced;		// offset valid, parent was synced itself
+	int64_t		base;		// esp_timer_get_time() of the last sample
+	int64_t		offset;		// network time minus esp_timer_get_time() at base
+	int32_t		drift;		// ppb, network clock rate against ours
+	uint32_t	err;		// error bound at base, us
+	uint32_t	delay;		// round trip of the last sample
+	uint32_t	min_delay;	// best round trip lately, zero after a new parent
+	uint32_t	samples;
+	uint32_t	rejected;
+} ClockState;
+
+typedef struct NetStats {
+	uint32_t	frames;		// dispatched by svc_network
+	uint32_t	malformed;	// failed valid_packet, or unknown control
+	uint32_t	dropped;	// event queue full
+	uint32_t	unlinked;	// not from the (MAC, node-id) pair of a link
+	int64_t		busy_us;	// total time spent in dispatch_frame
+	int64_t		max_us;
+	uint32_t	would_block;	// frames dropped on a full outbound queue
+	uint32_t	group_sends;	// group messages sent or forwarded down
+	uint32_t	group_frames;	// frames those took
+	uint32_t	group_pruned;	// frames saved against flooding every child
+	uint32_t	lease_conflicts;	// LINK refused, id already linked from another MAC
+	uint32_t	out_hwm;	// outbound queue high-water mark since the last health record
+} NetStats;
+
 typedef struct NodeState {
 	int			isRoot;
 	NodeId		id;
+	uint8_t		mac[6];
+	uint32_t	tx_counter;
+	uint32_t	groups;				// own memberships
+	uint32_t	groups_reported;	// subtree mask last sent up-stream
 	LinkTable	link_table;
 	AppTable	app_table;
 	uint32_t	flags;
@@ -72,22 +322,43 @@ typedef struct NodeState {
 	uint8_t		loc_ident;
 	LinkEntry	loc_response[LOCATE_SIZE];
 	uint32_t	loc_count;
-	esp_timer_handle_t loc_timer;
+	WheelTimer	loc_timer;
 
 	uint8_t				pending_mac[6];
 	NodeId				pending_id;
-	esp_timer_handle_t	pending_timer;
-
-	esp_timer_handle_t status_timer;
-	esp_timer_handle_t join_timer;
-
+	uint8_t				pending_branch;	// link table entry offered in the proposal
+	WheelTimer			pending_timer;
+
+	WheelTimer	status_timer;
+	WheelTimer	join_timer;
+	WheelTimer	lease_timer;
+	TimerWheel	wheel;
+	LeaseTable*	leases;		// root only
+
+	MapState	map;
+	KxState		kx;
+	NetStats	stats;
+	TdmaState	tdma;
+	ClockState	clock;
+	LateralState	lateral;
+	HealthState	health;
+	int64_t		rx_time;	// receive time of the frame being dispatched
+
+	EventGroupHandle_t events;
+	QueueHandle_t	inbound;	// NetEvent, drained by svc_network
+	TaskHandle_t svc_network;
 	TaskHandle_t svc_outbound;
+	TaskHandle_t svc_kx;
 } NodeState;
 
+#define EVT_MAP_DONE (1ul << 0)
+#define EVT_OUTBOUND_CLEAR (1ul << 1)	// cleared when a send found outbound full
+
 #define STATE_LOCATING (1ul << 0)
 #define STATE_PENDING_LINK (1ul << 1)
 #define STATE_UPLINK_STATUS (1ul << 2)
 #define STATE_FROZEN (1ul << 3)
+#define STATE_LEASED (1ul << 4)
 
 typedef struct NetFrameHeader {
 	uint8_t version;
@@ -98,10 +369,22 @@ typedef struct NetFrameHeader {
 	uint8_t reserved[11];
 } NetFrameHeader;
 
-#define RES_CONTROL 0
+#define RES_GROUP 0
 #define RES_IDENT 1
-#define RES_ORIGIN 1
-#define RES_UPSTREAM 2
+#define RES_MAP_SEQ 1
+#define RES_MAP_BUDGET 2
+#define RES_MAP_COUNT 3
+#define RES_MAP_MORE 4
+#define RES_NONCE 1
+#define RES_TAG 5
+#define RES_DEPTH 2
+#define RES_BRANCH 3
+#define RES_SYNCED 3
+#define RES_GROUPS 4
+#define RES_LAT_PARENT 4
+#define RES_LAT_LOAD 5
+#define RES_LOAD 8
+#define RES_HEALTH_COUNT 1
 
 #define CONTROL_DEFAULT 0
 #define CONTROL_LOCATE 1
@@ -110,21 +393,71 @@ typedef struct NetFrameHeader {
 #define CONTROL_MAP 4
 #define CONTROL_BLACKOUT 5
 #define CONTROL_FREEZE 6
+#define CONTROL_GROUP 7
+#define CONTROL_LEASE 8
+#define CONTROL_LATERAL 9
+#define CONTROL_HEALTH 10
 
 typedef struct NetFrame {
 	NetFrameHeader head;
 	uint8_t contents[136];
 } NetFrame;
 
+#define MAP_PER_FRAME (sizeof(((NetFrame*)0)->contents) / sizeof(MapRecord))
+#define HEALTH_PER_FRAME (sizeof(((NetFrame*)0)->contents) / sizeof(HealthRecord))
+
+// Work for the network service task.  Received frames and requests from
+//  other tasks are serialised with the timer wheel through one queue.
+#define EVENT_FRAME 0
+#define EVENT_MAP 1
+#define EVENT_GROUP 2
+#define EVENT_SENT 3
+#define EVENT_KX 4		// a link key from svc_kx
+
+typedef struct NetEvent {
+	uint8_t		type;
+	uint8_t		mac[6];		// sender, EVENT_FRAME, or receiver, EVENT_SENT
+	uint8_t		ok;			// acknowledged, EVENT_SENT only
+	int64_t		time;		// receive time, EVENT_FRAME only
+	NetFrame	frame;
+} NetEvent;
+
+// Frame capture ring -- records inbound and outbound frames for later dumping
+//  over serial (NET_CAPTURE DUMP, capture.py).  Off by default, the ring takes
+//  CAPTURE_SIZE entries of RAM.  Rename to NET_CAPTURE to enable it.
+#define noNET_CAPTURE
+#define CAPTURE_SIZE 32
+
+#define CAPTURE_IN 0
+#define CAPTURE_OUT 1
+
+typedef struct __attribute__((packed)) CaptureEntry {
+	int64_t		time;		// esp_timer_get_time() at capture, microseconds
+	uint8_t		direction;	// CAPTURE_IN or CAPTURE_OUT
+	uint8_t		mac[6];		// sender in, receiver out, zero if not known
+	NetFrame	frame;
+} CaptureEntry;
+
+typedef struct CaptureRing {
+	CaptureEntry	entry[CAPTURE_SIZE];
+	uint32_t		next;		// slot the next capture is written to
+	uint32_t		count;		// valid entries, at most CAPTURE_SIZE
+	uint32_t		total;		// frames captured since last clear
+	int				enabled;
+	portMUX_TYPE	lock;
+} CaptureRing;
+
 
 // Clearinghouse for internal methods.
 void init_sys();
 void init_node(NodeState* node, NodeId id);
 void init_table(LinkTable* table);
 void init_hooks(AppTable* table);
+void init_keys();
 
 int valid_packet(const uint8_t* mac, const uint8_t* data, int len);
 int valid_link(const uint8_t* mac, NodeId node);
+int check_table();
 
 int is_linked(NodeId id);
 int is_upstream(NodeId id);
@@ -134,32 +467,114 @@ const uint8_t* find_mac(NodeId id);
 NodeId find_id(const uint8_t* mac);
 LinkEntry* find_entry(NodeId id);
 QueueHandle_t find_app(uint16_t app_id);
+void deliver_app(QueueHandle_t qh, const uint8_t* app_pkt);
 
 int has_uplink(const LinkTable* table);
 int has_available_downlinks(const LinkTable* table);
 int form_uplink(LinkTable* table, const uint8_t* mac, NodeId id);
-int form_downlink(LinkTable* table, const uint8_t* mac, NodeId id);
+int form_downlink(LinkTable* table, const uint8_t* mac, NodeId id, int x);
 
 uint8_t pak_checksum(const NetFrame* frame);
 
+crypto_key_t* link_key(NodeId id);
+void link_rekey(LinkEntry* link, const uint8_t* key);
+int seal_frame(NetFrame* frame);
+int open_frame(NetFrame* frame, LinkEntry* link);
+
 int cmp_mac(const uint8_t* mac_a, const uint8_t* mac_b);
 
 // Packet sending interface?
-void net_send_raw(NetFrame* frame);
+int net_send_raw(NetFrame* frame);
+int net_queue_frame(NetFrame* frame, TickType_t wait);
+int send_up(const app_header_t* head, const uint8_t* data, TickType_t wait);
+int send_down(uint8_t group, const app_header_t* head, const uint8_t* data, TickType_t wait);
+TickType_t to_ticks(int32_t timeout);
+
+// Group membership.
+int set_group(uint8_t group, int member);
+uint32_t subtree_groups();
+void group_update();
 
 void worker_send(void* param);
+void transmit_frame(NetFrame* packet);
+int64_t network_time();
+int64_t clock_at(int64_t local);
+uint32_t clock_error();
+void clock_sample(const TimeRecord* rec, int64_t rx);
+int tdma_slot();
+void tdma_wait(NetFrame* frame);
+void worker_network(void* param);
+void service_event(const NetEvent* evt);
+void worker_kx(void* param);
+
+void dispatch_frame(const uint8_t* mac, const NetFrame* frame);
 
 // Control packet handlers.
 void exec_blackout();
-
-
-// Callback methods for various timers.
+void exec_map_request(NodeId src, const NetFrame* frame);
+void exec_map_reply(NodeId src, const NetFrame* frame);
+void map_begin(uint8_t seq, uint64_t budget);
+void map_complete();
+void exec_lease_request(NodeId src, const NetFrame* frame);
+void exec_lease_reply(const NetFrame* frame);
+void route_lease(LeaseRecord* rec);
+void exec_lateral(const uint8_t* mac, const NetFrame* frame);
+int lateral_failover();
+void exec_health(NodeId src, const NetFrame* frame);
+
+// Health telemetry.
+void health_sample(HealthRecord* rec);
+
+// Lateral links, NET_LATERAL only.
+LinkEntry* find_lateral(NodeId id);
+LinkEntry* lateral_route();
+void espnow_sent(const uint8_t* mac, esp_now_send_status_t status);
+void count_sent(const uint8_t* mac, int ok);
+
+// Lease persistence, NVS namespace "net".
+NodeId lease_stored_id();
+void lease_store_id(NodeId id);
+void lease_load();
+void lease_save();
+
+// Key exchange steps, all return 0 on success (and when NET_LINK_KX is off).
+int kx_locate(NetFrame* out);
+int kx_propose(const NetFrame* locate, NetFrame* out);
+int kx_offer(const NetFrame* link, uint32_t slot);
+int kx_confirm(uint32_t slot);
+int kx_prove(uint32_t slot, NetFrame* out, const uint8_t* key);
+int kx_accept(const NetFrame* link, uint8_t* key);
+void kx_derived(const KxResult* res);
+int kx_work(TickType_t wait);
+void join_uplink(uint32_t x, const uint8_t* key);
+
+void wifi_sniffer(void* buf, wifi_promiscuous_pkt_type_t type);
+
+
+// Callback methods for various timers, run by svc_network.
 void timer_cb_pending_link(void* param);
 void timer_cb_locating(void* param);
 void timer_cb_up_status(void* param);
 void timer_cb_upstream(void* param);
 void timer_cb_downstream(void* param);
 void timer_cb_join(void* param);
+void timer_cb_map(void* param);
+void timer_cb_lease(void* param);
+void timer_cb_beacon(void* param);
+void timer_cb_lateral(void* param);
+void timer_cb_health(void* param);
 
 // Addition for net_table
 void net_info();
+void net_map_info();
+int map_collect();
+void net_time_info();
+void net_kx_info();
+void net_stats_info();
+void net_health_info();
+
+// Frame capture ring.
+void capture_frame(const uint8_t* mac, const uint8_t* data, uint8_t direction);
+void net_capture_enable(int enabled);
+void net_capture_clear();
+void net_capture_dump();
@@ -0,0 +1,132 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "net_lease.h"
+
+static int is_reserved(const LeaseTable* table, uint8_t id) {
+    return (table->reserved[id / 8] & (1u << (id % 8))) != 0;
+}
+
+static LeaseEntry* find_mac_entry(LeaseTable* table, const uint8_t* mac) {
+    for (int i = 0; i < LEASE_MAX; ++i) {
+        if (table->entry[i].id && memcmp(table->entry[i].mac, mac, 6) == 0) {
+            return table->entry + i;
+        }
+    }
+    return NULL;
+}
+
+static LeaseEntry* find_id_entry(LeaseTable* table, uint8_t id) {
+    for (int i = 0; i < LEASE_MAX; ++i) {
+        if (table->entry[i].id == id) {
+            return table->entry + i;
+        }
+    }
+    return NULL;
+}
+
+static int expired(const LeaseTable* table, const LeaseEntry* entry, int64_t now) {
+    return now - entry->renewed > table->lifetime;
+}
+
+void lease_init(LeaseTable* table, int64_t lifetime) {
+    memset(table, 0, sizeof(LeaseTable));
+    table->lifetime = lifetime;
+}
+
+void lease_reserve(LeaseTable* table, uint8_t id) {
+    table->reserved[id / 8] |= (1u << (id % 8));
+}
+
+void lease_loaded(LeaseTable* table, int64_t now) {
+    for (int i = 0; i < LEASE_MAX; ++i) {
+        LeaseEntry* entry = table->entry + i;
+        // Drop anything a different firmware could have left behind.
+        if (entry->id && (lease_provisional(entry->id) || is_reserved(table, entry->id))) {
+            memset(entry, 0, sizeof(LeaseEntry));
+            table->dirty = 1;
+        }
+        entry->renewed = now;
+    }
+}
+
+int lease_provisional(uint8_t id) {
+    return id >= LEASE_PROVISIONAL;
+}
+
+int lease_grant(LeaseTable* table, const uint8_t* mac, uint8_t hint, int64_t now) {
+    LeaseEntry* entry = find_mac_entry(table, mac);
+    if (entry != NULL) {
+        entry->renewed = now;
+        table->renewed++;
+        return entry->id;
+    }
+
+    // Pick the id first: the hint keeps hand-assigned and previously leased
+    //  ids stable, as long as nobody else holds them.
+    uint8_t id = 0;
+    LeaseEntry* holder = NULL;
+    if (hint >= LEASE_ID_MIN && hint <= LEASE_ID_MAX && !is_reserved(table, hint)) {
+        holder = find_id_entry(table, hint);
+        if (holder == NULL) {
+            id = hint;
+        }
+        else {
+            table->conflicts++;
+            if (expired(table, holder, now)) {
+                id = hint;
+            }
+            else {
+                holder = NULL;
+            }
+        }
+    }
+    for (int i = LEASE_ID_MIN; !id && i <= LEASE_ID_MAX; ++i) {
+        if (!is_reserved(table, i) && find_id_entry(table, i) == NULL) {
+            id = i;
+        }
+    }
+
+    // Then the entry: a free one, or the one whose lease lapsed longest ago.
+    //  Reclaiming an id takes that holder's entry along with it.
+    entry = holder;
+    for (int i = 0; entry == NULL && i < LEASE_MAX; ++i) {
+        if (!table->entry[i].id) {
+            entry = table->entry + i;
+        }
+    }
+    if (entry == NULL || !id) {
+        LeaseEntry* oldest = NULL;
+        for (int i = 0; i < LEASE_MAX; ++i) {
+            LeaseEntry* e = table->entry + i;
+            if (expired(table, e, now) && (oldest == NULL || e->renewed < oldest->renewed)) {
+                oldest = e;
+            }
+        }
+        if (oldest == NULL) {
+            table->exhausted++;
+            return -1;
+        }
+        if (!id) {
+            id = oldest->id;
+        }
+        entry = oldest;
+    }
+
+    memcpy(entry->mac, mac, 6);
+    entry->id = id;
+    entry->renewed = now;
+    table->granted++;
+    table->dirty = 1;
+    return id;
+}
+
+int lease_count(const LeaseTable* table) {
+    int count = 0;
+    for (int i = 0; i < LEASE_MAX; ++i) {
+        if (table->entry[i].id) {
+            count++;
+        }
+    }
+    return count;
+}
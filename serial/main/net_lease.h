@@ -0,0 +1,55 @@
+#ifndef NET_LEASE_H
+#define NET_LEASE_H
+
+/*
+* Node-id leases, kept by the root.  A lease binds an id to a MAC for as long
+*  as the node keeps renewing it; ids of leases not renewed for the lifetime
+*  may be handed to new nodes once the range runs out.
+*
+* Ids from LEASE_PROVISIONAL up are never leased, nodes use them only until
+*  the first grant arrives.  The table does no locking and no I/O, the caller
+*  persists 'entry' whenever 'dirty' is set.
+*/
+#include <stdint.h>
+
+#define LEASE_MAX 128
+#define LEASE_ID_MIN 0x01
+#define LEASE_PROVISIONAL 0xC0
+#define LEASE_ID_MAX (LEASE_PROVISIONAL - 1)
+
+typedef struct LeaseEntry {
+	uint8_t		mac[6];
+	uint8_t		id;			// zero if the entry is free
+	uint8_t		pad;
+	int64_t		renewed;	// last grant or renewal, microseconds
+} LeaseEntry;
+
+typedef struct LeaseTable {
+	LeaseEntry	entry[LEASE_MAX];
+	uint8_t		reserved[32];	// bitmap of ids never to lease (the root's own)
+	int64_t		lifetime;
+	uint32_t	granted;		// new leases
+	uint32_t	renewed;
+	uint32_t	conflicts;		// hint held by another MAC
+	uint32_t	exhausted;		// requests refused, no id or entry left
+	int			dirty;			// entries changed since last persisted
+} LeaseTable;
+
+void lease_init(LeaseTable* table, int64_t lifetime);
+void lease_reserve(LeaseTable* table, uint8_t id);
+
+// Restarts the lifetime of every loaded lease, the root's clock restarted too.
+void lease_loaded(LeaseTable* table, int64_t now);
+
+int lease_provisional(uint8_t id);
+
+/*
+* Returns the id leased to 'mac', granting one if it has none: 'hint' (the
+*  id the node already uses) when it is free, otherwise the lowest free id.
+*  Negative if the table is full of live leases.
+*/
+int lease_grant(LeaseTable* table, const uint8_t* mac, uint8_t hint, int64_t now);
+
+int lease_count(const LeaseTable* table);
+
+#endif
@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "net_wheel.h"
+
+// Expired timers are parked on their own list while callbacks run.
+#define SLOT_EXPIRED WHEEL_SLOTS
+
+static WheelTimer** wheel_head(TimerWheel* wheel, uint32_t slot) {
+    return (slot == SLOT_EXPIRED ? &wheel->expired : &wheel->slot[slot]);
+}
+
+static void wheel_link(TimerWheel* wheel, WheelTimer* timer, uint32_t slot) {
+    WheelTimer** head = wheel_head(wheel, slot);
+
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = timer;
+    }
+    *head = timer;
+}
+
+static void wheel_unlink(TimerWheel* wheel, WheelTimer* timer) {
+    if (timer->prev != NULL) {
+        timer->prev->next = timer->next;
+    }
+    else {
+        *wheel_head(wheel, timer->slot) = timer->next;
+    }
+    if (timer->next != NULL) {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+void wheel_init(TimerWheel* wheel, int64_t now) {
+    memset(wheel, 0, sizeof(TimerWheel));
+    wheel->epoch = now;
+}
+
+void wheel_timer_init(WheelTimer* timer, wheel_cb_t callback, void* param) {
+    memset(timer, 0, sizeof(WheelTimer));
+    timer->callback = callback;
+    timer->param = param;
+}
+
+/*
+* Arms (or re-arms) a one-shot timer.  Expiry is rounded up to whole ticks,
+*  so a timer never fires early.
+*/
+void wheel_start(TimerWheel* wheel, WheelTimer* timer, uint64_t us) {
+    assert(timer->callback != NULL);
+
+    wheel_stop(wheel, timer);
+
+    uint64_t ticks = (us + WHEEL_TICK_US - 1) / WHEEL_TICK_US;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    timer->rounds = ticks / WHEEL_SLOTS;
+    timer->active = 1;
+    wheel->active++;
+    wheel_link(wheel, timer, (wheel->tick + ticks) % WHEEL_SLOTS);
+}
+
+void wheel_stop(TimerWheel* wheel, WheelTimer* timer) {
+    if (!timer->active) {
+        return;
+    }
+    wheel_unlink(wheel, timer);
+    timer->active = 0;
+    wheel->active--;
+}
+
+void wheel_advance(TimerWheel* wheel, int64_t now) {
+    if (!wheel->active && now >= wheel->epoch) {
+        // Nothing armed, skip the idle ticks instead of walking them.
+        wheel->tick = (uint32_t)((now - wheel->epoch) / WHEEL_TICK_US) + 1;
+        return;
+    }
+
+    while (wheel->epoch + (int64_t)wheel->tick * WHEEL_TICK_US <= now) {
+        WheelTimer* timer = wheel->slot[wheel->tick % WHEEL_SLOTS];
+        wheel->tick++;
+
+        // Collect first: callbacks may start or stop any timer, this slot included.
+        while (timer != NULL) {
+            WheelTimer* next = timer->next;
+            if (timer->rounds == 0) {
+                wheel_unlink(wheel, timer);
+                wheel_link(wheel, timer, SLOT_EXPIRED);
+            }
+            else {
+                timer->rounds--;
+            }
+            timer = next;
+        }
+
+        while (wheel->expired != NULL) {
+            timer = wheel->expired;
+            wheel_stop(wheel, timer);
+            timer->callback(timer->param);
+        }
+    }
+}
+
+int64_t wheel_next(const TimerWheel* wheel, int64_t now) {
+    if (!wheel->active) {
+        return -1;
+    }
+
+    for (uint32_t d = 0; d < WHEEL_SLOTS; ++d) {
+        if (wheel->slot[(wheel->tick + d) % WHEEL_SLOTS] != NULL) {
+            int64_t due = wheel->epoch + (int64_t)(wheel->tick + d) * WHEEL_TICK_US - now;
+            return (due > 0 ? due : 0);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,49 @@
+#ifndef NET_WHEEL_H
+#define NET_WHEEL_H
+
+/*
+* Hashed timer wheel for the network layer.  Timers are bucketed by expiry
+*  tick modulo WHEEL_SLOTS and carry the number of full turns left, so
+*  starting and stopping is O(1) no matter how many links there are.
+*
+* The wheel does no locking: every call must come from the network service
+*  task (or before it is started).
+*/
+#include <stdint.h>
+
+#define WHEEL_SLOTS 64
+#define WHEEL_TICK_US 10000
+
+typedef void (*wheel_cb_t)(void* param);
+
+typedef struct WheelTimer {
+	struct WheelTimer*	next;
+	struct WheelTimer*	prev;
+	uint32_t			slot;
+	uint32_t			rounds;		// full turns of the wheel left
+	int					active;
+	wheel_cb_t			callback;
+	void*				param;
+} WheelTimer;
+
+typedef struct TimerWheel {
+	WheelTimer*	slot[WHEEL_SLOTS];
+	WheelTimer*	expired;	// due timers whose callbacks have not run yet
+	uint32_t	tick;		// next tick to be processed
+	int64_t		epoch;		// time of tick zero, microseconds
+	uint32_t	active;		// armed timers
+} TimerWheel;
+
+void wheel_init(TimerWheel* wheel, int64_t now);
+void wheel_timer_init(WheelTimer* timer, wheel_cb_t callback, void* param);
+
+void wheel_start(TimerWheel* wheel, WheelTimer* timer, uint64_t us);
+void wheel_stop(TimerWheel* wheel, WheelTimer* timer);
+
+// Runs the callbacks of every timer due by 'now'.
+void wheel_advance(TimerWheel* wheel, int64_t now);
+
+// Microseconds until the next occupied slot comes due, negative if idle.
+int64_t wheel_next(const TimerWheel* wheel, int64_t now);
+
+#endif
@@ -14,13 +14,50 @@ typedef struct
 
 /*
  * Note: app_id > 0
+ *
+ * node_id 0 (not at the root) leases an id from the root on first join and
+ * keeps it in NVS, later starts use the stored one.
  */
 int net_init(uint8_t node_id, int isDebugRoot);
+uint8_t net_node_id(void);    /* current id, changes when a lease is granted */
+int net_has_uplink(void);     /* non-zero while joined to a parent, always at the root */
 int net_register_app(uint16_t app_id);
 int net_unregister_app(uint16_t app_id);
 int net_send_up(const app_header_t *head, const uint8_t *data);
 int net_send_down(const app_header_t *head, const uint8_t *data);
 
+/*
+ * Backpressure: the send calls return NET_WOULD_BLOCK when the outbound
+ * queue is full and the frame (or, sending down, one of its copies) was
+ * dropped.  The _timeout variants wait up to 'timeout' ms for room, the
+ * plain ones not at all.  net_congested() is non-zero from a dropped send
+ * until the queue has drained, net_wait_clear(..) blocks until then and
+ * returns 0, or NET_WOULD_BLOCK on timeout.
+ */
+#define NET_WOULD_BLOCK (-5)
+
+int net_send_up_timeout(const app_header_t *head, const uint8_t *data, int32_t timeout);
+int net_send_down_timeout(const app_header_t *head, const uint8_t *data, int32_t timeout);
+int net_congested(void);
+int net_wait_clear(int32_t timeout);
+
+/*
+ * Groups: 0 < group < 32.  A group send reaches only the subtrees with
+ * members, and is delivered to members only (app header reserved[1]
+ * carries the group id).  Members of a group still receive broadcasts.
+ * Joining or leaving returns -1 for an invalid group, -2 before net_init.
+ */
+int net_join_group(uint8_t group);
+int net_leave_group(uint8_t group);
+int net_send_group(uint8_t group, const app_header_t *head, const uint8_t *data);
+
+/*
+ * Mesh time: the root's clock in microseconds, synchronised over the
+ * STATUS exchanges.  'err' (may be NULL) gets the bound on the error
+ * against the root, UINT32_MAX until this node has synchronised.
+ */
+int64_t net_time_us(uint32_t *err);
+
 #define NET_MAX_PAYLOAD 128
 
 // Blocks until viable packet is available, or timeout occurs.
@@ -197,3 +197,76 @@ void rl_fdiv2(bigint_t *x)
         }
     }
 }
+
+/*
+ *  For the step tables of collatz_kernel.c
+ */
+uint32_t rl_low(const bigint_t *x, int k)
+{
+    return x->len ? x->a[0] & ((((uint32_t)1) << k) - 1) : 0;
+}
+
+void rl_shr(bigint_t *x, int k)
+{
+    int p = BLEN - k;
+
+    if (!x->len)
+        return;
+    for (int i = 1; i < x->len; i++)
+        x->a[i - 1] = (x->a[i] << p & MASK) | (x->a[i - 1] >> k);
+    x->a[x->len - 1] = x->a[x->len - 1] >> k;
+    if (!x->a[x->len - 1]) /* only the top word can empty */
+        x->len--;
+}
+
+void rl_muladd(bigint_t *x, uint32_t m, uint32_t c)
+{
+    uint64_t r = c; /* 30 x 32 bit products, the carry fits */
+
+    for (int i = 0; i < x->len; i++)
+    {
+        r += (uint64_t)x->a[i] * m;
+        x->a[i] = (uint32_t)r & MASK;
+        r = r >> BLEN;
+    }
+    while (r)
+    {
+        if (x->len >= INT_LEN)
+        {
+            rl_overflow = 1;
+            return;
+        }
+        x->a[x->len++] = (uint32_t)r & MASK;
+        r = r >> BLEN;
+    }
+}
+
+void rl_add_shl(bigint_t *x, uint32_t c, int s)
+{
+    int i = s / BLEN;
+    uint64_t r = (uint64_t)c << (s % BLEN); /* at most 61 bits */
+
+    if (!c)
+        return;
+    if (i >= INT_LEN)
+    {
+        rl_overflow = 1;
+        return;
+    }
+    while (x->len < i)
+        x->a[x->len++] = 0;
+    for (; r; i++)
+    {
+        if (i >= INT_LEN)
+        {
+            rl_overflow = 1;
+            return;
+        }
+        if (i < x->len)
+            r += x->a[i];
+        else
+            x->len++;
+        x->a[i] = (uint32_t)r & MASK;
+        r = r >> BLEN;
+    }
+}
@@ -45,4 +45,10 @@ void rl_add(bigint_t *x, uint32_t c);
 void rl_f3n1(bigint_t *x);
 void rl_fdiv2(bigint_t *x);
 
+/* 0 < k < BLEN */
+uint32_t rl_low(const bigint_t *x, int k); /* x mod 2^k  */
+void rl_shr(bigint_t *x, int k);           /* x / 2^k    */
+void rl_muladd(bigint_t *x, uint32_t m, uint32_t c); /* x*m + c */
+void rl_add_shl(bigint_t *x, uint32_t c, int s);      /* x + c*2^s, any s >= 0 */
+
 #endif
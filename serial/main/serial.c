@@ -25,6 +25,8 @@
 #include "collatz.h"
 #include "dht.h"
 #include "app_sensor.h"
+#include "app_probe.h"
+#include "gateway.h"
 
 const TickType_t read_delay = 50 / portTICK_PERIOD_MS;
 // Data structures and global variables to ease communication
@@ -192,6 +194,58 @@ void respond()
 		{
 			command_net_table();
 		}
+		else if (strcmp(command, "NET_CAPTURE") == 0)
+		{
+			command_net_capture(quant, command_split);
+		}
+		else if (strcmp(command, "NET_MAP") == 0)
+		{
+			command_net_map();
+		}
+		else if (strcmp(command, "NET_CRYPTO") == 0)
+		{
+			command_net_crypto();
+		}
+		else if (strcmp(command, "NET_STATS") == 0)
+		{
+			command_net_stats();
+		}
+		else if (strcmp(command, "NET_TIME") == 0)
+		{
+			command_net_time();
+		}
+		else if (strcmp(command, "NET_HEALTH") == 0)
+		{
+			command_net_health();
+		}
+		else if (strcmp(command, "GATEWAY") == 0)
+		{
+			command_gateway();
+		}
+		else if (strcmp(command, "COLLATZ_STATS") == 0)
+		{
+			command_collatz_stats();
+		}
+		else if (strcmp(command, "COLLATZ_WORKERS") == 0)
+		{
+			command_collatz_workers(quant, command_split);
+		}
+		else if (strcmp(command, "COLLATZ_BENCH") == 0)
+		{
+			command_collatz_bench(quant, command_split);
+		}
+		else if (strcmp(command, "PROBE_PING") == 0)
+		{
+			command_probe_ping(quant, command_split);
+		}
+		else if (strcmp(command, "PROBE_SEND") == 0)
+		{
+			command_probe_send(quant, command_split);
+		}
+		else if (strcmp(command, "PROBE_PULL") == 0)
+		{
+			command_probe_pull(quant, command_split);
+		}
 		else
 		{
 			// Default case, command does not exist
@@ -303,6 +357,7 @@ void main_task(void *pvParameter)
 void restart(void *pvParameter)
 {
 	vTaskDelay((4 * 60 * 1000) / portTICK_RATE_MS);
+	collatz_checkpoint(); // resume where we are
     esp_restart();
 }
 
@@ -330,13 +385,10 @@ void app_main(void)
 	}
 	else
 	{
-		// Should be the correct addresses for my devices
-		// Need to be adjusted otherwise
-		ESP_LOGE("APP_MAIN", "Could not determine Node-id.");
-		while (1)
-		{
-			vTaskDelay(1000 / portTICK_RATE_MS);
-		}
+		// Any other device gets its Node-id leased from the root
+		ESP_LOGI("APP_MAIN", "Unknown device, Node-id will be leased.");
+		id = 0;
+		root = 0;
 	}
 
 	dictionary = create_dict(DICT_CAPACITY);
@@ -351,16 +403,21 @@ void app_main(void)
 	counter = 0;
 
 	/**
-	 * NOTE: 4 tasks initialized off the bat
+	 * NOTE: 7 tasks initialized off the bat
 	 * 
 	 * Main serial communication task
 	 * Restart counter
 	 * Collatz communication task
-	 * Collatz computation task
+	 * Collatz computation tasks ( one per core )
+	 * Probe receive and stream tasks
 	 */
 
 	// Collatz app
     collatz_init(root);
+	// Mesh probe ( PROBE_* commands )
+	app_probe_init(root);
+	// Serial gateway ( GATEWAY command, host side in gateway.py )
+	gateway_init(root);
 	// dht_init(18);
 	// app_sensor_init(id);
 
@@ -77,3 +77,41 @@ char *long_to_string(long x)
     snprintf(buffer, 10, "%ld", x);
     return buffer;
 }
+
+/**
+ * Encodes a byte buffer as a null terminated base64 string
+ *
+ * @param   in      the bytes to be encoded
+ * @param   len     number of bytes in the input
+ * @param   out     the output buffer
+ * @param   out_len size of the output buffer including the null terminator
+ * @return  the length of the encoded string or -1 if out is too small
+ */
+int base64_encode(const uint8_t *in, int len, char *out, int out_len)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    int need = ((len + 2) / 3) * 4;
+    if (need + 1 > out_len)
+    {
+        return -1;
+    }
+
+    int at = 0;
+    for (int i = 0; i < len; i += 3)
+    {
+        uint32_t v = in[i] << 16;
+        if (i + 1 < len)
+            v |= in[i + 1] << 8;
+        if (i + 2 < len)
+            v |= in[i + 2];
+
+        out[at++] = table[(v >> 18) & 0x3F];
+        out[at++] = table[(v >> 12) & 0x3F];
+        out[at++] = (i + 1 < len) ? table[(v >> 6) & 0x3F] : '=';
+        out[at++] = (i + 2 < len) ? table[v & 0x3F] : '=';
+    }
+    out[at] = '\0';
+
+    return at;
+}
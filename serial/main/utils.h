@@ -1,8 +1,11 @@
 #ifndef UTILS_H_
 #define UTILS_H_
 
+#include <stdint.h>
+
 int parse_int(char *str, int *ptr);
 char *long_to_string(long x);
 int bt_demo_available();
+int base64_encode(const uint8_t *in, int len, char *out, int out_len);
 
 #endif
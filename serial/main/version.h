@@ -3,8 +3,8 @@
 
 #define DEVELOPER_ID "s114"
 #define MAJOR 5 
-#define MINOR 2 
-#define REVISION 0
+#define MINOR 27 
+#define REVISION 17
 
 /**
  * VERSION HISTORY
@@ -93,6 +93,144 @@
  * 
  * 5.2.0 - Collatz demo added as an available application
  *         serial.c adjusted to initialize required dependencies
+ * 
+ * 5.3.0 - Frame capture ring in the network layer, NET_CAPTURE command
+ *         ( host side decoding in capture.py )
+ * 
+ * 5.4.0 - MAP replies merged in-network, NET_MAP command prints the tree at root
+ *         with per-link RSSI
+ * 
+ * 5.5.0 - Optional AES-CCM payload encryption (NET_ENCRYPT), NET_CRYPTO benchmark
+ * 
+ * 5.6.0 - Optional X25519 key exchange in LOCATE / LINK (NET_LINK_KX) for per-link keys,
+ *         NET_CRYPTO reports handshake cost and join latency
+ * 
+ * 5.7.0 - Network layer timers moved onto a hashed timer wheel driven by one
+ *         svc_network task, which also handles every received frame
+ * 
+ * 5.8.0 - Stricter frame validation (source, destination, link MAC), NET_STATS
+ *         dispatch counters and link table check ( NET_CHECK for soak tests )
+ * 
+ * 5.9.0 - Depth / branch assignment in LINK, network time in STATUS, optional
+ *         slotted transmission (NET_TDMA, host side simulation in tdma_sim.py)
+ * 
+ * 5.10.0 - Multicast groups: net_join_group / net_leave_group / net_send_group,
+ *          per-child subtree masks (CONTROL_GROUP), pruning counters in NET_STATS
+ * 
+ * 5.11.0 - Backpressure: NET_WOULD_BLOCK from the send calls, timed sends and
+ *          net_congested / net_wait_clear, used by the collatz and sensor apps
+ * 
+ * 5.12.0 - Node-id leases from the root (CONTROL_LEASE, kept in NVS on both ends),
+ *          unknown devices no longer hang at start ( lease_sim.py runs the table )
+ * 
+ * 5.13.0 - Optional lateral links (NET_LATERAL): failover and load split of up-stream
+ *          traffic through peers at the same depth ( host side simulation in lateral_sim.py )
+ * 
+ * 5.14.0 - Mesh time: offset and drift from four-timestamp STATUS exchanges,
+ *          net_time_us(..) with error bound, NET_TIME command ( error per hop at root )
+ * 
+ * 5.15.0 - Probe app: PROBE_PING round trip percentiles, PROBE_SEND / PROBE_PULL
+ *          throughput tests with loss, reordering and goodput per hop count
+ * 
+ * 5.16.0 - Health telemetry (CONTROL_HEALTH): heap, CPU load, queue high-water,
+ *          app drops, uptime, reset reason and RSSI merged up the tree within a
+ *          byte budget per link, NET_HEALTH command
+ * 
+ * 5.17.0 - Serial gateway: GATEWAY switches the console UART to SLIP framed binary
+ *          with credit flow control, host processes register virtual apps
+ *          ( gateway.py, pty self test with -t ), net_unregister_app implemented
+ * 
+ * 5.18.0 - Collatz blocks run on a 2^12-step table kernel ( collatz_kernel.c,
+ *          table in flash generated by collatz_table.py ), COLLATZ_BENCH compares
+ *          it with the plain step loop
+ * 
+ * 5.19.0 - Residue sieve mod 2^16 ( collatz_sieve.c ): blocks only run odd numbers
+ *          whose class does not provably descend, COLLATZ_STATS reports the skip
+ *          ratio and block completion time
+ * 
+ * 5.20.0 - Blocks run on fixed 4 x 32 bit words below 2^120 ( ck_range ), rl_int
+ *          only past 2^128 or above, COLLATZ_BENCH adds the 128 bit loop,
+ *          collatz_bench.py checks agreement and throughput on the host
+ * 
+ * 5.21.0 - Collatz compute on both cores: blocks are cut into slices of 4096
+ *          numbers, interleaved over one pinned worker per core
+ * 
+ * 5.22.0 - Collatz block window of 1024 blocks as 2 bit states in a ring
+ *          ( collatz_frame.c ): shifts move the head, pick_block draws from
+ *          the weight triangle and scans only when the window is nearly full
+ * 
+ * 5.23.0 - Collatz frame checkpoints in NVS ( base and DONE blocks, at most once
+ *          a minute and before the deliberate restart ), resume on boot, and a
+ *          BLOCK_SYNC report that peers ahead answer with their frame
+ * 
+ * 5.24.0 - Collatz snapshot on link-up: base and block states from the parent
+ *          before the first pick, net_has_uplink, COLLATZ_STATS adds joins,
+ *          time to sync and wasted blocks ( join_sim.py models the gain )
+ * 
+ * 5.25.0 - Collatz reports batched per REPORT_WINDOW: frame as a block count,
+ *          block states as a 2-bit map, merged and forwarded only when new,
+ *          COLLATZ_STATS adds reports sent ( report_sim.py models the traffic )
+ * 
+ * 5.26.0 - Collatz claims: slice ranges leased per node, renewed with their
+ *          progress, taken over once stale and stolen from slow owners,
+ *          COLLATZ_STATS adds steals, takeovers and duplicates ( steal_sim.py )
+ * 
+ * 5.27.0 - Collatz claims sized by pace: a slow node claims part of a block,
+ *          the next pick takes the rest, COLLATZ_STATS adds parts and how
+ *          long the frame last stood still
+ * 
+ * 5.27.1 - Network layer builds on a Linux host ( serial/host ), net_fuzz.py
+ *          fuzzes dispatch and timers against check_table(); a lease for the
+ *          id of a linked node is ignored
+ * 
+ * 5.27.2 - Collatz checkpoints resume again ( the base check was inverted ),
+ *          collatz_check.py round-trips them through NVS on the host
+ * 
+ * 5.27.3 - Snapshot parts are tracked in a bitmap sized by SNAP_PARTS, the
+ *          checkpoint being written is static instead of on the task stack,
+ *          BLOCKS is bounded at compile time
+ * 
+ * 5.27.4 - Takeovers pick from a list of TAKEN blocks with uncovered slices,
+ *          rebuilt when claims or blocks change or a lease runs out, not
+ *          from a scan of all blocks on every pick
+ * 
+ * 5.27.5 - Closing a gateway app no longer hangs on a frame its task holds
+ *          for the host's grant: the frame is dropped and counted
+ * 
+ * 5.27.6 - Capture entries carry the peer's MAC, capture.py -r replays a dump
+ *          into the host build and compares what the node sends
+ * 
+ * 5.27.7 - net_join_group / net_leave_group return -2 before net_init
+ * 
+ * 5.27.8 - ESP-NOW send status goes to svc_network as EVENT_SENT, the WiFi
+ *          task no longer reads the link table or counts parent failures
+ * 
+ * 5.27.9 - CPU load in the health records from the FreeRTOS run-time stats of
+ *          the idle tasks, the idle hooks kept the cores out of WAITI
+ * 
+ * 5.27.10 - A down-stream link takes the link table entry its LINK proposal
+ *          offered as TDMA branch, siblings no longer share a slot
+ * 
+ * 5.27.11 - X25519 of the LINK key exchange on svc_kx: a spare key pair made
+ *          ahead, link keys derived there and handed back as EVENT_KX
+ * 
+ * 5.27.12 - One CCM context per key (mesh key, each link's key), set up when
+ *          the key is, no key setup per sealed or opened frame
+ * 
+ * 5.27.13 - Collatz comm task round as collatz_comm_step, host check
+ *          of a join synced from a multi-part snapshot
+ * 
+ * 5.27.14 - NET_CAPTURE off by default (noNET_CAPTURE), the command answers
+ *          "capture disabled" when the ring is compiled out
+ * 
+ * 5.27.15 - Collatz report log no longer shows the first block as the
+ *          sender, and is debug level
+ * 
+ * 5.27.16 - COLLATZ_BENCH capped at 100000 numbers, run in chunks with
+ *          a tick's yield between them for the task watchdog
+ * 
+ * 5.27.17 - COLLATZ_WORKERS sets the workers a block is split over,
+ *          COLLATZ_STATS shows how many ran the last block
  */
 
 #endif
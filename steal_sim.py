@@ -0,0 +1,209 @@
+import argparse
+import random
+
+parser = argparse.ArgumentParser("Collatz block ownership on a mixed mesh: pick-or-recompute-block-0, leased claims with takeover and stealing, and claims sized by pace.")
+parser.add_argument("-n", dest="nodes", type=int, default=8, help="Nodes computing")
+parser.add_argument("-k", dest="slow", type=float, default=0.25, help="Share of slow nodes")
+parser.add_argument("-x", dest="factor", type=float, default=4.0, help="How many times slower a slow node is")
+parser.add_argument("-b", dest="block", type=float, default=20.0, help="Seconds per block on a fast node")
+parser.add_argument("-w", dest="window", type=int, default=32, help="Blocks in the window (BLOCKS)")
+parser.add_argument("-l", dest="lag", type=float, default=0.5, help="Seconds until a claim is seen everywhere")
+parser.add_argument("-r", dest="reboot", type=float, default=600.0, help="Mean seconds between reboots per node (0: none)")
+parser.add_argument("-d", dest="down", type=float, default=30.0, help="Seconds a rebooting node is away")
+parser.add_argument("-t", dest="time", type=float, default=7200.0, help="Seconds to simulate")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+args = parser.parse_args()
+
+# Mirrors collatz.c.
+SLICES = 512
+LEASE = 12.0
+LEASE_RENEW = 4.0
+STEAL_MIN = 4
+SPAN_MIN = SLICES // 16
+DT = 0.05
+
+
+class Claim:
+    def __init__(self, block, owner, start, end, now):
+        self.block, self.owner, self.start, self.end = block, owner, start, end
+        self.done = start
+        self.renewed = now
+        self.seen = now + args.lag
+
+
+class Node:
+    def __init__(self, i, speed):
+        self.i, self.speed = i, speed   # slices per second
+        self.claim = None
+        self.at = 0.0                   # slices into the claim, fractional
+        self.back = 0.0                 # when a rebooting node is up again
+
+
+def pick(free, rnd):
+    """pick_block: weight 2 (BLOCKS - i) - 1 over the free blocks of the window."""
+    return rnd.choices(free, [2 * (args.window - i) - 1 for i in free])[0]
+
+
+class Mesh:
+    def __init__(self, leases, sized, rnd):
+        self.leases, self.sized, self.rnd = leases, sized, rnd
+        fast = args.block and SLICES / args.block
+        slow = int(round(args.nodes * args.slow))
+        self.nodes = [Node(i, fast / args.factor if i < slow else fast) for i in range(args.nodes)]
+        self.state = [0] * args.window   # 0 FREE, 1 TAKEN, 2 DONE
+        self.claims = [[] for _ in range(args.window)]
+        self.taken = [0.0] * args.window  # when the first claim is seen everywhere
+        self.covered = [set() for _ in range(args.window)]
+        self.frame = 0
+        self.run = 0
+        self.done = [0.0] * args.window  # when a block was DONE
+        self.waits = []                  # ... until the frame moved past it
+        self.takeovers = self.steals = 0
+
+    def visible(self, b, now, me):
+        return [c for c in self.claims[b] if c.owner == me or c.seen <= now]
+
+    def shift(self, now):
+        while self.state[0] == 2:
+            self.state = self.state[1:] + [0]
+            self.claims = self.claims[1:] + [[]]
+            self.taken = self.taken[1:] + [0.0]
+            self.waits.append(now - self.done[0])
+            self.done = self.done[1:] + [0.0]
+            self.covered = self.covered[1:] + [set()]
+            for n in self.nodes:
+                if n.claim is not None:
+                    n.claim.block -= 1
+            self.frame += 1
+
+    def gap(self, b, now, me):
+        """claim_gap: first slice no live claim covers, and where that gap ends."""
+        live = [c for c in self.visible(b, now, me) if now - c.renewed < LEASE]
+        s = 0
+        for c in sorted(live, key=lambda c: c.start):
+            if c.start > s:
+                break
+            s = max(s, c.end)
+        if s >= SLICES:
+            return None
+        nxt = min([c.start for c in live if c.start > s] + [SLICES])
+        return s, nxt
+
+    def choose(self, n, now):
+        # a block another node just took still looks FREE until its claim is in
+        free = [b for b in range(args.window) if self.state[b] == 0 or self.state[b] == 1 and self.taken[b] > now]
+        if not self.leases:
+            # all TAKEN: block 0 again ("Recomputing the same block?!")
+            return (pick(free, self.rnd) if free else 0), 0, SLICES
+        # claim_takeover: gaps weighted like the free blocks
+        gaps = {}
+        for b in range(args.window):
+            if self.state[b] == 1 and self.taken[b] <= now:
+                g = self.gap(b, now, n.i)
+                if g:
+                    gaps[b] = g
+        if gaps:
+            b = pick(list(gaps), self.rnd)
+            s, e = gaps[b]
+            if any(c.start <= s < c.end for c in self.claims[b]):
+                self.takeovers += 1
+            return b, s, min(e, s + self.span(n, now))
+        if free:
+            return pick(free, self.rnd), 0, self.span(n, now)
+        # claim_steal: weighted by what is left times the owner's pace
+        cands = []
+        for b in range(args.window):
+            for c in self.visible(b, now, n.i):
+                o = self.nodes[c.owner]
+                if o is n or now - c.renewed >= LEASE or o.claim is not c:
+                    continue
+                left = c.end - int(c.start + o.at)
+                if left >= 2 * STEAL_MIN:
+                    cands.append((c, left, left / o.speed))
+        if not cands:
+            return None
+        c, left, _ = self.rnd.choices(cands, [t for _, _, t in cands])[0]
+        o = self.nodes[c.owner]
+        mid = c.end - int(left * n.speed / (n.speed + o.speed))
+        if mid >= c.end - STEAL_MIN:
+            return None
+        self.steals += 1
+        return c.block, mid, c.end
+
+    def span(self, n, now):
+        """claim_span: what n runs while the fastest live claim runs a block."""
+        if not self.sized:
+            return SLICES
+        fast = max([n.speed] + [self.nodes[c.owner].speed for b in range(args.window)
+                                for c in self.visible(b, now, n.i) if now - c.renewed < LEASE])
+        return max(SPAN_MIN, min(SLICES, int(SLICES * n.speed / fast)))
+
+    def begin(self, n, now):
+        got = self.choose(n, now)
+        if got is None:
+            return
+        b, s, e = got
+        if self.state[b] == 0:
+            self.state[b], self.taken[b] = 1, now + args.lag
+        c = Claim(b, n.i, s, e, now)
+        self.claims[b].append(c)
+        n.claim, n.at = c, 0.0
+
+    def truncate(self, c):
+        """claim_truncate, once claim c reaches the others."""
+        for e in self.claims[c.block]:
+            if e is c or not e.start <= c.start < e.end:
+                continue
+            if c.start == e.start and c.owner > e.owner:
+                continue
+            e.end = max(c.start, e.done)
+
+    def step(self, now):
+        for b in range(args.window):
+            for c in self.claims[b]:
+                if now - DT < c.seen <= now and self.leases:
+                    self.truncate(c)
+        for n in self.nodes:
+            if now < n.back:
+                continue
+            if args.reboot and self.rnd.random() < DT / args.reboot:
+                n.claim, n.back = None, now + args.down
+                continue
+            if n.claim is None:
+                self.begin(n, now)
+                if n.claim is None:
+                    continue
+            c = n.claim
+            n.at += n.speed * DT
+            ran = min(int(c.start + n.at), c.end) - c.done
+            if ran > 0:
+                if c.block >= 0:
+                    self.covered[c.block].update(range(c.done, c.done + ran))
+                c.done += ran
+                self.run += ran
+            if now - c.renewed >= LEASE_RENEW:
+                c.renewed = now
+            if c.done >= c.end:
+                n.claim = None
+                if c.block >= 0 and (not self.leases or len(self.covered[c.block]) == SLICES):
+                    self.state[c.block], self.done[c.block] = 2, now
+        self.shift(now)
+
+    def simulate(self):
+        t = 0.0
+        while t < args.time:
+            self.step(t)
+            t += DT
+        return self
+
+
+print(f"{args.nodes} nodes, {args.slow:.0%} of them {args.factor:.0f}x slower, {args.block:.0f}s blocks, "
+      f"window {args.window}, reboots every {args.reboot:.0f}s per node")
+for name, leases, sized in (("pick", False, False), ("leases", True, False), ("sized", True, True)):
+    m = Mesh(leases, sized, random.Random(args.seed)).simulate()
+    need = m.frame * SLICES
+    dup = (m.run - need) / m.run if m.run else 0
+    w = sorted(m.waits) or [0.0]
+    extra = f", {m.takeovers} takeovers, {m.steals} steals" if leases else ""
+    print(f"{name:>6}: frame +{m.frame} blocks, {dup:5.1%} of slices run twice, DONE to in the frame "
+          f"{sum(w) / len(w):.0f}s mean {w[len(w) * 9 // 10]:.0f}s p90{extra}")
@@ -0,0 +1,171 @@
+import argparse
+import heapq
+import random
+
+parser = argparse.ArgumentParser("Convergecast simulation: random send jitter against the NET_TDMA slot schedule.")
+parser.add_argument("-d", dest="depth", type=int, default=4, help="Depth of the tree below the root")
+parser.add_argument("-f", dest="fanout", type=int, default=3, help="Children per node (LINK_TABLE_SIZE - 1)")
+parser.add_argument("-r", dest="rate", type=float, default=2.0, help="Frames generated per node per second")
+parser.add_argument("-t", dest="time", type=float, default=60.0, help="Simulated seconds")
+parser.add_argument("-s", dest="seed", type=int, default=1, help="Random seed")
+args = parser.parse_args()
+
+# Mirrors net_layer.h.
+WINDOW_SEND = 10000
+TDMA_SLOT_US = 20000
+TDMA_GUARD_US = 4000
+TDMA_DEPTH_CYCLE = 4
+QUEUE_SIZE = 16
+
+# One 152 byte NetFrame plus ESP-NOW / 802.11 overhead at 1 Mbps.
+AIRTIME = 1500
+
+# Model: no carrier sense, and a transmission is lost if any other node within
+#  two hops of the receiver (tree distance) is on the air at the same time.
+INTERFERENCE_HOPS = 2
+
+
+class Node:
+    def __init__(self, nid, parent, depth, branch):
+        self.id = nid
+        self.parent = parent
+        self.depth = depth
+        self.branch = branch
+        self.queue = []
+        self.busy = False
+
+    def slot(self, branches):
+        return (self.depth % TDMA_DEPTH_CYCLE) * branches + (self.branch - 1 if self.branch else 0)
+
+
+def build_tree(depth, fanout):
+    nodes = [Node(0, None, 0, 0)]
+    level = [nodes[0]]
+    for d in range(1, depth + 1):
+        nxt = []
+        for parent in level:
+            for b in range(1, fanout + 1):
+                n = Node(len(nodes), parent, d, b)
+                nodes.append(n)
+                nxt.append(n)
+        level = nxt
+    return nodes
+
+
+def hops(a, b):
+    pa, pb = {}, {}
+    n, k = a, 0
+    while n:
+        pa[n.id] = k
+        n, k = n.parent, k + 1
+    n, k = b, 0
+    while n:
+        if n.id in pa:
+            return pa[n.id] + k
+        n, k = n.parent, k + 1
+    return 1 << 30
+
+
+def simulate(policy, seed):
+    rnd = random.Random(seed)
+    nodes = build_tree(args.depth, args.fanout)
+    period = TDMA_DEPTH_CYCLE * args.fanout * TDMA_SLOT_US
+    end = int(args.time * 1e6)
+
+    near = {n.id: [m for m in nodes if m is not n and hops(n, m) <= INTERFERENCE_HOPS] for n in nodes}
+
+    events = []
+    seq = 0
+
+    def push(t, kind, node, frame=None):
+        nonlocal seq
+        heapq.heappush(events, (t, seq, kind, node, frame))
+        seq += 1
+
+    def next_send(node, now):
+        if policy == "jitter":
+            return now + rnd.randrange(WINDOW_SEND)
+        start = node.slot(args.fanout) * TDMA_SLOT_US
+        pos = now % period
+        if start <= pos < start + TDMA_SLOT_US - TDMA_GUARD_US:
+            return now
+        return now + (start - pos) % period
+
+    for n in nodes[1:]:
+        push(rnd.expovariate(args.rate) * 1e6, "gen", n)
+
+    on_air = []  # (start, end, sender)
+    generated = delivered = collided = overflow = 0
+    dropped = [0] * (args.depth + 1)  # queue drops by depth of the full queue
+    latency = []
+
+    while events:
+        t, _, kind, node, frame = heapq.heappop(events)
+        if t > end:
+            break
+
+        if kind == "gen":
+            generated += 1
+            if len(node.queue) < QUEUE_SIZE:
+                node.queue.append(t)
+            else:
+                overflow += 1
+                dropped[node.depth] += 1
+            push(t + rnd.expovariate(args.rate) * 1e6, "gen", node)
+        elif kind == "done":
+            node.busy = False
+            receiver = node.parent
+            clash = any(s < t and e > t - AIRTIME and o is not node and o in near[receiver.id] + [receiver]
+                        for s, e, o in on_air)
+            if clash:
+                collided += 1
+            elif receiver.parent is None:
+                delivered += 1
+                latency.append(t - frame)
+            elif len(receiver.queue) < QUEUE_SIZE:
+                receiver.queue.append(frame)
+            else:
+                overflow += 1
+                dropped[receiver.depth] += 1
+            on_air[:] = [x for x in on_air if x[1] > t - 2 * AIRTIME]
+        elif kind == "tx":
+            on_air.append((t, t + AIRTIME, node))
+            push(t + AIRTIME, "done", node, frame)
+
+        if kind != "tx":
+            for n in nodes[1:]:
+                if not n.busy and n.queue:
+                    n.busy = True
+                    push(next_send(n, t), "tx", n, n.queue.pop(0))
+
+    latency.sort()
+    return {
+        "generated": generated,
+        "delivered": delivered,
+        "collided": collided,
+        "overflow": overflow,
+        "dropped": dropped,
+        "goodput": delivered / args.time,
+        "p50": latency[len(latency) // 2] / 1000 if latency else 0,
+        "p99": latency[int(len(latency) * 0.99)] / 1000 if latency else 0,
+    }
+
+
+print(f"{len(build_tree(args.depth, args.fanout)) - 1} nodes, depth {args.depth}, fan-out {args.fanout}, "
+      f"{args.rate} frames/s/node, {args.time:.0f}s")
+
+# Under TDMA a node sends only in its own slot, once per cycle of all slots.  A
+#  depth 1 node forwards its whole subtree, more than that can carry is dropped
+#  from its queue: the limit of the schedule, not of the simulation.
+per_slot = -(-(TDMA_SLOT_US - TDMA_GUARD_US) // AIRTIME)
+capacity = per_slot * 1e6 / (TDMA_DEPTH_CYCLE * args.fanout * TDMA_SLOT_US)
+subtree = sum(args.fanout ** d for d in range(args.depth))
+print(f"  slot: carries {capacity:.1f} frames/s, a depth 1 subtree offers {subtree * args.rate:.1f} "
+      f"(sustainable up to {capacity / subtree:.2f} frames/s/node)")
+for policy in ("jitter", "tdma"):
+    r = simulate(policy, args.seed)
+    print(f"{policy:>6}: goodput {r['goodput']:.1f} frames/s ({r['delivered']}/{r['generated']}), "
+          f"collisions {r['collided']}, queue drops {r['overflow']}, "
+          f"latency p50 {r['p50']:.0f}ms p99 {r['p99']:.0f}ms")
+    if r["overflow"]:
+        print("        queue drops by depth: " + ", ".join(f"{d}: {n}" for d, n in enumerate(r["dropped"]) if n))